@@ -0,0 +1,63 @@
+from sedona.utils import geometry_serde
+
+from bench_serde import (
+    short_line, short_line_iterations,
+    long_line, long_line_iterations,
+    point, point_iterations,
+    small_polygon, small_polygon_iterations,
+    large_polygon, large_polygon_iterations,
+    large_multipoint, large_multipoint_iterations,
+    large_multilinestring, large_multilinestring_iterations,
+    large_multipolygon, large_multipolygon_iterations,
+)
+
+# Coordinate copy paths compared with the per-coordinate loop, the 'shapely'
+# path only differs from the loop for deserialization
+coord_copy_paths = ['geos_buffer', 'shapely']
+
+shapes = [
+    (short_line, short_line_iterations, "short line"),
+    (long_line, long_line_iterations, "long line"),
+    (point, point_iterations, "point"),
+    (small_polygon, small_polygon_iterations, "small polygon"),
+    (large_polygon, large_polygon_iterations, "large polygon"),
+    (large_multipoint, large_multipoint_iterations, "large multipoint"),
+    (large_multilinestring, large_multilinestring_iterations, "large multilinestring"),
+    (large_multipolygon, large_multipolygon_iterations, "large multipolygon"),
+]
+
+
+def forcing(path, func):
+    def run():
+        prev_path = geometry_serde.set_coord_copy_path(path)
+        try:
+            func()
+        finally:
+            geometry_serde.set_coord_copy_path(prev_path)
+    return run
+
+
+def bench_serialize(geom, iterations, name, path):
+
+    def serialize():
+        for k in range(iterations):
+            geometry_serde.serialize(geom)
+
+    return (forcing('loop', serialize), forcing(path, serialize), "serialize {} - {}".format(path, name))
+
+
+def bench_deserialize(geom, iterations, name, path):
+
+    buf = geometry_serde.serialize(geom)
+
+    def deserialize():
+        for k in range(iterations):
+            geometry_serde.deserialize(buf)
+
+    return (forcing('loop', deserialize), forcing(path, deserialize), "deserialize {} - {}".format(path, name))
+
+
+__benchmarks__ = (
+    [bench_serialize(*shape, path) for path in coord_copy_paths for shape in shapes]
+    + [bench_deserialize(*shape, path) for path in coord_copy_paths for shape in shapes]
+)
@@ -0,0 +1,74 @@
+import shapely
+from sedona.utils import geometry_serde
+
+from bench_serde import (
+    short_line, short_line_iterations,
+    long_line, long_line_iterations,
+    point, point_iterations,
+    small_polygon, small_polygon_iterations,
+    large_polygon, large_polygon_iterations,
+    large_multipoint, large_multipoint_iterations,
+    large_multilinestring, large_multilinestring_iterations,
+    large_multipolygon, large_multipolygon_iterations,
+)
+
+coord_encodings = ['float32', 'quantized', 'xor']
+
+shapes = [
+    (short_line, short_line_iterations, "short line"),
+    (long_line, long_line_iterations, "long line"),
+    (point, point_iterations, "point"),
+    (small_polygon, small_polygon_iterations, "small polygon"),
+    (large_polygon, large_polygon_iterations, "large polygon"),
+    (large_multipoint, large_multipoint_iterations, "large multipoint"),
+    (large_multilinestring, large_multilinestring_iterations, "large multilinestring"),
+    (large_multipolygon, large_multipolygon_iterations, "large multipolygon"),
+]
+
+
+def bench_encode(geom, iterations, name, coord_encoding):
+
+    buf = geometry_serde.serialize(geom)
+
+    def copy_plain():
+        for k in range(iterations):
+            geometry_serde.encode_coords(buf, 'none')
+
+    def encode():
+        for k in range(iterations):
+            geometry_serde.encode_coords(buf, coord_encoding)
+
+    return (copy_plain, encode, "encode {} - {}".format(coord_encoding, name))
+
+
+def bench_decode(geom, iterations, name, coord_encoding):
+
+    buf = geometry_serde.serialize(geom)
+    encoded = geometry_serde.encode_coords(buf, coord_encoding)
+
+    def deserialize_plain():
+        for k in range(iterations):
+            geometry_serde.deserialize(buf)
+
+    def deserialize_encoded():
+        for k in range(iterations):
+            geometry_serde.deserialize(encoded)
+
+    return (deserialize_plain, deserialize_encoded, "deserialize {} - {}".format(coord_encoding, name))
+
+
+__benchmarks__ = (
+    [bench_encode(*shape, coord_encoding) for coord_encoding in coord_encodings for shape in shapes]
+    + [bench_decode(*shape, coord_encoding) for coord_encoding in coord_encodings for shape in shapes]
+)
+
+
+if __name__ == '__main__':
+    print("{:<24}{:>10}".format("bytes per vertex", "plain")
+          + "".join("{:>12}".format(e) for e in coord_encodings))
+    for geom, _, name in shapes:
+        buf = geometry_serde.serialize(geom)
+        num_coords = shapely.get_num_coordinates(geom)
+        sizes = [len(buf)] + [len(geometry_serde.encode_coords(buf, e)) for e in coord_encodings]
+        print("{:<24}{:>10.2f}".format(name, sizes[0] / num_coords)
+              + "".join("{:>12.2f}".format(size / num_coords) for size in sizes[1:]))
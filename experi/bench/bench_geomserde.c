@@ -0,0 +1,355 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/* Native microbenchmark of geometry serialization, without going through the
+ * Python interpreter. Serialize and deserialize are timed for a matrix of
+ * geometry type x vertex count x XY/XYZ x fast/slow coordinate copying path,
+ * results are written as JSON. The slow path is forced by hiding
+ * GEOSCoordSeq_copyToBuffer_r and GEOSCoordSeq_copyFromBuffer_r, just like
+ * running on libgeos < 3.10.
+ *
+ * See experi/bench/Makefile for building it. Usage:
+ *
+ *   bench_geomserde [-l libgeos_c] [-t min_seconds] [-o output.json]
+ */
+
+#include <dlfcn.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "geomserde.h"
+#include "geos_c_dyn.h"
+
+#define NUM_REPEATS 5
+
+typedef struct BenchCase {
+  const char *name;
+  int geos_type;
+  /* number of parts of multi geometries, 0 for non-collections */
+  int num_parts;
+} BenchCase;
+
+static const BenchCase bench_cases[] = {
+    {"point", GEOS_POINT, 0},
+    {"linestring", GEOS_LINESTRING, 0},
+    {"polygon", GEOS_POLYGON, 0},
+    {"multipoint", GEOS_MULTIPOINT, 0},
+    {"multilinestring", GEOS_MULTILINESTRING, 8},
+    {"multipolygon", GEOS_MULTIPOLYGON, 8},
+};
+
+static const int vertex_counts[] = {4, 64, 1024, 16384};
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void geos_message_handler(const char *fmt, ...) { (void)fmt; }
+
+static GEOSCoordSequence *make_coord_seq(GEOSContextHandle_t handle,
+                                         int num_coords, int has_z,
+                                         int closed, double offset) {
+  GEOSCoordSequence *coord_seq =
+      dyn_GEOSCoordSeq_create_r(handle, num_coords, has_z ? 3 : 2);
+  if (coord_seq == NULL) {
+    return NULL;
+  }
+  for (int k = 0; k < num_coords; k++) {
+    int j = (closed && k == num_coords - 1) ? 0 : k;
+    double angle = 2 * M_PI * j / (closed ? num_coords - 1 : num_coords);
+    double x = offset + 100 * cos(angle);
+    double y = offset + 100 * sin(angle);
+    if (has_z) {
+      dyn_GEOSCoordSeq_setXYZ_r(handle, coord_seq, k, x, y, (double)j);
+    } else {
+      dyn_GEOSCoordSeq_setXY_r(handle, coord_seq, k, x, y);
+    }
+  }
+  return coord_seq;
+}
+
+static GEOSGeometry *make_simple_geom(GEOSContextHandle_t handle, int type,
+                                      int num_coords, int has_z,
+                                      double offset) {
+  switch (type) {
+    case GEOS_POINT:
+      return dyn_GEOSGeom_createPoint_r(
+          handle, make_coord_seq(handle, 1, has_z, 0, offset));
+    case GEOS_LINESTRING:
+      return dyn_GEOSGeom_createLineString_r(
+          handle, make_coord_seq(handle, num_coords, has_z, 0, offset));
+    case GEOS_POLYGON: {
+      GEOSGeometry *shell = dyn_GEOSGeom_createLinearRing_r(
+          handle, make_coord_seq(handle, num_coords, has_z, 1, offset));
+      return dyn_GEOSGeom_createPolygon_r(handle, shell, NULL, 0);
+    }
+    default:
+      return NULL;
+  }
+}
+
+/* Total number of vertices of the geometry is num_vertices, divided evenly
+ * among parts of multi geometries */
+static GEOSGeometry *make_geom(GEOSContextHandle_t handle,
+                               const BenchCase *bench_case, int num_vertices,
+                               int has_z) {
+  int num_parts;
+  int part_type;
+  switch (bench_case->geos_type) {
+    case GEOS_POINT:
+    case GEOS_LINESTRING:
+    case GEOS_POLYGON:
+      return make_simple_geom(handle, bench_case->geos_type, num_vertices,
+                              has_z, 0);
+    case GEOS_MULTIPOINT:
+      num_parts = num_vertices;
+      part_type = GEOS_POINT;
+      break;
+    case GEOS_MULTILINESTRING:
+      num_parts = bench_case->num_parts;
+      part_type = GEOS_LINESTRING;
+      break;
+    default:
+      num_parts = bench_case->num_parts;
+      part_type = GEOS_POLYGON;
+      break;
+  }
+  int part_vertices = num_vertices / num_parts;
+  if (part_vertices < 4) {
+    part_vertices = 4;
+  }
+  GEOSGeometry **parts = calloc(num_parts, sizeof(GEOSGeometry *));
+  if (parts == NULL) {
+    return NULL;
+  }
+  for (int k = 0; k < num_parts; k++) {
+    parts[k] = make_simple_geom(handle, part_type, part_vertices, has_z,
+                                300.0 * k);
+  }
+  GEOSGeometry *geom = dyn_GEOSGeom_createCollection_r(
+      handle, bench_case->geos_type, parts, num_parts);
+  free(parts);
+  return geom;
+}
+
+typedef struct BenchResult {
+  long iterations;
+  double ns_per_op;
+} BenchResult;
+
+/* Runs the operation in batches of doubling size until a batch takes at least
+ * min_ns, then reports the median of NUM_REPEATS batches of that size */
+#define RUN_BENCH(result, min_ns, body)                                   \
+  do {                                                                    \
+    long iterations = 1;                                                  \
+    double samples[NUM_REPEATS];                                          \
+    for (;;) {                                                            \
+      double start = now_ns();                                            \
+      for (long it = 0; it < iterations; it++) {                          \
+        body;                                                             \
+      }                                                                   \
+      double elapsed = now_ns() - start;                                  \
+      if (elapsed >= (min_ns) || iterations >= (1L << 30)) break;         \
+      iterations *= 2;                                                    \
+    }                                                                     \
+    for (int r = 0; r < NUM_REPEATS; r++) {                               \
+      double start = now_ns();                                            \
+      for (long it = 0; it < iterations; it++) {                          \
+        body;                                                             \
+      }                                                                   \
+      samples[r] = (now_ns() - start) / iterations;                       \
+    }                                                                     \
+    qsort(samples, NUM_REPEATS, sizeof(double), compare_double);          \
+    (result).iterations = iterations;                                     \
+    (result).ns_per_op = samples[NUM_REPEATS / 2];                        \
+  } while (0)
+
+static int compare_double(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static void print_result(FILE *out, int *first, const char *op,
+                         const char *type, int num_vertices, int has_z,
+                         const char *path, int num_bytes,
+                         const BenchResult *result) {
+  fprintf(out,
+          "%s\n    {\"op\": \"%s\", \"type\": \"%s\", \"num_vertices\": %d, "
+          "\"coord_type\": \"%s\", \"path\": \"%s\", \"bytes\": %d, "
+          "\"iterations\": %ld, \"ns_per_op\": %.2f, \"gb_per_s\": %.4f}",
+          *first ? "" : ",", op, type, num_vertices, has_z ? "XYZ" : "XY",
+          path, num_bytes, result->iterations, result->ns_per_op,
+          num_bytes / result->ns_per_op);
+  *first = 0;
+}
+
+static int run_case(FILE *out, int *first, GEOSContextHandle_t handle,
+                    const BenchCase *bench_case, int num_vertices, int has_z,
+                    double min_ns, void *copy_to_buffer,
+                    void *copy_from_buffer) {
+  GEOSGeometry *geom = make_geom(handle, bench_case, num_vertices, has_z);
+  if (geom == NULL) {
+    fprintf(stderr, "failed to create %s\n", bench_case->name);
+    return -1;
+  }
+  int buf_size = 0;
+  SedonaErrorCode err = sedona_serialized_size(handle, geom, &buf_size);
+  char *buf = (err == SEDONA_SUCCESS ? malloc(buf_size) : NULL);
+  if (buf == NULL) {
+    dyn_GEOSGeom_destroy_r(handle, geom);
+    fprintf(stderr, "failed to serialize %s\n", bench_case->name);
+    return -1;
+  }
+  int actual_vertices = dyn_GEOSGetNumCoordinates_r(handle, geom);
+
+  for (int slow = 0; slow <= 1; slow++) {
+    const char *path = slow ? "slow" : "fast";
+    if (!slow && copy_to_buffer == NULL) {
+      /* libgeos < 3.10 has no fast path */
+      continue;
+    }
+    dyn_GEOSCoordSeq_copyToBuffer_r = slow ? NULL : copy_to_buffer;
+    dyn_GEOSCoordSeq_copyFromBuffer_r = slow ? NULL : copy_from_buffer;
+
+    BenchResult result;
+    int bytes_written = 0;
+    RUN_BENCH(result, min_ns, {
+      err = sedona_serialize_geom_into(handle, geom, buf, buf_size,
+                                       &bytes_written);
+      if (err != SEDONA_SUCCESS) break;
+    });
+    if (err != SEDONA_SUCCESS) {
+      break;
+    }
+    print_result(out, first, "serialize", bench_case->name, actual_vertices,
+                 has_z, path, buf_size, &result);
+
+    /* Deserialization includes destroying the deserialized geometry */
+    RUN_BENCH(result, min_ns, {
+      GEOSGeometry *geom_out = NULL;
+      int bytes_read = 0;
+      err = sedona_deserialize_geom(handle, buf, buf_size, &geom_out,
+                                    &bytes_read);
+      if (err != SEDONA_SUCCESS) break;
+      dyn_GEOSGeom_destroy_r(handle, geom_out);
+    });
+    if (err != SEDONA_SUCCESS) {
+      break;
+    }
+    print_result(out, first, "deserialize", bench_case->name, actual_vertices,
+                 has_z, path, buf_size, &result);
+  }
+
+  dyn_GEOSCoordSeq_copyToBuffer_r = copy_to_buffer;
+  dyn_GEOSCoordSeq_copyFromBuffer_r = copy_from_buffer;
+  free(buf);
+  dyn_GEOSGeom_destroy_r(handle, geom);
+  if (err != SEDONA_SUCCESS) {
+    fprintf(stderr, "%s: %s\n", bench_case->name,
+            sedona_get_error_message(err));
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *geos_path = "libgeos_c.so.1";
+  const char *output_path = NULL;
+  double min_seconds = 0.05;
+  int opt;
+  while ((opt = getopt(argc, argv, "l:t:o:h")) != -1) {
+    switch (opt) {
+      case 'l':
+        geos_path = optarg;
+        break;
+      case 't':
+        min_seconds = atof(optarg);
+        break;
+      case 'o':
+        output_path = optarg;
+        break;
+      default:
+        fprintf(stderr,
+                "usage: %s [-l libgeos_c] [-t min_seconds] [-o output.json]\n",
+                argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  void *lib = dlopen(geos_path, RTLD_LOCAL | RTLD_NOW);
+  if (lib == NULL) {
+    fprintf(stderr, "cannot load %s: %s\n", geos_path, dlerror());
+    return 1;
+  }
+  char err_msg[256];
+  if (load_geos_c_from_handle(lib, err_msg, sizeof(err_msg)) != 0) {
+    fprintf(stderr, "%s\n", err_msg);
+    return 1;
+  }
+  const char *(*geos_version)(void) =
+      (const char *(*)(void))dlsym(lib, "GEOSversion");
+
+  FILE *out = stdout;
+  if (output_path != NULL && (out = fopen(output_path, "w")) == NULL) {
+    perror(output_path);
+    return 1;
+  }
+
+  GEOSContextHandle_t handle = dyn_GEOS_init_r();
+  dyn_GEOSContext_setErrorHandler_r(handle, geos_message_handler);
+  void *copy_to_buffer = (void *)dyn_GEOSCoordSeq_copyToBuffer_r;
+  void *copy_from_buffer = (void *)dyn_GEOSCoordSeq_copyFromBuffer_r;
+
+  fprintf(out,
+          "{\n  \"geos_version\": \"%s\",\n  \"min_seconds\": %g,\n"
+          "  \"repeats\": %d,\n  \"results\": [",
+          geos_version != NULL ? geos_version() : "unknown", min_seconds,
+          NUM_REPEATS);
+  int first = 1;
+  int status = 0;
+  int num_cases = sizeof(bench_cases) / sizeof(bench_cases[0]);
+  int num_vertex_counts = sizeof(vertex_counts) / sizeof(vertex_counts[0]);
+  for (int i = 0; i < num_cases && status == 0; i++) {
+    for (int j = 0; j < num_vertex_counts && status == 0; j++) {
+      /* Points have a single vertex */
+      if (bench_cases[i].geos_type == GEOS_POINT && j > 0) {
+        break;
+      }
+      for (int has_z = 0; has_z <= 1 && status == 0; has_z++) {
+        status = run_case(out, &first, handle, &bench_cases[i],
+                          vertex_counts[j], has_z, min_seconds * 1e9,
+                          copy_to_buffer, copy_from_buffer);
+      }
+    }
+  }
+  fprintf(out, "\n  ]\n}\n");
+
+  dyn_GEOS_finish_r(handle);
+  if (out != stdout) {
+    fclose(out);
+  }
+  return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+"""Benchmarks of geometry serde on synthetic datasets resembling production
+data, compared against the vectorized WKB functions of shapely 2.
+
+Each dataset is generated from a fixed seed and has 10 % NULL rows:
+
+    buildings     OSM-like building footprints, 4 to 12 vertices
+    trajectories  long GPS tracks, 500 to 5000 vertices
+    admin         administrative multipolygons with holes
+    mixed         mix of all geometry types, including collections
+
+Single-call benchmarks time every call and report p50/p99 latency per call.
+Batch benchmarks time the whole batch repeatedly and report p50/p99 latency
+per batch. All of them report rows/s (NULL rows included), the peak of
+memory traced by tracemalloc in a separate untimed run, and the max RSS of
+the process after the run. Results are written as JSON, pass the JSON of
+a previous run with --baseline to print speedups against it:
+
+    python bench_workloads.py -o after.json --baseline before.json
+"""
+
+import argparse
+import json
+import platform
+import resource
+import sys
+import time
+import tracemalloc
+
+import numpy as np
+import shapely
+from shapely.geometry import GeometryCollection, LineString, MultiLineString, MultiPoint, MultiPolygon, Point, Polygon
+
+from sedona import version as sedona_version
+from sedona.utils import geometry_serde
+
+NULL_FRACTION = 0.1
+
+
+def _ring(rng, cx, cy, radius, num_vertices, jitter=0.3):
+    angles = np.sort(rng.uniform(0, 2 * np.pi, num_vertices))
+    radii = radius * (1 + rng.uniform(-jitter, jitter, num_vertices))
+    coords = np.column_stack([cx + radii * np.cos(angles), cy + radii * np.sin(angles)])
+    return np.vstack([coords, coords[:1]])
+
+
+def _building(rng):
+    cx, cy = rng.uniform(-0.1, 0.1) + 13.4, rng.uniform(-0.1, 0.1) + 52.5
+    num_vertices = rng.integers(4, 13)
+    if num_vertices == 4:
+        w, h = rng.uniform(5e-5, 3e-4, 2)
+        return Polygon([(cx, cy), (cx + w, cy), (cx + w, cy + h), (cx, cy + h)])
+    return Polygon(_ring(rng, cx, cy, rng.uniform(5e-5, 3e-4), num_vertices - 1, jitter=0.1))
+
+
+def _trajectory(rng):
+    num_vertices = rng.integers(500, 5001)
+    steps = rng.normal(0, 1e-4, (num_vertices, 2)).cumsum(axis=0)
+    start = rng.uniform([-10, 40], [20, 60])
+    return LineString(steps + start)
+
+
+def _admin_area(rng):
+    parts = []
+    for k in range(rng.integers(1, 6)):
+        cx, cy = rng.uniform(-10, 20), rng.uniform(40, 60)
+        radius = rng.uniform(0.1, 1)
+        shell = _ring(rng, cx, cy, radius, rng.integers(100, 1001), jitter=0.05)
+        holes = [_ring(rng, cx + dx * radius * 0.5, cy + dy * radius * 0.5, radius * 0.1, rng.integers(10, 50), 0.05)
+                 for dx, dy in rng.uniform(-1, 1, (rng.integers(0, 4), 2))]
+        parts.append(Polygon(shell, holes))
+    return MultiPolygon(parts)
+
+
+def _mixed(rng):
+    kind = rng.integers(0, 7)
+    x, y = rng.uniform(-180, 180), rng.uniform(-80, 80)
+    if kind == 0:
+        return Point(x, y)
+    if kind == 1:
+        return LineString(rng.normal(0, 0.01, (rng.integers(2, 50), 2)).cumsum(axis=0) + (x, y))
+    if kind == 2:
+        return Polygon(_ring(rng, x, y, 0.01, rng.integers(3, 30)))
+    if kind == 3:
+        return MultiPoint(rng.normal((x, y), 0.01, (rng.integers(1, 20), 2)))
+    if kind == 4:
+        return MultiLineString([rng.normal((x, y), 0.01, (rng.integers(2, 10), 2)) for _ in range(rng.integers(1, 5))])
+    if kind == 5:
+        return MultiPolygon([Polygon(_ring(rng, x + k, y, 0.1, 8)) for k in range(rng.integers(1, 4))])
+    return GeometryCollection([Point(x, y), LineString([(x, y), (x + 1, y + 1)]), Polygon(_ring(rng, x, y, 0.1, 6))])
+
+
+DATASETS = {
+    # name: (generator, rows at scale 1)
+    'buildings': (_building, 100_000),
+    'trajectories': (_trajectory, 1_000),
+    'admin': (_admin_area, 200),
+    'mixed': (_mixed, 50_000),
+}
+
+
+def make_dataset(name: str, scale: float, seed: int) -> np.ndarray:
+    generator, rows = DATASETS[name]
+    rng = np.random.default_rng([seed, list(DATASETS).index(name)])
+    geoms = np.empty(max(1, int(rows * scale)), dtype=object)
+    for k in range(len(geoms)):
+        geoms[k] = generator(rng)
+    geoms[rng.random(len(geoms)) < NULL_FRACTION] = None
+    return geoms
+
+
+def _single_call_benchmarks(geoms):
+    sedona_bufs = [geometry_serde.serialize(g) for g in geoms]
+    wkb_bufs = [shapely.to_wkb(g) if g is not None else None for g in geoms]
+
+    def each(func, items):
+        # NULL rows are passed through without calling func
+        def run(latencies):
+            clock = time.perf_counter_ns
+            for item in items:
+                if item is None:
+                    continue
+                start = clock()
+                func(item)
+                latencies.append(clock() - start)
+        return run
+
+    return [
+        ('serialize', 'sedona', each(geometry_serde.serialize, geoms)),
+        ('serialize', 'shapely_wkb', each(shapely.to_wkb, geoms)),
+        ('deserialize', 'sedona', each(geometry_serde.deserialize, sedona_bufs)),
+        ('deserialize', 'shapely_wkb', each(shapely.from_wkb, wkb_bufs)),
+    ]
+
+
+def _batch_benchmarks(geoms, num_threads):
+    batch = geometry_serde.serialize_array(geoms)
+    wkb = shapely.to_wkb(geoms)
+
+    def timed(func, *args, **kwargs):
+        def run(latencies):
+            start = time.perf_counter_ns()
+            func(*args, **kwargs)
+            latencies.append(time.perf_counter_ns() - start)
+        return run
+
+    benchmarks = [
+        ('serialize_array', 'sedona', timed(geometry_serde.serialize_array, geoms, 1)),
+        ('serialize_array', 'shapely_wkb', timed(shapely.to_wkb, geoms)),
+        ('deserialize_array', 'sedona', timed(geometry_serde.deserialize_array, *batch, num_threads=1)),
+        ('deserialize_array', 'shapely_wkb', timed(shapely.from_wkb, wkb)),
+    ]
+    if num_threads != 1:
+        benchmarks += [
+            ('serialize_array', 'sedona_mt', timed(geometry_serde.serialize_array, geoms, num_threads)),
+            ('deserialize_array', 'sedona_mt', timed(geometry_serde.deserialize_array, *batch, num_threads=num_threads)),
+        ]
+    return benchmarks
+
+
+def _max_rss_bytes() -> int:
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in bytes on macOS and in kilobytes elsewhere
+    return rss if sys.platform == 'darwin' else rss * 1024
+
+
+def run_benchmark(run, num_rows: int, min_time: float) -> dict:
+    # Untimed run for warming up and measuring memory
+    tracemalloc.start()
+    run([])
+    _, traced_peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+
+    latencies = []
+    repeats = 0
+    start = time.perf_counter()
+    while repeats < 3 or time.perf_counter() - start < min_time:
+        run(latencies)
+        repeats += 1
+    p50, p99 = np.percentile(latencies, [50, 99])
+    return {
+        'rows': num_rows,
+        'repeats': repeats,
+        'rows_per_s': num_rows * repeats / (sum(latencies) / 1e9),
+        'p50_ns': float(p50),
+        'p99_ns': float(p99),
+        'tracemalloc_peak_bytes': traced_peak,
+        'max_rss_bytes': _max_rss_bytes(),
+    }
+
+
+def _result_key(result):
+    return result['dataset'], result['api'], result['impl']
+
+
+def print_results(results, baseline=None):
+    baseline = {_result_key(r): r for r in (baseline or [])}
+    header = '{:<14}{:<19}{:<13}{:>14}{:>14}{:>14}{:>12}'.format(
+        'dataset', 'api', 'impl', 'rows/s', 'p50 us', 'p99 us', 'peak MB')
+    if baseline:
+        header += '{:>10}'.format('speedup')
+    print(header, file=sys.stderr)
+    for r in results:
+        line = '{:<14}{:<19}{:<13}{:>14,.0f}{:>14.2f}{:>14.2f}{:>12.1f}'.format(
+            r['dataset'], r['api'], r['impl'], r['rows_per_s'],
+            r['p50_ns'] / 1e3, r['p99_ns'] / 1e3, r['tracemalloc_peak_bytes'] / 2 ** 20)
+        if _result_key(r) in baseline:
+            line += '{:>10.2f}'.format(r['rows_per_s'] / baseline[_result_key(r)]['rows_per_s'])
+        print(line, file=sys.stderr)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-d', '--dataset', action='append', choices=list(DATASETS),
+                        help='datasets to run, all of them by default')
+    parser.add_argument('-s', '--scale', type=float, default=0.1, help='scale of dataset sizes')
+    parser.add_argument('--seed', type=int, default=20230512)
+    parser.add_argument('-t', '--min-time', type=float, default=1.0,
+                        help='minimum seconds to spend on each benchmark')
+    parser.add_argument('-j', '--num-threads', type=int, default=0,
+                        help='threads of multi-threaded batch benchmarks, 0 for all cores')
+    parser.add_argument('-o', '--output', help='write JSON results to this file instead of stdout')
+    parser.add_argument('--baseline', help='JSON results of a previous run to compare with')
+    args = parser.parse_args(argv)
+
+    if not shapely.__version__.startswith('2.'):
+        parser.error('the baselines require shapely 2.x')
+
+    results = []
+    for name in args.dataset or list(DATASETS):
+        geoms = make_dataset(name, args.scale, args.seed)
+        cases = _single_call_benchmarks(geoms) + _batch_benchmarks(geoms, args.num_threads)
+        for api, impl, run in cases:
+            result = {'dataset': name, 'api': api, 'impl': impl}
+            result.update(run_benchmark(run, len(geoms), args.min_time))
+            results.append(result)
+
+    report = {
+        'meta': {
+            'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+            'sedona': sedona_version,
+            'python': platform.python_version(),
+            'shapely': shapely.__version__,
+            'geos': shapely.geos_version_string,
+            'numpy': np.__version__,
+            'platform': platform.platform(),
+            'seed': args.seed,
+            'scale': args.scale,
+            'num_threads': args.num_threads,
+            'speedup': hasattr(geometry_serde, 'geomserde_speedup'),
+        },
+        'results': results,
+    }
+    baseline = None
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)['results']
+    print_results(results, baseline)
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        json.dump(report, sys.stdout, indent=2)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,193 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+
+"""Block-compressed batches of serialized geometries.
+
+Rows are grouped into blocks of a fixed number of rows, and each block is
+compressed with an LZ4 compatible codec, which catches redundancy across rows
+such as repeated small polygons and shared grid coordinates. Each block
+carries its row count and bounds, so readers could skip whole blocks by
+bounds and only decompress the blocks they touch. Blocks are compressed and
+decompressed in parallel.
+
+The serialized form of a container is laid out as follows, all integers are
+little endian:
+
+    header   magic "SEDBLOCK", uint32 version, uint32 flags, uint64 number
+             of blocks
+    index    int64 (offset, compressed size, raw size, number of rows) of each
+             block, offsets are relative to the start of the blocks
+    bounds   float64 (xmin, ymin, xmax, ymax) of each block, NaN when all rows
+             of the block are null or empty
+    blocks   compressed blocks
+
+A decompressed block is the concatenation of the serialized geometries of its
+rows followed by int32 sizes of rows, -1 for null rows. Serialized geometries
+are in native byte order.
+"""
+
+from typing import Iterator, Optional, Sequence, Tuple
+import struct
+
+from shapely.geometry.base import BaseGeometry
+
+from .geometry_serde import (
+    _batch_arrays,
+    deserialize_array,
+    geometry_info_array,
+    serialize_array,
+)
+
+BLOCKS_MAGIC = b'SEDBLOCK'
+BLOCKS_VERSION = 1
+
+_HEADER = struct.Struct('<8sIIQ')
+
+
+def _compress_blocks_py(data, offsets=None, validity=None, rows_per_block: int = 4096, num_threads: int = 0):
+    raise NotImplementedError('Block compression requires the geomserde_speedup extension module')
+
+
+def _decompress_blocks_py(data, index, num_threads: int = 0):
+    raise NotImplementedError('Block compression requires the geomserde_speedup extension module')
+
+
+try:
+    from .geomserde_speedup import compress_blocks, decompress_blocks
+except ImportError:
+    compress_blocks = _compress_blocks_py
+    decompress_blocks = _decompress_blocks_py
+
+
+class GeometryBlocks:
+    """A batch of serialized geometries compressed in blocks.
+
+    index is an int64 array of (offset, compressed size, raw size, number of
+    rows) of each block, bounds is a float64 array of (xmin, ymin, xmax, ymax)
+    of each block, and data holds the compressed blocks.
+    """
+
+    def __init__(self, data, index: "np.ndarray", bounds: "np.ndarray"):
+        import numpy as np
+        self.data = data
+        self.index = index
+        self.bounds = bounds
+        self.row_starts = np.concatenate([[0], np.cumsum(index[:, 3])]).astype(np.int64)
+
+    @classmethod
+    def from_serialized(cls, data, offsets=None, validity=None, rows_per_block: int = 4096,
+                        num_threads: int = 0) -> "GeometryBlocks":
+        """Compress a batch of serialized geometries given in any form accepted
+        by deserialize_array."""
+        import numpy as np
+        compressed, index = compress_blocks(data, offsets, validity, rows_per_block, num_threads)
+        index = np.frombuffer(index, dtype=np.int64).reshape(-1, 4)
+        info = geometry_info_array(data, offsets, validity, num_threads=num_threads)
+        bounds = np.empty((len(index), 4))
+        if len(index) > 0:
+            starts = np.arange(len(index)) * rows_per_block
+            for k, (key, reduce) in enumerate([('xmin', np.fmin), ('ymin', np.fmin),
+                                               ('xmax', np.fmax), ('ymax', np.fmax)]):
+                bounds[:, k] = reduce.reduceat(info[key], starts)
+        return cls(compressed, index, bounds)
+
+    @classmethod
+    def from_geometries(cls, geoms: Sequence[Optional[BaseGeometry]], rows_per_block: int = 4096,
+                        num_threads: int = 0) -> "GeometryBlocks":
+        return cls.from_serialized(*serialize_array(geoms, num_threads), rows_per_block=rows_per_block,
+                                   num_threads=num_threads)
+
+    @classmethod
+    def from_buffer(cls, buf) -> "GeometryBlocks":
+        """Load a container from its serialized form. Blocks are not copied,
+        they are views of buf."""
+        import numpy as np
+        view = memoryview(buf).cast('B')
+        if len(view) < _HEADER.size:
+            raise ValueError('Buffer is too small to hold geometry blocks')
+        magic, version, _, num_blocks = _HEADER.unpack_from(view, 0)
+        if magic != BLOCKS_MAGIC:
+            raise ValueError('Buffer does not hold geometry blocks')
+        if version != BLOCKS_VERSION:
+            raise ValueError('Unsupported geometry blocks version {}'.format(version))
+        data_offset = _HEADER.size + 64 * num_blocks
+        if len(view) < data_offset:
+            raise ValueError('Index of geometry blocks is truncated')
+        index = np.frombuffer(view, dtype='<i8', count=4 * num_blocks, offset=_HEADER.size)
+        bounds = np.frombuffer(view, dtype='<f8', count=4 * num_blocks, offset=_HEADER.size + 32 * num_blocks)
+        return cls(view[data_offset:], index.astype(np.int64).reshape(-1, 4), bounds.reshape(-1, 4))
+
+    def to_bytes(self) -> bytes:
+        return b''.join([_HEADER.pack(BLOCKS_MAGIC, BLOCKS_VERSION, 0, self.num_blocks),
+                         self.index.astype('<i8').tobytes(), self.bounds.astype('<f8').tobytes(),
+                         bytes(self.data)])
+
+    @property
+    def num_blocks(self) -> int:
+        return len(self.index)
+
+    def __len__(self) -> int:
+        return int(self.row_starts[-1])
+
+    @property
+    def compressed_size(self) -> int:
+        return int(self.index[:, 1].sum())
+
+    @property
+    def raw_size(self) -> int:
+        return int(self.index[:, 2].sum())
+
+    def blocks_intersecting(self, xmin: float, ymin: float, xmax: float, ymax: float) -> "np.ndarray":
+        """Get ids of blocks whose bounds intersect the given box. Blocks
+        without any non-empty geometry are never returned."""
+        import numpy as np
+        b = self.bounds
+        return np.flatnonzero((b[:, 0] <= xmax) & (b[:, 2] >= xmin) & (b[:, 1] <= ymax) & (b[:, 3] >= ymin))
+
+    def serialized_blocks(self, block_ids=None, num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+        """Decompress the given blocks (all blocks by default) into a
+        (data, offsets, validity) batch of their rows in the order of
+        block_ids."""
+        index = self.index if block_ids is None else self.index[block_ids]
+        return _batch_arrays(*decompress_blocks(self.data, index, num_threads))
+
+    def serialized_batch(self, start: int = 0, stop: Optional[int] = None,
+                         num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+        """Get rows [start, stop) as a (data, offsets, validity) batch, only
+        the blocks covering these rows are decompressed. Offsets point into
+        the decompressed blocks."""
+        import numpy as np
+        start, stop, _ = slice(start, stop).indices(len(self))
+        stop = max(start, stop)
+        first = np.searchsorted(self.row_starts, start, side='right') - 1
+        last = np.searchsorted(self.row_starts, stop, side='left')
+        data, offsets, validity = self.serialized_blocks(np.arange(first, max(first, last)), num_threads)
+        lo = start - int(self.row_starts[first]) if first < self.num_blocks else 0
+        hi = lo + stop - start
+        valid = np.unpackbits(validity, count=len(offsets) - 1, bitorder='little')[lo:hi]
+        return data, offsets[lo:hi + 1], np.packbits(valid, bitorder='little')
+
+    def read_blocks(self, block_ids=None, num_threads: int = 0) -> "np.ndarray":
+        return deserialize_array(*self.serialized_blocks(block_ids, num_threads), num_threads=num_threads)
+
+    def read_batch(self, start: int = 0, stop: Optional[int] = None, num_threads: int = 0) -> "np.ndarray":
+        return deserialize_array(*self.serialized_batch(start, stop, num_threads), num_threads=num_threads)
+
+    def iter_blocks(self, num_threads: int = 0) -> Iterator["np.ndarray"]:
+        for k in range(self.num_blocks):
+            yield self.read_blocks([k], num_threads)
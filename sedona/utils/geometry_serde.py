@@ -15,7 +15,7 @@
 #  specific language governing permissions and limitations
 #  under the License.
 
-from typing import Optional
+from typing import Dict, Optional, Sequence, Tuple
 from warnings import warn
 import sys
 import os
@@ -24,6 +24,444 @@ import shapely
 from shapely.geometry.base import BaseGeometry
 
 
+def _serialize_array_py(geoms: Sequence[Optional[BaseGeometry]], num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    # Generic implementation of serialize_array built on top of serialize, it
+    # is used when the batch API is not provided by geomserde_speedup.
+    import numpy as np
+    data = bytearray()
+    offsets = np.zeros(len(geoms) + 1, dtype=np.int64)
+    validity = np.zeros((len(geoms) + 7) // 8, dtype=np.uint8)
+    for k, geom in enumerate(geoms):
+        buf = serialize(geom) if geom is not None else None
+        if buf is not None:
+            data += buf
+            validity[k >> 3] |= (1 << (k & 7))
+        offsets[k + 1] = len(data)
+    return data, offsets, validity
+
+
+def _serialized_size_py(geom: Optional[BaseGeometry]) -> int:
+    buf = serialize(geom) if geom is not None else None
+    return len(buf) if buf is not None else 0
+
+
+def _serialize_into_py(geom: Optional[BaseGeometry], buffer, offset: int = 0) -> int:
+    buf = serialize(geom) if geom is not None else None
+    if buf is None:
+        return 0
+    view = memoryview(buffer).cast('B')
+    if offset < 0 or offset + len(buf) > len(view):
+        raise ValueError("Buffer is too small to hold the serialized geometry")
+    view[offset:offset + len(buf)] = buf
+    return len(buf)
+
+
+def _iter_serialized(data, offsets=None, validity=None):
+    if offsets is None and hasattr(data, '__arrow_c_array__'):
+        import pyarrow as pa
+        data = pa.array(data).to_pylist()
+    if offsets is None:
+        yield from data
+        return
+    for k in range(len(offsets) - 1):
+        if validity is not None and not (validity[k >> 3] >> (k & 7)) & 1:
+            yield None
+        else:
+            yield data[offsets[k]:offsets[k + 1]]
+
+
+def _to_object_array(values: list) -> "np.ndarray":
+    import numpy as np
+    arr = np.empty(len(values), dtype=object)
+    arr[:] = values
+    return arr
+
+
+def _deserialize_array_py(data, offsets=None, validity=None, num_threads: int = 0) -> "np.ndarray":
+    # Generic implementation of deserialize_array built on top of deserialize
+    geoms = []
+    for buf in _iter_serialized(data, offsets, validity):
+        geoms.append(deserialize(buf)[0] if buf is not None else None)
+    return _to_object_array(geoms)
+
+
+_GEOMETRY_TYPE_NAMES = [
+    "Unknown", "Point", "LineString", "Polygon", "MultiPoint",
+    "MultiLineString", "MultiPolygon", "GeometryCollection",
+]
+
+
+def _num_coords(geom: BaseGeometry) -> int:
+    if geom.is_empty:
+        return 0
+    if hasattr(geom, 'geoms'):
+        return sum(_num_coords(g) for g in geom.geoms)
+    if hasattr(geom, 'exterior'):
+        return len(geom.exterior.coords) + sum(len(r.coords) for r in geom.interiors)
+    return len(geom.coords)
+
+
+class _SerializedGeometryPy:
+    """Generic implementation of SerializedGeometry. Properties other than
+    srid and coords are answered by the eagerly deserialized geometry.
+    """
+
+    def __init__(self, buf):
+        self._buf = buf
+        self._geom = deserialize(buf)[0]
+
+    @property
+    def geom_type(self) -> str:
+        return _GEOMETRY_TYPE_NAMES[(bytes(self._buf[:1])[0] & 0x7F) >> 4]
+
+    @property
+    def srid(self) -> int:
+        header = bytes(self._buf[:4])
+        if header[0] & 1 == 0:
+            return 0
+        return (header[1] << 16) | (header[2] << 8) | header[3]
+
+    @property
+    def num_coords(self) -> int:
+        return _num_coords(self._geom)
+
+    @property
+    def is_empty(self) -> bool:
+        return self._geom.is_empty
+
+    @property
+    def bounds(self) -> Tuple[float, float, float, float]:
+        if self._geom.is_empty:
+            return (float('nan'),) * 4
+        return tuple(self._geom.bounds)
+
+    @property
+    def coords(self) -> memoryview:
+        if self.geom_type == "GeometryCollection":
+            raise NotImplementedError("Coordinates of geometry collections are not stored contiguously")
+        header = bytes(self._buf[:8])
+        dims = [2, 2, 3, 3, 4][(header[0] & 0x0F) >> 1]
+        num_coords = int.from_bytes(header[4:8], sys.byteorder, signed=True)
+        view = memoryview(self._buf).cast('B')[8:8 + num_coords * dims * 8]
+        if num_coords == 0:
+            return view.cast('d')
+        return view.cast('d', (num_coords, dims))
+
+    def to_shapely(self) -> BaseGeometry:
+        return self._geom
+
+    def __getattr__(self, name):
+        return getattr(self._geom, name)
+
+    def __repr__(self):
+        return "<SerializedGeometry {} srid={}>".format(self.geom_type, self.srid)
+
+
+def _geometry_info_arrays(geom_types, srids, dims, num_coords, is_empty, bounds) -> Dict[str, "np.ndarray"]:
+    import numpy as np
+    bounds = np.frombuffer(bounds, dtype=np.float64).reshape(-1, 4)
+    return {
+        'geom_type': np.frombuffer(geom_types, dtype=np.int8),
+        'srid': np.frombuffer(srids, dtype=np.int32),
+        'dims': np.frombuffer(dims, dtype=np.int8),
+        'num_coords': np.frombuffer(num_coords, dtype=np.int32),
+        'is_empty': np.frombuffer(is_empty, dtype=np.bool_),
+        'xmin': bounds[:, 0],
+        'ymin': bounds[:, 1],
+        'xmax': bounds[:, 2],
+        'ymax': bounds[:, 3],
+    }
+
+
+def _geometry_info_array_py(data, offsets=None, validity=None, compute_bounds: bool = True,
+                            num_threads: int = 0) -> Dict[str, "np.ndarray"]:
+    # Generic implementation of geometry_info_array built on top of
+    # _SerializedGeometryPy
+    import array
+    columns = [array.array('b'), array.array('i'), array.array('b'), array.array('i'),
+               array.array('B'), array.array('d')]
+    for buf in _iter_serialized(data, offsets, validity):
+        if buf is None:
+            row = (0, 0, 0, 0, 1, (float('nan'),) * 4)
+        else:
+            view = _SerializedGeometryPy(buf)
+            geom = view.to_shapely()
+            bounds = view.bounds if compute_bounds else (float('nan'),) * 4
+            row = (_GEOMETRY_TYPE_NAMES.index(view.geom_type), view.srid,
+                   2 + int(geom.has_z), view.num_coords, int(view.is_empty), bounds)
+        for column, value in zip(columns[:5], row[:5]):
+            column.append(value)
+        columns[5].extend(row[5])
+    return _geometry_info_arrays(*columns)
+
+
+def _batch_arrays(data, offsets, validity) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    import numpy as np
+    return data, np.frombuffer(offsets, dtype=np.int64), np.frombuffer(validity, dtype=np.uint8)
+
+
+def _to_wkb_py(buf, byte_order: int = 1, include_srid: bool = False) -> Optional[bytes]:
+    # Generic implementation of to_wkb going through shapely geometries
+    import shapely.wkb
+    if buf is None:
+        return None
+    srid = _SerializedGeometryPy(buf).srid if include_srid else 0
+    return shapely.wkb.dumps(deserialize(buf)[0], big_endian=(byte_order == 0), srid=srid or None)
+
+
+def _from_wkb_py(wkb) -> Optional[bytes]:
+    import shapely.wkb
+    if wkb is None:
+        return None
+    return serialize(shapely.wkb.loads(bytes(wkb)))
+
+
+def _to_wkt_py(buf, precision: int = -1, include_srid: bool = False) -> Optional[str]:
+    import shapely.wkt
+    if buf is None:
+        return None
+    wkt = shapely.wkt.dumps(deserialize(buf)[0], trim=True, rounding_precision=precision)
+    srid = _SerializedGeometryPy(buf).srid if include_srid else 0
+    return "SRID={};{}".format(srid, wkt) if srid != 0 else wkt
+
+
+def _round_coords(coords, precision: int):
+    if isinstance(coords, (tuple, list)):
+        return [_round_coords(c, precision) for c in coords]
+    return round(coords, precision)
+
+
+def _to_geojson_py(buf, precision: int = -1) -> Optional[str]:
+    import json
+    from shapely.geometry import mapping
+    if buf is None:
+        return None
+    obj = mapping(deserialize(buf)[0])
+    if precision >= 0:
+        obj = json.loads(json.dumps(obj))
+        for geom in obj.get('geometries', [obj]):
+            geom['coordinates'] = _round_coords(geom['coordinates'], precision)
+    return json.dumps(obj, separators=(',', ':'))
+
+
+def _transcode_array_py(func, data, offsets=None, validity=None) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    import numpy as np
+    values = [func(buf) if buf is not None else None for buf in _iter_serialized(data, offsets, validity)]
+    out = bytearray()
+    out_offsets = np.zeros(len(values) + 1, dtype=np.int64)
+    out_validity = np.zeros((len(values) + 7) // 8, dtype=np.uint8)
+    for k, value in enumerate(values):
+        if value is not None:
+            out += value.encode() if isinstance(value, str) else value
+            out_validity[k >> 3] |= (1 << (k & 7))
+        out_offsets[k + 1] = len(out)
+    return out, out_offsets, out_validity
+
+
+def _to_wkb_array_py(data, offsets=None, validity=None, byte_order: int = 1, include_srid: bool = False,
+                     num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    return _transcode_array_py(lambda buf: _to_wkb_py(buf, byte_order, include_srid), data, offsets, validity)
+
+
+def _from_wkb_array_py(data, offsets=None, validity=None,
+                       num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    return _transcode_array_py(_from_wkb_py, data, offsets, validity)
+
+
+def _to_wkt_array_py(data, offsets=None, validity=None, precision: int = -1, include_srid: bool = False,
+                     num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    return _transcode_array_py(lambda buf: _to_wkt_py(buf, precision, include_srid), data, offsets, validity)
+
+
+def _to_geojson_array_py(data, offsets=None, validity=None, precision: int = -1,
+                         num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    return _transcode_array_py(lambda buf: _to_geojson_py(buf, precision), data, offsets, validity)
+
+
+_GEOARROW_TYPES = {
+    'point': 1, 'linestring': 2, 'polygon': 3,
+    'multipoint': 4, 'multilinestring': 5, 'multipolygon': 6,
+}
+
+
+class GeoArrowArray:
+    """A batch of serialized geometries exported as a GeoArrow native array.
+
+    The array implements the Arrow PyCapsule interface, so it could be
+    consumed by any Arrow implementation, e.g. pyarrow.array(arr). The
+    capsules produced by to_geoarrow are handed out on the first request,
+    the array is exported again for subsequent requests.
+    """
+
+    def __init__(self, export, data, offsets, validity, interleaved: bool):
+        self._export = lambda: export(data, offsets, validity, interleaved)
+        self._capsules = self._export()
+
+    def __arrow_c_schema__(self):
+        return self.__arrow_c_array__()[0]
+
+    def __arrow_c_array__(self, requested_schema=None):
+        capsules, self._capsules = self._capsules, None
+        return capsules if capsules is not None else self._export()
+
+
+def _geoarrow_capsules(obj):
+    if hasattr(obj, '__arrow_c_array__'):
+        return obj.__arrow_c_array__()
+    schema, array = obj
+    return schema, array
+
+
+def _geoarrow_type_id(geom_type) -> int:
+    if geom_type is None:
+        return 0
+    if isinstance(geom_type, str):
+        return _GEOARROW_TYPES[geom_type.lower()]
+    return int(geom_type)
+
+
+def _to_geoarrow_py(data, offsets=None, validity=None, interleaved: bool = True) -> GeoArrowArray:
+    raise NotImplementedError('GeoArrow conversion requires the geomserde_speedup extension module')
+
+
+def _from_geoarrow_py(obj, geom_type=None, num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    raise NotImplementedError('GeoArrow conversion requires the geomserde_speedup extension module')
+
+
+# Status codes returned by validate and validate_array, the same as
+# SedonaErrorCode of the extension module
+VALID = 0
+ERROR_UNKNOWN_GEOM_TYPE = 1
+ERROR_UNKNOWN_COORD_TYPE = 2
+ERROR_UNSUPPORTED_GEOM_TYPE = 3
+ERROR_INCOMPLETE_BUFFER = 4
+ERROR_BAD_GEOM_BUFFER = 5
+
+
+def _validate_py(buf) -> int:
+    # Generic implementation of validate, which has to deserialize the
+    # geometry
+    try:
+        deserialize(buf)
+    except Exception:
+        return ERROR_BAD_GEOM_BUFFER
+    return VALID
+
+
+def _validate_array_py(data, offsets=None, validity=None, num_threads: int = 0) -> "np.ndarray":
+    import numpy as np
+    return np.array([_validate_py(buf) if buf is not None else VALID
+                     for buf in _iter_serialized(data, offsets, validity)], dtype=np.int8)
+
+
+def _validation_error_message_py(code: int) -> str:
+    return ['', 'Unknown geometry type', 'Unknown coordinate type', 'Unsupported geometry type',
+            'Buffer to be deserialized is incomplete', 'Bad serialized geometry buffer'][code]
+
+
+COORD_ENCODINGS = {'none': 0, 'float32': 1, 'quantized': 2, 'xor': 3}
+
+
+def _coord_encoding_id(coord_encoding) -> int:
+    if coord_encoding is None:
+        return 0
+    if isinstance(coord_encoding, str):
+        return COORD_ENCODINGS[coord_encoding.lower()]
+    return int(coord_encoding)
+
+
+def _encode_coords_py(buf, coord_encoding='xor', step: float = 0.0) -> Optional[bytes]:
+    raise NotImplementedError('Coordinate encodings require the geomserde_speedup extension module')
+
+
+def _encode_coords_array_py(data, offsets=None, validity=None, coord_encoding='xor', step: float = 0.0,
+                            num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    raise NotImplementedError('Coordinate encodings require the geomserde_speedup extension module')
+
+
+def _stats_py() -> dict:
+    raise NotImplementedError('Runtime statistics require the geomserde_speedup extension module')
+
+
+def _reset_stats_py() -> None:
+    raise NotImplementedError('Runtime statistics require the geomserde_speedup extension module')
+
+
+def _set_stats_sampling_py(interval: int) -> None:
+    raise NotImplementedError('Runtime statistics require the geomserde_speedup extension module')
+
+
+def _set_geos_context_pool_size_py(size: int) -> None:
+    raise NotImplementedError('GEOS context pool requires the geomserde_speedup extension module')
+
+
+# Ways of copying coordinates between serialized geometries and GEOS, see
+# set_coord_copy_path
+COORD_COPY_PATHS = ['auto', 'geos_buffer', 'shapely', 'loop']
+
+
+def _set_coord_copy_path_py(path: str) -> str:
+    raise NotImplementedError('Coordinate copy paths require the geomserde_speedup extension module')
+
+
+def stats_openmetrics(stats_dict: Optional[dict] = None, prefix: str = 'sedona_serde') -> str:
+    """Format runtime statistics returned by stats() (collected now if not
+    given) as OpenMetrics text exposition."""
+    if stats_dict is None:
+        stats_dict = stats()
+    lines = []
+
+    def family(name, metric_type, help_text):
+        lines.append('# TYPE {}_{} {}'.format(prefix, name, metric_type))
+        lines.append('# HELP {}_{} {}'.format(prefix, name, help_text))
+
+    def sample(name, value, **labels):
+        label_text = ','.join('{}="{}"'.format(k, v) for k, v in labels.items())
+        lines.append('{}_{}{} {}'.format(prefix, name, '{' + label_text + '}' if labels else '', value))
+
+    for direction in ['serialized', 'deserialized']:
+        family(direction + '_geometries', 'counter', 'Number of {} geometries.'.format(direction))
+        for geom_type, counts in stats_dict[direction].items():
+            sample(direction + '_geometries_total', counts['count'], type=geom_type)
+        family(direction + '_bytes', 'counter', 'Size of {} geometries in bytes.'.format(direction))
+        for geom_type, counts in stats_dict[direction].items():
+            sample(direction + '_bytes_total', counts['bytes'], type=geom_type)
+        family(direction + '_coordinates', 'counter', 'Number of {} coordinates.'.format(direction))
+        sample(direction + '_coordinates_total', stats_dict[direction + '_coords'])
+    family('slow_path', 'counter', 'Coordinate sequences copied without GEOSCoordSeq_copyToBuffer/copyFromBuffer.')
+    sample('slow_path_total', stats_dict['slow_path_serialize'], direction='serialize')
+    sample('slow_path_total', stats_dict['slow_path_deserialize'], direction='deserialize')
+    family('allocations', 'counter', 'Number of memory allocations.')
+    sample('allocations_total', stats_dict['allocs'])
+    family('allocated_bytes', 'counter', 'Bytes of memory allocated.')
+    sample('allocated_bytes_total', stats_dict['alloc_bytes'])
+    family('frees', 'counter', 'Number of memory blocks freed.')
+    sample('frees_total', stats_dict['frees'])
+    family('freed_bytes', 'counter', 'Bytes of memory freed.')
+    sample('freed_bytes_total', stats_dict['free_bytes'])
+    family('geos_contexts_created', 'counter', 'Number of GEOS contexts created.')
+    sample('geos_contexts_created_total', stats_dict['geos_contexts']['created'])
+    family('geos_contexts', 'gauge', 'Number of GEOS contexts by state.')
+    sample('geos_contexts', stats_dict['geos_contexts']['in_use'], state='in_use')
+    sample('geos_contexts', stats_dict['geos_contexts']['idle'], state='idle')
+    family('errors', 'counter', 'Errors of serialization and deserialization.')
+    for code, count in stats_dict['errors'].items():
+        sample('errors_total', count, code=code)
+    family('stage_seconds', 'histogram', 'Sampled durations of serde stages.')
+    for stage, timing in stats_dict['timings'].items():
+        # Bucket k of the native histogram counts durations shorter than
+        # 2^(k+1) ns, the last bucket is unbounded
+        cumulative = 0
+        for k, count in enumerate(timing['buckets'][:-1]):
+            cumulative += count
+            sample('stage_seconds_bucket', cumulative, stage=stage, le='{:.9g}'.format(2 ** (k + 1) / 1e9))
+        sample('stage_seconds_bucket', timing['count'], stage=stage, le='+Inf')
+        sample('stage_seconds_count', timing['count'], stage=stage)
+        sample('stage_seconds_sum', '{:.9g}'.format(timing['sum_ns'] / 1e9), stage=stage)
+    lines.append('# EOF')
+    return '\n'.join(lines) + '\n'
+
+
 # Use geomserde_speedup when available, otherwise fallback to general pure
 # python implementation.
 try:
@@ -52,13 +490,267 @@ try:
 
         from .geomserde_speedup import serialize
 
+        def serialized_size(geom: Optional[BaseGeometry]) -> int:
+            """Get the exact number of bytes of the serialized geometry. 0 is
+            returned for None.
+            """
+            return geomserde_speedup.serialized_size(geom)
+
+        def serialize_into(geom: Optional[BaseGeometry], buffer, offset: int = 0) -> int:
+            """Serialize geometry into a writable buffer (bytearray,
+            memoryview, numpy array, etc.) starting at offset, and return the
+            number of bytes written. The buffer should have at least
+            serialized_size(geom) bytes after offset, otherwise ValueError
+            will be raised.
+            """
+            return geomserde_speedup.serialize_into(geom, buffer, offset)
+
+        def serialize_array(geoms: Sequence[Optional[BaseGeometry]], num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Serialize a sequence (or numpy object array) of geometries
+            into one contiguous buffer.
+
+            Returns a (data, offsets, validity) tuple. The serialized form of
+            the k-th geometry is data[offsets[k]:offsets[k + 1]]; offsets is
+            an int64 array of len(geoms) + 1 elements. validity is an
+            Arrow-style bitmap where bit (k % 8) of validity[k // 8] is unset
+            when the k-th geometry is None.
+
+            Geometries are serialized by a pool of native threads without
+            holding the GIL. num_threads=0 uses the default size of the pool,
+            which could be changed by calling set_num_threads.
+            """
+            import numpy as np
+            data, offsets, validity = geomserde_speedup.serialize_array(geoms, num_threads)
+            return data, np.frombuffer(offsets, dtype=np.int64), np.frombuffer(validity, dtype=np.uint8)
+
         def deserialize(buf: bytearray) -> Optional[BaseGeometry]:
             if buf is None:
                 return None
             return geomserde_speedup.deserialize(buf)
 
+        def deserialize_array(data, offsets=None, validity=None, num_threads: int = 0) -> "np.ndarray":
+            """Deserialize a batch of serialized geometries into a numpy object
+            array of geometries.
+
+            The batch is either a sequence of bytes-like objects (None for
+            null geometries), a contiguous data buffer with int64 or int32
+            offsets and an optional validity bitmap, as returned by
+            serialize_array, or an Arrow binary or large binary array (e.g.
+            pyarrow.BinaryArray, or a (schema, array) tuple of PyCapsules),
+            whose buffers are read in place without creating a bytes object
+            per row. GEOS geometries are built by a pool of native threads,
+            see serialize_array for the meaning of num_threads.
+            """
+            return _to_object_array(
+                geomserde_speedup.deserialize_array(data, offsets, validity, num_threads))
+
+        def geometry_info_array(data, offsets=None, validity=None, compute_bounds: bool = True,
+                                num_threads: int = 0) -> Dict[str, "np.ndarray"]:
+            """Get basic information of a batch of serialized geometries
+            without deserializing them.
+
+            The batch is given in the same forms accepted by
+            deserialize_array. Returns a dict of numpy arrays keyed by
+            geom_type (type id, 1 for Point ... 7 for GeometryCollection, 0 for
+            None), srid, dims, num_coords, is_empty, xmin, ymin, xmax and
+            ymax. Bounds are NaN for empty or null geometries, and are not
+            computed when compute_bounds is False.
+            """
+            return _geometry_info_arrays(*geomserde_speedup.get_geom_info_array(
+                data, offsets, validity, compute_bounds, num_threads))
+
+        def to_wkb(buf, byte_order: int = 1, include_srid: bool = False) -> Optional[bytes]:
+            """Convert serialized geometry to WKB without constructing GEOS
+            geometries. byte_order is 0 for big endian (XDR) and 1 for little
+            endian (NDR). When include_srid is True and the geometry has a
+            SRID, extended WKB (EWKB) carrying the SRID will be produced.
+            Geometries with Z or M coordinates are written using EWKB flags,
+            the same as shapely.to_wkb(flavor="extended").
+            """
+            return geomserde_speedup.to_wkb(buf, byte_order, include_srid)
+
+        def from_wkb(wkb) -> Optional[bytes]:
+            """Convert WKB or EWKB of either byte order to serialized geometry
+            without constructing GEOS geometries. SRID in EWKB is preserved.
+            """
+            return geomserde_speedup.from_wkb(wkb)
+
+        def to_wkb_array(data, offsets=None, validity=None, byte_order: int = 1, include_srid: bool = False,
+                         num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Convert a batch of serialized geometries to WKB. The batch is
+            given in the same forms accepted by deserialize_array, the result
+            is a (data, offsets, validity) tuple in the same form as the
+            result of serialize_array.
+            """
+            return _batch_arrays(*geomserde_speedup.to_wkb_array(
+                data, offsets, validity, byte_order, include_srid, num_threads))
+
+        def from_wkb_array(data, offsets=None, validity=None,
+                           num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Convert a batch of WKB to serialized geometries, see
+            to_wkb_array for the forms of input and output.
+            """
+            return _batch_arrays(*geomserde_speedup.from_wkb_array(data, offsets, validity, num_threads))
+
+        def to_wkt(buf, precision: int = -1, include_srid: bool = False) -> Optional[str]:
+            """Render serialized geometry as WKT without constructing GEOS
+            geometries. Numbers are rounded to precision decimal places and
+            trimmed, or written in the shortest form that round-trips when
+            precision is -1. When include_srid is True and the geometry has a
+            SRID, EWKT (SRID=4326;POINT (...)) will be produced.
+            """
+            return geomserde_speedup.to_wkt(buf, precision, include_srid)
+
+        def to_geojson(buf, precision: int = -1) -> Optional[str]:
+            """Render serialized geometry as a compact GeoJSON geometry
+            object without constructing GEOS geometries, see to_wkt for the
+            meaning of precision. M values and empty points in multipoints
+            are dropped since GeoJSON cannot represent them.
+            """
+            return geomserde_speedup.to_geojson(buf, precision)
+
+        def to_wkt_array(data, offsets=None, validity=None, precision: int = -1, include_srid: bool = False,
+                         num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Render a batch of serialized geometries as WKT. The UTF-8
+            text of all geometries are written into one buffer, see
+            to_wkb_array for the forms of input and output.
+            """
+            return _batch_arrays(*geomserde_speedup.to_wkt_array(
+                data, offsets, validity, precision, include_srid, num_threads))
+
+        def to_geojson_array(data, offsets=None, validity=None, precision: int = -1,
+                             num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Render a batch of serialized geometries as GeoJSON, see
+            to_wkt_array for the forms of input and output.
+            """
+            return _batch_arrays(*geomserde_speedup.to_geojson_array(
+                data, offsets, validity, precision, num_threads))
+
+        def to_geoarrow(data, offsets=None, validity=None, interleaved: bool = True) -> GeoArrowArray:
+            """Export a batch of serialized geometries as a GeoArrow native
+            array. Input could be given in any form accepted by to_wkb_array.
+            Coordinates are stored as a fixed size list of xy(z)(m) values
+            when interleaved is True, otherwise as a struct of x, y, (z), (m)
+            arrays. Single geometries are promoted to multi geometries when
+            mixed with multi geometries of the same family, empty points are
+            exported as NaN coordinates, and the CRS is recorded as EPSG:srid
+            when all geometries share the same SRID. Raises ValueError for
+            non-empty geometry collections and geometries of mixed families.
+            """
+            return GeoArrowArray(geomserde_speedup.to_geoarrow, data, offsets, validity, interleaved)
+
+        def from_geoarrow(obj, geom_type=None, num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Convert a GeoArrow native array to serialized geometries. obj
+            could be any object implementing __arrow_c_array__ (e.g.
+            pyarrow.Array), or a (schema, array) tuple of PyCapsules. The
+            geometry type is read from the geoarrow extension name, it should
+            be specified by geom_type ('point', ..., 'multipolygon') when the
+            extension type is missing. Returns (data, offsets, validity) in
+            the same form as serialize_array.
+            """
+            schema, array = _geoarrow_capsules(obj)
+            return _batch_arrays(*geomserde_speedup.from_geoarrow(
+                schema, array, _geoarrow_type_id(geom_type), num_threads))
+
+        def encode_coords(buf, coord_encoding='xor', step: float = 0.0) -> Optional[bytes]:
+            """Re-encode coordinates of a serialized geometry to shrink it.
+
+            coord_encoding is one of 'float32' (rounded to single
+            precision), 'quantized' (int32 multiples of step from a
+            per-geometry origin, the step is enlarged when the extent of the
+            geometry does not fit; step=0 picks the finest step possible) and
+            'xor' (lossless XOR of consecutive ordinates). 'none' converts
+            coordinates back to plain doubles. Encoded geometries are
+            accepted by all functions taking serialized geometries.
+            """
+            if buf is None:
+                return None
+            return geomserde_speedup.encode_coords(buf, _coord_encoding_id(coord_encoding), step)
+
+        def encode_coords_array(data, offsets=None, validity=None, coord_encoding='xor', step: float = 0.0,
+                                num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            """Re-encode coordinates of a batch of serialized geometries, see
+            encode_coords for the encodings and to_wkb_array for the forms of
+            input and output.
+            """
+            return _batch_arrays(*geomserde_speedup.encode_coords_array(
+                data, offsets, validity, _coord_encoding_id(coord_encoding), step, num_threads))
+
+        def validate(buf) -> int:
+            """Check the structure of an untrusted serialized geometry
+            without deserializing it. Returns VALID (0) for well-formed
+            buffers, otherwise the ERROR_* code deserialize would fail with.
+            Nothing is allocated and GEOS is not involved, only GEOS itself
+            could still reject a validated geometry (e.g. a ring with too few
+            points). Geometry collections nested more than 256 levels deep
+            are rejected here and by all other functions of this module.
+            """
+            return geomserde_speedup.validate(buf)
+
+        def validate_array(data, offsets=None, validity=None, num_threads: int = 0) -> "np.ndarray":
+            """Validate a batch of serialized geometries given in any form
+            accepted by deserialize_array. Returns an int8 numpy array of the
+            status code of each row, null rows are VALID. Use
+            validation_error_message to describe the codes.
+            """
+            import numpy as np
+            return np.frombuffer(geomserde_speedup.validate_array(data, offsets, validity, num_threads),
+                                 dtype=np.int8)
+
+        def validation_error_message(code: int) -> str:
+            return geomserde_speedup.get_error_message(code)
+
+        def stats() -> dict:
+            """Get runtime statistics of serialization and deserialization
+            summed up over all threads: number and bytes of geometries by
+            type, coordinate counts, coordinate sequences copied by the slow
+            path for GEOS < 3.10, native allocations and frees, errors by
+            code, and sampled timing histograms of the header_parse,
+            coord_copy, geos_construct and python_wrap stages, and the
+            number of GEOS contexts created, idle and borrowed by threads.
+            Use stats_openmetrics to export them.
+
+            Calling reset_stats before a call and stats after it reports
+            native allocations made by that call. Native buffers are only
+            traced by tracemalloc when it was tracing when this module was
+            imported (e.g. python -X tracemalloc), since tracing them takes
+            the GIL on worker threads.
+            """
+            return geomserde_speedup.stats()
+
+        def set_stats_sampling(interval: int) -> None:
+            """Time one of every interval executions of each stage, 0 (the
+            default) disables timing. Counters are always maintained.
+            """
+            geomserde_speedup.set_stats_sampling(interval)
+
+        def set_coord_copy_path(path: str) -> str:
+            """Force the way coordinates are copied between serialized
+            geometries and GEOS, for testing and benchmarking. Returns the
+            previous path. Paths are 'auto' (the default, fastest available),
+            'geos_buffer' (GEOSCoordSeq_copyFromBuffer/copyToBuffer of GEOS
+            >= 3.10), 'shapely' (the CoordSeq_FromBuffer C API of shapely for
+            deserialization, serialization copies coordinates one by one) and
+            'loop' (one coordinate at a time). ValueError is raised if the
+            path is not available.
+            """
+            return COORD_COPY_PATHS[geomserde_speedup.set_coord_copy_path(COORD_COPY_PATHS.index(path))]
+
+        def set_geos_context_pool_size(size: int) -> None:
+            """Set the maximum number of idle GEOS contexts kept for reuse, 0
+            (the default) for the number of CPU cores. Each thread borrows a
+            GEOS context on first use and returns it when the thread exits,
+            contexts returned to a full pool are destroyed. Only idle
+            contexts are bounded: every live thread that used GEOS holds
+            one context, so their number grows with the number of threads
+            (reported as stats()['geos_contexts']['in_use']).
+            """
+            geomserde_speedup.set_geos_context_pool_size(size)
+
+        from .geomserde_speedup import set_num_threads, get_num_threads, reset_stats
+        from .geomserde_speedup import SerializedGeometry
+
     elif shapely.__version__.startswith('1.'):
-        import shapely.geometry.base
         from shapely.geometry import (
             Point,
             LineString,
@@ -91,39 +783,155 @@ try:
             GeometryCollection,
         ]
 
-        def serialize(geom: BaseGeometry) -> Optional[bytearray]:
+        def serialize(geom: BaseGeometry) -> Optional[bytes]:
             if geom is None:
                 return None
             return geomserde_speedup.serialize_1(geom._geom)
 
+        # Shapely objects are built by geomserde_speedup the same way as
+        # geom_factory in shapely/geometry/base.py does
+        geomserde_speedup.init_shapely_1(BaseGeometry, GEOMETRY_CLASSES)
+
         def deserialize(buf: bytearray) -> Optional[BaseGeometry]:
             if buf is None:
                 return None
-            g, geom_type_id, has_z, bytes_read = geomserde_speedup.deserialize_1(buf)
-
-            # The following code is mostly taken from the geom_factory function
-            # in shapely/geometry/base.py, with a few tweaks to eliminate
-            # invocations to GEOS functions. We've also replaced direct
-            # attribute reference with __dict__['attr'] to get rid of the extra
-            # cost of __setattr__ in shapely 1.8.
-            if not g:
-                raise ValueError("No Shapely geometry can be created from null value")
-            ob = BaseGeometry()
-            geom_type = shapely.geometry.base.GEOMETRY_TYPES[geom_type_id]
-            ob.__class__ = GEOMETRY_CLASSES[geom_type_id]
-            ob.__dict__['__geom__'] = g
-            ob.__dict__['__p__'] = None
-            if has_z != 0:
-                ob.__dict__['_ndim'] = 3
-            else:
-                ob.__dict__['_ndim'] = 2
-            ob.__dict__['_is_empty'] = False
-            return ob, bytes_read
+            return geomserde_speedup.deserialize_1(buf)
+
+        def deserialize_array(data, offsets=None, validity=None, num_threads: int = 0) -> "np.ndarray":
+            return _to_object_array(geomserde_speedup.deserialize_array_1(data, offsets, validity, num_threads))
+
+        serialize_array = _serialize_array_py
+        serialized_size = _serialized_size_py
+        serialize_into = _serialize_into_py
+        SerializedGeometry = _SerializedGeometryPy
+
+        def geometry_info_array(data, offsets=None, validity=None, compute_bounds: bool = True,
+                                num_threads: int = 0) -> Dict[str, "np.ndarray"]:
+            return _geometry_info_arrays(*geomserde_speedup.get_geom_info_array(
+                data, offsets, validity, compute_bounds, num_threads))
+
+        def to_wkb(buf, byte_order: int = 1, include_srid: bool = False) -> Optional[bytes]:
+            return geomserde_speedup.to_wkb(buf, byte_order, include_srid)
+
+        def from_wkb(wkb) -> Optional[bytes]:
+            return geomserde_speedup.from_wkb(wkb)
+
+        def to_wkb_array(data, offsets=None, validity=None, byte_order: int = 1, include_srid: bool = False,
+                         num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            return _batch_arrays(*geomserde_speedup.to_wkb_array(
+                data, offsets, validity, byte_order, include_srid, num_threads))
+
+        def from_wkb_array(data, offsets=None, validity=None,
+                           num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            return _batch_arrays(*geomserde_speedup.from_wkb_array(data, offsets, validity, num_threads))
+
+        def to_wkt(buf, precision: int = -1, include_srid: bool = False) -> Optional[str]:
+            return geomserde_speedup.to_wkt(buf, precision, include_srid)
+
+        def to_geojson(buf, precision: int = -1) -> Optional[str]:
+            return geomserde_speedup.to_geojson(buf, precision)
+
+        def to_wkt_array(data, offsets=None, validity=None, precision: int = -1, include_srid: bool = False,
+                         num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            return _batch_arrays(*geomserde_speedup.to_wkt_array(
+                data, offsets, validity, precision, include_srid, num_threads))
+
+        def to_geojson_array(data, offsets=None, validity=None, precision: int = -1,
+                             num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            return _batch_arrays(*geomserde_speedup.to_geojson_array(
+                data, offsets, validity, precision, num_threads))
+
+        def to_geoarrow(data, offsets=None, validity=None, interleaved: bool = True) -> GeoArrowArray:
+            return GeoArrowArray(geomserde_speedup.to_geoarrow, data, offsets, validity, interleaved)
+
+        def from_geoarrow(obj, geom_type=None, num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            schema, array = _geoarrow_capsules(obj)
+            return _batch_arrays(*geomserde_speedup.from_geoarrow(
+                schema, array, _geoarrow_type_id(geom_type), num_threads))
+
+        def validate(buf) -> int:
+            return geomserde_speedup.validate(buf)
+
+        def validate_array(data, offsets=None, validity=None, num_threads: int = 0) -> "np.ndarray":
+            import numpy as np
+            return np.frombuffer(geomserde_speedup.validate_array(data, offsets, validity, num_threads),
+                                 dtype=np.int8)
+
+        def validation_error_message(code: int) -> str:
+            return geomserde_speedup.get_error_message(code)
+
+        def encode_coords(buf, coord_encoding='xor', step: float = 0.0) -> Optional[bytes]:
+            if buf is None:
+                return None
+            return geomserde_speedup.encode_coords(buf, _coord_encoding_id(coord_encoding), step)
+
+        def encode_coords_array(data, offsets=None, validity=None, coord_encoding='xor', step: float = 0.0,
+                                num_threads: int = 0) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+            return _batch_arrays(*geomserde_speedup.encode_coords_array(
+                data, offsets, validity, _coord_encoding_id(coord_encoding), step, num_threads))
+
+        def set_coord_copy_path(path: str) -> str:
+            return COORD_COPY_PATHS[geomserde_speedup.set_coord_copy_path(COORD_COPY_PATHS.index(path))]
+
+        from .geomserde_speedup import stats, reset_stats, set_stats_sampling
+        from .geomserde_speedup import set_geos_context_pool_size
 
     else:
         # fallback to our general pure python implementation
         from .geomserde_general import serialize, deserialize
+        serialize_array = _serialize_array_py
+        deserialize_array = _deserialize_array_py
+        serialized_size = _serialized_size_py
+        serialize_into = _serialize_into_py
+        SerializedGeometry = _SerializedGeometryPy
+        geometry_info_array = _geometry_info_array_py
+        to_wkb = _to_wkb_py
+        from_wkb = _from_wkb_py
+        to_wkb_array = _to_wkb_array_py
+        from_wkb_array = _from_wkb_array_py
+        to_wkt = _to_wkt_py
+        to_geojson = _to_geojson_py
+        to_wkt_array = _to_wkt_array_py
+        to_geojson_array = _to_geojson_array_py
+        to_geoarrow = _to_geoarrow_py
+        from_geoarrow = _from_geoarrow_py
+        encode_coords = _encode_coords_py
+        encode_coords_array = _encode_coords_array_py
+        validate = _validate_py
+        validate_array = _validate_array_py
+        validation_error_message = _validation_error_message_py
+        stats = _stats_py
+        reset_stats = _reset_stats_py
+        set_stats_sampling = _set_stats_sampling_py
+        set_coord_copy_path = _set_coord_copy_path_py
+        set_geos_context_pool_size = _set_geos_context_pool_size_py
 
 except Exception as e:
     warn(f'Cannot load geomserde_speedup, fallback to general python implementation. Reason: {e}')
     from .geomserde_general import serialize, deserialize
+    serialize_array = _serialize_array_py
+    deserialize_array = _deserialize_array_py
+    serialized_size = _serialized_size_py
+    serialize_into = _serialize_into_py
+    SerializedGeometry = _SerializedGeometryPy
+    geometry_info_array = _geometry_info_array_py
+    to_wkb = _to_wkb_py
+    from_wkb = _from_wkb_py
+    to_wkb_array = _to_wkb_array_py
+    from_wkb_array = _from_wkb_array_py
+    to_wkt = _to_wkt_py
+    to_geojson = _to_geojson_py
+    to_wkt_array = _to_wkt_array_py
+    to_geojson_array = _to_geojson_array_py
+    to_geoarrow = _to_geoarrow_py
+    from_geoarrow = _from_geoarrow_py
+    encode_coords = _encode_coords_py
+    encode_coords_array = _encode_coords_array_py
+    validate = _validate_py
+    validate_array = _validate_array_py
+    validation_error_message = _validation_error_message_py
+    stats = _stats_py
+    reset_stats = _reset_stats_py
+    set_stats_sampling = _set_stats_sampling_py
+    set_coord_copy_path = _set_coord_copy_path_py
+    set_geos_context_pool_size = _set_geos_context_pool_size_py
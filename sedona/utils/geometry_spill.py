@@ -0,0 +1,233 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+"""Memory-mapped spill files of serialized geometries.
+
+A spill file has the following layout, all integers are little endian:
+
+    header   magic "SEDSPILL", uint32 version, uint32 flags, 16 reserved bytes
+    records  serialized geometries, each zero-padded to a multiple of 8 bytes
+    index    int64 file offsets of records (n + 1 values), followed by
+             float64 (xmin, ymin, xmax, ymax) of each record (n * 4 values)
+    footer   uint64 number of records, uint64 file offset of the index,
+             magic "SEDSPILL"
+
+Records start at 8-byte aligned file offsets, so coordinates could be read
+directly from the mapped pages. Null records occupy 0 bytes, while a non-null
+serialized geometry is at least 8 bytes, so validity is derived from the
+offsets. Bounds of empty and null records are NaN. Opening a file only reads
+the header and the footer, the index is mapped lazily like the records.
+"""
+
+from typing import Iterator, Optional, Sequence, Tuple, Union
+import mmap
+import os
+import struct
+
+from shapely.geometry.base import BaseGeometry
+
+from .geometry_serde import (
+    _batch_arrays,
+    _transcode_array_py,
+    deserialize,
+    deserialize_array,
+    geometry_info_array,
+    serialize_array,
+)
+
+SPILL_MAGIC = b'SEDSPILL'
+SPILL_VERSION = 1
+SPILL_ALIGNMENT = 8
+
+_HEADER = struct.Struct('<8sII16x')
+_FOOTER = struct.Struct('<QQ8s')
+
+
+def _pad_array_py(data, offsets=None, validity=None, alignment: int = 8) -> Tuple[bytearray, "np.ndarray", "np.ndarray"]:
+    def pad(buf):
+        return bytes(buf) + b'\0' * (-len(buf) % alignment)
+    return _transcode_array_py(pad, data, offsets, validity)
+
+
+try:
+    from .geomserde_speedup import pad_array
+except ImportError:
+    pad_array = _pad_array_py
+
+
+class SpillFileWriter:
+    """Writer of spill files.
+
+    Geometries written by write and write_array are serialized batch_size at
+    a time. Records are appended to the file as they come, the index is kept
+    in memory (40 bytes per record) and written by close.
+    """
+
+    def __init__(self, path: Union[str, os.PathLike], batch_size: int = 65536, num_threads: int = 0):
+        import numpy as np
+        self._file = open(path, 'wb')
+        self._file.write(_HEADER.pack(SPILL_MAGIC, SPILL_VERSION, 0))
+        self._position = _HEADER.size
+        self._offsets = [np.array([self._position], dtype=np.int64)]
+        self._bounds = []
+        self._pending = []
+        self._batch_size = batch_size
+        self._num_threads = num_threads
+
+    def write(self, geom: Optional[BaseGeometry]) -> None:
+        self._pending.append(geom)
+        if len(self._pending) >= self._batch_size:
+            self._flush_pending()
+
+    def write_array(self, geoms: Sequence[Optional[BaseGeometry]]) -> None:
+        self._flush_pending()
+        for start in range(0, len(geoms), self._batch_size):
+            batch = serialize_array(geoms[start:start + self._batch_size], self._num_threads)
+            self.write_serialized_array(*batch)
+
+    def write_serialized_array(self, data, offsets=None, validity=None) -> None:
+        """Append a batch of serialized geometries given in any form accepted
+        by deserialize_array."""
+        import numpy as np
+        self._flush_pending()
+        info = geometry_info_array(data, offsets, validity, num_threads=self._num_threads)
+        self._bounds.append(np.column_stack([info['xmin'], info['ymin'], info['xmax'], info['ymax']]))
+        padded, padded_offsets, _ = _batch_arrays(*pad_array(data, offsets, validity, SPILL_ALIGNMENT))
+        self._file.write(padded)
+        self._offsets.append(padded_offsets[1:] + self._position)
+        self._position += len(padded)
+
+    def _flush_pending(self) -> None:
+        if self._pending:
+            geoms, self._pending = self._pending, []
+            self.write_serialized_array(*serialize_array(geoms, self._num_threads))
+
+    def close(self) -> None:
+        """Write pending records, the index and the footer, then close the
+        file."""
+        import numpy as np
+        if self._file.closed:
+            return
+        self._flush_pending()
+        offsets = np.concatenate(self._offsets)
+        bounds = np.concatenate(self._bounds) if self._bounds else np.empty((0, 4))
+        self._file.write(offsets.astype('<i8').tobytes())
+        self._file.write(bounds.astype('<f8').tobytes())
+        self._file.write(_FOOTER.pack(len(offsets) - 1, self._position, SPILL_MAGIC))
+        self._file.close()
+
+    def __enter__(self) -> "SpillFileWriter":
+        return self
+
+    def __exit__(self, *exc_info) -> None:
+        self.close()
+
+
+class SpillFileReader:
+    """Random access reader of spill files.
+
+    The file is memory mapped, serialized geometries returned by
+    get_serialized and serialized_batch are views of the mapped pages and
+    batches are decoded directly from them. Indexing with an integer returns
+    a geometry, indexing with a slice returns a numpy array of geometries.
+    """
+
+    def __init__(self, path: Union[str, os.PathLike]):
+        import numpy as np
+        with open(path, 'rb') as f:
+            size = os.fstat(f.fileno()).st_size
+            if size < _HEADER.size + _FOOTER.size:
+                raise ValueError('{} is too small to be a spill file'.format(path))
+            self._mmap = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, _ = _HEADER.unpack_from(self._mmap, 0)
+        num_records, index_offset, footer_magic = _FOOTER.unpack_from(self._mmap, size - _FOOTER.size)
+        if magic != SPILL_MAGIC or footer_magic != SPILL_MAGIC:
+            self._mmap.close()
+            raise ValueError('{} is not a spill file or is truncated'.format(path))
+        if version != SPILL_VERSION:
+            self._mmap.close()
+            raise ValueError('Unsupported spill file version {}'.format(version))
+        if index_offset + 40 * num_records + 8 + _FOOTER.size != size:
+            self._mmap.close()
+            raise ValueError('Corrupted index of spill file {}'.format(path))
+        self._num_records = num_records
+        self.offsets = np.frombuffer(self._mmap, dtype='<i8', count=num_records + 1, offset=index_offset)
+        self.bounds = np.frombuffer(self._mmap, dtype='<f8', count=4 * num_records,
+                                    offset=index_offset + 8 * (num_records + 1)).reshape(-1, 4)
+
+    def __len__(self) -> int:
+        return self._num_records
+
+    def get_serialized(self, k: int) -> Optional[memoryview]:
+        """Get the serialized k-th geometry (including its padding) as a view
+        of the mapped file, or None if it is null."""
+        start, end = self.offsets[k], self.offsets[k + 1]
+        if start == end:
+            return None
+        return memoryview(self._mmap)[start:end]
+
+    def serialized_batch(self, start: int = 0, stop: Optional[int] = None) -> Tuple[mmap.mmap, "np.ndarray", "np.ndarray"]:
+        """Get records [start, stop) as (data, offsets, validity) accepted by
+        deserialize_array and other batch functions. data is the mapped file
+        itself and offsets are file offsets, nothing is copied."""
+        import numpy as np
+        start, stop, _ = slice(start, stop).indices(self._num_records)
+        stop = max(start, stop)
+        offsets = self.offsets[start:stop + 1]
+        validity = np.packbits(np.diff(offsets) != 0, bitorder='little')
+        return self._mmap, offsets, validity
+
+    def read_batch(self, start: int = 0, stop: Optional[int] = None, num_threads: int = 0) -> "np.ndarray":
+        return deserialize_array(*self.serialized_batch(start, stop), num_threads=num_threads)
+
+    def iter_batches(self, batch_size: int = 65536, num_threads: int = 0) -> Iterator["np.ndarray"]:
+        for start in range(0, self._num_records, batch_size):
+            yield self.read_batch(start, start + batch_size, num_threads)
+
+    def __getitem__(self, key):
+        if isinstance(key, slice):
+            if key.step not in (None, 1):
+                return self.read_batch()[key]
+            return self.read_batch(key.start, key.stop)
+        if key < 0:
+            key += self._num_records
+        if not 0 <= key < self._num_records:
+            raise IndexError('spill file record index out of range')
+        buf = self.get_serialized(key)
+        return deserialize(buf)[0] if buf is not None else None
+
+    def __iter__(self) -> Iterator[Optional[BaseGeometry]]:
+        for batch in self.iter_batches():
+            yield from batch
+
+    def close(self) -> None:
+        if self._mmap is None:
+            return
+        mm, self._mmap = self._mmap, None
+        del self.offsets, self.bounds
+        try:
+            mm.close()
+        except BufferError:
+            # Views returned by the reader are still alive, the file is
+            # unmapped when the last of them is released
+            pass
+
+    def __enter__(self) -> "SpillFileReader":
+        return self
+
+    def __exit__(self, *exc_info) -> None:
+        self.close()
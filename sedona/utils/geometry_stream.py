@@ -0,0 +1,194 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+"""Streaming of serialized geometries between processes.
+
+A stream is a sequence of records, each record is a 4-byte little endian
+signed length followed by a serialized geometry. Null geometries are encoded
+as a length of -1 without payload. Record boundaries could be found without
+parsing geometries, so streams of any size are read and written in bounded
+memory.
+"""
+
+from typing import Iterator, Optional, Sequence, Tuple
+import struct
+
+from shapely.geometry.base import BaseGeometry
+
+from .geometry_serde import (
+    _batch_arrays,
+    _iter_serialized,
+    _transcode_array_py,
+    deserialize_array,
+    serialize,
+    serialize_array,
+)
+
+_FRAME_HEADER = struct.Struct('<i')
+_NULL_FRAME = _FRAME_HEADER.pack(-1)
+
+
+def _frame_array_py(data, offsets=None, validity=None) -> bytearray:
+    frames = bytearray()
+    for buf in _iter_serialized(data, offsets, validity):
+        if buf is None:
+            frames += _NULL_FRAME
+        else:
+            frames += _FRAME_HEADER.pack(len(buf))
+            frames += buf
+    return frames
+
+
+def _split_frames_py(buf) -> Tuple[Tuple[bytearray, "np.ndarray", "np.ndarray"], int]:
+    view = memoryview(buf).cast('B')
+    bufs = []
+    pos = 0
+    while len(view) - pos >= _FRAME_HEADER.size:
+        (length,) = _FRAME_HEADER.unpack_from(view, pos)
+        if length < -1:
+            raise ValueError('Invalid frame length {} at offset {}'.format(length, pos))
+        payload_size = max(length, 0)
+        if len(view) - pos - _FRAME_HEADER.size < payload_size:
+            break
+        start = pos + _FRAME_HEADER.size
+        bufs.append(bytes(view[start:start + payload_size]) if length >= 0 else None)
+        pos = start + payload_size
+    return _transcode_array_py(lambda b: b, bufs), pos
+
+
+try:
+    from .geomserde_speedup import frame_array, split_frames
+except ImportError:
+    frame_array = _frame_array_py
+    split_frames = _split_frames_py
+
+
+class GeometryStreamWriter:
+    """Writer appending framed serialized geometries to a binary stream.
+
+    The stream could be any object with a write method (e.g. BufferedWriter)
+    or a socket. Small records are accumulated in a buffer of buffer_size
+    bytes before being written, batches written by write_array are
+    serialized batch_size geometries at a time, so memory usage does not
+    depend on the total size of the stream.
+    """
+
+    def __init__(self, stream, buffer_size: int = 1 << 20, batch_size: int = 4096, num_threads: int = 0):
+        self._write = stream.write if hasattr(stream, 'write') else stream.sendall
+        self._stream = stream
+        self._buffer = bytearray()
+        self._buffer_size = buffer_size
+        self._batch_size = batch_size
+        self._num_threads = num_threads
+
+    def write(self, geom: Optional[BaseGeometry]) -> None:
+        self.write_serialized(serialize(geom) if geom is not None else None)
+
+    def write_serialized(self, buf) -> None:
+        if buf is None:
+            self._buffer += _NULL_FRAME
+        else:
+            self._buffer += _FRAME_HEADER.pack(len(buf))
+            self._buffer += buf
+        if len(self._buffer) >= self._buffer_size:
+            self._flush_buffer()
+
+    def write_array(self, geoms: Sequence[Optional[BaseGeometry]]) -> None:
+        for start in range(0, len(geoms), self._batch_size):
+            batch = serialize_array(geoms[start:start + self._batch_size], self._num_threads)
+            self.write_serialized_array(*batch)
+
+    def write_serialized_array(self, data, offsets=None, validity=None) -> None:
+        """Write a batch of serialized geometries given in any form accepted
+        by deserialize_array."""
+        frames = frame_array(data, offsets, validity)
+        if len(self._buffer) + len(frames) < self._buffer_size:
+            self._buffer += frames
+            return
+        self._flush_buffer()
+        self._write(frames)
+
+    def _flush_buffer(self) -> None:
+        if self._buffer:
+            self._write(self._buffer)
+            self._buffer = bytearray()
+
+    def flush(self) -> None:
+        self._flush_buffer()
+        if hasattr(self._stream, 'flush'):
+            self._stream.flush()
+
+    def close(self) -> None:
+        """Flush buffered records, the underlying stream is left open."""
+        self.flush()
+
+    def __enter__(self) -> "GeometryStreamWriter":
+        return self
+
+    def __exit__(self, *exc_info) -> None:
+        self.close()
+
+
+class GeometryStreamReader:
+    """Incremental reader of streams written by GeometryStreamWriter.
+
+    The stream is consumed in chunks of chunk_size bytes, which could be any
+    object with a readinto method (e.g. BufferedReader) or a socket. Complete
+    records of each chunk are decoded as one batch, a partial record at the
+    end of a chunk is carried over until the rest of it arrives. Memory usage
+    is bounded by chunk_size plus the size of the largest record.
+    """
+
+    def __init__(self, stream, chunk_size: int = 1 << 20, num_threads: int = 0):
+        self._readinto = stream.readinto if hasattr(stream, 'readinto') else stream.recv_into
+        self._chunk = bytearray(chunk_size)
+        self._pending = bytearray()
+        self._eof = False
+        self._num_threads = num_threads
+
+    def read_serialized_batch(self) -> Optional[Tuple[bytearray, "np.ndarray", "np.ndarray"]]:
+        """Read the next batch of complete records as (data, offsets,
+        validity) in the same form as serialize_array. Returns None at the
+        end of the stream. Raises ValueError when the stream ends with an
+        incomplete record.
+        """
+        while not self._eof:
+            num_bytes = self._readinto(self._chunk) or 0
+            self._eof = (num_bytes == 0)
+            self._pending += memoryview(self._chunk)[:num_bytes]
+            batch, consumed = split_frames(self._pending)
+            if consumed > 0:
+                del self._pending[:consumed]
+                return _batch_arrays(*batch)
+        if self._pending:
+            raise ValueError('Stream ends with an incomplete record of {} bytes'.format(len(self._pending)))
+        return None
+
+    def read_batch(self) -> Optional["np.ndarray"]:
+        """Read and deserialize the next batch of complete records, returns
+        None at the end of the stream."""
+        batch = self.read_serialized_batch()
+        if batch is None:
+            return None
+        return deserialize_array(*batch, num_threads=self._num_threads)
+
+    def __iter__(self) -> Iterator[Optional[BaseGeometry]]:
+        while True:
+            batch = self.read_batch()
+            if batch is None:
+                return
+            yield from batch
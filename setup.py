@@ -23,20 +23,41 @@ from sedona import version
 with open("README.md", "r") as fh:
     long_description = fh.read()
 
-extension_args = {}
+extension_args = {
+    'extra_compile_args': [],
+    'extra_link_args': []
+}
+
+if os.name != 'nt':
+    # Batch functions process geometries using a pool of native threads
+    extension_args['extra_compile_args'].append("-pthread")
+    extension_args['extra_link_args'].append("-pthread")
 
 if os.getenv('ENABLE_ASAN'):
-    extension_args = {
-        'extra_compile_args': ["-fsanitize=address"],
-        'extra_link_args': ["-fsanitize=address"]
-    }
+    extension_args['extra_compile_args'].append("-fsanitize=address")
+    extension_args['extra_link_args'].append("-fsanitize=address")
+
+if os.getenv('ENABLE_USDT'):
+    # Static tracepoints of the serializer, requires sys/sdt.h
+    extension_args['extra_compile_args'].append("-DSEDONA_ENABLE_USDT")
 
 ext_modules = [
     Extension('sedona.utils.geomserde_speedup', sources=[
         'src/geomserde_speedup_module.c',
         'src/geomserde.c',
         'src/geom_buf.c',
-        'src/geos_c_dyn.c'
+        'src/coord_codec.c',
+        'src/block_codec.c',
+        'src/geom_info.c',
+        'src/geom_text.c',
+        'src/geom_wkb.c',
+        'src/geoarrow.c',
+        'src/geos_c_dyn.c',
+        'src/thread_pool.c',
+        'src/scratch_arena.c',
+        'src/serde_stats.c',
+        'src/serde_alloc.c',
+        'src/geos_context_pool.c',
     ], **extension_args)
 ]
 
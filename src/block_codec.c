@@ -0,0 +1,209 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "block_codec.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "scratch_arena.h"
+
+#define MIN_MATCH 4
+#define HASH_BITS 14
+#define MAX_OFFSET 65535
+/* The last 5 bytes of a block are always literals, and the last match should
+ * start at least 12 bytes before the end of the block */
+#define LAST_LITERALS 5
+#define MATCH_FIND_LIMIT 12
+/* Misses skip ahead faster the longer no match was found, so incompressible
+ * data is passed through quickly */
+#define SKIP_SHIFT 6
+
+static inline uint32_t load_u32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t hash_u32(uint32_t v) {
+  return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static inline uint8_t *write_length(uint8_t *op, int length) {
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = (uint8_t)length;
+  return op;
+}
+
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *literals,
+                               int literal_length) {
+  uint8_t *token = op++;
+  if (literal_length >= 15) {
+    *token = 15 << 4;
+    op = write_length(op, literal_length - 15);
+  } else {
+    *token = (uint8_t)(literal_length << 4);
+  }
+  memcpy(op, literals, literal_length);
+  return op + literal_length;
+}
+
+SedonaErrorCode block_compress(const char *src, int src_size, char *dst,
+                               int capacity, int *p_size) {
+  if (src_size < 0 || capacity < block_compress_bound(src_size)) {
+    return SEDONA_BUFFER_TOO_SMALL;
+  }
+  const uint8_t *base = (const uint8_t *)src;
+  const uint8_t *end = base + src_size;
+  const uint8_t *anchor = base;
+  uint8_t *op = (uint8_t *)dst;
+
+  if (src_size > MATCH_FIND_LIMIT) {
+    scratch_arena_begin();
+    uint32_t *table = scratch_arena_calloc(1 << HASH_BITS, sizeof(uint32_t));
+    if (table == NULL) {
+      scratch_arena_end();
+      return SEDONA_ALLOC_ERROR;
+    }
+    const uint8_t *match_limit = end - MATCH_FIND_LIMIT;
+    const uint8_t *copy_limit = end - LAST_LITERALS;
+    const uint8_t *ip = base + 1;
+    while (ip < match_limit) {
+      uint32_t seq = load_u32(ip);
+      uint32_t h = hash_u32(seq);
+      const uint8_t *ref = base + table[h];
+      table[h] = (uint32_t)(ip - base);
+      if (ip - ref > MAX_OFFSET || load_u32(ref) != seq) {
+        ip += 1 + ((ip - anchor) >> SKIP_SHIFT);
+        continue;
+      }
+
+      /* Extend the match backwards over pending literals, then forwards */
+      while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      const uint8_t *mp = ip + MIN_MATCH;
+      const uint8_t *rp = ref + MIN_MATCH;
+      while (mp < copy_limit && *mp == *rp) {
+        mp++;
+        rp++;
+      }
+
+      uint8_t *token = op;
+      op = write_sequence(op, anchor, (int)(ip - anchor));
+      int offset = (int)(ip - ref);
+      *op++ = (uint8_t)(offset & 0xFF);
+      *op++ = (uint8_t)(offset >> 8);
+      int match_length = (int)(mp - ip) - MIN_MATCH;
+      if (match_length >= 15) {
+        *token |= 15;
+        op = write_length(op, match_length - 15);
+      } else {
+        *token |= (uint8_t)match_length;
+      }
+
+      ip = anchor = mp;
+      if (ip < match_limit) {
+        table[hash_u32(load_u32(ip - 2))] = (uint32_t)(ip - 2 - base);
+      }
+    }
+    scratch_arena_end();
+  }
+
+  op = write_sequence(op, anchor, (int)(end - anchor));
+  *p_size = (int)(op - (uint8_t *)dst);
+  return SEDONA_SUCCESS;
+}
+
+static inline int read_length(const uint8_t **p_ip, const uint8_t *iend,
+                              int64_t *p_length) {
+  const uint8_t *ip = *p_ip;
+  int64_t length = *p_length;
+  uint8_t b;
+  do {
+    if (ip >= iend || length > INT32_MAX) {
+      return -1;
+    }
+    b = *ip++;
+    length += b;
+  } while (b == 255);
+  *p_ip = ip;
+  *p_length = length;
+  return 0;
+}
+
+SedonaErrorCode block_decompress(const char *src, int src_size, char *dst,
+                                 int dst_size) {
+  const uint8_t *ip = (const uint8_t *)src;
+  const uint8_t *iend = ip + src_size;
+  uint8_t *op = (uint8_t *)dst;
+  uint8_t *oend = op + dst_size;
+
+  for (;;) {
+    if (ip >= iend) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    unsigned token = *ip++;
+    int64_t literal_length = token >> 4;
+    if (literal_length == 15 && read_length(&ip, iend, &literal_length) != 0) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    if (literal_length > iend - ip || literal_length > oend - op) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    memcpy(op, ip, literal_length);
+    op += literal_length;
+    ip += literal_length;
+    if (ip == iend) {
+      break; /* The last sequence has no match */
+    }
+
+    if (iend - ip < 2) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    int64_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > op - (uint8_t *)dst) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    int64_t match_length = token & 15;
+    if (match_length == 15 && read_length(&ip, iend, &match_length) != 0) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    match_length += MIN_MATCH;
+    if (match_length > oend - op) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    const uint8_t *match = op - offset;
+    if (offset >= match_length) {
+      memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      /* Overlapping match repeats the last offset bytes */
+      for (int64_t k = 0; k < match_length; k++) {
+        *op++ = match[k];
+      }
+    }
+  }
+  return op == oend ? SEDONA_SUCCESS : SEDONA_BAD_GEOM_BUFFER;
+}
@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef BLOCK_CODEC
+#define BLOCK_CODEC
+
+#include "geomserde.h"
+
+/* A small LZ4 compatible block codec for compressing blocks of serialized
+ * geometries. Compressed blocks use the LZ4 block format (without the frame
+ * format), so they could also be decoded by liblz4's LZ4_decompress_safe.
+ * The compressor is a greedy single-probe matcher tuned for speed over ratio,
+ * which works well on serialized geometries where redundancy mostly comes
+ * from repeated headers, structural integers and shared coordinates. */
+
+/**
+ * Returns the worst-case size of compressing size bytes
+ */
+static inline int block_compress_bound(int size) {
+  return size + size / 255 + 16;
+}
+
+/**
+ * Compresses a block
+ *
+ * @param src data to compress
+ * @param src_size size of data
+ * @param dst buffer for writing the compressed block into
+ * @param capacity size of dst, should be at least
+ * block_compress_bound(src_size), otherwise SEDONA_BUFFER_TOO_SMALL will be
+ * returned
+ * @param p_size OUTPUT parameter for receiving size of the compressed block
+ * @return error code
+ */
+SedonaErrorCode block_compress(const char *src, int src_size, char *dst,
+                               int capacity, int *p_size);
+
+/**
+ * Decompresses a block. Malformed input never reads or writes out of bounds.
+ *
+ * @param src compressed block
+ * @param src_size size of the compressed block
+ * @param dst buffer for writing decompressed data into
+ * @param dst_size exact size of decompressed data, SEDONA_BAD_GEOM_BUFFER will
+ * be returned if the block does not decompress to exactly dst_size bytes
+ * @return error code
+ */
+SedonaErrorCode block_decompress(const char *src, int src_size, char *dst,
+                                 int dst_size);
+
+#endif /* BLOCK_CODEC */
@@ -0,0 +1,658 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "coord_codec.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "geom_buf.h"
+#include "scratch_arena.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline int clz64(uint64_t x) {
+  unsigned long index;
+  _BitScanReverse64(&index, x);
+  return 63 - (int)index;
+}
+static inline int ctz64(uint64_t x) {
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return (int)index;
+}
+#else
+static inline int clz64(uint64_t x) { return __builtin_clzll(x); }
+static inline int ctz64(uint64_t x) { return __builtin_ctzll(x); }
+#endif
+
+#define BLOCK_HEADER_SIZE 8
+#define MAX_DIMS 4
+
+/* Quantized ordinates are in [-QUANT_MAX, QUANT_MAX], values out of this
+ * range are reserved for non-finite ordinates */
+#define QUANT_MAX 2147483646
+#define QUANT_NAN INT32_MIN
+#define QUANT_NEG_INF (INT32_MIN + 1)
+#define QUANT_POS_INF INT32_MAX
+
+static inline int64_t aligned_size(int64_t size) { return (size + 7) & ~7; }
+static inline int aligned_offset(int offset) { return (offset + 7) & ~7; }
+
+/* Bit streams of the XOR encoding are written MSB first in 64-bit big endian
+ * words, so the payload is always a multiple of 8 bytes and does not depend
+ * on the byte order of the machine. */
+
+typedef struct BitWriter {
+  unsigned char *p; /* NULL when counting */
+  unsigned char *end;
+  uint64_t acc;
+  int acc_bits;
+  int64_t num_bits;
+} BitWriter;
+
+static inline void store_word(unsigned char *p, uint64_t word) {
+  for (int k = 0; k < 8; k++) {
+    p[k] = (unsigned char)(word >> (56 - 8 * k));
+  }
+}
+
+static inline uint64_t load_word(const unsigned char *p) {
+  uint64_t word = 0;
+  for (int k = 0; k < 8; k++) {
+    word = (word << 8) | p[k];
+  }
+  return word;
+}
+
+static inline void bits_flush_word(BitWriter *w) {
+  if (w->p != NULL) {
+    if (w->end - w->p >= 8) {
+      store_word(w->p, w->acc);
+      w->p += 8;
+    } else {
+      w->p = NULL; /* out of space, keep counting */
+    }
+  }
+  w->acc = 0;
+  w->acc_bits = 0;
+}
+
+/* Append the lowest n bits of value, 1 <= n <= 64 */
+static inline void bits_put(BitWriter *w, uint64_t value, int n) {
+  w->num_bits += n;
+  int space = 64 - w->acc_bits;
+  if (n < space) {
+    w->acc = (w->acc << n) | (value & ((UINT64_C(1) << n) - 1));
+    w->acc_bits += n;
+    return;
+  }
+  /* Fill up the current word with the highest bits of value */
+  int rest = n - space;
+  uint64_t high = (rest > 0 ? value >> rest : value);
+  w->acc = (space == 64 ? high : (w->acc << space) | high);
+  bits_flush_word(w);
+  if (rest > 0) {
+    w->acc = value & ((UINT64_C(1) << rest) - 1);
+    w->acc_bits = rest;
+  }
+}
+
+static inline void bits_finish(BitWriter *w) {
+  if (w->acc_bits > 0) {
+    w->acc <<= (64 - w->acc_bits);
+    bits_flush_word(w);
+  }
+}
+
+typedef struct BitReader {
+  const unsigned char *p;
+  const unsigned char *end;
+  uint64_t acc;
+  int acc_bits;
+} BitReader;
+
+/* Read n bits, 1 <= n <= 64. Returns -1 if the stream is exhausted. */
+static inline int bits_get(BitReader *r, int n, uint64_t *p_value) {
+  uint64_t value = 0;
+  while (n > 0) {
+    if (r->acc_bits == 0) {
+      if (r->end - r->p < 8) {
+        return -1;
+      }
+      r->acc = load_word(r->p);
+      r->acc_bits = 64;
+      r->p += 8;
+    }
+    int take = (n < r->acc_bits ? n : r->acc_bits);
+    if (take == 64) {
+      value = r->acc;
+      r->acc = 0;
+    } else {
+      value = (value << take) | (r->acc >> (64 - take));
+      r->acc <<= take;
+    }
+    r->acc_bits -= take;
+    n -= take;
+  }
+  *p_value = value;
+  return 0;
+}
+
+/* Gorilla-style XOR encoding. Each ordinate is XORed with the previous
+ * ordinate of the same dimension. A zero XOR is written as a single 0 bit;
+ * otherwise the meaningful bits are written either within the window of
+ * leading and trailing zeros of the previous XOR of that dimension (prefix
+ * 10), or with a new window (prefix 11, 5 bits of leading zeros, 6 bits of
+ * length - 1). */
+typedef struct XorState {
+  uint64_t prev[MAX_DIMS];
+  int lead[MAX_DIMS];
+  int trail[MAX_DIMS];
+} XorState;
+
+static void xor_state_init(XorState *s) {
+  for (int d = 0; d < MAX_DIMS; d++) {
+    s->prev[d] = 0;
+    s->lead[d] = 64; /* no window yet */
+    s->trail[d] = 0;
+  }
+}
+
+static void xor_encode(BitWriter *w, const double *coords, int64_t num_ordinates,
+                       int dims) {
+  XorState s;
+  xor_state_init(&s);
+  int d = 0;
+  for (int64_t k = 0; k < num_ordinates; k++) {
+    uint64_t bits;
+    memcpy(&bits, coords + k, 8);
+    uint64_t x = bits ^ s.prev[d];
+    s.prev[d] = bits;
+    if (x == 0) {
+      bits_put(w, 0, 1);
+    } else {
+      int lead = clz64(x);
+      int trail = ctz64(x);
+      if (lead > 31) {
+        lead = 31;
+      }
+      if (lead >= s.lead[d] && trail >= s.trail[d]) {
+        bits_put(w, 2, 2);
+        bits_put(w, x >> s.trail[d], 64 - s.lead[d] - s.trail[d]);
+      } else {
+        int num_sig = 64 - lead - trail;
+        bits_put(w, 3, 2);
+        bits_put(w, (uint64_t)lead, 5);
+        bits_put(w, (uint64_t)(num_sig - 1), 6);
+        bits_put(w, x >> trail, num_sig);
+        s.lead[d] = lead;
+        s.trail[d] = trail;
+      }
+    }
+    if (++d == dims) {
+      d = 0;
+    }
+  }
+  bits_finish(w);
+}
+
+static SedonaErrorCode xor_decode(BitReader *r, double *coords,
+                                  int64_t num_ordinates, int dims) {
+  XorState s;
+  xor_state_init(&s);
+  int d = 0;
+  for (int64_t k = 0; k < num_ordinates; k++) {
+    uint64_t control = 0;
+    uint64_t x = 0;
+    if (bits_get(r, 1, &control) != 0) {
+      return SEDONA_INCOMPLETE_BUFFER;
+    }
+    if (control != 0) {
+      if (bits_get(r, 1, &control) != 0) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      if (control != 0) {
+        uint64_t lead = 0;
+        uint64_t num_sig = 0;
+        if (bits_get(r, 5, &lead) != 0 || bits_get(r, 6, &num_sig) != 0) {
+          return SEDONA_INCOMPLETE_BUFFER;
+        }
+        num_sig += 1;
+        if (lead + num_sig > 64) {
+          return SEDONA_BAD_GEOM_BUFFER;
+        }
+        s.lead[d] = (int)lead;
+        s.trail[d] = (int)(64 - lead - num_sig);
+      } else if (s.lead[d] == 64) {
+        return SEDONA_BAD_GEOM_BUFFER;
+      }
+      if (bits_get(r, 64 - s.lead[d] - s.trail[d], &x) != 0) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      x <<= s.trail[d];
+    }
+    s.prev[d] ^= x;
+    if (coords != NULL) {
+      memcpy(coords + k, &s.prev[d], 8);
+    }
+    if (++d == dims) {
+      d = 0;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Quantization origin and step of each dimension. The origin is the center of
+ * the finite values, so that the step needed for covering them with int32
+ * values is minimized. */
+static void quantize_params(const double *coords, int64_t num_coords,
+                            int dims, double step, double *origin,
+                            double *steps) {
+  for (int d = 0; d < dims; d++) {
+    double lo = INFINITY;
+    double hi = -INFINITY;
+    for (int64_t k = 0; k < num_coords; k++) {
+      double v = coords[k * dims + d];
+      if (isfinite(v)) {
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+      }
+    }
+    if (lo > hi) {
+      origin[d] = 0;
+      steps[d] = 1;
+      continue;
+    }
+    /* Halve before subtracting to avoid overflow */
+    double half_range = hi / 2 - lo / 2;
+    double min_step = half_range / (QUANT_MAX - 1);
+    double s = (step > 0 ? step : 0);
+    if (s < min_step) {
+      s = min_step;
+    }
+    origin[d] = lo / 2 + hi / 2;
+    steps[d] = (s > 0 ? s : 1);
+  }
+}
+
+static inline int32_t quantize(double v, double origin, double step) {
+  if (isnan(v)) {
+    return QUANT_NAN;
+  }
+  if (isinf(v)) {
+    return v > 0 ? QUANT_POS_INF : QUANT_NEG_INF;
+  }
+  double q = floor((v - origin) / step + 0.5);
+  if (q > QUANT_MAX) {
+    q = QUANT_MAX;
+  } else if (q < -QUANT_MAX) {
+    q = -QUANT_MAX;
+  }
+  return (int32_t)q;
+}
+
+static inline double dequantize(int32_t q, double origin, double step) {
+  switch (q) {
+    case QUANT_NAN:
+      return NAN;
+    case QUANT_NEG_INF:
+      return -INFINITY;
+    case QUANT_POS_INF:
+      return INFINITY;
+    default:
+      return origin + q * step;
+  }
+}
+
+static void write_block_header(char *out, CoordEncoding encoding,
+                               int payload_size) {
+  memset(out, 0, BLOCK_HEADER_SIZE);
+  out[0] = (char)encoding;
+  memcpy(out + 4, &payload_size, sizeof(int));
+}
+
+SedonaErrorCode coord_encode(CoordEncoding encoding, double step,
+                             const double *coords, int num_coords, int dims,
+                             char *out, int capacity, int *p_size) {
+  if (dims < 2 || dims > MAX_DIMS) {
+    return SEDONA_UNKNOWN_COORD_TYPE;
+  }
+  int64_t num_ordinates = (int64_t)num_coords * dims;
+  int64_t payload_size;
+  switch (encoding) {
+    case COORD_ENCODING_FLOAT32:
+      payload_size = aligned_size(num_ordinates * 4);
+      break;
+    case COORD_ENCODING_QUANTIZED:
+      payload_size = dims * 16 + aligned_size(num_ordinates * 4);
+      break;
+    case COORD_ENCODING_XOR: {
+      /* The size of the bit stream is only known after encoding, so the
+       * stream is written while there's room and counted anyway */
+      BitWriter w = {NULL, NULL, 0, 0, 0};
+      if (out != NULL && capacity > BLOCK_HEADER_SIZE) {
+        w.p = (unsigned char *)out + BLOCK_HEADER_SIZE;
+        w.end = (unsigned char *)out + capacity;
+      }
+      xor_encode(&w, coords, num_ordinates, dims);
+      payload_size = (w.num_bits + 63) / 64 * 8;
+      break;
+    }
+    default:
+      return SEDONA_INTERNAL_ERROR;
+  }
+  if (BLOCK_HEADER_SIZE + payload_size > INT_MAX) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  int size = (int)(BLOCK_HEADER_SIZE + payload_size);
+  *p_size = size;
+  if (out == NULL) {
+    return SEDONA_SUCCESS;
+  }
+  if (size > capacity) {
+    return SEDONA_BUFFER_TOO_SMALL;
+  }
+
+  write_block_header(out, encoding, (int)payload_size);
+  char *p = out + BLOCK_HEADER_SIZE;
+  char *end = out + size;
+  if (encoding == COORD_ENCODING_FLOAT32) {
+    float *values = (float *)p;
+    for (int64_t k = 0; k < num_ordinates; k++) {
+      values[k] = (float)coords[k];
+    }
+    p += num_ordinates * 4;
+  } else if (encoding == COORD_ENCODING_QUANTIZED) {
+    double origin[MAX_DIMS];
+    double steps[MAX_DIMS];
+    quantize_params(coords, num_coords, dims, step, origin, steps);
+    memcpy(p, origin, dims * sizeof(double));
+    memcpy(p + dims * sizeof(double), steps, dims * sizeof(double));
+    p += dims * 16;
+    int32_t *values = (int32_t *)p;
+    for (int64_t k = 0; k < num_ordinates; k++) {
+      int d = (int)(k % dims);
+      values[k] = quantize(coords[k], origin[d], steps[d]);
+    }
+    p += num_ordinates * 4;
+  } else {
+    p = end; /* already written */
+  }
+  memset(p, 0, end - p);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode coord_decode(const char *buf, int buf_size, int num_coords,
+                             int dims, double *coords, int *p_bytes_read) {
+  if (buf_size < BLOCK_HEADER_SIZE) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  if (dims < 2 || dims > MAX_DIMS) {
+    return SEDONA_UNKNOWN_COORD_TYPE;
+  }
+  int encoding = (unsigned char)buf[0];
+  int payload_size = 0;
+  memcpy(&payload_size, buf + 4, sizeof(int));
+  if (payload_size < 0 || payload_size % 8 != 0) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  if (payload_size > buf_size - BLOCK_HEADER_SIZE) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+
+  const char *p = buf + BLOCK_HEADER_SIZE;
+  int64_t num_ordinates = (int64_t)num_coords * dims;
+  switch (encoding) {
+    case COORD_ENCODING_FLOAT32: {
+      if (num_ordinates * 4 > payload_size) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      const float *values = (const float *)p;
+      for (int64_t k = 0; coords != NULL && k < num_ordinates; k++) {
+        coords[k] = values[k];
+      }
+      break;
+    }
+    case COORD_ENCODING_QUANTIZED: {
+      if (dims * 16 + num_ordinates * 4 > payload_size) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      double origin[MAX_DIMS];
+      double steps[MAX_DIMS];
+      memcpy(origin, p, dims * sizeof(double));
+      memcpy(steps, p + dims * sizeof(double), dims * sizeof(double));
+      const int32_t *values = (const int32_t *)(p + dims * 16);
+      for (int64_t k = 0; coords != NULL && k < num_ordinates; k++) {
+        int d = (int)(k % dims);
+        coords[k] = dequantize(values[k], origin[d], steps[d]);
+      }
+      break;
+    }
+    case COORD_ENCODING_XOR: {
+      BitReader r = {(const unsigned char *)p,
+                     (const unsigned char *)p + payload_size, 0, 0};
+      SedonaErrorCode err = xor_decode(&r, coords, num_ordinates, dims);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      break;
+    }
+    default:
+      return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_bytes_read = BLOCK_HEADER_SIZE + payload_size;
+  return SEDONA_SUCCESS;
+}
+
+/* Re-encoding of whole geometries. Output is appended to an EncodeOutput;
+ * once it runs out of space, the rest of the geometry is only measured so
+ * that the required size could be reported. */
+
+typedef struct EncodeOutput {
+  char *out; /* NULL when counting */
+  int64_t capacity;
+  int64_t size;
+} EncodeOutput;
+
+static void output_append(EncodeOutput *o, const void *data, int64_t n) {
+  if (o->out != NULL) {
+    if (o->capacity - o->size >= n) {
+      if (data != NULL) {
+        memcpy(o->out + o->size, data, n);
+      } else {
+        memset(o->out + o->size, 0, n);
+      }
+    } else {
+      o->out = NULL;
+    }
+  }
+  o->size += n;
+}
+
+/* Number of structural integers of a non-collection geometry */
+static SedonaErrorCode count_ints(GeometryTypeId geom_type_id,
+                                  const GeomBuffer *geom_buf, int num_coords,
+                                  int64_t *p_num_ints) {
+  const int *ints = geom_buf->buf_int;
+  int64_t avail = geom_buf->buf_int_end - geom_buf->buf_int;
+  int64_t pos = 0;
+  switch (geom_type_id) {
+    case POINT:
+    case LINESTRING:
+    case MULTIPOINT:
+      break;
+    case POLYGON:
+    case MULTILINESTRING:
+      if (geom_type_id == POLYGON && num_coords == 0) {
+        break;
+      }
+      if (avail < 1 || ints[0] < 0) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      pos = 1 + (int64_t)ints[0];
+      break;
+    case MULTIPOLYGON: {
+      if (avail < 1 || ints[0] < 0) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      int num_polygons = ints[0];
+      pos = 1;
+      for (int k = 0; k < num_polygons; k++) {
+        if (pos >= avail || ints[pos] < 0) {
+          return SEDONA_INCOMPLETE_BUFFER;
+        }
+        pos += 1 + (int64_t)ints[pos];
+      }
+      break;
+    }
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  if (pos > avail) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  *p_num_ints = pos;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode encode_geom(const char *buf, int buf_size,
+                                   CoordEncoding encoding, double step,
+                                   int depth, EncodeOutput *o,
+                                   int *p_bytes_read) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  if (geom_type_id == GEOMETRYCOLLECTION) {
+    if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    output_append(o, buf, 8);
+    const char *child_buf = buf + 8;
+    int remaining_size = buf_size - 8;
+    for (unsigned int k = 0; k < cs_info.num_coords; k++) {
+      int bytes_read = 0;
+      err = encode_geom(child_buf, remaining_size, encoding, step, depth + 1,
+                        o, &bytes_read);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      output_append(o, NULL, aligned_size(o->size) - o->size);
+      bytes_read = aligned_offset(bytes_read);
+      if (remaining_size < bytes_read) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      remaining_size -= bytes_read;
+      child_buf += bytes_read;
+    }
+    *p_bytes_read = (int)(child_buf - buf);
+    return SEDONA_SUCCESS;
+  }
+
+  int num_coords = cs_info.num_coords;
+  int64_t num_ints = 0;
+  err = count_ints(geom_type_id, &geom_buf, num_coords, &num_ints);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  unsigned char header[8];
+  memcpy(header, buf, 8);
+  int is_encoded = (encoding != COORD_ENCODING_NONE && num_coords > 0);
+  header[0] = (unsigned char)(is_encoded ? header[0] | COORD_ENCODED_FLAG
+                                         : header[0] & ~COORD_ENCODED_FLAG);
+  output_append(o, header, 8);
+  if (is_encoded) {
+    int64_t capacity = (o->out != NULL ? o->capacity - o->size : 0);
+    int block_size = 0;
+    err = coord_encode(encoding, step, geom_buf.buf_coord, num_coords,
+                       cs_info.dims, o->out != NULL ? o->out + o->size : NULL,
+                       capacity > INT_MAX ? INT_MAX : (int)capacity,
+                       &block_size);
+    if (err == SEDONA_BUFFER_TOO_SMALL) {
+      o->out = NULL;
+    } else if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    o->size += block_size;
+  } else {
+    output_append(o, geom_buf.buf_coord,
+                  (int64_t)num_coords * cs_info.dims * 8);
+  }
+  output_append(o, geom_buf.buf_int, num_ints * 4);
+  *p_bytes_read = (int)((const char *)(geom_buf.buf_int + num_ints) - buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_encode_coords(const char *buf, int buf_size,
+                                     CoordEncoding encoding, double step,
+                                     char *out, int capacity, int *p_size) {
+  if (encoding < COORD_ENCODING_NONE || encoding > COORD_ENCODING_XOR) {
+    return SEDONA_INTERNAL_ERROR;
+  }
+  EncodeOutput o = {out, capacity, 0};
+  int bytes_read = 0;
+
+  /* Decoded coordinates of the input are allocated from the scratch arena */
+  scratch_arena_begin();
+  SedonaErrorCode err = encode_geom(buf, buf_size, encoding, step, 0, &o,
+                                    &bytes_read);
+  scratch_arena_end();
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (o.size > INT_MAX) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_size = (int)o.size;
+  if (out != NULL && o.size > capacity) {
+    return SEDONA_BUFFER_TOO_SMALL;
+  }
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_read_coords(const char *buf, int buf_size,
+                                   double *coords) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  scratch_arena_begin();
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err == SEDONA_SUCCESS) {
+    if (geom_type_id == GEOMETRYCOLLECTION) {
+      err = SEDONA_UNSUPPORTED_GEOM_TYPE;
+    } else {
+      memcpy(coords, geom_buf.buf_coord,
+             (size_t)cs_info.num_coords * cs_info.dims * sizeof(double));
+    }
+  }
+  scratch_arena_end();
+  return err;
+}
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef COORD_CODEC
+#define COORD_CODEC
+
+#include "geomserde.h"
+
+/* Compact encodings of the coordinate region of serialized geometries.
+ *
+ * Geometry type ids are smaller than 8, so the highest bit of the preamble
+ * byte is never set by the plain format. Non-collection geometries with
+ * encoded coordinates set that bit, and their coordinate region is replaced
+ * by an encoding block:
+ *
+ *   byte 0     encoding (CoordEncoding)
+ *   bytes 1-3  reserved, zero
+ *   bytes 4-7  int32 size of the payload following the block header, which
+ *              is a multiple of 8 so the structural integers stay aligned
+ *
+ * Payload of each encoding:
+ *
+ *   FLOAT32    float ordinates, rounded to nearest
+ *   QUANTIZED  double origin[dims], double step[dims], then int32 ordinates
+ *              holding round((value - origin) / step); INT32_MIN is NaN,
+ *              INT32_MIN + 1 and INT32_MAX are -inf and +inf
+ *   XOR        Gorilla-style bit stream of each ordinate XORed with the
+ *              previous ordinate of the same dimension, lossless
+ *
+ * All values are stored in native byte order, like the rest of the serialized
+ * format. Empty geometries and geometry collections are never flagged, child
+ * geometries of collections are encoded individually. read_geom_buf_header
+ * decodes encoded coordinates transparently. */
+
+#define COORD_ENCODED_FLAG 0x80
+
+typedef enum CoordEncoding {
+  COORD_ENCODING_NONE = 0,
+  COORD_ENCODING_FLOAT32 = 1,
+  COORD_ENCODING_QUANTIZED = 2,
+  COORD_ENCODING_XOR = 3
+} CoordEncoding;
+
+/**
+ * Encodes num_coords coordinates as an encoding block
+ *
+ * @param encoding encoding of the block, should not be COORD_ENCODING_NONE
+ * @param step quantization step of COORD_ENCODING_QUANTIZED, ignored by other
+ * encodings. The step is enlarged when the extent of the coordinates could
+ * not be covered by int32 values, 0 for the finest step possible
+ * @param coords coordinates to encode
+ * @param num_coords number of coordinates
+ * @param dims number of dimensions of each coordinate
+ * @param out buffer for writing the block into, NULL for computing the size
+ * only
+ * @param capacity size of out, SEDONA_BUFFER_TOO_SMALL will be returned if it
+ * is not large enough
+ * @param p_size OUTPUT parameter for receiving size of the block
+ * @return error code
+ */
+SedonaErrorCode coord_encode(CoordEncoding encoding, double step,
+                             const double *coords, int num_coords, int dims,
+                             char *out, int capacity, int *p_size);
+
+/**
+ * Decodes an encoding block
+ *
+ * @param buf buffer starting with the encoding block
+ * @param buf_size size of the buffer
+ * @param num_coords number of coordinates in the block
+ * @param dims number of dimensions of each coordinate
+ * @param coords OUTPUT buffer for num_coords * dims decoded ordinates, NULL
+ * for validating the block only
+ * @param p_bytes_read OUTPUT parameter for receiving size of the block
+ * @return error code
+ */
+SedonaErrorCode coord_decode(const char *buf, int buf_size, int num_coords,
+                             int dims, double *coords, int *p_bytes_read);
+
+/**
+ * Re-encodes coordinates of a serialized geometry, structural integers are
+ * copied as is. The input could be in any encoding, COORD_ENCODING_NONE
+ * converts it back to plain doubles.
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param encoding encoding of the output
+ * @param step quantization step, see coord_encode
+ * @param out buffer for writing the re-encoded geometry into, NULL for
+ * computing the size only
+ * @param capacity size of out, SEDONA_BUFFER_TOO_SMALL will be returned if it
+ * is not large enough
+ * @param p_size OUTPUT parameter for receiving size of the output
+ * @return error code
+ */
+SedonaErrorCode sedona_encode_coords(const char *buf, int buf_size,
+                                     CoordEncoding encoding, double step,
+                                     char *out, int capacity, int *p_size);
+
+/**
+ * Copies decoded coordinates of a non-collection serialized geometry, which
+ * has as many coordinates as the num_coords field of its header
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param coords OUTPUT buffer for num_coords * dims ordinates
+ * @return error code
+ */
+SedonaErrorCode sedona_read_coords(const char *buf, int buf_size,
+                                   double *coords);
+
+#endif /* COORD_CODEC */
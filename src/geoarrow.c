@@ -0,0 +1,1094 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "geoarrow.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "geom_buf.h"
+#include "scratch_arena.h"
+
+/* SRID is stored in 3 bytes of the serialized geometry */
+#define MAX_SRID 0xFFFFFF
+
+#define EXTENSION_NAME_KEY "ARROW:extension:name"
+#define EXTENSION_METADATA_KEY "ARROW:extension:metadata"
+
+/* Number of nested list levels of each geometry type */
+static const int type_num_levels[] = {0, 0, 1, 2, 1, 2, 3};
+
+static const char *const type_extension_names[] = {
+    NULL,
+    "geoarrow.point",
+    "geoarrow.linestring",
+    "geoarrow.polygon",
+    "geoarrow.multipoint",
+    "geoarrow.multilinestring",
+    "geoarrow.multipolygon"};
+
+/* Field names of the children of each list level, the last one is the name
+ * of the coordinate array */
+static const char *const type_child_names[][GEOARROW_MAX_LEVELS] = {
+    {NULL},
+    {NULL},
+    {"vertices"},
+    {"rings", "vertices"},
+    {"points"},
+    {"linestrings", "vertices"},
+    {"polygons", "rings", "vertices"}};
+
+static inline int is_multi_type(int geom_type) {
+  return geom_type >= MULTIPOINT && geom_type <= MULTIPOLYGON;
+}
+
+/* POINT, LINESTRING or POLYGON for single and multi geometry types */
+static inline int type_family(int geom_type) {
+  return is_multi_type(geom_type) ? geom_type - 3 : geom_type;
+}
+
+/* Serialized geometries to GeoArrow. The batch is walked twice using the same
+ * code path: the first walk counts the elements of each level, the second
+ * walk fills the offsets and coordinates into buffers allocated using those
+ * counts. */
+
+typedef struct GeoArrowBuilder {
+  int geom_type;
+  int num_levels;
+  int has_z;
+  int has_m;
+  int dims;
+  int interleaved;
+  /* lengths[i] is the number of elements of level i, lengths[num_levels] is
+   * the number of coordinates */
+  int64_t lengths[GEOARROW_MAX_LEVELS + 1];
+  /* Buffers are NULL when counting */
+  int32_t *offsets[GEOARROW_MAX_LEVELS];
+  double *coords[4];
+  unsigned char *validity;
+  int64_t null_count;
+} GeoArrowBuilder;
+
+static void builder_free_buffers(GeoArrowBuilder *b) {
+  for (int k = 0; k < GEOARROW_MAX_LEVELS; k++) {
+    free(b->offsets[k]);
+    b->offsets[k] = NULL;
+  }
+  for (int k = 0; k < 4; k++) {
+    free(b->coords[k]);
+    b->coords[k] = NULL;
+  }
+  free(b->validity);
+  b->validity = NULL;
+}
+
+/* Finish an element of the given level, whose children are all the elements
+ * of the next level appended since the previous element was finished */
+static inline void builder_end_element(GeoArrowBuilder *b, int level) {
+  int64_t k = ++b->lengths[level];
+  if (b->offsets[level] != NULL) {
+    b->offsets[level][k] = (int32_t)b->lengths[level + 1];
+  }
+}
+
+static void builder_append_coords(GeoArrowBuilder *b, const double *coords,
+                                  unsigned int num_coords,
+                                  const CoordinateSequenceInfo *cs_info) {
+  int64_t start = b->lengths[b->num_levels];
+  b->lengths[b->num_levels] += num_coords;
+  if (b->coords[0] == NULL) {
+    return;
+  }
+
+  int src_dims = cs_info->dims;
+  int dims = b->dims;
+  if (b->interleaved && src_dims == dims) {
+    memcpy(b->coords[0] + start * dims, coords,
+           (size_t)num_coords * dims * sizeof(double));
+    return;
+  }
+
+  /* Index of each output ordinate in the source coordinates, -1 for
+   * ordinates missing in the source */
+  int src_index[4] = {0, 1, -1, -1};
+  int d = 2;
+  if (b->has_z) {
+    src_index[d++] = cs_info->has_z ? 2 : -1;
+  }
+  if (b->has_m) {
+    src_index[d++] = cs_info->has_m ? 2 + cs_info->has_z : -1;
+  }
+  for (unsigned int i = 0; i < num_coords; i++) {
+    const double *src = coords + (size_t)i * src_dims;
+    for (d = 0; d < dims; d++) {
+      double value = NAN;
+      if (src_index[d] >= 0) {
+        memcpy(&value, src + src_index[d], sizeof(double));
+      }
+      if (b->interleaved) {
+        b->coords[0][(start + i) * dims + d] = value;
+      } else {
+        b->coords[d][start + i] = value;
+      }
+    }
+  }
+}
+
+static void builder_append_nan_coord(GeoArrowBuilder *b) {
+  int64_t k = b->lengths[b->num_levels]++;
+  if (b->coords[0] == NULL) {
+    return;
+  }
+  for (int d = 0; d < b->dims; d++) {
+    if (b->interleaved) {
+      b->coords[0][k * b->dims + d] = NAN;
+    } else {
+      b->coords[d][k] = NAN;
+    }
+  }
+}
+
+static void builder_append_empty(GeoArrowBuilder *b) {
+  if (b->geom_type == POINT) {
+    builder_append_nan_coord(b);
+  } else {
+    builder_end_element(b, 0);
+  }
+}
+
+/* Read the number of parts of a multi geometry, which may be omitted for
+ * empty geometries */
+static SedonaErrorCode read_num_parts(GeomBuffer *geom_buf, int *p_value) {
+  if (geom_buf->buf_int >= geom_buf->buf_int_end) {
+    *p_value = 0;
+    return SEDONA_SUCCESS;
+  }
+  return geom_buf_read_bounded_int(geom_buf, p_value);
+}
+
+/* Append a linear segment whose number of coordinates is read from the
+ * integer region as an element of the given level */
+static SedonaErrorCode append_linear_segment(
+    GeoArrowBuilder *b, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info, int level) {
+  int num_coords = 0;
+  const double *coords = NULL;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_coords);
+  if (err == SEDONA_SUCCESS) {
+    err = geom_buf_take_coords(geom_buf, cs_info, num_coords, &coords);
+  }
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  builder_append_coords(b, coords, num_coords, cs_info);
+  builder_end_element(b, level);
+  return SEDONA_SUCCESS;
+}
+
+/* Append a polygon as an element of the given level, its rings are
+ * elements of level + 1 */
+static SedonaErrorCode append_polygon(GeoArrowBuilder *b, GeomBuffer *geom_buf,
+                                      const CoordinateSequenceInfo *cs_info,
+                                      int level) {
+  int num_rings = 0;
+  SedonaErrorCode err = read_num_parts(geom_buf, &num_rings);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  for (int k = 0; k < num_rings; k++) {
+    err = append_linear_segment(b, geom_buf, cs_info, level + 1);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  builder_end_element(b, level);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode append_geom(GeoArrowBuilder *b, const char *buf,
+                                   int buf_size) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  /* Geometries not matching the type of the array were verified to be empty
+   * when determining the type of the array */
+  int target_type = b->geom_type;
+  if (geom_type_id == GEOMETRYCOLLECTION ||
+      type_family(geom_type_id) != type_family(target_type) ||
+      (is_multi_type(geom_type_id) && !is_multi_type(target_type))) {
+    builder_append_empty(b);
+    return SEDONA_SUCCESS;
+  }
+
+  const double *coords = NULL;
+  int num_parts = 0;
+  switch (geom_type_id) {
+    case POINT:
+      if (cs_info.num_coords == 0) {
+        if (target_type == POINT) {
+          builder_append_nan_coord(b);
+        } else {
+          builder_end_element(b, 0);
+        }
+        return SEDONA_SUCCESS;
+      }
+      err = geom_buf_take_coords(&geom_buf, &cs_info, 1, &coords);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      builder_append_coords(b, coords, 1, &cs_info);
+      if (target_type == MULTIPOINT) {
+        builder_end_element(b, 0);
+      }
+      return SEDONA_SUCCESS;
+    case LINESTRING:
+    case MULTIPOINT:
+      err = geom_buf_take_coords(&geom_buf, &cs_info, cs_info.num_coords,
+                                 &coords);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      builder_append_coords(b, coords, cs_info.num_coords, &cs_info);
+      if (target_type == MULTILINESTRING && cs_info.num_coords > 0) {
+        builder_end_element(b, 1);
+      }
+      builder_end_element(b, 0);
+      return SEDONA_SUCCESS;
+    case POLYGON:
+      if (target_type == POLYGON) {
+        return append_polygon(b, &geom_buf, &cs_info, 0);
+      }
+      if (cs_info.num_coords > 0) {
+        err = append_polygon(b, &geom_buf, &cs_info, 1);
+        if (err != SEDONA_SUCCESS) {
+          return err;
+        }
+      }
+      builder_end_element(b, 0);
+      return SEDONA_SUCCESS;
+    case MULTILINESTRING:
+    case MULTIPOLYGON:
+      if ((err = read_num_parts(&geom_buf, &num_parts)) != SEDONA_SUCCESS) {
+        return err;
+      }
+      for (int k = 0; k < num_parts; k++) {
+        if (geom_type_id == MULTILINESTRING) {
+          err = append_linear_segment(b, &geom_buf, &cs_info, 1);
+        } else {
+          err = append_polygon(b, &geom_buf, &cs_info, 1);
+        }
+        if (err != SEDONA_SUCCESS) {
+          return err;
+        }
+      }
+      builder_end_element(b, 0);
+      return SEDONA_SUCCESS;
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+}
+
+static SedonaErrorCode append_batch(GeoArrowBuilder *b,
+                                    const char *const *bufs,
+                                    const int *buf_sizes, int64_t num_geoms) {
+  memset(b->lengths, 0, sizeof(b->lengths));
+  for (int64_t k = 0; k < num_geoms; k++) {
+    if (bufs[k] == NULL) {
+      builder_append_empty(b);
+      continue;
+    }
+    /* Encoded coordinates are decoded into the scratch arena */
+    scratch_arena_begin();
+    SedonaErrorCode err = append_geom(b, bufs[k], buf_sizes[k]);
+    scratch_arena_end();
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Determine geometry type, dimensions and SRID of the exported array. Returns
+ * SEDONA_UNSUPPORTED_GEOM_TYPE when the geometries could not be represented
+ * by a single GeoArrow native type. */
+static SedonaErrorCode scan_batch(const char *const *bufs,
+                                  const int *buf_sizes, int64_t num_geoms,
+                                  GeoArrowBuilder *b, int *p_srid) {
+  int family = 0;
+  int has_multi = 0;
+  int srid = -1;
+  for (int64_t k = 0; k < num_geoms; k++) {
+    if (bufs[k] == NULL) {
+      b->null_count++;
+      continue;
+    }
+    SedonaGeometryInfo info;
+    SedonaErrorCode err =
+        sedona_get_geom_info(bufs[k], buf_sizes[k], 0, &info, NULL);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    b->has_z |= info.has_z;
+    b->has_m |= info.has_m;
+    if (srid == -1) {
+      srid = info.srid;
+    } else if (srid != info.srid) {
+      srid = 0;
+    }
+    if (info.is_empty) {
+      continue;
+    }
+    if (info.geom_type == GEOMETRYCOLLECTION) {
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    }
+    if (family == 0) {
+      family = type_family(info.geom_type);
+    } else if (family != type_family(info.geom_type)) {
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    }
+    has_multi |= is_multi_type(info.geom_type);
+  }
+
+  if (family == 0) {
+    family = POINT;
+  }
+  b->geom_type = has_multi ? family + 3 : family;
+  b->num_levels = type_num_levels[b->geom_type];
+  b->dims = 2 + b->has_z + b->has_m;
+  *p_srid = (srid > 0 ? srid : 0);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode alloc_builder_buffers(GeoArrowBuilder *b,
+                                             int64_t num_geoms) {
+  /* Offsets are 32-bit, arrays with too many elements are not supported */
+  for (int level = 1; level <= b->num_levels; level++) {
+    if (b->lengths[level] > INT32_MAX) {
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    }
+  }
+  for (int level = 0; level < b->num_levels; level++) {
+    b->offsets[level] = malloc((b->lengths[level] + 1) * sizeof(int32_t));
+    if (b->offsets[level] == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+    b->offsets[level][0] = 0;
+  }
+  int64_t num_coords = b->lengths[b->num_levels];
+  int num_arrays = b->interleaved ? 1 : b->dims;
+  size_t array_size = (size_t)num_coords * sizeof(double);
+  if (b->interleaved) {
+    array_size *= b->dims;
+  }
+  for (int d = 0; d < num_arrays; d++) {
+    /* malloc(0) may return NULL, which means counting for the builder */
+    b->coords[d] = malloc(array_size > 0 ? array_size : 1);
+    if (b->coords[d] == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+  }
+  if (b->null_count > 0) {
+    b->validity = calloc((num_geoms + 7) / 8, 1);
+    if (b->validity == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Arrow structs produced by the exporter own all their buffers and
+ * children, the pointer tables referenced by the structs are kept in the
+ * private data. */
+
+typedef struct ExportedArrayData {
+  const void *buffers[3];
+  struct ArrowArray *children[4];
+} ExportedArrayData;
+
+typedef struct ExportedSchemaData {
+  char *metadata;
+  struct ArrowSchema *children[4];
+} ExportedSchemaData;
+
+static void release_exported_array(struct ArrowArray *array) {
+  ExportedArrayData *data = array->private_data;
+  for (int64_t k = 0; k < array->n_children; k++) {
+    struct ArrowArray *child = data->children[k];
+    if (child != NULL) {
+      if (child->release != NULL) {
+        child->release(child);
+      }
+      free(child);
+    }
+  }
+  for (int64_t k = 0; k < array->n_buffers; k++) {
+    free((void *)data->buffers[k]);
+  }
+  free(data);
+  array->release = NULL;
+}
+
+static void release_exported_schema(struct ArrowSchema *schema) {
+  ExportedSchemaData *data = schema->private_data;
+  for (int64_t k = 0; k < schema->n_children; k++) {
+    struct ArrowSchema *child = data->children[k];
+    if (child != NULL) {
+      if (child->release != NULL) {
+        child->release(child);
+      }
+      free(child);
+    }
+  }
+  free(data->metadata);
+  free(data);
+  schema->release = NULL;
+}
+
+/* Initialize an array with uninitialized children. The array could be
+ * released even if its children were not initialized. */
+static SedonaErrorCode init_exported_array(struct ArrowArray *array,
+                                           int64_t length, int n_buffers,
+                                           int n_children) {
+  ExportedArrayData *data = calloc(1, sizeof(ExportedArrayData));
+  if (data == NULL) {
+    return SEDONA_ALLOC_ERROR;
+  }
+  memset(array, 0, sizeof(struct ArrowArray));
+  array->length = length;
+  array->n_buffers = n_buffers;
+  array->n_children = n_children;
+  array->buffers = data->buffers;
+  array->children = (n_children > 0 ? data->children : NULL);
+  array->release = release_exported_array;
+  array->private_data = data;
+  for (int k = 0; k < n_children; k++) {
+    data->children[k] = calloc(1, sizeof(struct ArrowArray));
+    if (data->children[k] == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode init_exported_schema(struct ArrowSchema *schema,
+                                            const char *format,
+                                            const char *name, int n_children) {
+  ExportedSchemaData *data = calloc(1, sizeof(ExportedSchemaData));
+  if (data == NULL) {
+    return SEDONA_ALLOC_ERROR;
+  }
+  memset(schema, 0, sizeof(struct ArrowSchema));
+  schema->format = format;
+  schema->name = name;
+  schema->flags = ARROW_FLAG_NULLABLE;
+  schema->n_children = n_children;
+  schema->children = (n_children > 0 ? data->children : NULL);
+  schema->release = release_exported_schema;
+  schema->private_data = data;
+  for (int k = 0; k < n_children; k++) {
+    data->children[k] = calloc(1, sizeof(struct ArrowSchema));
+    if (data->children[k] == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Move buffer into the array, which will be freed when releasing the array */
+static inline void move_buffer(struct ArrowArray *array, int index,
+                               void **p_buffer) {
+  ((ExportedArrayData *)array->private_data)->buffers[index] = *p_buffer;
+  *p_buffer = NULL;
+}
+
+static char *append_metadata_item(char *p, const char *key,
+                                  const char *value) {
+  int32_t key_len = (int32_t)strlen(key);
+  int32_t value_len = (int32_t)strlen(value);
+  memcpy(p, &key_len, 4);
+  memcpy(p + 4, key, key_len);
+  p += 4 + key_len;
+  memcpy(p, &value_len, 4);
+  memcpy(p + 4, value, value_len);
+  return p + 4 + value_len;
+}
+
+/* Encode extension name and metadata in the binary format of Arrow schema
+ * metadata: number of items, followed by length-prefixed keys and values */
+static char *build_extension_metadata(int geom_type, int srid) {
+  char ext_metadata[64];
+  if (srid != 0) {
+    snprintf(ext_metadata, sizeof(ext_metadata),
+             "{\"crs\":\"EPSG:%d\",\"crs_type\":\"authority_code\"}", srid);
+  } else {
+    snprintf(ext_metadata, sizeof(ext_metadata), "{}");
+  }
+  const char *ext_name = type_extension_names[geom_type];
+  size_t size = 4 + 8 + strlen(EXTENSION_NAME_KEY) + strlen(ext_name) + 8 +
+                strlen(EXTENSION_METADATA_KEY) + strlen(ext_metadata);
+  char *metadata = malloc(size);
+  if (metadata == NULL) {
+    return NULL;
+  }
+  int32_t num_items = 2;
+  memcpy(metadata, &num_items, 4);
+  char *p = append_metadata_item(metadata + 4, EXTENSION_NAME_KEY, ext_name);
+  append_metadata_item(p, EXTENSION_METADATA_KEY, ext_metadata);
+  return metadata;
+}
+
+static SedonaErrorCode export_coords(GeoArrowBuilder *b,
+                                     struct ArrowSchema *schema,
+                                     struct ArrowArray *array,
+                                     const char *name) {
+  static const char *const interleaved_formats[] = {NULL, NULL, "+w:2",
+                                                    "+w:3", "+w:4"};
+  static const char *const dim_names[] = {"x", "y", "z", "m"};
+  int64_t num_coords = b->lengths[b->num_levels];
+  SedonaErrorCode err;
+  if (b->interleaved) {
+    const char *child_name =
+        b->has_z ? (b->has_m ? "xyzm" : "xyz") : (b->has_m ? "xym" : "xy");
+    if ((err = init_exported_schema(schema, interleaved_formats[b->dims],
+                                    name, 1)) != SEDONA_SUCCESS ||
+        (err = init_exported_schema(schema->children[0], "g", child_name,
+                                    0)) != SEDONA_SUCCESS ||
+        (err = init_exported_array(array, num_coords, 1, 1)) !=
+            SEDONA_SUCCESS ||
+        (err = init_exported_array(array->children[0], num_coords * b->dims,
+                                   2, 0)) != SEDONA_SUCCESS) {
+      return err;
+    }
+    schema->children[0]->flags = 0;
+    move_buffer(array->children[0], 1, (void **)&b->coords[0]);
+    return SEDONA_SUCCESS;
+  }
+
+  if ((err = init_exported_schema(schema, "+s", name, b->dims)) !=
+          SEDONA_SUCCESS ||
+      (err = init_exported_array(array, num_coords, 1, b->dims)) !=
+          SEDONA_SUCCESS) {
+    return err;
+  }
+  int d = 0;
+  for (int k = 0; k < 4; k++) {
+    if ((k == 2 && !b->has_z) || (k == 3 && !b->has_m)) {
+      continue;
+    }
+    if ((err = init_exported_schema(schema->children[d], "g", dim_names[k],
+                                    0)) != SEDONA_SUCCESS ||
+        (err = init_exported_array(array->children[d], num_coords, 2, 0)) !=
+            SEDONA_SUCCESS) {
+      return err;
+    }
+    schema->children[d]->flags = 0;
+    move_buffer(array->children[d], 1, (void **)&b->coords[d]);
+    d++;
+  }
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode export_level(GeoArrowBuilder *b, int level,
+                                    struct ArrowSchema *schema,
+                                    struct ArrowArray *array,
+                                    const char *name) {
+  if (level == b->num_levels) {
+    return export_coords(b, schema, array, name);
+  }
+  SedonaErrorCode err;
+  if ((err = init_exported_schema(schema, "+l", name, 1)) != SEDONA_SUCCESS ||
+      (err = init_exported_array(array, b->lengths[level], 2, 1)) !=
+          SEDONA_SUCCESS) {
+    return err;
+  }
+  move_buffer(array, 1, (void **)&b->offsets[level]);
+  return export_level(b, level + 1, schema->children[0], array->children[0],
+                      type_child_names[b->geom_type][level]);
+}
+
+SedonaErrorCode sedona_export_geoarrow(const char *const *bufs,
+                                       const int *buf_sizes,
+                                       int64_t num_geoms, int interleaved,
+                                       struct ArrowSchema *schema,
+                                       struct ArrowArray *array) {
+  GeoArrowBuilder b;
+  memset(&b, 0, sizeof(b));
+  b.interleaved = interleaved;
+  schema->release = NULL;
+  array->release = NULL;
+
+  int srid = 0;
+  SedonaErrorCode err = scan_batch(bufs, buf_sizes, num_geoms, &b, &srid);
+  if (err != SEDONA_SUCCESS) {
+    goto fail;
+  }
+  if ((err = append_batch(&b, bufs, buf_sizes, num_geoms)) != SEDONA_SUCCESS ||
+      (err = alloc_builder_buffers(&b, num_geoms)) != SEDONA_SUCCESS) {
+    goto fail;
+  }
+  int64_t counted_lengths[GEOARROW_MAX_LEVELS + 1];
+  memcpy(counted_lengths, b.lengths, sizeof(counted_lengths));
+  if ((err = append_batch(&b, bufs, buf_sizes, num_geoms)) != SEDONA_SUCCESS) {
+    goto fail;
+  }
+  if (memcmp(counted_lengths, b.lengths, sizeof(counted_lengths)) != 0) {
+    err = SEDONA_INTERNAL_ERROR;
+    goto fail;
+  }
+  for (int64_t k = 0; k < num_geoms && b.validity != NULL; k++) {
+    if (bufs[k] != NULL) {
+      b.validity[k >> 3] |= (unsigned char)(1 << (k & 7));
+    }
+  }
+
+  if ((err = export_level(&b, 0, schema, array, "")) != SEDONA_SUCCESS) {
+    goto fail;
+  }
+  array->null_count = b.null_count;
+  move_buffer(array, 0, (void **)&b.validity);
+  ExportedSchemaData *schema_data = schema->private_data;
+  schema_data->metadata = build_extension_metadata(b.geom_type, srid);
+  if (schema_data->metadata == NULL) {
+    err = SEDONA_ALLOC_ERROR;
+    goto fail;
+  }
+  schema->metadata = schema_data->metadata;
+  return SEDONA_SUCCESS;
+
+fail:
+  builder_free_buffers(&b);
+  if (schema->release != NULL) {
+    schema->release(schema);
+  }
+  if (array->release != NULL) {
+    array->release(array);
+  }
+  return err;
+}
+
+/* GeoArrow to serialized geometries */
+
+static const char *find_metadata_value(const char *metadata, const char *key,
+                                       int32_t *p_value_len) {
+  if (metadata == NULL) {
+    return NULL;
+  }
+  int32_t num_items;
+  memcpy(&num_items, metadata, 4);
+  const char *p = metadata + 4;
+  size_t key_len = strlen(key);
+  for (int32_t k = 0; k < num_items; k++) {
+    int32_t item_key_len, value_len;
+    memcpy(&item_key_len, p, 4);
+    const char *item_key = p + 4;
+    p = item_key + item_key_len;
+    memcpy(&value_len, p, 4);
+    const char *value = p + 4;
+    p = value + value_len;
+    if ((size_t)item_key_len == key_len &&
+        memcmp(item_key, key, key_len) == 0) {
+      *p_value_len = value_len;
+      return value;
+    }
+  }
+  return NULL;
+}
+
+static int parse_geom_type(const char *metadata) {
+  int32_t len = 0;
+  const char *name = find_metadata_value(metadata, EXTENSION_NAME_KEY, &len);
+  if (name == NULL) {
+    return 0;
+  }
+  for (int type = POINT; type <= MULTIPOLYGON; type++) {
+    const char *ext_name = type_extension_names[type];
+    if ((size_t)len == strlen(ext_name) && memcmp(name, ext_name, len) == 0) {
+      return type;
+    }
+  }
+  return 0;
+}
+
+/* Only authority codes of EPSG are recognized, other CRSes are ignored */
+static int parse_srid(const char *metadata) {
+  int32_t len = 0;
+  const char *value =
+      find_metadata_value(metadata, EXTENSION_METADATA_KEY, &len);
+  if (value == NULL) {
+    return 0;
+  }
+  static const char prefix[] = "EPSG:";
+  static const char crs84[] = "OGC:CRS84";
+  const char *end = value + len;
+  for (const char *p = value; p < end; p++) {
+    if (end - p > (int)sizeof(crs84) - 1 &&
+        memcmp(p, crs84, sizeof(crs84) - 1) == 0) {
+      return 4326;
+    }
+    if (end - p <= (int)sizeof(prefix) - 1 ||
+        memcmp(p, prefix, sizeof(prefix) - 1) != 0) {
+      continue;
+    }
+    int srid = 0;
+    for (p += sizeof(prefix) - 1; p < end && *p >= '0' && *p <= '9'; p++) {
+      srid = srid * 10 + (*p - '0');
+      if (srid > MAX_SRID) {
+        return 0;
+      }
+    }
+    return srid;
+  }
+  return 0;
+}
+
+static SedonaErrorCode init_coords(GeoArrowReader *reader,
+                                   const struct ArrowSchema *schema,
+                                   const struct ArrowArray *array) {
+  const char *format = schema->format;
+  int64_t end = array->offset + array->length;
+  reader->num_coords = array->length;
+  if (strncmp(format, "+w:", 3) == 0) {
+    int dims = atoi(format + 3);
+    if (dims < 2 || dims > 4 || schema->n_children != 1 ||
+        array->n_children != 1 ||
+        strcmp(schema->children[0]->format, "g") != 0) {
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    }
+    const struct ArrowArray *child = array->children[0];
+    const char *name = schema->children[0]->name;
+    /* 3 dimensional coordinates are XYZ unless the child is named xym */
+    int is_xym = (dims == 3 && name != NULL && strcmp(name, "xym") == 0);
+    reader->has_z = (dims == 4 || (dims == 3 && !is_xym));
+    reader->has_m = (dims == 4 || is_xym);
+    reader->interleaved = 1;
+    if (child->n_buffers != 2 || child->length < end * dims) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    reader->coords[0] = child->buffers[1];
+    reader->coord_offsets[0] = child->offset + array->offset * dims;
+    reader->dims = dims;
+    return SEDONA_SUCCESS;
+  }
+
+  if (strcmp(format, "+s") != 0 || schema->n_children < 2 ||
+      schema->n_children > 4 || array->n_children != schema->n_children) {
+    return SEDONA_UNSUPPORTED_GEOM_TYPE;
+  }
+  for (int64_t d = 0; d < schema->n_children; d++) {
+    const struct ArrowSchema *child_schema = schema->children[d];
+    const struct ArrowArray *child = array->children[d];
+    const char *name = child_schema->name != NULL ? child_schema->name : "";
+    if (strcmp(child_schema->format, "g") != 0 ||
+        (d == 0 && strcmp(name, "x") != 0) ||
+        (d == 1 && strcmp(name, "y") != 0)) {
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    }
+    if (d >= 2) {
+      if (strcmp(name, "z") == 0 && d == 2) {
+        reader->has_z = 1;
+      } else if (strcmp(name, "m") == 0) {
+        reader->has_m = 1;
+      } else {
+        return SEDONA_UNSUPPORTED_GEOM_TYPE;
+      }
+    }
+    if (child->n_buffers != 2 || child->length < end) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    reader->coords[d] = child->buffers[1];
+    reader->coord_offsets[d] = child->offset + array->offset;
+  }
+  reader->dims = (int)schema->n_children;
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode geoarrow_reader_init(GeoArrowReader *reader,
+                                     const struct ArrowSchema *schema,
+                                     const struct ArrowArray *array,
+                                     int geom_type) {
+  memset(reader, 0, sizeof(GeoArrowReader));
+  if (geom_type == 0) {
+    geom_type = parse_geom_type(schema->metadata);
+  }
+  if (geom_type < POINT || geom_type > MULTIPOLYGON) {
+    return SEDONA_UNSUPPORTED_GEOM_TYPE;
+  }
+  reader->geom_type = geom_type;
+  reader->srid = parse_srid(schema->metadata);
+  reader->length = array->length;
+  reader->offset = array->offset;
+  if (array->n_buffers > 0 && array->null_count != 0) {
+    reader->validity = array->buffers[0];
+  }
+
+  reader->num_levels = type_num_levels[geom_type];
+  for (int level = 0; level < reader->num_levels; level++) {
+    GeoArrowLevel *l = &reader->levels[level];
+    if (strcmp(schema->format, "+l") == 0) {
+      l->offset_size = 4;
+    } else if (strcmp(schema->format, "+L") == 0) {
+      l->offset_size = 8;
+    } else {
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    }
+    if (schema->n_children != 1 || array->n_children != 1 ||
+        array->n_buffers != 2) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    l->offsets = array->buffers[1];
+    l->offset = array->offset;
+    if (l->offsets == NULL && array->length > 0) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    schema = schema->children[0];
+    array = array->children[0];
+    l->length = array->length;
+  }
+  return init_coords(reader, schema, array);
+}
+
+int geoarrow_reader_is_null(const GeoArrowReader *reader, int64_t k) {
+  if (reader->validity == NULL) {
+    return 0;
+  }
+  k += reader->offset;
+  return !(reader->validity[k >> 3] & (1 << (k & 7)));
+}
+
+static inline int64_t level_offset(const GeoArrowLevel *level, int64_t k) {
+  const char *p = (const char *)level->offsets;
+  k += level->offset;
+  if (level->offset_size == 4) {
+    int32_t value;
+    memcpy(&value, p + 4 * k, 4);
+    return value;
+  } else {
+    int64_t value;
+    memcpy(&value, p + 8 * k, 8);
+    return value;
+  }
+}
+
+/* Get range of children of the k-th element of a level */
+static SedonaErrorCode level_range(const GeoArrowLevel *level, int64_t k,
+                                   int64_t *p_begin, int64_t *p_end) {
+  int64_t begin = level_offset(level, k);
+  int64_t end = level_offset(level, k + 1);
+  if (begin < 0 || end < begin || end > level->length) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_begin = begin;
+  *p_end = end;
+  return SEDONA_SUCCESS;
+}
+
+/* Integers of serialized geometry are counted when geom_buf is NULL */
+typedef struct IntSink {
+  GeomBuffer *geom_buf;
+  int num_ints;
+} IntSink;
+
+static inline SedonaErrorCode sink_int(IntSink *sink, int64_t value) {
+  if (value > INT32_MAX) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  sink->num_ints++;
+  if (sink->geom_buf != NULL) {
+    return geom_buf_write_int(sink->geom_buf, (int)value);
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Write number of children and the size of each child for elements
+ * [begin, end) of a level. Each element of the multipolygon level is a
+ * polygon, which also writes the sizes of its rings. */
+static SedonaErrorCode sink_parts(const GeoArrowReader *reader, int level,
+                                  int64_t begin, int64_t end, IntSink *sink) {
+  SedonaErrorCode err = sink_int(sink, end - begin);
+  for (int64_t k = begin; k < end && err == SEDONA_SUCCESS; k++) {
+    int64_t child_begin, child_end;
+    err = level_range(&reader->levels[level], k, &child_begin, &child_end);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    if (level + 1 < reader->num_levels) {
+      err = sink_parts(reader, level + 1, child_begin, child_end, sink);
+    } else {
+      err = sink_int(sink, child_end - child_begin);
+    }
+  }
+  return err;
+}
+
+/* Get the range of coordinates and write the integers of the k-th geometry.
+ * Coordinates of a geometry are contiguous in the coordinate array. */
+static SedonaErrorCode read_structure(const GeoArrowReader *reader, int64_t k,
+                                      int64_t *p_coord_begin,
+                                      int64_t *p_coord_end, IntSink *sink) {
+  if (k < 0 || k >= reader->length) {
+    return SEDONA_INTERNAL_ERROR;
+  }
+  if (reader->num_levels == 0) {
+    *p_coord_begin = k;
+    *p_coord_end = k + 1;
+    return SEDONA_SUCCESS;
+  }
+
+  int64_t begin, end;
+  SedonaErrorCode err = level_range(&reader->levels[0], k, &begin, &end);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  int64_t parts_begin = begin;
+  int64_t parts_end = end;
+  for (int level = 1; level < reader->num_levels; level++) {
+    if (end > begin) {
+      int64_t unused;
+      if ((err = level_range(&reader->levels[level], begin, &begin,
+                             &unused)) != SEDONA_SUCCESS ||
+          (err = level_range(&reader->levels[level], end - 1, &unused,
+                             &end)) != SEDONA_SUCCESS) {
+        return err;
+      }
+    } else {
+      begin = end = 0;
+    }
+  }
+  *p_coord_begin = begin;
+  *p_coord_end = end;
+
+  switch (reader->geom_type) {
+    case POLYGON:
+      /* Empty polygons do not have any structural integer */
+      if (end == begin) {
+        return SEDONA_SUCCESS;
+      }
+      /* fall through */
+    case MULTILINESTRING:
+    case MULTIPOLYGON:
+      return sink_parts(reader, 1, parts_begin, parts_end, sink);
+    default:
+      return SEDONA_SUCCESS;
+  }
+}
+
+static int is_empty_point(const GeoArrowReader *reader, int64_t k) {
+  double x, y;
+  if (reader->interleaved) {
+    const double *coord =
+        reader->coords[0] + reader->coord_offsets[0] + k * reader->dims;
+    memcpy(&x, coord, sizeof(double));
+    memcpy(&y, coord + 1, sizeof(double));
+  } else {
+    memcpy(&x, reader->coords[0] + reader->coord_offsets[0] + k,
+           sizeof(double));
+    memcpy(&y, reader->coords[1] + reader->coord_offsets[1] + k,
+           sizeof(double));
+  }
+  return isnan(x) && isnan(y);
+}
+
+static SedonaErrorCode read_layout(const GeoArrowReader *reader, int64_t k,
+                                   int64_t *p_coord_begin,
+                                   int64_t *p_coord_end,
+                                   CoordinateSequenceInfo *cs_info,
+                                   int *p_num_ints, int *p_buf_size) {
+  IntSink counter = {NULL, 0};
+  SedonaErrorCode err =
+      read_structure(reader, k, p_coord_begin, p_coord_end, &counter);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (reader->geom_type == POINT && is_empty_point(reader, k)) {
+    *p_coord_end = *p_coord_begin;
+  }
+  int64_t num_coords = *p_coord_end - *p_coord_begin;
+  int64_t buf_size = 8 + num_coords * reader->dims * 8 +
+                     (int64_t)counter.num_ints * 4;
+  if (buf_size > INT32_MAX) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  coord_seq_info_init(cs_info, reader->has_z, reader->has_m, (int)num_coords);
+  *p_num_ints = counter.num_ints;
+  *p_buf_size = geom_buf_size(cs_info, counter.num_ints);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode geoarrow_reader_serialized_size(const GeoArrowReader *reader,
+                                                int64_t k, int *p_buf_size) {
+  int64_t coord_begin, coord_end;
+  CoordinateSequenceInfo cs_info;
+  int num_ints;
+  return read_layout(reader, k, &coord_begin, &coord_end, &cs_info, &num_ints,
+                     p_buf_size);
+}
+
+SedonaErrorCode geoarrow_reader_read(const GeoArrowReader *reader, int64_t k,
+                                     char *buf, int buf_capacity,
+                                     int *p_buf_size) {
+  int64_t coord_begin, coord_end;
+  CoordinateSequenceInfo cs_info;
+  int num_ints, buf_size;
+  SedonaErrorCode err = read_layout(reader, k, &coord_begin, &coord_end,
+                                    &cs_info, &num_ints, &buf_size);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (buf_size > buf_capacity) {
+    return SEDONA_BUFFER_TOO_SMALL;
+  }
+
+  GeomBuffer geom_buf;
+  geom_buf_init_with_buffer(&geom_buf, buf, reader->geom_type, reader->srid,
+                            &cs_info, num_ints);
+  int dims = reader->dims;
+  int64_t num_coords = coord_end - coord_begin;
+  if (reader->interleaved) {
+    memcpy(geom_buf.buf_coord,
+           reader->coords[0] + reader->coord_offsets[0] + coord_begin * dims,
+           (size_t)num_coords * dims * sizeof(double));
+  } else {
+    for (int d = 0; d < dims; d++) {
+      const double *src =
+          reader->coords[d] + reader->coord_offsets[d] + coord_begin;
+      double *dst = geom_buf.buf_coord + d;
+      for (int64_t i = 0; i < num_coords; i++) {
+        dst[i * dims] = src[i];
+      }
+    }
+  }
+  geom_buf.buf_coord += num_coords * dims;
+
+  IntSink writer = {&geom_buf, 0};
+  err = read_structure(reader, k, &coord_begin, &coord_end, &writer);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  *p_buf_size = buf_size;
+  return SEDONA_SUCCESS;
+}
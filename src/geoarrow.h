@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GEOARROW
+#define GEOARROW
+
+#include <stdint.h>
+
+#include "arrow/abi.h"
+#include "geomserde.h"
+
+/* Conversion between serialized geometries and GeoArrow native arrays
+ * (https://geoarrow.org/format.html) exchanged through the Arrow C data
+ * interface. Only arrays with a single geometry type are supported by the
+ * GeoArrow native encoding, so geometry collections could not be exported.
+ * Lists are exported with 32-bit offsets, both 32-bit and 64-bit offsets are
+ * accepted when importing. */
+
+/* Max number of nested list levels, multipolygons have 3 levels */
+#define GEOARROW_MAX_LEVELS 3
+
+/**
+ * Exports a batch of serialized geometries as a GeoArrow native array. The
+ * geometry type of the array is the common type of all non-empty geometries,
+ * single geometries are promoted to multi geometries when they are mixed
+ * with multi geometries of the same family. Empty geometries and empty
+ * geometry collections are exported as empty geometries of that type, empty
+ * points are exported as points with NaN coordinates. The array has Z or M
+ * dimension when any of the geometries has them, missing ordinates are
+ * filled with NaN. The CRS is recorded in the extension metadata when all
+ * geometries have the same non-zero SRID.
+ *
+ * @param bufs serialized geometries, NULL for null geometries
+ * @param buf_sizes sizes of serialized geometries
+ * @param num_geoms number of geometries
+ * @param interleaved whether to export coordinates as a fixed size list
+ * (xyxyxy...) or as a struct of coordinate arrays (xxx..., yyy...)
+ * @param schema OUTPUT parameter for receiving the schema of the array,
+ * released by calling schema->release
+ * @param array OUTPUT parameter for receiving the array, released by calling
+ * array->release
+ * @return error code
+ */
+SedonaErrorCode sedona_export_geoarrow(const char *const *bufs,
+                                       const int *buf_sizes,
+                                       int64_t num_geoms, int interleaved,
+                                       struct ArrowSchema *schema,
+                                       struct ArrowArray *array);
+
+/* Offsets of a level of nested lists */
+typedef struct GeoArrowLevel {
+  const void *offsets;
+  int offset_size; /* 4 for lists, 8 for large lists */
+  int64_t offset;  /* offset of the list array */
+  int64_t length;  /* length of the child array */
+} GeoArrowLevel;
+
+/**
+ * Reader of a GeoArrow native array. The reader only holds pointers to the
+ * buffers of the array, which should outlive the reader.
+ */
+typedef struct GeoArrowReader {
+  int geom_type; /* POINT, LINESTRING, ..., MULTIPOLYGON */
+  int srid;
+  int has_z;
+  int has_m;
+  int dims;
+  int64_t length;
+  int64_t offset;
+  const unsigned char *validity;
+  int num_levels;
+  GeoArrowLevel levels[GEOARROW_MAX_LEVELS];
+  /* Coordinates, coords[0] is the only array for interleaved coordinates,
+   * otherwise coords[d] is the array of the d-th dimension */
+  int interleaved;
+  const double *coords[4];
+  int64_t coord_offsets[4];
+  int64_t num_coords;
+} GeoArrowReader;
+
+/**
+ * Initializes a reader of GeoArrow native array. The geometry type is
+ * derived from the ARROW:extension:name metadata of the schema, unless it is
+ * overridden by geom_type. Both interleaved and separated coordinates are
+ * supported. The SRID is derived from "EPSG:<code>" CRS in the extension
+ * metadata.
+ *
+ * @param reader the reader to initialize
+ * @param schema schema of the array
+ * @param array the array to read
+ * @param geom_type geometry type of the array (POINT, LINESTRING, ...,
+ * MULTIPOLYGON), 0 for detecting it from the schema
+ * @return error code
+ */
+SedonaErrorCode geoarrow_reader_init(GeoArrowReader *reader,
+                                     const struct ArrowSchema *schema,
+                                     const struct ArrowArray *array,
+                                     int geom_type);
+
+/**
+ * Checks whether the k-th geometry of the array is null
+ */
+int geoarrow_reader_is_null(const GeoArrowReader *reader, int64_t k);
+
+/**
+ * Computes the size of the serialized form of the k-th geometry
+ *
+ * @param reader the reader
+ * @param k index of the geometry
+ * @param p_buf_size OUTPUT parameter for receiving size of the serialized
+ * geometry
+ * @return error code
+ */
+SedonaErrorCode geoarrow_reader_serialized_size(const GeoArrowReader *reader,
+                                                int64_t k, int *p_buf_size);
+
+/**
+ * Writes the serialized form of the k-th geometry into buf
+ *
+ * @param reader the reader
+ * @param k index of the geometry
+ * @param buf buffer for writing the serialized geometry into
+ * @param buf_capacity size of buf, SEDONA_BUFFER_TOO_SMALL will be returned
+ * if it is not large enough
+ * @param p_buf_size OUTPUT parameter for receiving number of bytes written
+ * @return error code
+ */
+SedonaErrorCode geoarrow_reader_read(const GeoArrowReader *reader, int64_t k,
+                                     char *buf, int buf_capacity,
+                                     int *p_buf_size);
+
+#endif /* GEOARROW */
@@ -19,10 +19,17 @@
 
 #include "geom_buf.h"
 
+#include <stdint.h>
 #include <string.h>
 
+#include "coord_codec.h"
 #include "geomserde.h"
 #include "geos_c_dyn.h"
+#include "scratch_arena.h"
+#include "serde_alloc.h"
+#include "sedona_probes.h"
+#include "sedona_thread.h"
+#include "serde_stats.h"
 
 static CoordinateType coordinate_type_of(int has_z, int has_m) {
   if (has_z && has_m) {
@@ -49,6 +56,19 @@ static unsigned int get_bytes_per_coordinate(CoordinateType coord_type) {
   }
 }
 
+void coord_seq_info_init(CoordinateSequenceInfo *cs_info, int has_z,
+                         int has_m, int num_coords) {
+  CoordinateType coord_type = coordinate_type_of(has_z, has_m);
+  unsigned int bytes_per_coord = get_bytes_per_coordinate(coord_type);
+  cs_info->dims = bytes_per_coord / 8;
+  cs_info->has_z = has_z;
+  cs_info->has_m = has_m;
+  cs_info->coord_type = coord_type;
+  cs_info->bytes_per_coord = bytes_per_coord;
+  cs_info->num_coords = num_coords;
+  cs_info->total_bytes = bytes_per_coord * num_coords;
+}
+
 SedonaErrorCode get_coord_seq_info_from_geom(
     GEOSContextHandle_t handle, const GEOSGeometry *geom,
     CoordinateSequenceInfo *coord_seq_info) {
@@ -75,29 +95,73 @@ SedonaErrorCode get_coord_seq_info_from_geom(
   return SEDONA_SUCCESS;
 }
 
+void write_buffer_header(void *buf, GeometryTypeId geom_type_id,
+                         CoordinateType coord_type, int srid, int num_coords) {
+  unsigned char *header = buf;
+  int *buf_int = (int *)buf;
+  int has_srid = (srid != 0) ? 1 : 0;
+  unsigned char preamble_byte =
+      (geom_type_id << 4) | (coord_type << 1) | has_srid;
+  header[0] = preamble_byte;
+  header[1] = srid >> 16;
+  header[2] = srid >> 8;
+  header[3] = srid;
+  buf_int[1] = num_coords;
+}
+
 void *alloc_buffer_for_geom(GeometryTypeId geom_type_id,
                             CoordinateType coord_type, int srid, int buf_size,
                             int num_coords) {
-  unsigned char *buf = malloc(buf_size);
-  int *buf_int = (int *)buf;
+  unsigned char *buf = serde_malloc(buf_size);
   if (buf == NULL) {
     return buf;
   }
-  int has_srid = (srid != 0) ? 1 : 0;
-  unsigned char preamble_byte =
-      (geom_type_id << 4) | (coord_type << 1) | has_srid;
-  buf[0] = preamble_byte;
-  buf[1] = srid >> 16;
-  buf[2] = srid >> 8;
-  buf[3] = srid;
-  buf_int[1] = num_coords;
+  write_buffer_header(buf, geom_type_id, coord_type, srid, num_coords);
   return buf;
 }
 
+/* Read by worker threads not holding the GIL, so they are accessed
+ * atomically */
+static void *volatile host_coord_seq_from_buffer;
+static volatile long coord_copy_path = COORD_COPY_AUTO;
+
+static CoordSeqFromBufferFunc get_host_coord_seq_from_buffer(void) {
+  return (CoordSeqFromBufferFunc)sedona_atomic_load_ptr(
+      &host_coord_seq_from_buffer);
+}
+
+void geom_buf_set_coord_seq_from_buffer(CoordSeqFromBufferFunc func) {
+  sedona_atomic_store_ptr(&host_coord_seq_from_buffer, (void *)func);
+}
+
+int geom_buf_coord_copy_path_available(CoordCopyPath path) {
+  switch (path) {
+    case COORD_COPY_AUTO:
+    case COORD_COPY_LOOP:
+      return 1;
+    case COORD_COPY_GEOS_BUFFER:
+      return dyn_GEOSCoordSeq_copyFromBuffer_r != NULL &&
+             dyn_GEOSCoordSeq_copyToBuffer_r != NULL;
+    case COORD_COPY_HOST_BUFFER:
+      return get_host_coord_seq_from_buffer() != NULL;
+    default:
+      return 0;
+  }
+}
+
+CoordCopyPath geom_buf_set_coord_copy_path(CoordCopyPath path) {
+  CoordCopyPath prev_path =
+      (CoordCopyPath)sedona_atomic_load_32(&coord_copy_path);
+  sedona_atomic_store_32(&coord_copy_path, path);
+  return prev_path;
+}
+
 static SedonaErrorCode copy_coord_seq_to_buffer(
     GEOSContextHandle_t handle, const GEOSCoordSequence *coord_seq, double *buf,
     int num_coords, int has_z, int has_m) {
-  if (dyn_GEOSCoordSeq_copyToBuffer_r != NULL) {
+  CoordCopyPath path = (CoordCopyPath)sedona_atomic_load_32(&coord_copy_path);
+  if (dyn_GEOSCoordSeq_copyToBuffer_r != NULL &&
+      (path == COORD_COPY_AUTO || path == COORD_COPY_GEOS_BUFFER)) {
     /* fast path for libgeos >= 3.10.0 */
     if (dyn_GEOSCoordSeq_copyToBuffer_r(handle, coord_seq, buf, has_z, has_m) ==
         0) {
@@ -107,6 +171,8 @@ static SedonaErrorCode copy_coord_seq_to_buffer(
   }
 
   /* slow path for old libgeos */
+  SERDE_STATS_ADD(slow_path_serialize, 1);
+  SEDONA_PROBE2(serialize__slow_path, num_coords, 2 + has_z + has_m);
   for (int k = 0; k < num_coords; k++) {
     if (has_z) {
       double x, y, z;
@@ -136,7 +202,9 @@ static SedonaErrorCode copy_coord_seq_to_buffer(
 static SedonaErrorCode copy_buffer_to_coord_seq(
     GEOSContextHandle_t handle, double *buf, int num_coords, int has_z,
     int has_m, GEOSCoordSequence **p_coord_seq) {
-  if (dyn_GEOSCoordSeq_copyFromBuffer_r != NULL) {
+  CoordCopyPath path = (CoordCopyPath)sedona_atomic_load_32(&coord_copy_path);
+  if (dyn_GEOSCoordSeq_copyFromBuffer_r != NULL &&
+      (path == COORD_COPY_AUTO || path == COORD_COPY_GEOS_BUFFER)) {
     /* fast path for libgeos >= 3.10.0 */
     GEOSCoordSequence *coord_seq = dyn_GEOSCoordSeq_copyFromBuffer_r(
         handle, buf, num_coords, has_z, has_m);
@@ -147,7 +215,22 @@ static SedonaErrorCode copy_buffer_to_coord_seq(
     return SEDONA_SUCCESS;
   }
 
+  CoordSeqFromBufferFunc host_copy = get_host_coord_seq_from_buffer();
+  if (host_copy != NULL && !has_m &&
+      (path == COORD_COPY_AUTO || path == COORD_COPY_HOST_BUFFER)) {
+    /* bulk copy provided by the host, e.g. shapely linked with old libgeos */
+    GEOSCoordSequence *coord_seq =
+        host_copy(handle, buf, num_coords, 2 + has_z);
+    if (coord_seq == NULL) {
+      return SEDONA_GEOS_ERROR;
+    }
+    *p_coord_seq = coord_seq;
+    return SEDONA_SUCCESS;
+  }
+
   /* slow path for old libgeos */
+  SERDE_STATS_ADD(slow_path_deserialize, 1);
+  SEDONA_PROBE2(deserialize__slow_path, num_coords, 2 + has_z + has_m);
   GEOSCoordSequence *coord_seq =
       dyn_GEOSCoordSeq_create_r(handle, num_coords, 2 + has_z + has_m);
   if (coord_seq == NULL) {
@@ -192,19 +275,31 @@ static void geom_buf_init(GeomBuffer *geom_buf, void *buf,
   geom_buf->buf_int_end = geom_buf->buf_int + num_ints;
 }
 
-SedonaErrorCode geom_buf_alloc(GeomBuffer *geom_buf,
+int geom_buf_size(const CoordinateSequenceInfo *cs_info, int num_ints) {
+  return 8 + cs_info->num_coords * cs_info->bytes_per_coord + 4 * num_ints;
+}
+
+void geom_buf_init_with_buffer(GeomBuffer *geom_buf, void *buf,
                                GeometryTypeId geom_type_id, int srid,
                                const CoordinateSequenceInfo *cs_info,
                                int num_ints) {
   int num_coords = cs_info->num_coords;
-  int bytes_per_coord = cs_info->bytes_per_coord;
-  int buf_size = 8 + num_coords * bytes_per_coord + 4 * num_ints;
-  void *buf = alloc_buffer_for_geom(geom_type_id, cs_info->coord_type, srid,
-                                    buf_size, num_coords);
+  write_buffer_header(buf, geom_type_id, cs_info->coord_type, srid,
+                      num_coords);
+  geom_buf_init(geom_buf, buf, cs_info, num_coords, num_ints);
+}
+
+SedonaErrorCode geom_buf_alloc(GeomBuffer *geom_buf,
+                               GeometryTypeId geom_type_id, int srid,
+                               const CoordinateSequenceInfo *cs_info,
+                               int num_ints) {
+  int buf_size = geom_buf_size(cs_info, num_ints);
+  void *buf = serde_malloc(buf_size);
   if (buf == NULL) {
     return SEDONA_ALLOC_ERROR;
   }
-  geom_buf_init(geom_buf, buf, cs_info, num_coords, num_ints);
+  geom_buf_init_with_buffer(geom_buf, buf, geom_type_id, srid, cs_info,
+                            num_ints);
   return SEDONA_SUCCESS;
 }
 
@@ -216,32 +311,40 @@ SedonaErrorCode read_geom_buf_header(const char *buf, int buf_size,
   if (buf_size < 8) {
     return SEDONA_INCOMPLETE_BUFFER;
   }
-  unsigned int preamble = (unsigned int)buf[0];
+  const unsigned char *header = (const unsigned char *)buf;
+  unsigned int preamble = header[0];
   int srid = 0;
-  int geom_type_id = preamble >> 4;
+  int is_encoded = ((preamble & COORD_ENCODED_FLAG) != 0);
+  int geom_type_id = (preamble & 0x7F) >> 4;
   int coord_type = (preamble & 0x0F) >> 1;
   if ((preamble & 0x01) != 0) {
-    srid = (((unsigned int)buf[1]) << 16) | (((unsigned int)buf[2]) << 8) |
-           ((unsigned int)buf[3]);
+    srid = (((unsigned int)header[1]) << 16) |
+           (((unsigned int)header[2]) << 8) | ((unsigned int)header[3]);
   }
   int num_coords = ((int *)buf)[1];
   if (geom_type_id < 0 || geom_type_id > GEOMETRYCOLLECTION) {
     return SEDONA_UNKNOWN_GEOM_TYPE;
   }
-  if (coord_type < 0 || coord_type > XYZM) {
+  if (coord_type < XY || coord_type > XYZM) {
     return SEDONA_UNKNOWN_COORD_TYPE;
   }
-  if (num_coords < 0 || num_coords > buf_size) {
+  int bytes_per_coord = get_bytes_per_coordinate(coord_type);
+  int dims = bytes_per_coord / 8;
+  /* Encoded ordinates take at least 1 bit each */
+  if (num_coords < 0 ||
+      (is_encoded ? (int64_t)num_coords * dims > (int64_t)buf_size * 8
+                  : num_coords > buf_size)) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  if (is_encoded && geom_type_id == GEOMETRYCOLLECTION) {
     return SEDONA_BAD_GEOM_BUFFER;
   }
 
-  int bytes_per_coord = get_bytes_per_coordinate(coord_type);
   if (geom_type_id != GEOMETRYCOLLECTION) {
-    if (8 + num_coords * bytes_per_coord > buf_size) {
+    if (!is_encoded && 8 + num_coords * bytes_per_coord > buf_size) {
       return SEDONA_INCOMPLETE_BUFFER;
     }
 
-    int dims = bytes_per_coord / 8;
     int has_z = ((coord_type == XYZ || coord_type == XYZM) ? 1 : 0);
     int has_m = ((coord_type == XYM || coord_type == XYZM) ? 1 : 0);
     cs_info->bytes_per_coord = bytes_per_coord;
@@ -252,11 +355,36 @@ SedonaErrorCode read_geom_buf_header(const char *buf, int buf_size,
     cs_info->has_m = has_m;
 
     geom_buf->buf = (void *)buf;
-    geom_buf->buf_coord = (double *)(buf + 8);
-    geom_buf->buf_coord_end = geom_buf->buf_coord + num_coords * dims;
-    geom_buf->buf_int = (int *)geom_buf->buf_coord_end;
-    geom_buf->buf_int_end = (int *)(buf + buf_size);
     geom_buf->buf_size = buf_size;
+    /* Structural integers start at a multiple of 4 bytes, a trailing partial
+     * integer of a truncated buffer should not be read */
+    geom_buf->buf_int_end = (int *)(buf + (buf_size & ~3));
+    if (!is_encoded) {
+      geom_buf->buf_coord = (double *)(buf + 8);
+      geom_buf->buf_coord_end = geom_buf->buf_coord + num_coords * dims;
+      geom_buf->buf_int = (int *)geom_buf->buf_coord_end;
+    } else {
+      /* Decode coordinates into the scratch arena, callers should be in a
+       * scratch scope. Counts of coordinates in the structural integers are
+       * bounded by num_coords instead of buf_size. */
+      double *coords = scratch_arena_calloc((size_t)num_coords * dims,
+                                            sizeof(double));
+      if (coords == NULL) {
+        return SEDONA_ALLOC_ERROR;
+      }
+      int block_size = 0;
+      SedonaErrorCode err = coord_decode(buf + 8, buf_size - 8, num_coords,
+                                         dims, coords, &block_size);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      geom_buf->buf_coord = coords;
+      geom_buf->buf_coord_end = coords + (size_t)num_coords * dims;
+      geom_buf->buf_int = (int *)(buf + 8 + block_size);
+      if (num_coords > buf_size) {
+        geom_buf->buf_size = num_coords;
+      }
+    }
   } else {
     /* num_coords for GeometryCollection is number of geometries in the
      * collection, other fields in cs_info are unused. */
@@ -298,6 +426,19 @@ SedonaErrorCode geom_buf_read_bounded_int(GeomBuffer *geom_buf, int *p_value) {
   return SEDONA_SUCCESS;
 }
 
+SedonaErrorCode geom_buf_take_coords(GeomBuffer *geom_buf,
+                                     const CoordinateSequenceInfo *cs_info,
+                                     unsigned int num_coords,
+                                     const double **p_coords) {
+  if ((size_t)(geom_buf->buf_coord_end - geom_buf->buf_coord) / cs_info->dims <
+      num_coords) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  *p_coords = geom_buf->buf_coord;
+  geom_buf->buf_coord += num_coords * cs_info->dims;
+  return SEDONA_SUCCESS;
+}
+
 SedonaErrorCode geom_buf_write_coords(GeomBuffer *geom_buf,
                                       GEOSContextHandle_t handle,
                                       const GEOSCoordSequence *coord_seq,
@@ -310,11 +451,14 @@ SedonaErrorCode geom_buf_write_coords(GeomBuffer *geom_buf,
   if (geom_buf->buf_coord + num_doubles > geom_buf->buf_coord_end) {
     return SEDONA_INTERNAL_ERROR;
   }
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_COORD_COPY);
   SedonaErrorCode err = copy_coord_seq_to_buffer(
       handle, coord_seq, geom_buf->buf_coord, cs_info->num_coords, cs_info->has_z, cs_info->has_m);
   if (err != SEDONA_SUCCESS) {
     return err;
   }
+  serde_stats_timer_end(SERDE_STAGE_COORD_COPY, timer);
+  SERDE_STATS_ADD(serialized_coords, num_coords);
   geom_buf->buf_coord += num_doubles;
   return SEDONA_SUCCESS;
 }
@@ -329,12 +473,15 @@ SedonaErrorCode geom_buf_read_coords(GeomBuffer *geom_buf,
   if (geom_buf->buf_coord + num_ordinates > geom_buf->buf_coord_end) {
     return SEDONA_INCOMPLETE_BUFFER;
   }
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_COORD_COPY);
   int err =
       copy_buffer_to_coord_seq(handle, geom_buf->buf_coord, num_coords,
                                cs_info->has_z, cs_info->has_m, p_coord_seq);
   if (err != SEDONA_SUCCESS) {
     return err;
   }
+  serde_stats_timer_end(SERDE_STAGE_COORD_COPY, timer);
+  SERDE_STATS_ADD(deserialized_coords, num_coords);
   geom_buf->buf_coord += num_ordinates;
   return SEDONA_SUCCESS;
 }
@@ -381,6 +528,7 @@ SedonaErrorCode geom_buf_read_linear_segment(GeomBuffer *geom_buf,
   }
 
   GEOSGeometry *segment = NULL;
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   switch (type) {
     case GEOS_LINESTRING:
       segment = dyn_GEOSGeom_createLineString_r(handle, coord_seq);
@@ -392,10 +540,11 @@ SedonaErrorCode geom_buf_read_linear_segment(GeomBuffer *geom_buf,
       return SEDONA_INTERNAL_ERROR;
   }
 
+  /* GEOS takes ownership of coord_seq even if the construction failed */
   if (segment == NULL) {
-    dyn_GEOSCoordSeq_destroy_r(handle, coord_seq);
     return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
   *p_geom = segment;
   return SEDONA_SUCCESS;
@@ -472,7 +621,8 @@ SedonaErrorCode geom_buf_read_polygon(GeomBuffer *geom_buf,
     return SEDONA_SUCCESS;
   }
 
-  GEOSGeometry **rings = calloc(num_rings, sizeof(GEOSGeometry *));
+  GEOSGeometry **rings =
+      scratch_arena_calloc(num_rings, sizeof(GEOSGeometry *));
   if (rings == NULL) {
     return SEDONA_ALLOC_ERROR;
   }
@@ -486,14 +636,16 @@ SedonaErrorCode geom_buf_read_polygon(GeomBuffer *geom_buf,
     rings[k] = ring;
   }
 
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   GEOSGeometry *geom =
       dyn_GEOSGeom_createPolygon_r(handle, rings[0], &rings[1], num_rings - 1);
   if (geom == NULL) {
-    err = SEDONA_GEOS_ERROR;
-    goto handle_error;
+    /* GEOS took ownership of the rings before failing, e.g. when the shell
+     * is empty but holes are not */
+    return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
-  free(rings);
   *p_geom = geom;
   return SEDONA_SUCCESS;
 
@@ -509,5 +661,4 @@ void destroy_geometry_array(GEOSContextHandle_t handle, GEOSGeometry **geoms,
       dyn_GEOSGeom_destroy_r(handle, geoms[k]);
     }
   }
-  free(geoms);
 }
@@ -77,14 +77,32 @@ typedef struct GeomBuffer {
   int *buf_int_end;
 } GeomBuffer;
 
+/* Initialize cs_info for num_coords coordinates with given dimensions */
+void coord_seq_info_init(CoordinateSequenceInfo *cs_info, int has_z,
+                         int has_m, int num_coords);
+
 SedonaErrorCode get_coord_seq_info_from_geom(
     GEOSContextHandle_t handle, const GEOSGeometry *geom,
     CoordinateSequenceInfo *coord_seq_info);
 
+void write_buffer_header(void *buf, GeometryTypeId geom_type_id,
+                         CoordinateType coord_type, int srid, int num_coords);
+
 void *alloc_buffer_for_geom(GeometryTypeId geom_type_id,
                             CoordinateType coord_type, int srid, int buf_size,
                             int num_coords);
 
+/* Size of serialized buffer holding cs_info->num_coords coordinates and
+ * num_ints integers */
+int geom_buf_size(const CoordinateSequenceInfo *cs_info, int num_ints);
+
+/* Initialize geom_buf for writing into caller provided buffer, buf should
+ * have at least geom_buf_size(cs_info, num_ints) bytes. */
+void geom_buf_init_with_buffer(GeomBuffer *geom_buf, void *buf,
+                               GeometryTypeId geom_type_id, int srid,
+                               const CoordinateSequenceInfo *cs_info,
+                               int num_ints);
+
 SedonaErrorCode geom_buf_alloc(GeomBuffer *geom_buf,
                                GeometryTypeId geom_type_id, int srid,
                                const CoordinateSequenceInfo *cs_info,
@@ -99,6 +117,47 @@ SedonaErrorCode read_geom_buf_header(const char *buf, int buf_size,
 SedonaErrorCode geom_buf_write_int(GeomBuffer *geom_buf, int value);
 SedonaErrorCode geom_buf_read_bounded_int(GeomBuffer *geom_buf, int *p_value);
 
+/* Take num_coords coordinates from the coordinate region without copying
+ * them, used by transcoders that do not construct GEOS geometries */
+SedonaErrorCode geom_buf_take_coords(GeomBuffer *geom_buf,
+                                     const CoordinateSequenceInfo *cs_info,
+                                     unsigned int num_coords,
+                                     const double **p_coords);
+
+/*
+ * Ways of copying coordinates between serialized buffers and GEOS coordinate
+ * sequences, from the fastest to the slowest. COORD_COPY_AUTO picks the
+ * fastest one available, the others are for testing and benchmarking.
+ */
+typedef enum CoordCopyPath {
+  COORD_COPY_AUTO,
+  /* GEOSCoordSeq_copyFromBuffer_r/copyToBuffer_r of libgeos >= 3.10.0 */
+  COORD_COPY_GEOS_BUFFER,
+  /* Coordinate sequence constructor registered by the host, only used for
+   * deserializing XY and XYZ coordinates */
+  COORD_COPY_HOST_BUFFER,
+  /* Per-coordinate getters and setters */
+  COORD_COPY_LOOP
+} CoordCopyPath;
+
+/* Creates a coordinate sequence of size coordinates with dims (2 or 3)
+ * interleaved ordinates, returns NULL on failure */
+typedef GEOSCoordSequence *(*CoordSeqFromBufferFunc)(GEOSContextHandle_t handle,
+                                                      const double *buf,
+                                                      unsigned int size,
+                                                      unsigned int dims);
+
+/* Register a bulk coordinate sequence constructor for libgeos without
+ * GEOSCoordSeq_copyFromBuffer_r, NULL to unregister */
+void geom_buf_set_coord_seq_from_buffer(CoordSeqFromBufferFunc func);
+
+/* Returns 0 if the path is not available */
+int geom_buf_coord_copy_path_available(CoordCopyPath path);
+
+/* Caller should check that the path is available, returns the previous
+ * path */
+CoordCopyPath geom_buf_set_coord_copy_path(CoordCopyPath path);
+
 SedonaErrorCode geom_buf_write_coords(GeomBuffer *geom_buf,
                                       GEOSContextHandle_t handle,
                                       const GEOSCoordSequence *coord_seq,
@@ -129,18 +188,9 @@ SedonaErrorCode geom_buf_read_polygon(GeomBuffer *geom_buf,
                                       CoordinateSequenceInfo *cs_info,
                                       GEOSGeometry **p_geom);
 
+/* Destroy non-NULL geometries in geoms. The array itself is allocated from
+ * the scratch arena, so it is not freed by this function. */
 void destroy_geometry_array(GEOSContextHandle_t handle, GEOSGeometry **geoms,
                             int num_geoms);
 
-#define RETURN_BUFFER_FOR_EMPTY_GEOM(geom_type_id, coord_type, srid)         \
-  do {                                                                       \
-    void *buf = alloc_buffer_for_geom(geom_type_id, coord_type, srid, 8, 0); \
-    if (buf == NULL) {                                                       \
-      return SEDONA_ALLOC_ERROR;                                             \
-    }                                                                        \
-    *p_buf = buf;                                                            \
-    *p_buf_size = 8;                                                         \
-    return SEDONA_SUCCESS;                                                   \
-  } while (0)
-
 #endif /* GEOM_BUF */
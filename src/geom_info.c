@@ -0,0 +1,400 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "coord_codec.h"
+#include "geom_buf.h"
+#include "geomserde.h"
+#include "scratch_arena.h"
+
+/* Inspecting serialized geometries without constructing GEOS geometries. Only
+ * the header, the structural integers and (optionally) the coordinates are
+ * read, so these functions work without loading libgeos_c. */
+
+static inline int aligned_offset(int offset) { return (offset + 7) & ~7; }
+
+static void bounds_init(double *bounds) {
+  bounds[0] = INFINITY;
+  bounds[1] = INFINITY;
+  bounds[2] = -INFINITY;
+  bounds[3] = -INFINITY;
+}
+
+/* Extend bounds with coordinates in geom_buf. Empty points in multipoints are
+ * serialized as NaN coordinates, they are ignored. Returns number of
+ * coordinates which are not NaN. */
+static int bounds_extend(double *bounds, const GeomBuffer *geom_buf,
+                         const CoordinateSequenceInfo *cs_info) {
+  /* The serialized buffer may not be aligned, so coordinates are loaded using
+   * memcpy */
+  const char *p = (const char *)geom_buf->buf_coord;
+  int num_valid = 0;
+  for (unsigned int k = 0; k < cs_info->num_coords; k++) {
+    double xy[2];
+    memcpy(xy, p, sizeof(xy));
+    p += cs_info->bytes_per_coord;
+    if (isnan(xy[0])) {
+      continue;
+    }
+    num_valid++;
+    if (xy[0] < bounds[0]) bounds[0] = xy[0];
+    if (xy[1] < bounds[1]) bounds[1] = xy[1];
+    if (xy[0] > bounds[2]) bounds[2] = xy[0];
+    if (xy[1] > bounds[3]) bounds[3] = xy[1];
+  }
+  return num_valid;
+}
+
+/* Skip structural integers of a polygon, returns error code */
+static SedonaErrorCode skip_polygon_ints(GeomBuffer *geom_buf) {
+  int num_rings = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_rings);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (geom_buf->buf_int_end - geom_buf->buf_int < num_rings) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  geom_buf->buf_int += num_rings;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode get_geom_info(const char *buf, int buf_size,
+                                     int compute_bounds, int depth,
+                                     SedonaGeometryInfo *info,
+                                     int *p_bytes_read);
+
+static SedonaErrorCode get_geometrycollection_info(
+    GeomBuffer *geom_buf, int num_geoms, int compute_bounds, int depth,
+    SedonaGeometryInfo *info) {
+  if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  const char *buf = (const char *)geom_buf->buf + 8;
+  int remaining_size = geom_buf->buf_size - 8;
+  for (int k = 0; k < num_geoms; k++) {
+    SedonaGeometryInfo child_info;
+    int bytes_read = 0;
+    SedonaErrorCode err =
+        get_geom_info(buf, remaining_size, compute_bounds, depth + 1,
+                      &child_info, &bytes_read);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+
+    info->num_coords += child_info.num_coords;
+    info->has_z |= child_info.has_z;
+    info->has_m |= child_info.has_m;
+    if (!child_info.is_empty) {
+      info->is_empty = 0;
+    }
+    if (compute_bounds && !child_info.is_empty) {
+      if (child_info.bounds[0] < info->bounds[0])
+        info->bounds[0] = child_info.bounds[0];
+      if (child_info.bounds[1] < info->bounds[1])
+        info->bounds[1] = child_info.bounds[1];
+      if (child_info.bounds[2] > info->bounds[2])
+        info->bounds[2] = child_info.bounds[2];
+      if (child_info.bounds[3] > info->bounds[3])
+        info->bounds[3] = child_info.bounds[3];
+    }
+
+    bytes_read = aligned_offset(bytes_read);
+    if (remaining_size < bytes_read) {
+      return SEDONA_INCOMPLETE_BUFFER;
+    }
+    remaining_size -= bytes_read;
+    buf += bytes_read;
+  }
+
+  info->dims = 2 + info->has_z + info->has_m;
+  geom_buf->buf_int = (int *)buf;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode get_geom_info(const char *buf, int buf_size,
+                                     int compute_bounds, int depth,
+                                     SedonaGeometryInfo *info,
+                                     int *p_bytes_read) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  info->geom_type = geom_type_id;
+  info->srid = srid;
+  info->num_coords = 0;
+  info->is_empty = 1;
+  info->has_z = 0;
+  info->has_m = 0;
+  info->dims = 2;
+  bounds_init(info->bounds);
+
+  if (geom_type_id == GEOMETRYCOLLECTION) {
+    err = get_geometrycollection_info(&geom_buf, cs_info.num_coords,
+                                      compute_bounds, depth, info);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  } else {
+    info->dims = cs_info.dims;
+    info->has_z = cs_info.has_z;
+    info->has_m = cs_info.has_m;
+    info->num_coords = cs_info.num_coords;
+    if (geom_type_id == MULTIPOINT || compute_bounds) {
+      /* Multipoints may contain empty points, which are not counted as
+       * coordinates, so we have to look at the coordinates. */
+      double bounds[4];
+      bounds_init(bounds);
+      int num_valid = bounds_extend(bounds, &geom_buf, &cs_info);
+      if (geom_type_id == MULTIPOINT) {
+        info->num_coords = num_valid;
+      }
+      memcpy(info->bounds, bounds, sizeof(bounds));
+    }
+    info->is_empty = (info->num_coords == 0);
+
+    /* Skip the structural integers to find the end of this geometry */
+    switch (geom_type_id) {
+      case POLYGON:
+        if (cs_info.num_coords > 0) {
+          err = skip_polygon_ints(&geom_buf);
+        }
+        break;
+      case MULTILINESTRING: {
+        int num_linestrings = 0;
+        err = geom_buf_read_bounded_int(&geom_buf, &num_linestrings);
+        if (err == SEDONA_SUCCESS) {
+          if (geom_buf.buf_int_end - geom_buf.buf_int < num_linestrings) {
+            err = SEDONA_INCOMPLETE_BUFFER;
+          } else {
+            geom_buf.buf_int += num_linestrings;
+          }
+        }
+        break;
+      }
+      case MULTIPOLYGON: {
+        int num_polygons = 0;
+        err = geom_buf_read_bounded_int(&geom_buf, &num_polygons);
+        for (int k = 0; k < num_polygons && err == SEDONA_SUCCESS; k++) {
+          err = skip_polygon_ints(&geom_buf);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+
+  if (info->is_empty) {
+    info->bounds[0] = NAN;
+    info->bounds[1] = NAN;
+    info->bounds[2] = NAN;
+    info->bounds[3] = NAN;
+  }
+  *p_bytes_read = (int)((const char *)geom_buf.buf_int - buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_get_geom_info(const char *buf, int buf_size,
+                                     int compute_bounds,
+                                     SedonaGeometryInfo *info,
+                                     int *p_bytes_read) {
+  int bytes_read = 0;
+  /* Encoded coordinates are decoded into the scratch arena */
+  scratch_arena_begin();
+  SedonaErrorCode err =
+      get_geom_info(buf, buf_size, compute_bounds, 0, info, &bytes_read);
+  scratch_arena_end();
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (p_bytes_read != NULL) {
+    *p_bytes_read = bytes_read;
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Structure-only validation. Structural integers are loaded with memcpy since
+ * untrusted buffers may not be aligned, and each count is bounded the same
+ * way as geom_buf_read_bounded_int does. */
+
+typedef struct ValidateCursor {
+  const char *p;
+  const char *end;
+  int bound;           /* upper bound of counts */
+  int64_t coords_left; /* coordinates not yet taken by counts */
+} ValidateCursor;
+
+static SedonaErrorCode validate_read_count(ValidateCursor *c, int *p_value) {
+  if (c->end - c->p < (ptrdiff_t)sizeof(int)) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  int value;
+  memcpy(&value, c->p, sizeof(int));
+  c->p += sizeof(int);
+  if (value < 0 || value > c->bound) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_value = value;
+  return SEDONA_SUCCESS;
+}
+
+/* Read the coordinate count of a linear segment and take its coordinates */
+static SedonaErrorCode validate_segment(ValidateCursor *c) {
+  int num_coords = 0;
+  SedonaErrorCode err = validate_read_count(c, &num_coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (c->coords_left < num_coords) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  c->coords_left -= num_coords;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode validate_segments(ValidateCursor *c) {
+  int num_segments = 0;
+  SedonaErrorCode err = validate_read_count(c, &num_segments);
+  for (int k = 0; k < num_segments && err == SEDONA_SUCCESS; k++) {
+    err = validate_segment(c);
+  }
+  return err;
+}
+
+static SedonaErrorCode validate_geom(const char *buf, int buf_size, int depth,
+                                     int *p_bytes_read) {
+  if (buf_size < 8) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  unsigned int preamble = (unsigned char)buf[0];
+  int is_encoded = ((preamble & COORD_ENCODED_FLAG) != 0);
+  int geom_type_id = (preamble & 0x7F) >> 4;
+  int coord_type = (preamble & 0x0F) >> 1;
+  int num_coords;
+  memcpy(&num_coords, buf + 4, sizeof(int));
+  if (geom_type_id < POINT || geom_type_id > GEOMETRYCOLLECTION) {
+    return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  if (coord_type < XY || coord_type > XYZM) {
+    return SEDONA_UNKNOWN_COORD_TYPE;
+  }
+  int dims = (coord_type == XY ? 2 : (coord_type == XYZM ? 4 : 3));
+  if (num_coords < 0 ||
+      (is_encoded ? (int64_t)num_coords * dims > (int64_t)buf_size * 8
+                  : num_coords > buf_size)) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+
+  if (geom_type_id == GEOMETRYCOLLECTION) {
+    if (is_encoded || depth >= SEDONA_MAX_NESTING_DEPTH) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    const char *p = buf + 8;
+    int remaining_size = buf_size - 8;
+    for (int k = 0; k < num_coords; k++) {
+      int bytes_read = 0;
+      SedonaErrorCode err =
+          validate_geom(p, remaining_size, depth + 1, &bytes_read);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      bytes_read = aligned_offset(bytes_read);
+      if (remaining_size < bytes_read) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      remaining_size -= bytes_read;
+      p += bytes_read;
+    }
+    *p_bytes_read = (int)(p - buf);
+    return SEDONA_SUCCESS;
+  }
+
+  ValidateCursor c;
+  c.end = buf + buf_size;
+  c.bound = buf_size;
+  c.coords_left = num_coords;
+  if (!is_encoded) {
+    if (8 + (int64_t)num_coords * dims * 8 > buf_size) {
+      return SEDONA_INCOMPLETE_BUFFER;
+    }
+    c.p = buf + 8 + (ptrdiff_t)num_coords * dims * 8;
+  } else {
+    int block_size = 0;
+    SedonaErrorCode err = coord_decode(buf + 8, buf_size - 8, num_coords,
+                                       dims, NULL, &block_size);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    c.p = buf + 8 + block_size;
+    if (num_coords > c.bound) {
+      c.bound = num_coords;
+    }
+  }
+
+  SedonaErrorCode err = SEDONA_SUCCESS;
+  switch (geom_type_id) {
+    case POLYGON:
+      if (num_coords > 0) {
+        err = validate_segments(&c);
+      }
+      break;
+    case MULTILINESTRING:
+      err = validate_segments(&c);
+      break;
+    case MULTIPOLYGON: {
+      int num_polygons = 0;
+      err = validate_read_count(&c, &num_polygons);
+      for (int k = 0; k < num_polygons && err == SEDONA_SUCCESS; k++) {
+        err = validate_segments(&c);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  *p_bytes_read = (int)(c.p - buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_validate(const char *buf, int buf_size,
+                                int *p_bytes_read) {
+  int bytes_read = 0;
+  SedonaErrorCode err = validate_geom(buf, buf_size, 0, &bytes_read);
+  if (err == SEDONA_SUCCESS && p_bytes_read != NULL) {
+    *p_bytes_read = bytes_read;
+  }
+  return err;
+}
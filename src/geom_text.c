@@ -0,0 +1,859 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "geom_text.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "geom_buf.h"
+#include "scratch_arena.h"
+
+static inline int aligned_offset(int offset) { return (offset + 7) & ~7; }
+
+/* Shortest round-trip formatting of doubles using the Grisu2 algorithm by
+ * Florian Loitsch ("Printing Floating-Point Numbers Quickly and Accurately
+ * with Integers", PLDI 2010). The output always round-trips, and is the
+ * shortest representation for all but a tiny fraction of inputs. */
+
+typedef struct DiyFp {
+  uint64_t f;
+  int e;
+} DiyFp;
+
+/* Normalized 64-bit approximations of 10^k for k = -348, -340, ..., 340 */
+static const DiyFp kCachedPowers[] = {
+    {0xFA8FD5A0081C0288ull, -1220}, {0xBAAEE17FA23EBF76ull, -1193},
+    {0x8B16FB203055AC76ull, -1166}, {0xCF42894A5DCE35EAull, -1140},
+    {0x9A6BB0AA55653B2Dull, -1113}, {0xE61ACF033D1A45DFull, -1087},
+    {0xAB70FE17C79AC6CAull, -1060}, {0xFF77B1FCBEBCDC4Full, -1034},
+    {0xBE5691EF416BD60Cull, -1007}, {0x8DD01FAD907FFC3Cull, -980},
+    {0xD3515C2831559A83ull, -954}, {0x9D71AC8FADA6C9B5ull, -927},
+    {0xEA9C227723EE8BCBull, -901}, {0xAECC49914078536Dull, -874},
+    {0x823C12795DB6CE57ull, -847}, {0xC21094364DFB5637ull, -821},
+    {0x9096EA6F3848984Full, -794}, {0xD77485CB25823AC7ull, -768},
+    {0xA086CFCD97BF97F4ull, -741}, {0xEF340A98172AACE5ull, -715},
+    {0xB23867FB2A35B28Eull, -688}, {0x84C8D4DFD2C63F3Bull, -661},
+    {0xC5DD44271AD3CDBAull, -635}, {0x936B9FCEBB25C996ull, -608},
+    {0xDBAC6C247D62A584ull, -582}, {0xA3AB66580D5FDAF6ull, -555},
+    {0xF3E2F893DEC3F126ull, -529}, {0xB5B5ADA8AAFF80B8ull, -502},
+    {0x87625F056C7C4A8Bull, -475}, {0xC9BCFF6034C13053ull, -449},
+    {0x964E858C91BA2655ull, -422}, {0xDFF9772470297EBDull, -396},
+    {0xA6DFBD9FB8E5B88Full, -369}, {0xF8A95FCF88747D94ull, -343},
+    {0xB94470938FA89BCFull, -316}, {0x8A08F0F8BF0F156Bull, -289},
+    {0xCDB02555653131B6ull, -263}, {0x993FE2C6D07B7FACull, -236},
+    {0xE45C10C42A2B3B06ull, -210}, {0xAA242499697392D3ull, -183},
+    {0xFD87B5F28300CA0Eull, -157}, {0xBCE5086492111AEBull, -130},
+    {0x8CBCCC096F5088CCull, -103}, {0xD1B71758E219652Cull, -77},
+    {0x9C40000000000000ull, -50}, {0xE8D4A51000000000ull, -24},
+    {0xAD78EBC5AC620000ull, 3}, {0x813F3978F8940984ull, 30},
+    {0xC097CE7BC90715B3ull, 56}, {0x8F7E32CE7BEA5C70ull, 83},
+    {0xD5D238A4ABE98068ull, 109}, {0x9F4F2726179A2245ull, 136},
+    {0xED63A231D4C4FB27ull, 162}, {0xB0DE65388CC8ADA8ull, 189},
+    {0x83C7088E1AAB65DBull, 216}, {0xC45D1DF942711D9Aull, 242},
+    {0x924D692CA61BE758ull, 269}, {0xDA01EE641A708DEAull, 295},
+    {0xA26DA3999AEF774Aull, 322}, {0xF209787BB47D6B85ull, 348},
+    {0xB454E4A179DD1877ull, 375}, {0x865B86925B9BC5C2ull, 402},
+    {0xC83553C5C8965D3Dull, 428}, {0x952AB45CFA97A0B3ull, 455},
+    {0xDE469FBD99A05FE3ull, 481}, {0xA59BC234DB398C25ull, 508},
+    {0xF6C69A72A3989F5Cull, 534}, {0xB7DCBF5354E9BECEull, 561},
+    {0x88FCF317F22241E2ull, 588}, {0xCC20CE9BD35C78A5ull, 614},
+    {0x98165AF37B2153DFull, 641}, {0xE2A0B5DC971F303Aull, 667},
+    {0xA8D9D1535CE3B396ull, 694}, {0xFB9B7CD9A4A7443Cull, 720},
+    {0xBB764C4CA7A44410ull, 747}, {0x8BAB8EEFB6409C1Aull, 774},
+    {0xD01FEF10A657842Cull, 800}, {0x9B10A4E5E9913129ull, 827},
+    {0xE7109BFBA19C0C9Dull, 853}, {0xAC2820D9623BF429ull, 880},
+    {0x80444B5E7AA7CF85ull, 907}, {0xBF21E44003ACDD2Dull, 933},
+    {0x8E679C2F5E44FF8Full, 960}, {0xD433179D9C8CB841ull, 986},
+    {0x9E19DB92B4E31BA9ull, 1013}, {0xEB96BF6EBADF77D9ull, 1039},
+    {0xAF87023B9BF0EE6Bull, 1066},
+};
+
+static const uint32_t kPow10U32[] = {1,      10,      100,      1000,
+                                     10000,  100000,  1000000,  10000000,
+                                     100000000, 1000000000};
+
+static inline DiyFp diyfp_mul(DiyFp x, DiyFp y) {
+  const uint64_t M32 = 0xFFFFFFFFu;
+  uint64_t a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+  tmp += 1u << 31; /* round */
+  DiyFp r = {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+  return r;
+}
+
+static inline DiyFp diyfp_normalize(DiyFp x) {
+#if defined(__GNUC__)
+  int shift = __builtin_clzll(x.f);
+  x.f <<= shift;
+  x.e -= shift;
+#else
+  while ((x.f & 0x8000000000000000ull) == 0) {
+    x.f <<= 1;
+    x.e--;
+  }
+#endif
+  return x;
+}
+
+static inline int count_digits_u32(uint32_t n) {
+  int k = 1;
+  while (k < 10 && n >= kPow10U32[k]) {
+    k++;
+  }
+  return k;
+}
+
+static void grisu_round(char *digits, int len, uint64_t delta, uint64_t rest,
+                        uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    digits[len - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+/* Generate the shortest digits of a number in (Mm, Mp), where delta is
+ * Mp - Mm and W is the scaled value. Returns the number of digits. */
+static int grisu_digit_gen(DiyFp W, DiyFp Mp, uint64_t delta, char *digits,
+                           int *K) {
+  const int shift = -Mp.e;
+  const uint64_t one = 1ull << shift;
+  const uint64_t wp_w = Mp.f - W.f;
+  uint32_t p1 = (uint32_t)(Mp.f >> shift);
+  uint64_t p2 = Mp.f & (one - 1);
+  int kappa = count_digits_u32(p1);
+  int len = 0;
+  while (kappa > 0) {
+    uint32_t d = p1 / kPow10U32[kappa - 1];
+    p1 %= kPow10U32[kappa - 1];
+    if (d != 0 || len != 0) {
+      digits[len++] = (char)('0' + d);
+    }
+    kappa--;
+    uint64_t rest = ((uint64_t)p1 << shift) + p2;
+    if (rest <= delta) {
+      *K += kappa;
+      grisu_round(digits, len, delta, rest,
+                  (uint64_t)kPow10U32[kappa] << shift, wp_w);
+      return len;
+    }
+  }
+  uint64_t unit = 1;
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    unit *= 10;
+    char d = (char)(p2 >> shift);
+    if (d != 0 || len != 0) {
+      digits[len++] = (char)('0' + d);
+    }
+    p2 &= one - 1;
+    kappa--;
+    if (p2 < delta) {
+      *K += kappa;
+      grisu_round(digits, len, delta, p2, one, wp_w * unit);
+      return len;
+    }
+  }
+}
+
+/* Find the shortest decimal digits of positive finite x such that
+ * 0.digits * 10^(len + exp10) round-trips to x. Returns len. digits should
+ * have room for at least 20 characters. */
+static int shortest_digits(double x, char *digits, int *p_exp10) {
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  int biased_e = (int)((bits >> 52) & 0x7FF);
+  uint64_t significand = bits & 0x000FFFFFFFFFFFFFull;
+  DiyFp v;
+  if (biased_e != 0) {
+    v.f = significand | 0x0010000000000000ull;
+    v.e = biased_e - 1075;
+  } else {
+    v.f = significand;
+    v.e = -1074;
+  }
+
+  /* Boundaries m- and m+ of the rounding interval of x */
+  DiyFp mp = {(v.f << 1) + 1, v.e - 1};
+  mp = diyfp_normalize(mp);
+  DiyFp mm;
+  if (v.f == 0x0010000000000000ull) {
+    mm.f = (v.f << 2) - 1;
+    mm.e = v.e - 2;
+  } else {
+    mm.f = (v.f << 1) - 1;
+    mm.e = v.e - 1;
+  }
+  mm.f <<= mm.e - mp.e;
+  mm.e = mp.e;
+
+  /* Scale by a cached power of 10 so that the exponent of the product falls
+   * in [-60, -32] */
+  double dk = (-61 - mp.e) * 0.30102999566398114 + 347;
+  int k = (int)dk;
+  if (dk - k > 0.0) {
+    k++;
+  }
+  int index = (k >> 3) + 1;
+  int K = -(-348 + index * 8);
+  DiyFp c_mk = kCachedPowers[index];
+
+  DiyFp W = diyfp_mul(diyfp_normalize(v), c_mk);
+  DiyFp Wp = diyfp_mul(mp, c_mk);
+  DiyFp Wm = diyfp_mul(mm, c_mk);
+  Wm.f++;
+  Wp.f--;
+
+  int len = grisu_digit_gen(W, Wp, Wp.f - Wm.f, digits, &K);
+  *p_exp10 = K;
+  return len;
+}
+
+static int write_decimal(char *out, int negative, const char *digits, int n,
+                         int exp10) {
+  while (n > 1 && digits[n - 1] == '0') {
+    n--;
+    exp10++;
+  }
+
+  char *p = out;
+  if (negative) {
+    *p++ = '-';
+  }
+  int point = n + exp10; /* number of digits before the decimal point */
+  int sci_exp = point - 1;
+  if (sci_exp > -5 && sci_exp < 17) {
+    if (point <= 0) {
+      *p++ = '0';
+      *p++ = '.';
+      for (int k = point; k < 0; k++) {
+        *p++ = '0';
+      }
+      point = -1; /* the decimal point has been written */
+    }
+    for (int k = 0; k < n; k++) {
+      if (k == point) {
+        *p++ = '.';
+      }
+      *p++ = digits[k];
+    }
+    for (int k = n; k < point; k++) {
+      *p++ = '0';
+    }
+  } else {
+    *p++ = digits[0];
+    if (n > 1) {
+      *p++ = '.';
+      memcpy(p, digits + 1, n - 1);
+      p += n - 1;
+    }
+    *p++ = 'e';
+    *p++ = (sci_exp < 0 ? '-' : '+');
+    p += sprintf(p, "%d", abs(sci_exp));
+  }
+  return (int)(p - out);
+}
+
+/* Powers of 10 that are exactly representable as doubles, for rounding to
+ * a fixed number of decimal places */
+static const double kPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+#define MAX_EXACT_POW10 22
+
+int sedona_format_double(double value, int precision, char *out) {
+  if (isnan(value)) {
+    memcpy(out, "NaN", 3);
+    return 3;
+  }
+  if (isinf(value)) {
+    if (value > 0) {
+      memcpy(out, "Infinity", 8);
+      return 8;
+    }
+    memcpy(out, "-Infinity", 9);
+    return 9;
+  }
+
+  int negative = signbit(value) != 0;
+  double x = fabs(value);
+  if (precision >= 0 && precision <= MAX_EXACT_POW10) {
+    double scaled = x * kPow10[precision];
+    if (scaled < 9007199254740992.0) {
+      x = round(scaled) / kPow10[precision];
+    }
+  }
+  if (x == 0) {
+    if (negative && value == 0) {
+      memcpy(out, "-0", 2);
+      return 2;
+    }
+    out[0] = '0';
+    return 1;
+  }
+
+  char digits[20];
+  int exp10 = 0;
+  int n = shortest_digits(x, digits, &exp10);
+  return write_decimal(out, negative, digits, n, exp10);
+}
+
+/* Text writers write into [p, end) and count the length of output. When the
+ * output overflows the buffer, p is set to NULL and the writer keeps counting,
+ * so that the caller could retry with a buffer of exact size. Computing the
+ * length takes as much work as writing the text, so there's no separate pass
+ * for computing sizes. */
+
+typedef struct TextWriter {
+  char *p;
+  char *end;
+  int64_t size;
+  int precision;
+} TextWriter;
+
+static inline void text_write(TextWriter *w, const char *s, size_t n) {
+  if (w->p != NULL) {
+    if ((size_t)(w->end - w->p) >= n) {
+      memcpy(w->p, s, n);
+      w->p += n;
+    } else {
+      w->p = NULL;
+    }
+  }
+  w->size += n;
+}
+
+static inline void text_write_str(TextWriter *w, const char *s) {
+  text_write(w, s, strlen(s));
+}
+
+static inline void text_write_double(TextWriter *w, double value) {
+  if (w->p != NULL && w->end - w->p >= SEDONA_DOUBLE_BUF_SIZE) {
+    int n = sedona_format_double(value, w->precision, w->p);
+    w->p += n;
+    w->size += n;
+  } else {
+    char tmp[SEDONA_DOUBLE_BUF_SIZE];
+    int n = sedona_format_double(value, w->precision, tmp);
+    text_write(w, tmp, n);
+  }
+}
+
+static inline int is_nan_coord(const double *coord) {
+  return isnan(coord[0]) && isnan(coord[1]);
+}
+
+typedef SedonaErrorCode (*TextGeomWriter)(TextWriter *w, const char *buf,
+                                          int buf_size, int include_srid,
+                                          int depth, int *p_bytes_read);
+
+static SedonaErrorCode text_write_geom(TextGeomWriter write_geom,
+                                       const char *buf, int buf_size,
+                                       int precision, int include_srid,
+                                       char *out, int capacity, int *p_size) {
+  TextWriter w = {out, out + capacity, 0, precision};
+  int bytes_read = 0;
+  /* Encoded coordinates are decoded into the scratch arena */
+  scratch_arena_begin();
+  SedonaErrorCode err =
+      write_geom(&w, buf, buf_size, include_srid, 0, &bytes_read);
+  scratch_arena_end();
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (w.size > INT32_MAX) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_size = (int)w.size;
+  return (w.size > capacity ? SEDONA_BUFFER_TOO_SMALL : SEDONA_SUCCESS);
+}
+
+/* Geometry collections are laid out as a sequence of 8-byte aligned
+ * children following the 8-byte header. depth is the nesting depth of the
+ * collection itself. */
+static SedonaErrorCode write_children(TextWriter *w, TextGeomWriter write_geom,
+                                      const char *buf, int buf_size,
+                                      int num_geoms, const char *sep,
+                                      int depth, int *p_bytes_read) {
+  if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  const char *child_buf = buf + 8;
+  int remaining_size = buf_size - 8;
+  for (int k = 0; k < num_geoms; k++) {
+    if (k > 0) {
+      text_write_str(w, sep);
+    }
+    int bytes_read = 0;
+    SedonaErrorCode err =
+        write_geom(w, child_buf, remaining_size, 0, depth + 1, &bytes_read);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    bytes_read = aligned_offset(bytes_read);
+    if (remaining_size < bytes_read) {
+      return SEDONA_INCOMPLETE_BUFFER;
+    }
+    remaining_size -= bytes_read;
+    child_buf += bytes_read;
+  }
+  *p_bytes_read = (int)(child_buf - buf);
+  return SEDONA_SUCCESS;
+}
+
+/* WKT */
+
+static const char *kWktTypeNames[] = {
+    NULL,         "POINT",           "LINESTRING",   "POLYGON",
+    "MULTIPOINT", "MULTILINESTRING", "MULTIPOLYGON", "GEOMETRYCOLLECTION"};
+
+static void wkt_write_coord(TextWriter *w, const double *coord,
+                            unsigned int dims) {
+  for (unsigned int k = 0; k < dims; k++) {
+    if (k > 0) {
+      text_write(w, " ", 1);
+    }
+    text_write_double(w, coord[k]);
+  }
+}
+
+static SedonaErrorCode wkt_write_coords(TextWriter *w, GeomBuffer *geom_buf,
+                                        const CoordinateSequenceInfo *cs_info,
+                                        unsigned int num_coords) {
+  if (num_coords == 0) {
+    text_write(w, "EMPTY", 5);
+    return SEDONA_SUCCESS;
+  }
+  const double *coords = NULL;
+  SedonaErrorCode err =
+      geom_buf_take_coords(geom_buf, cs_info, num_coords, &coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "(", 1);
+  for (unsigned int k = 0; k < num_coords; k++) {
+    if (k > 0) {
+      text_write(w, ", ", 2);
+    }
+    wkt_write_coord(w, coords + k * cs_info->dims, cs_info->dims);
+  }
+  text_write(w, ")", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode wkt_write_linear_segment(
+    TextWriter *w, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info) {
+  int num_coords = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  return wkt_write_coords(w, geom_buf, cs_info, num_coords);
+}
+
+static SedonaErrorCode wkt_write_polygon_body(
+    TextWriter *w, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info) {
+  int num_rings = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_rings);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (num_rings == 0) {
+    text_write(w, "EMPTY", 5);
+    return SEDONA_SUCCESS;
+  }
+  text_write(w, "(", 1);
+  for (int k = 0; k < num_rings; k++) {
+    if (k > 0) {
+      text_write(w, ", ", 2);
+    }
+    err = wkt_write_linear_segment(w, geom_buf, cs_info);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  text_write(w, ")", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode wkt_write_multipoint(
+    TextWriter *w, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info) {
+  unsigned int num_points = cs_info->num_coords;
+  if (num_points == 0) {
+    text_write(w, "EMPTY", 5);
+    return SEDONA_SUCCESS;
+  }
+  const double *coords = NULL;
+  SedonaErrorCode err =
+      geom_buf_take_coords(geom_buf, cs_info, num_points, &coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "(", 1);
+  for (unsigned int k = 0; k < num_points; k++) {
+    const double *coord = coords + k * cs_info->dims;
+    if (k > 0) {
+      text_write(w, ", ", 2);
+    }
+    if (is_nan_coord(coord)) {
+      text_write(w, "EMPTY", 5);
+    } else {
+      text_write(w, "(", 1);
+      wkt_write_coord(w, coord, cs_info->dims);
+      text_write(w, ")", 1);
+    }
+  }
+  text_write(w, ")", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode wkt_write_multi(TextWriter *w, GeomBuffer *geom_buf,
+                                       const CoordinateSequenceInfo *cs_info,
+                                       GeometryTypeId child_type) {
+  int num_geoms = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_geoms);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (num_geoms == 0) {
+    text_write(w, "EMPTY", 5);
+    return SEDONA_SUCCESS;
+  }
+  text_write(w, "(", 1);
+  for (int k = 0; k < num_geoms; k++) {
+    if (k > 0) {
+      text_write(w, ", ", 2);
+    }
+    if (child_type == LINESTRING) {
+      err = wkt_write_linear_segment(w, geom_buf, cs_info);
+    } else {
+      err = wkt_write_polygon_body(w, geom_buf, cs_info);
+    }
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  text_write(w, ")", 1);
+  return SEDONA_SUCCESS;
+}
+
+static void wkt_write_type(TextWriter *w, GeometryTypeId geom_type_id,
+                           int has_z, int has_m) {
+  text_write_str(w, kWktTypeNames[geom_type_id]);
+  if (has_z && has_m) {
+    text_write(w, " ZM", 3);
+  } else if (has_z) {
+    text_write(w, " Z", 2);
+  } else if (has_m) {
+    text_write(w, " M", 2);
+  }
+  text_write(w, " ", 1);
+}
+
+static SedonaErrorCode write_wkt_geom(TextWriter *w, const char *buf,
+                                      int buf_size, int include_srid,
+                                      int depth, int *p_bytes_read) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (geom_type_id < POINT || geom_type_id > GEOMETRYCOLLECTION) {
+    return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  if (include_srid && srid != 0) {
+    char tmp[32];
+    int n = snprintf(tmp, sizeof(tmp), "SRID=%d;", srid);
+    text_write(w, tmp, n);
+  }
+
+  if (geom_type_id == GEOMETRYCOLLECTION) {
+    /* Dimensions of geometry collections are derived from their children */
+    SedonaGeometryInfo info;
+    err = sedona_get_geom_info(buf, buf_size, 0, &info, NULL);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    wkt_write_type(w, GEOMETRYCOLLECTION, info.has_z, info.has_m);
+    int num_geoms = cs_info.num_coords;
+    if (num_geoms == 0) {
+      text_write(w, "EMPTY", 5);
+      *p_bytes_read = 8;
+      return SEDONA_SUCCESS;
+    }
+    text_write(w, "(", 1);
+    err = write_children(w, write_wkt_geom, buf, buf_size, num_geoms, ", ",
+                         depth, p_bytes_read);
+    text_write(w, ")", 1);
+    return err;
+  }
+
+  wkt_write_type(w, geom_type_id, cs_info.has_z, cs_info.has_m);
+  switch (geom_type_id) {
+    case POINT:
+    case LINESTRING:
+      err = wkt_write_coords(w, &geom_buf, &cs_info, cs_info.num_coords);
+      break;
+    case POLYGON:
+      if (cs_info.num_coords == 0) {
+        text_write(w, "EMPTY", 5);
+      } else {
+        err = wkt_write_polygon_body(w, &geom_buf, &cs_info);
+      }
+      break;
+    case MULTIPOINT:
+      err = wkt_write_multipoint(w, &geom_buf, &cs_info);
+      break;
+    case MULTILINESTRING:
+      err = wkt_write_multi(w, &geom_buf, &cs_info, LINESTRING);
+      break;
+    case MULTIPOLYGON:
+      err = wkt_write_multi(w, &geom_buf, &cs_info, POLYGON);
+      break;
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  *p_bytes_read = (int)((const char *)geom_buf.buf_int - buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_to_wkt(const char *buf, int buf_size, int precision,
+                              int include_srid, char *out, int capacity,
+                              int *p_size) {
+  return text_write_geom(write_wkt_geom, buf, buf_size, precision,
+                         include_srid, out, capacity, p_size);
+}
+
+/* GeoJSON */
+
+static const char *kGeoJsonTypeNames[] = {
+    NULL,         "Point",           "LineString",   "Polygon",
+    "MultiPoint", "MultiLineString", "MultiPolygon", "GeometryCollection"};
+
+static void geojson_write_position(TextWriter *w, const double *coord,
+                                   int has_z) {
+  text_write(w, "[", 1);
+  text_write_double(w, coord[0]);
+  text_write(w, ",", 1);
+  text_write_double(w, coord[1]);
+  if (has_z) {
+    text_write(w, ",", 1);
+    text_write_double(w, coord[2]);
+  }
+  text_write(w, "]", 1);
+}
+
+static SedonaErrorCode geojson_write_positions(
+    TextWriter *w, GeomBuffer *geom_buf, const CoordinateSequenceInfo *cs_info,
+    unsigned int num_coords) {
+  const double *coords = NULL;
+  SedonaErrorCode err =
+      geom_buf_take_coords(geom_buf, cs_info, num_coords, &coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "[", 1);
+  for (unsigned int k = 0; k < num_coords; k++) {
+    if (k > 0) {
+      text_write(w, ",", 1);
+    }
+    geojson_write_position(w, coords + k * cs_info->dims, cs_info->has_z);
+  }
+  text_write(w, "]", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode geojson_write_linear_segment(
+    TextWriter *w, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info) {
+  int num_coords = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  return geojson_write_positions(w, geom_buf, cs_info, num_coords);
+}
+
+static SedonaErrorCode geojson_write_polygon_body(
+    TextWriter *w, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info) {
+  int num_rings = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_rings);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "[", 1);
+  for (int k = 0; k < num_rings; k++) {
+    if (k > 0) {
+      text_write(w, ",", 1);
+    }
+    err = geojson_write_linear_segment(w, geom_buf, cs_info);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  text_write(w, "]", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode geojson_write_multipoint(
+    TextWriter *w, GeomBuffer *geom_buf,
+    const CoordinateSequenceInfo *cs_info) {
+  const double *coords = NULL;
+  SedonaErrorCode err =
+      geom_buf_take_coords(geom_buf, cs_info, cs_info->num_coords, &coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "[", 1);
+  int num_written = 0;
+  for (unsigned int k = 0; k < cs_info->num_coords; k++) {
+    const double *coord = coords + k * cs_info->dims;
+    if (is_nan_coord(coord)) {
+      continue;
+    }
+    if (num_written++ > 0) {
+      text_write(w, ",", 1);
+    }
+    geojson_write_position(w, coord, cs_info->has_z);
+  }
+  text_write(w, "]", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode geojson_write_multi(
+    TextWriter *w, GeomBuffer *geom_buf, const CoordinateSequenceInfo *cs_info,
+    GeometryTypeId child_type) {
+  int num_geoms = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_geoms);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "[", 1);
+  for (int k = 0; k < num_geoms; k++) {
+    if (k > 0) {
+      text_write(w, ",", 1);
+    }
+    if (child_type == LINESTRING) {
+      err = geojson_write_linear_segment(w, geom_buf, cs_info);
+    } else {
+      err = geojson_write_polygon_body(w, geom_buf, cs_info);
+    }
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  text_write(w, "]", 1);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode write_geojson_geom(TextWriter *w, const char *buf,
+                                          int buf_size, int include_srid,
+                                          int depth, int *p_bytes_read) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (geom_type_id < POINT || geom_type_id > GEOMETRYCOLLECTION) {
+    return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+
+  text_write(w, "{\"type\":\"", 9);
+  text_write_str(w, kGeoJsonTypeNames[geom_type_id]);
+  if (geom_type_id == GEOMETRYCOLLECTION) {
+    text_write_str(w, "\",\"geometries\":[");
+    err = write_children(w, write_geojson_geom, buf, buf_size,
+                         cs_info.num_coords, ",", depth, p_bytes_read);
+    text_write(w, "]}", 2);
+    return err;
+  }
+
+  text_write_str(w, "\",\"coordinates\":");
+  switch (geom_type_id) {
+    case POINT:
+      if (cs_info.num_coords == 0) {
+        text_write(w, "[]", 2);
+      } else {
+        const double *coord = NULL;
+        err = geom_buf_take_coords(&geom_buf, &cs_info, 1, &coord);
+        if (err == SEDONA_SUCCESS) {
+          geojson_write_position(w, coord, cs_info.has_z);
+        }
+      }
+      break;
+    case LINESTRING:
+      err = geojson_write_positions(w, &geom_buf, &cs_info,
+                                    cs_info.num_coords);
+      break;
+    case POLYGON:
+      if (cs_info.num_coords == 0) {
+        text_write(w, "[]", 2);
+      } else {
+        err = geojson_write_polygon_body(w, &geom_buf, &cs_info);
+      }
+      break;
+    case MULTIPOINT:
+      err = geojson_write_multipoint(w, &geom_buf, &cs_info);
+      break;
+    case MULTILINESTRING:
+      err = geojson_write_multi(w, &geom_buf, &cs_info, LINESTRING);
+      break;
+    case MULTIPOLYGON:
+      err = geojson_write_multi(w, &geom_buf, &cs_info, POLYGON);
+      break;
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  text_write(w, "}", 1);
+
+  *p_bytes_read = (int)((const char *)geom_buf.buf_int - buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_to_geojson(const char *buf, int buf_size, int precision,
+                                  char *out, int capacity, int *p_size) {
+  return text_write_geom(write_geojson_geom, buf, buf_size, precision, 0, out,
+                         capacity, p_size);
+}
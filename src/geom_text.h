@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GEOM_TEXT
+#define GEOM_TEXT
+
+#include "geomserde.h"
+
+/* Rendering serialized geometries as WKT and GeoJSON without constructing
+ * GEOS geometries. Numbers are written using the shortest decimal
+ * representation that round-trips to the same double, optionally after
+ * rounding to a fixed number of decimal places. Writers render text in a
+ * single pass and report the required size when the output buffer is too
+ * small. */
+
+/* Size of a buffer large enough for holding any formatted double */
+#define SEDONA_DOUBLE_BUF_SIZE 32
+
+/**
+ * Formats a double as decimal text. Values with decimal exponents in
+ * [-4, 16] are written in positional notation, other values are written in
+ * scientific notation (e.g. 1e+17, 1.5e-5), the same as the WKT writer of
+ * GEOS. Non-finite values are written as NaN, Infinity and -Infinity.
+ *
+ * @param value the value to format
+ * @param precision number of decimal places to round to, or -1 for writing
+ * the shortest representation that round-trips. The shortest representation
+ * is found using Grisu2, which may emit one extra digit for about 0.1% of
+ * inputs
+ * @param out buffer of at least SEDONA_DOUBLE_BUF_SIZE bytes, the output is
+ * not NUL terminated
+ * @return number of characters written
+ */
+int sedona_format_double(double value, int precision, char *out);
+
+/**
+ * Writes the WKT representation of a serialized geometry. The output follows
+ * the format of GEOS with trimmed numbers, empty points in multipoints are
+ * written as EMPTY.
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param precision number of decimal places, -1 for full precision
+ * @param include_srid whether to write EWKT when the geometry has a non-zero
+ * SRID
+ * @param out buffer for writing WKT into, the output is not NUL terminated
+ * @param capacity size of out
+ * @param p_size OUTPUT parameter for receiving the length of WKT. When it is
+ * larger than capacity, SEDONA_BUFFER_TOO_SMALL is returned and the caller
+ * should retry with a buffer of that size
+ * @return error code
+ */
+SedonaErrorCode sedona_to_wkt(const char *buf, int buf_size, int precision,
+                              int include_srid, char *out, int capacity,
+                              int *p_size);
+
+/**
+ * Writes the compact GeoJSON geometry object of a serialized geometry. M
+ * values are dropped since GeoJSON positions could only have Z values. Empty
+ * points in multipoints are skipped, since GeoJSON cannot represent them.
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param precision number of decimal places, -1 for full precision
+ * @param out buffer for writing GeoJSON into, the output is not NUL
+ * terminated
+ * @param capacity size of out
+ * @param p_size OUTPUT parameter for receiving the length of GeoJSON. When it
+ * is larger than capacity, SEDONA_BUFFER_TOO_SMALL is returned and the caller
+ * should retry with a buffer of that size
+ * @return error code
+ */
+SedonaErrorCode sedona_to_geojson(const char *buf, int buf_size, int precision,
+                                  char *out, int capacity, int *p_size);
+
+#endif /* GEOM_TEXT */
@@ -0,0 +1,740 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "geom_wkb.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "geom_buf.h"
+#include "scratch_arena.h"
+
+#define EWKB_Z_FLAG 0x80000000u
+#define EWKB_M_FLAG 0x40000000u
+#define EWKB_SRID_FLAG 0x20000000u
+
+/* SRID is stored in 3 bytes of the serialized geometry */
+#define MAX_SRID 0xFFFFFF
+
+static inline int aligned_offset(int offset) { return (offset + 7) & ~7; }
+
+static int native_byte_order(void) {
+  const uint16_t one = 1;
+  return *(const unsigned char *)&one == 1 ? SEDONA_WKB_NDR : SEDONA_WKB_XDR;
+}
+
+static inline uint32_t swap_u32(uint32_t v) {
+  return ((v & 0xFF) << 24) | ((v & 0xFF00) << 8) | ((v >> 8) & 0xFF00) |
+         (v >> 24);
+}
+
+static inline uint64_t swap_u64(uint64_t v) {
+  return ((uint64_t)swap_u32((uint32_t)v) << 32) | swap_u32((uint32_t)(v >> 32));
+}
+
+/* Serialized geometry to WKB. The writer only counts bytes when p is NULL, so
+ * the same code path computes the size of WKB and writes it. */
+
+typedef struct WkbWriter {
+  unsigned char *p;
+  int64_t size;
+  int byte_order;
+  int swap;
+} WkbWriter;
+
+static inline void wkb_write_bytes(WkbWriter *w, const void *data, size_t n) {
+  if (w->p != NULL) {
+    memcpy(w->p, data, n);
+    w->p += n;
+  }
+  w->size += n;
+}
+
+static inline void wkb_write_u32(WkbWriter *w, uint32_t value) {
+  if (w->swap) {
+    value = swap_u32(value);
+  }
+  wkb_write_bytes(w, &value, 4);
+}
+
+static void wkb_write_header(WkbWriter *w, int geom_type, int has_z, int has_m,
+                             int srid) {
+  unsigned char byte_order = (unsigned char)w->byte_order;
+  wkb_write_bytes(w, &byte_order, 1);
+  uint32_t type_code = (uint32_t)geom_type;
+  if (has_z) type_code |= EWKB_Z_FLAG;
+  if (has_m) type_code |= EWKB_M_FLAG;
+  if (srid != 0) type_code |= EWKB_SRID_FLAG;
+  wkb_write_u32(w, type_code);
+  if (srid != 0) {
+    wkb_write_u32(w, (uint32_t)srid);
+  }
+}
+
+/* Add dimension flags to the header written at p. Dimensions of geometry
+ * collections are only known after their children were written. */
+static void wkb_set_header_dims(const WkbWriter *w, unsigned char *p,
+                                int has_z, int has_m) {
+  if (p == NULL || (!has_z && !has_m)) {
+    return;
+  }
+  uint32_t type_code;
+  memcpy(&type_code, p + 1, 4);
+  if (w->swap) {
+    type_code = swap_u32(type_code);
+  }
+  if (has_z) type_code |= EWKB_Z_FLAG;
+  if (has_m) type_code |= EWKB_M_FLAG;
+  if (w->swap) {
+    type_code = swap_u32(type_code);
+  }
+  memcpy(p + 1, &type_code, 4);
+}
+
+static void wkb_write_doubles(WkbWriter *w, const char *src, size_t n) {
+  if (!w->swap || w->p == NULL) {
+    wkb_write_bytes(w, src, n * 8);
+    return;
+  }
+  for (size_t k = 0; k < n; k++) {
+    uint64_t value;
+    memcpy(&value, src + 8 * k, 8);
+    value = swap_u64(value);
+    wkb_write_bytes(w, &value, 8);
+  }
+}
+
+static void wkb_write_nan_coord(WkbWriter *w, int dims) {
+  double nan_coord[4] = {NAN, NAN, NAN, NAN};
+  wkb_write_doubles(w, (const char *)nan_coord, dims);
+}
+
+static SedonaErrorCode write_wkb_coords(WkbWriter *w, GeomBuffer *geom_buf,
+                                        const CoordinateSequenceInfo *cs_info,
+                                        unsigned int num_coords) {
+  const double *coords = NULL;
+  SedonaErrorCode err =
+      geom_buf_take_coords(geom_buf, cs_info, num_coords, &coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  wkb_write_doubles(w, (const char *)coords,
+                    (size_t)num_coords * cs_info->dims);
+  return SEDONA_SUCCESS;
+}
+
+/* Write a linear segment whose number of coordinates is read from the
+ * integer region */
+static SedonaErrorCode write_wkb_linear_segment(
+    WkbWriter *w, GeomBuffer *geom_buf, const CoordinateSequenceInfo *cs_info) {
+  int num_coords = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  wkb_write_u32(w, num_coords);
+  return write_wkb_coords(w, geom_buf, cs_info, num_coords);
+}
+
+static SedonaErrorCode write_wkb_polygon_body(
+    WkbWriter *w, GeomBuffer *geom_buf, const CoordinateSequenceInfo *cs_info) {
+  int num_rings = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_rings);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  wkb_write_u32(w, num_rings);
+  for (int k = 0; k < num_rings; k++) {
+    err = write_wkb_linear_segment(w, geom_buf, cs_info);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode write_wkb_multi(WkbWriter *w, GeomBuffer *geom_buf,
+                                       const CoordinateSequenceInfo *cs_info,
+                                       GeometryTypeId child_type) {
+  int num_geoms = 0;
+  SedonaErrorCode err = geom_buf_read_bounded_int(geom_buf, &num_geoms);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  wkb_write_u32(w, num_geoms);
+  for (int k = 0; k < num_geoms; k++) {
+    wkb_write_header(w, child_type, cs_info->has_z, cs_info->has_m, 0);
+    if (child_type == LINESTRING) {
+      err = write_wkb_linear_segment(w, geom_buf, cs_info);
+    } else {
+      err = write_wkb_polygon_body(w, geom_buf, cs_info);
+    }
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Write the serialized geometry in buf as WKB. Dimensions of the written
+ * geometry are returned in p_has_z and p_has_m. */
+static SedonaErrorCode write_wkb_geom(WkbWriter *w, const char *buf,
+                                      int buf_size, int include_srid,
+                                      int depth, int *p_has_z, int *p_has_m,
+                                      int *p_bytes_read) {
+  GeomBuffer geom_buf;
+  CoordinateSequenceInfo cs_info;
+  GeometryTypeId geom_type_id;
+  int srid;
+  SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
+                                             &geom_type_id, &srid);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (!include_srid) {
+    srid = 0;
+  }
+
+  if (geom_type_id == GEOMETRYCOLLECTION) {
+    if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    /* Dimensions of geometry collections are derived from their children,
+     * they are added to the header once the children were written */
+    unsigned char *header = w->p;
+    int has_z = 0;
+    int has_m = 0;
+    int num_geoms = cs_info.num_coords;
+    wkb_write_header(w, GEOMETRYCOLLECTION, 0, 0, srid);
+    wkb_write_u32(w, num_geoms);
+    const char *child_buf = buf + 8;
+    int remaining_size = buf_size - 8;
+    for (int k = 0; k < num_geoms; k++) {
+      int bytes_read = 0;
+      int child_has_z = 0;
+      int child_has_m = 0;
+      err = write_wkb_geom(w, child_buf, remaining_size, 0, depth + 1,
+                           &child_has_z, &child_has_m, &bytes_read);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      has_z |= child_has_z;
+      has_m |= child_has_m;
+      bytes_read = aligned_offset(bytes_read);
+      if (remaining_size < bytes_read) {
+        return SEDONA_INCOMPLETE_BUFFER;
+      }
+      remaining_size -= bytes_read;
+      child_buf += bytes_read;
+    }
+    wkb_set_header_dims(w, header, has_z, has_m);
+    *p_has_z = has_z;
+    *p_has_m = has_m;
+    *p_bytes_read = (int)(child_buf - buf);
+    return SEDONA_SUCCESS;
+  }
+
+  *p_has_z = cs_info.has_z;
+  *p_has_m = cs_info.has_m;
+  wkb_write_header(w, geom_type_id, cs_info.has_z, cs_info.has_m, srid);
+  switch (geom_type_id) {
+    case POINT:
+      if (cs_info.num_coords == 0) {
+        wkb_write_nan_coord(w, cs_info.dims);
+      } else {
+        err = write_wkb_coords(w, &geom_buf, &cs_info, 1);
+      }
+      break;
+    case LINESTRING:
+      wkb_write_u32(w, cs_info.num_coords);
+      err = write_wkb_coords(w, &geom_buf, &cs_info, cs_info.num_coords);
+      break;
+    case POLYGON:
+      if (cs_info.num_coords == 0) {
+        wkb_write_u32(w, 0);
+      } else {
+        err = write_wkb_polygon_body(w, &geom_buf, &cs_info);
+      }
+      break;
+    case MULTIPOINT:
+      wkb_write_u32(w, cs_info.num_coords);
+      for (unsigned int k = 0; k < cs_info.num_coords && err == SEDONA_SUCCESS;
+           k++) {
+        wkb_write_header(w, POINT, cs_info.has_z, cs_info.has_m, 0);
+        err = write_wkb_coords(w, &geom_buf, &cs_info, 1);
+      }
+      break;
+    case MULTILINESTRING:
+      err = write_wkb_multi(w, &geom_buf, &cs_info, LINESTRING);
+      break;
+    case MULTIPOLYGON:
+      err = write_wkb_multi(w, &geom_buf, &cs_info, POLYGON);
+      break;
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  *p_bytes_read = (int)((const char *)geom_buf.buf_int - buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_wkb_size(const char *buf, int buf_size,
+                                int include_srid, int *p_wkb_size) {
+  WkbWriter w = {NULL, 0, SEDONA_WKB_NDR, 0};
+  int has_z = 0;
+  int has_m = 0;
+  int bytes_read = 0;
+  /* Encoded coordinates are decoded into the scratch arena */
+  scratch_arena_begin();
+  SedonaErrorCode err =
+      write_wkb_geom(&w, buf, buf_size, include_srid, 0, &has_z, &has_m,
+                     &bytes_read);
+  scratch_arena_end();
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (w.size > INT32_MAX) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_wkb_size = (int)w.size;
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_to_wkb(const char *buf, int buf_size, int byte_order,
+                              int include_srid, char *wkb, int wkb_capacity,
+                              int *p_wkb_size) {
+  int wkb_size = 0;
+  SedonaErrorCode err =
+      sedona_wkb_size(buf, buf_size, include_srid, &wkb_size);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (wkb_size > wkb_capacity) {
+    return SEDONA_BUFFER_TOO_SMALL;
+  }
+
+  byte_order = (byte_order == SEDONA_WKB_XDR ? SEDONA_WKB_XDR : SEDONA_WKB_NDR);
+  WkbWriter w = {(unsigned char *)wkb, 0, byte_order,
+                 byte_order != native_byte_order()};
+  int has_z = 0;
+  int has_m = 0;
+  int bytes_read = 0;
+  scratch_arena_begin();
+  err = write_wkb_geom(&w, buf, buf_size, include_srid, 0, &has_z, &has_m,
+                       &bytes_read);
+  scratch_arena_end();
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  *p_wkb_size = (int)w.size;
+  return SEDONA_SUCCESS;
+}
+
+/* WKB to serialized geometry. The body of each non-collection geometry is
+ * parsed twice: the first pass counts the coordinates and structural
+ * integers, which determine the layout of the serialized buffer, the second
+ * pass copies coordinates and integers into their regions. */
+
+typedef struct WkbReader {
+  const unsigned char *p;
+  const unsigned char *end;
+} WkbReader;
+
+typedef struct SedonaSink {
+  GeomBuffer *geom_buf; /* NULL when counting */
+  int num_coords;
+  int num_ints;
+} SedonaSink;
+
+typedef struct WkbHeader {
+  int swap;
+  int geom_type;
+  int has_z;
+  int has_m;
+  int srid;
+} WkbHeader;
+
+static SedonaErrorCode wkb_read_u32(WkbReader *r, int swap, uint32_t *p_value) {
+  if (r->end - r->p < 4) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  uint32_t value;
+  memcpy(&value, r->p, 4);
+  r->p += 4;
+  *p_value = swap ? swap_u32(value) : value;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode wkb_read_header(WkbReader *r, WkbHeader *header) {
+  if (r->end - r->p < 1) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  int byte_order = *r->p++;
+  if (byte_order != SEDONA_WKB_XDR && byte_order != SEDONA_WKB_NDR) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  header->swap = (byte_order != native_byte_order());
+
+  uint32_t type_code = 0;
+  SedonaErrorCode err = wkb_read_u32(r, header->swap, &type_code);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  header->has_z = (type_code & EWKB_Z_FLAG) != 0;
+  header->has_m = (type_code & EWKB_M_FLAG) != 0;
+  int has_srid = (type_code & EWKB_SRID_FLAG) != 0;
+  type_code &= 0x0FFFFFFF;
+
+  /* ISO WKB encodes dimensions as 1000 (Z), 2000 (M) or 3000 (ZM) */
+  switch (type_code / 1000) {
+    case 0:
+      break;
+    case 1:
+      header->has_z = 1;
+      break;
+    case 2:
+      header->has_m = 1;
+      break;
+    case 3:
+      header->has_z = 1;
+      header->has_m = 1;
+      break;
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+  header->geom_type = type_code % 1000;
+  if (header->geom_type < POINT || header->geom_type > GEOMETRYCOLLECTION) {
+    return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+
+  header->srid = 0;
+  if (has_srid) {
+    uint32_t srid = 0;
+    err = wkb_read_u32(r, header->swap, &srid);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    if (srid > MAX_SRID) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    header->srid = (int)srid;
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Read header of a part of multi geometry, which should have the expected
+ * type and the same dimensions as its parent */
+static SedonaErrorCode wkb_read_part_header(WkbReader *r,
+                                            const WkbHeader *parent,
+                                            int expected_type, int *p_swap) {
+  WkbHeader header;
+  SedonaErrorCode err = wkb_read_header(r, &header);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (header.geom_type != expected_type || header.has_z != parent->has_z ||
+      header.has_m != parent->has_m) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
+  *p_swap = header.swap;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode sink_coords(WkbReader *r, int swap, int dims,
+                                   uint32_t num_coords, SedonaSink *sink) {
+  size_t num_doubles = (size_t)num_coords * dims;
+  if ((size_t)(r->end - r->p) / 8 < num_doubles) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  GeomBuffer *geom_buf = sink->geom_buf;
+  if (geom_buf != NULL) {
+    if ((size_t)(geom_buf->buf_coord_end - geom_buf->buf_coord) <
+        num_doubles) {
+      return SEDONA_INTERNAL_ERROR;
+    }
+    if (!swap) {
+      memcpy(geom_buf->buf_coord, r->p, num_doubles * 8);
+    } else {
+      for (size_t k = 0; k < num_doubles; k++) {
+        uint64_t value;
+        memcpy(&value, r->p + 8 * k, 8);
+        value = swap_u64(value);
+        memcpy(geom_buf->buf_coord + k, &value, 8);
+      }
+    }
+    geom_buf->buf_coord += num_doubles;
+  }
+  r->p += num_doubles * 8;
+  sink->num_coords += num_coords;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode sink_int(SedonaSink *sink, uint32_t value) {
+  if (sink->geom_buf != NULL) {
+    SedonaErrorCode err = geom_buf_write_int(sink->geom_buf, (int)value);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  sink->num_ints++;
+  return SEDONA_SUCCESS;
+}
+
+/* Read number of coordinates and the coordinates of a linear segment.
+ * Serialized linestrings do not store the number of coordinates as an
+ * integer while rings and parts of multilinestrings do. */
+static SedonaErrorCode read_wkb_linear_segment(WkbReader *r, int swap, int dims,
+                                               int write_count,
+                                               SedonaSink *sink) {
+  uint32_t num_coords = 0;
+  SedonaErrorCode err = wkb_read_u32(r, swap, &num_coords);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (write_count && (err = sink_int(sink, num_coords)) != SEDONA_SUCCESS) {
+    return err;
+  }
+  return sink_coords(r, swap, dims, num_coords, sink);
+}
+
+static SedonaErrorCode read_wkb_polygon_body(WkbReader *r, int swap, int dims,
+                                             SedonaSink *sink) {
+  uint32_t num_rings = 0;
+  SedonaErrorCode err = wkb_read_u32(r, swap, &num_rings);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  /* Each ring takes at least 4 bytes */
+  if ((size_t)(r->end - r->p) / 4 < num_rings) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  if ((err = sink_int(sink, num_rings)) != SEDONA_SUCCESS) {
+    return err;
+  }
+  for (uint32_t k = 0; k < num_rings; k++) {
+    err = read_wkb_linear_segment(r, swap, dims, 1, sink);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+static int is_nan_point(const WkbReader *r, int swap) {
+  uint64_t bits[2];
+  double xy[2];
+  if (r->end - r->p < 16) {
+    return 0;
+  }
+  memcpy(bits, r->p, 16);
+  if (swap) {
+    bits[0] = swap_u64(bits[0]);
+    bits[1] = swap_u64(bits[1]);
+  }
+  memcpy(xy, bits, 16);
+  return isnan(xy[0]) && isnan(xy[1]);
+}
+
+static SedonaErrorCode read_wkb_body(WkbReader *r, const WkbHeader *header,
+                                     SedonaSink *sink) {
+  int swap = header->swap;
+  int dims = 2 + header->has_z + header->has_m;
+  SedonaErrorCode err = SEDONA_SUCCESS;
+  uint32_t num_parts = 0;
+  switch (header->geom_type) {
+    case POINT:
+      /* Points with NaN coordinates are empty points */
+      if (is_nan_point(r, swap)) {
+        if ((size_t)(r->end - r->p) < (size_t)dims * 8) {
+          return SEDONA_INCOMPLETE_BUFFER;
+        }
+        r->p += dims * 8;
+        return SEDONA_SUCCESS;
+      }
+      return sink_coords(r, swap, dims, 1, sink);
+    case LINESTRING:
+      return read_wkb_linear_segment(r, swap, dims, 0, sink);
+    case POLYGON:
+      return read_wkb_polygon_body(r, swap, dims, sink);
+    default:
+      break;
+  }
+
+  if ((err = wkb_read_u32(r, swap, &num_parts)) != SEDONA_SUCCESS) {
+    return err;
+  }
+  /* Each part takes at least 9 bytes */
+  if ((size_t)(r->end - r->p) / 9 < num_parts) {
+    return SEDONA_INCOMPLETE_BUFFER;
+  }
+  if (header->geom_type != MULTIPOINT &&
+      (err = sink_int(sink, num_parts)) != SEDONA_SUCCESS) {
+    return err;
+  }
+  for (uint32_t k = 0; k < num_parts; k++) {
+    int part_swap = 0;
+    switch (header->geom_type) {
+      case MULTIPOINT:
+        /* Empty points in multipoints are kept as NaN coordinates */
+        err = wkb_read_part_header(r, header, POINT, &part_swap);
+        if (err == SEDONA_SUCCESS) {
+          err = sink_coords(r, part_swap, dims, 1, sink);
+        }
+        break;
+      case MULTILINESTRING:
+        err = wkb_read_part_header(r, header, LINESTRING, &part_swap);
+        if (err == SEDONA_SUCCESS) {
+          err = read_wkb_linear_segment(r, part_swap, dims, 1, sink);
+        }
+        break;
+      case MULTIPOLYGON:
+        err = wkb_read_part_header(r, header, POLYGON, &part_swap);
+        if (err == SEDONA_SUCCESS) {
+          err = read_wkb_polygon_body(r, part_swap, dims, sink);
+        }
+        break;
+      default:
+        return SEDONA_UNKNOWN_GEOM_TYPE;
+    }
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+  }
+  return SEDONA_SUCCESS;
+}
+
+/* Convert the WKB geometry at r to serialized geometry. Only computes the
+ * size of serialized geometry when buf is NULL. Geometries without SRID
+ * inherit the SRID of their parent collection, the same as serialize(). */
+static SedonaErrorCode read_wkb_geom(WkbReader *r, int parent_srid, int depth,
+                                     char *buf, int buf_capacity,
+                                     int *p_buf_size) {
+  WkbHeader header;
+  SedonaErrorCode err = wkb_read_header(r, &header);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+  if (header.srid == 0) {
+    header.srid = parent_srid;
+  }
+
+  if (header.geom_type == GEOMETRYCOLLECTION) {
+    if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+      return SEDONA_BAD_GEOM_BUFFER;
+    }
+    uint32_t num_geoms = 0;
+    if ((err = wkb_read_u32(r, header.swap, &num_geoms)) != SEDONA_SUCCESS) {
+      return err;
+    }
+    if ((size_t)(r->end - r->p) / 9 < num_geoms) {
+      return SEDONA_INCOMPLETE_BUFFER;
+    }
+    if (buf != NULL) {
+      if (buf_capacity < 8) {
+        return SEDONA_BUFFER_TOO_SMALL;
+      }
+      write_buffer_header(buf, GEOMETRYCOLLECTION, XY, header.srid,
+                          (int)num_geoms);
+    }
+    int64_t offset = 8;
+    for (uint32_t k = 0; k < num_geoms; k++) {
+      int child_size = 0;
+      char *child_buf = (buf != NULL ? buf + offset : NULL);
+      int child_capacity = (buf != NULL ? buf_capacity - (int)offset : 0);
+      err = read_wkb_geom(r, header.srid, depth + 1, child_buf,
+                          child_capacity, &child_size);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+      int padded_size = aligned_offset(child_size);
+      if (buf != NULL) {
+        if (child_capacity < padded_size) {
+          return SEDONA_BUFFER_TOO_SMALL;
+        }
+        memset(child_buf + child_size, 0, padded_size - child_size);
+      }
+      offset += padded_size;
+      if (offset > INT32_MAX) {
+        return SEDONA_BAD_GEOM_BUFFER;
+      }
+    }
+    *p_buf_size = (int)offset;
+    return SEDONA_SUCCESS;
+  }
+
+  /* First pass: count coordinates and structural integers */
+  WkbReader body = *r;
+  SedonaSink counter = {NULL, 0, 0};
+  err = read_wkb_body(&body, &header, &counter);
+  if (err != SEDONA_SUCCESS) {
+    return err;
+  }
+
+  /* Empty polygons do not have any structural integer */
+  int num_ints = counter.num_ints;
+  if (header.geom_type == POLYGON && counter.num_coords == 0) {
+    num_ints = 0;
+  }
+  CoordinateSequenceInfo cs_info;
+  coord_seq_info_init(&cs_info, header.has_z, header.has_m,
+                      counter.num_coords);
+  int buf_size = geom_buf_size(&cs_info, num_ints);
+
+  /* Second pass: write coordinates and integers into the serialized buffer */
+  if (buf != NULL) {
+    if (buf_capacity < buf_size) {
+      return SEDONA_BUFFER_TOO_SMALL;
+    }
+    GeomBuffer geom_buf;
+    geom_buf_init_with_buffer(&geom_buf, buf, header.geom_type, header.srid,
+                              &cs_info, num_ints);
+    if (num_ints != counter.num_ints) {
+      *r = body;
+    } else {
+      SedonaSink writer = {&geom_buf, 0, 0};
+      err = read_wkb_body(r, &header, &writer);
+      if (err != SEDONA_SUCCESS) {
+        return err;
+      }
+    }
+  } else {
+    *r = body;
+  }
+
+  *p_buf_size = buf_size;
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_wkb_serialized_size(const char *wkb, int wkb_size,
+                                           int *p_buf_size) {
+  WkbReader r = {(const unsigned char *)wkb,
+                 (const unsigned char *)wkb + wkb_size};
+  return read_wkb_geom(&r, 0, 0, NULL, 0, p_buf_size);
+}
+
+SedonaErrorCode wkb_to_sedona(const char *wkb, int wkb_size, char *buf,
+                              int buf_capacity, int *p_buf_size) {
+  WkbReader r = {(const unsigned char *)wkb,
+                 (const unsigned char *)wkb + wkb_size};
+  return read_wkb_geom(&r, 0, 0, buf, buf_capacity, p_buf_size);
+}
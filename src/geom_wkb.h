@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GEOM_WKB
+#define GEOM_WKB
+
+#include "geomserde.h"
+
+/* Transcoding between serialized geometries and WKB/EWKB without constructing
+ * GEOS geometries. Coordinates of the serialized format are stored ahead of
+ * the structural integers, while WKB interleaves them, so the conversion is a
+ * simple walk over both regions of the serialized buffer. */
+
+/* Byte orders of WKB */
+#define SEDONA_WKB_XDR 0 /* big endian */
+#define SEDONA_WKB_NDR 1 /* little endian */
+
+/**
+ * Computes the size of the WKB representation of a serialized geometry
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param include_srid whether to write EWKB with SRID when the geometry has a
+ * non-zero SRID
+ * @param p_wkb_size OUTPUT parameter for receiving size of WKB
+ * @return error code
+ */
+SedonaErrorCode sedona_wkb_size(const char *buf, int buf_size,
+                                int include_srid, int *p_wkb_size);
+
+/**
+ * Converts a serialized geometry to WKB. Z and M dimensions and SRIDs are
+ * written using the EWKB flavor, which is the default of GEOS and PostGIS.
+ * Empty points are written as points with NaN coordinates.
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param byte_order SEDONA_WKB_NDR or SEDONA_WKB_XDR
+ * @param include_srid whether to write EWKB with SRID when the geometry has a
+ * non-zero SRID
+ * @param wkb buffer for writing WKB into
+ * @param wkb_capacity size of wkb, SEDONA_BUFFER_TOO_SMALL will be returned if
+ * it is not large enough
+ * @param p_wkb_size OUTPUT parameter for receiving number of bytes written
+ * @return error code
+ */
+SedonaErrorCode sedona_to_wkb(const char *buf, int buf_size, int byte_order,
+                              int include_srid, char *wkb, int wkb_capacity,
+                              int *p_wkb_size);
+
+/**
+ * Computes the size of the serialized geometry converted from WKB
+ *
+ * @param wkb buffer containing WKB or EWKB of either byte order
+ * @param wkb_size size of the WKB buffer
+ * @param p_buf_size OUTPUT parameter for receiving size of the serialized
+ * geometry
+ * @return error code
+ */
+SedonaErrorCode sedona_wkb_serialized_size(const char *wkb, int wkb_size,
+                                           int *p_buf_size);
+
+/**
+ * Converts WKB or EWKB of either byte order to a serialized geometry. Both
+ * ISO (1000/2000/3000 offsets) and EWKB (high bits) dimension flags are
+ * accepted. Points with NaN coordinates are treated as empty points.
+ *
+ * @param wkb buffer containing WKB or EWKB
+ * @param wkb_size size of the WKB buffer
+ * @param buf buffer for writing the serialized geometry into
+ * @param buf_capacity size of buf, SEDONA_BUFFER_TOO_SMALL will be returned
+ * if it is not large enough
+ * @param p_buf_size OUTPUT parameter for receiving number of bytes written
+ * @return error code
+ */
+SedonaErrorCode wkb_to_sedona(const char *wkb, int wkb_size, char *buf,
+                              int buf_capacity, int *p_buf_size);
+
+#endif /* GEOM_WKB */
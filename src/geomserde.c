@@ -25,39 +25,59 @@
 
 #include "geom_buf.h"
 #include "geos_c_dyn.h"
+#include "scratch_arena.h"
+#include "sedona_probes.h"
+#include "serde_alloc.h"
+#include "serde_stats.h"
+
+static inline int aligned_offset(int offset) { return (offset + 7) & ~7; }
+
+/*
+ * Serialization is done in 2 passes: the first pass computes the layout of
+ * the serialized geometry, which determines the exact size of the serialized
+ * buffer, the second pass writes the geometry into a buffer of that size.
+ * This makes it possible to serialize geometries into buffers provided by the
+ * caller, such as Python bytes objects or a contiguous buffer holding a batch
+ * of geometries.
+ *
+ * Layouts of child geometries of collections are kept in the scratch arena
+ * and reused by the second pass, so callers computing layouts should be in a
+ * scratch scope.
+ */
+typedef struct SerializationLayout {
+  int geos_type_id;
+  int srid;
+  /* For geometry collections, cs_info.num_coords is the number of child
+   * geometries and other fields of cs_info are unused. */
+  CoordinateSequenceInfo cs_info;
+  int num_ints;
+  int buf_size;
+  /* Layouts of child geometries, only for geometry collections */
+  struct SerializationLayout *children;
+} SerializationLayout;
+
+static SedonaErrorCode get_serialization_layout(GEOSContextHandle_t handle,
+                                                const GEOSGeometry *geom,
+                                                int depth,
+                                                SerializationLayout *layout);
+
+static SedonaErrorCode serialize_geom_with_layout(
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    const SerializationLayout *layout, char *buf);
 
 static SedonaErrorCode sedona_serialize_point(GEOSContextHandle_t handle,
                                               const GEOSGeometry *geom,
-                                              int srid,
                                               CoordinateSequenceInfo *cs_info,
-                                              char **p_buf, int *p_buf_size) {
-  if (cs_info->total_bytes == 0) {
-    RETURN_BUFFER_FOR_EMPTY_GEOM(POINT, cs_info->coord_type, srid);
+                                              GeomBuffer *geom_buf) {
+  if (cs_info->num_coords == 0) {
+    return SEDONA_SUCCESS;
   }
 
   const GEOSCoordSequence *coord_seq = dyn_GEOSGeom_getCoordSeq_r(handle, geom);
   if (coord_seq == NULL) {
     return SEDONA_GEOS_ERROR;
   }
-
-  GeomBuffer geom_buf;
-  SedonaErrorCode err = geom_buf_alloc(&geom_buf, POINT, srid, cs_info, 0);
-  if (err != SEDONA_SUCCESS) {
-    return err;
-  }
-
-  err = geom_buf_write_coords(&geom_buf, handle, coord_seq, cs_info);
-  if (err != SEDONA_SUCCESS) {
-    goto handle_error;
-  }
-
-  *p_buf = geom_buf.buf;
-  *p_buf_size = geom_buf.buf_size;
-  return SEDONA_SUCCESS;
-
-handle_error:
-  free(geom_buf.buf);
-  return SEDONA_GEOS_ERROR;
+  return geom_buf_write_coords(geom_buf, handle, coord_seq, cs_info);
 }
 
 static SedonaErrorCode sedona_deserialize_point(GEOSContextHandle_t handle,
@@ -71,7 +91,10 @@ static SedonaErrorCode sedona_deserialize_point(GEOSContextHandle_t handle,
     /* fast path for 2D points */
     double x = *geom_buf->buf_coord++;
     double y = *geom_buf->buf_coord++;
+    int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
     geom = dyn_GEOSGeom_createPointFromXY_r(handle, x, y);
+    serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
+    SERDE_STATS_ADD(deserialized_coords, 1);
   } else {
     GEOSCoordSequence *coord_seq = NULL;
     SedonaErrorCode err =
@@ -79,11 +102,12 @@ static SedonaErrorCode sedona_deserialize_point(GEOSContextHandle_t handle,
     if (err != SEDONA_SUCCESS) {
       return err;
     }
+    int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
     geom = dyn_GEOSGeom_createPoint_r(handle, coord_seq);
     if (geom == NULL) {
-      dyn_GEOSCoordSeq_destroy_r(handle, coord_seq);
       return SEDONA_GEOS_ERROR;
     }
+    serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
   }
 
   *p_geom = geom;
@@ -91,32 +115,17 @@ static SedonaErrorCode sedona_deserialize_point(GEOSContextHandle_t handle,
 }
 
 static SedonaErrorCode sedona_serialize_linestring(
-    GEOSContextHandle_t handle, const GEOSGeometry *geom, int srid,
-    CoordinateSequenceInfo *cs_info, char **p_buf, int *p_buf_size) {
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    CoordinateSequenceInfo *cs_info, GeomBuffer *geom_buf) {
   if (cs_info->num_coords == 0) {
-    RETURN_BUFFER_FOR_EMPTY_GEOM(LINESTRING, cs_info->coord_type, srid);
+    return SEDONA_SUCCESS;
   }
 
   const GEOSCoordSequence *coord_seq = dyn_GEOSGeom_getCoordSeq_r(handle, geom);
   if (coord_seq == NULL) {
     return SEDONA_GEOS_ERROR;
   }
-
-  GeomBuffer geom_buf;
-  SedonaErrorCode err = geom_buf_alloc(&geom_buf, LINESTRING, srid, cs_info, 0);
-  if (err != SEDONA_SUCCESS) {
-    return err;
-  }
-
-  err = geom_buf_write_coords(&geom_buf, handle, coord_seq, cs_info);
-  if (err != SEDONA_SUCCESS) {
-    free(geom_buf.buf);
-    return err;
-  }
-
-  *p_buf = geom_buf.buf;
-  *p_buf_size = geom_buf.buf_size;
-  return SEDONA_SUCCESS;
+  return geom_buf_write_coords(geom_buf, handle, coord_seq, cs_info);
 }
 
 static SedonaErrorCode sedona_deserialize_linestring(
@@ -138,11 +147,12 @@ static SedonaErrorCode sedona_deserialize_linestring(
     return err;
   }
 
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   GEOSGeometry *geom = dyn_GEOSGeom_createLineString_r(handle, coord_seq);
   if (geom == NULL) {
-    dyn_GEOSCoordSeq_destroy_r(handle, coord_seq);
     return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
   *p_geom = geom;
   return SEDONA_SUCCESS;
@@ -150,35 +160,12 @@ static SedonaErrorCode sedona_deserialize_linestring(
 
 static SedonaErrorCode sedona_serialize_polygon(GEOSContextHandle_t handle,
                                                 const GEOSGeometry *geom,
-                                                int srid,
                                                 CoordinateSequenceInfo *cs_info,
-                                                char **p_buf, int *p_buf_size) {
+                                                GeomBuffer *geom_buf) {
   if (cs_info->num_coords == 0) {
-    RETURN_BUFFER_FOR_EMPTY_GEOM(POLYGON, cs_info->coord_type, srid);
-  }
-
-  int num_interior_rings = dyn_GEOSGetNumInteriorRings_r(handle, geom);
-  if (num_interior_rings == -1) {
-    return SEDONA_GEOS_ERROR;
-  }
-
-  GeomBuffer geom_buf;
-  int num_rings = num_interior_rings + 1;
-  SedonaErrorCode err =
-      geom_buf_alloc(&geom_buf, POLYGON, srid, cs_info, num_rings + 1);
-  if (err != SEDONA_SUCCESS) {
-    return err;
-  }
-
-  err = geom_buf_write_polygon(&geom_buf, handle, geom, cs_info);
-  if (err != SEDONA_SUCCESS) {
-    free(geom_buf.buf);
-    return err;
+    return SEDONA_SUCCESS;
   }
-
-  *p_buf = geom_buf.buf;
-  *p_buf_size = geom_buf.buf_size;
-  return SEDONA_SUCCESS;
+  return geom_buf_write_polygon(geom_buf, handle, geom, cs_info);
 }
 
 static SedonaErrorCode sedona_deserialize_polygon(
@@ -196,84 +183,67 @@ static SedonaErrorCode sedona_deserialize_polygon(
 }
 
 static SedonaErrorCode sedona_serialize_multipoint(
-    GEOSContextHandle_t handle, const GEOSGeometry *geom, int srid,
-    CoordinateSequenceInfo *cs_info, char **p_buf, int *p_buf_size) {
-  int num_points = dyn_GEOSGetNumGeometries_r(handle, geom);
-  if (num_points == -1) {
-    return SEDONA_GEOS_ERROR;
-  }
-
-  /* cs_info->num_coords will be smaller than actual number of serialized
-   * coordinates when there're empty points in the multipoint, so let's fix
-   * it. */
-  cs_info->num_coords = num_points;
-
-  GeomBuffer geom_buf;
-  SedonaErrorCode err = geom_buf_alloc(&geom_buf, MULTIPOINT, srid, cs_info, 0);
-  if (err != SEDONA_SUCCESS) {
-    return err;
-  }
-
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    CoordinateSequenceInfo *cs_info, GeomBuffer *geom_buf) {
+  int num_points = cs_info->num_coords;
   for (int k = 0; k < num_points; k++) {
     const GEOSGeometry *point = dyn_GEOSGetGeometryN_r(handle, geom, k);
     if (point == NULL) {
-      err = SEDONA_GEOS_ERROR;
-      goto handle_error;
+      return SEDONA_GEOS_ERROR;
     }
 
     const GEOSCoordSequence *coord_seq =
         dyn_GEOSGeom_getCoordSeq_r(handle, point);
     if (coord_seq == NULL) {
-      err = SEDONA_GEOS_ERROR;
-      goto handle_error;
+      return SEDONA_GEOS_ERROR;
     }
 
     /* check if this point is empty */
     unsigned int num_coords = 0;
     if (dyn_GEOSCoordSeq_getSize_r(handle, coord_seq, &num_coords) == 0) {
-      err = SEDONA_GEOS_ERROR;
-      goto handle_error;
+      return SEDONA_GEOS_ERROR;
     }
 
     if (num_coords == 1) {
       /* non-empty point */
       cs_info->num_coords = 1;
-      err = geom_buf_write_coords(&geom_buf, handle, coord_seq, cs_info);
+      SedonaErrorCode err =
+          geom_buf_write_coords(geom_buf, handle, coord_seq, cs_info);
       if (err != SEDONA_SUCCESS) {
-        goto handle_error;
+        return err;
       }
     } else {
       /* point is empty, we have to manually write NaNs */
-      *geom_buf.buf_coord++ = NAN;
-      *geom_buf.buf_coord++ = NAN;
+      if (geom_buf->buf_coord + cs_info->dims > geom_buf->buf_coord_end) {
+        return SEDONA_INTERNAL_ERROR;
+      }
+      *geom_buf->buf_coord++ = NAN;
+      *geom_buf->buf_coord++ = NAN;
       if (cs_info->has_z) {
-        *geom_buf.buf_coord++ = NAN;
+        *geom_buf->buf_coord++ = NAN;
       }
       if (cs_info->has_m) {
-        *geom_buf.buf_coord++ = NAN;
+        *geom_buf->buf_coord++ = NAN;
       }
     }
   }
-
-  *p_buf = geom_buf.buf;
-  *p_buf_size = geom_buf.buf_size;
   return SEDONA_SUCCESS;
-
-handle_error:
-  free(geom_buf.buf);
-  return err;
 }
 
 static SedonaErrorCode sedona_deserialize_multipoint(
     GEOSContextHandle_t handle, int srid, GeomBuffer *geom_buf,
     CoordinateSequenceInfo *cs_info, GEOSGeometry **p_geom) {
   int num_points = cs_info->num_coords;
-  GEOSGeometry **points = calloc(num_points, sizeof(GEOSGeometry *));
+  GEOSGeometry **points =
+      scratch_arena_calloc(num_points, sizeof(GEOSGeometry *));
   if (points == NULL) {
     return SEDONA_ALLOC_ERROR;
   }
 
   SedonaErrorCode err = SEDONA_SUCCESS;
+  if (cs_info->dims == 2) {
+    SERDE_STATS_ADD(deserialized_coords, num_points);
+  }
   for (int k = 0; k < num_points; k++) {
     GEOSGeometry *point = NULL;
     if (cs_info->dims == 2) {
@@ -298,7 +268,6 @@ static SedonaErrorCode sedona_deserialize_multipoint(
       }
       point = dyn_GEOSGeom_createPoint_r(handle, coord_seq);
       if (point == NULL) {
-        dyn_GEOSCoordSeq_destroy_r(handle, coord_seq);
         err = SEDONA_GEOS_ERROR;
         goto handle_error;
       }
@@ -306,14 +275,15 @@ static SedonaErrorCode sedona_deserialize_multipoint(
     points[k] = point;
   }
 
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   GEOSGeometry *geom = dyn_GEOSGeom_createCollection_r(handle, GEOS_MULTIPOINT,
                                                        points, num_points);
   if (geom == NULL) {
-    err = SEDONA_GEOS_ERROR;
-    goto handle_error;
+    /* Child geometries are owned by GEOS even if the construction failed */
+    return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
-  free(points);
   *p_geom = geom;
   return SEDONA_SUCCESS;
 
@@ -323,43 +293,29 @@ handle_error:
 }
 
 static SedonaErrorCode sedona_serialize_multilinestring(
-    GEOSContextHandle_t handle, const GEOSGeometry *geom, int srid,
-    CoordinateSequenceInfo *cs_info, char **p_buf, int *p_buf_size) {
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    CoordinateSequenceInfo *cs_info, GeomBuffer *geom_buf) {
   int num_geoms = dyn_GEOSGetNumGeometries_r(handle, geom);
   if (num_geoms == -1) {
     return SEDONA_GEOS_ERROR;
   }
 
-  GeomBuffer geom_buf;
-  SedonaErrorCode err =
-      geom_buf_alloc(&geom_buf, MULTILINESTRING, srid, cs_info, num_geoms + 1);
+  SedonaErrorCode err = geom_buf_write_int(geom_buf, num_geoms);
   if (err != SEDONA_SUCCESS) {
     return err;
   }
-
-  if ((err = geom_buf_write_int(&geom_buf, num_geoms)) != SEDONA_SUCCESS) {
-    return err;
-  }
   for (int k = 0; k < num_geoms; k++) {
     const GEOSGeometry *linestring = dyn_GEOSGetGeometryN_r(handle, geom, k);
     if (linestring == NULL) {
-      err = SEDONA_GEOS_ERROR;
-      goto handle_error;
+      return SEDONA_GEOS_ERROR;
     }
 
-    err = geom_buf_write_linear_segment(&geom_buf, handle, linestring, cs_info);
+    err = geom_buf_write_linear_segment(geom_buf, handle, linestring, cs_info);
     if (err != SEDONA_SUCCESS) {
-      goto handle_error;
+      return err;
     }
   }
-
-  *p_buf = geom_buf.buf;
-  *p_buf_size = geom_buf.buf_size;
   return SEDONA_SUCCESS;
-
-handle_error:
-  free(geom_buf.buf);
-  return err;
 }
 
 static SedonaErrorCode sedona_deserialize_multilinestring(
@@ -371,7 +327,11 @@ static SedonaErrorCode sedona_deserialize_multilinestring(
     return err;
   }
 
-  GEOSGeometry **linestrings = calloc(num_geoms, sizeof(GEOSGeometry *));
+  GEOSGeometry **linestrings =
+      scratch_arena_calloc(num_geoms, sizeof(GEOSGeometry *));
+  if (linestrings == NULL) {
+    return SEDONA_ALLOC_ERROR;
+  }
   for (int k = 0; k < num_geoms; k++) {
     GEOSGeometry *linestring = NULL;
     if ((err = geom_buf_read_linear_segment(geom_buf, handle, cs_info,
@@ -382,14 +342,15 @@ static SedonaErrorCode sedona_deserialize_multilinestring(
     linestrings[k] = linestring;
   }
 
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   GEOSGeometry *geom = dyn_GEOSGeom_createCollection_r(
       handle, GEOS_MULTILINESTRING, linestrings, num_geoms);
   if (geom == NULL) {
-    err = SEDONA_GEOS_ERROR;
-    goto handle_error;
+    /* Child geometries are owned by GEOS even if the construction failed */
+    return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
-  free(linestrings);
   *p_geom = geom;
   return SEDONA_SUCCESS;
 
@@ -399,65 +360,29 @@ handle_error:
 }
 
 static SedonaErrorCode sedona_serialize_multipolygon(
-    GEOSContextHandle_t handle, const GEOSGeometry *geom, int srid,
-    CoordinateSequenceInfo *cs_info, char **p_buf, int *p_buf_size) {
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    CoordinateSequenceInfo *cs_info, GeomBuffer *geom_buf) {
   int num_geoms = dyn_GEOSGetNumGeometries_r(handle, geom);
   if (num_geoms == -1) {
     return SEDONA_GEOS_ERROR;
   }
 
-  /* collect size of structural data */
-  int num_rings = 0;
-  for (int k = 0; k < num_geoms; k++) {
-    const GEOSGeometry *polygon = dyn_GEOSGetGeometryN_r(handle, geom, k);
-    if (polygon == NULL) {
-      return SEDONA_GEOS_ERROR;
-    }
-    int num_interior_rings = dyn_GEOSGetNumInteriorRings_r(handle, polygon);
-    if (num_interior_rings == -1) {
-      return SEDONA_GEOS_ERROR;
-    }
-    if (num_interior_rings > 0) {
-      num_rings += (num_interior_rings + 1);
-    } else {
-      /* check if polygon is empty */
-      char is_empty = dyn_GEOSisEmpty_r(handle, polygon);
-      if (is_empty == 2) {
-        return SEDONA_GEOS_ERROR;
-      }
-      num_rings += (is_empty == 1 ? 0 : 1);
-    }
-  }
-
-  GeomBuffer geom_buf;
-  SedonaErrorCode err = geom_buf_alloc(&geom_buf, MULTIPOLYGON, srid, cs_info,
-                                       1 + num_geoms + num_rings);
+  SedonaErrorCode err = geom_buf_write_int(geom_buf, num_geoms);
   if (err != SEDONA_SUCCESS) {
     return err;
   }
-  if ((err = geom_buf_write_int(&geom_buf, num_geoms)) != SEDONA_SUCCESS) {
-    return err;
-  }
   for (int k = 0; k < num_geoms; k++) {
     const GEOSGeometry *polygon = dyn_GEOSGetGeometryN_r(handle, geom, k);
     if (polygon == NULL) {
-      err = SEDONA_GEOS_ERROR;
-      goto handle_error;
+      return SEDONA_GEOS_ERROR;
     }
 
-    if ((err = geom_buf_write_polygon(&geom_buf, handle, polygon, cs_info)) !=
-        SEDONA_SUCCESS) {
-      goto handle_error;
+    err = geom_buf_write_polygon(geom_buf, handle, polygon, cs_info);
+    if (err != SEDONA_SUCCESS) {
+      return err;
     }
   }
-
-  *p_buf = geom_buf.buf;
-  *p_buf_size = geom_buf.buf_size;
   return SEDONA_SUCCESS;
-
-handle_error:
-  free(geom_buf.buf);
-  return err;
 }
 
 static SedonaErrorCode sedona_deserialize_multipolygon(
@@ -469,7 +394,11 @@ static SedonaErrorCode sedona_deserialize_multipolygon(
     return err;
   }
 
-  GEOSGeometry **polygons = calloc(num_geoms, sizeof(GEOSGeometry *));
+  GEOSGeometry **polygons =
+      scratch_arena_calloc(num_geoms, sizeof(GEOSGeometry *));
+  if (polygons == NULL) {
+    return SEDONA_ALLOC_ERROR;
+  }
   for (int k = 0; k < num_geoms; k++) {
     GEOSGeometry *polygon = NULL;
     if ((err = geom_buf_read_polygon(geom_buf, handle, cs_info, &polygon)) !=
@@ -479,14 +408,15 @@ static SedonaErrorCode sedona_deserialize_multipolygon(
     polygons[k] = polygon;
   }
 
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   GEOSGeometry *geom = dyn_GEOSGeom_createCollection_r(handle, MULTIPOLYGON,
                                                        polygons, num_geoms);
   if (geom == NULL) {
-    err = SEDONA_GEOS_ERROR;
-    goto handle_error;
+    /* Child geometries are owned by GEOS even if the construction failed */
+    return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
-  free(polygons);
   *p_geom = geom;
   return SEDONA_SUCCESS;
 
@@ -495,88 +425,104 @@ handle_error:
   return err;
 }
 
-static inline int aligned_offset(int offset) { return (offset + 7) & ~7; }
-
-static SedonaErrorCode sedona_serialize_geometrycollection(
-    GEOSContextHandle_t handle, const GEOSGeometry *geom, int srid,
-    char **p_buf, int *p_buf_size) {
+static SedonaErrorCode get_geometrycollection_layout(
+    GEOSContextHandle_t handle, const GEOSGeometry *geom, int depth,
+    SerializationLayout *layout) {
+  /* Deeper geometries could not be deserialized */
+  if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
   int num_geoms = dyn_GEOSGetNumGeometries_r(handle, geom);
   if (num_geoms == -1) {
     return SEDONA_GEOS_ERROR;
   }
-  int total_size = 8;
-  unsigned char *scratch = calloc(num_geoms, sizeof(char *) + sizeof(int));
-  if (scratch == NULL) {
-    return SEDONA_ALLOC_ERROR;
+
+  SerializationLayout *children = NULL;
+  if (num_geoms > 0) {
+    children = scratch_arena_calloc(num_geoms, sizeof(SerializationLayout));
+    if (children == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
   }
-  char **geom_bufs = (char **) scratch;
-  int *geom_buf_sizes = (int *)(scratch + num_geoms * sizeof(char *));
-  SedonaErrorCode err = SEDONA_SUCCESS;
 
-  /* Serialize geometries individually */
+  int total_size = 8;
   for (int k = 0; k < num_geoms; k++) {
     const GEOSGeometry *child_geom = dyn_GEOSGetGeometryN_r(handle, geom, k);
     if (child_geom == NULL) {
-      err = SEDONA_GEOS_ERROR;
-      goto handle_error;
+      return SEDONA_GEOS_ERROR;
     }
-
-    char *buf = NULL;
-    int buf_size = 0;
-    err = sedona_serialize_geom(handle, child_geom, &buf, &buf_size);
+    SedonaErrorCode err =
+        get_serialization_layout(handle, child_geom, depth + 1, &children[k]);
     if (err != SEDONA_SUCCESS) {
-      goto handle_error;
+      return err;
     }
-    geom_bufs[k] = buf;
-    geom_buf_sizes[k] = buf_size;
-    total_size += aligned_offset(buf_size);
+    total_size += aligned_offset(children[k].buf_size);
   }
 
-  char *buf = alloc_buffer_for_geom(GEOMETRYCOLLECTION, XY, srid, total_size,
-                                    num_geoms);
-  if (buf == NULL) {
-    err = SEDONA_ALLOC_ERROR;
-    goto handle_error;
-  }
+  memset(&layout->cs_info, 0, sizeof(CoordinateSequenceInfo));
+  layout->cs_info.coord_type = XY;
+  layout->cs_info.num_coords = num_geoms;
+  layout->num_ints = 0;
+  layout->buf_size = total_size;
+  layout->children = children;
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode sedona_serialize_geometrycollection(
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    const SerializationLayout *layout, char *buf) {
+  int num_geoms = layout->cs_info.num_coords;
+  write_buffer_header(buf, GEOMETRYCOLLECTION, XY, layout->srid, num_geoms);
 
+  /* Serialize child geometries directly into their 8-byte aligned slots */
   char *p_next_geom = buf + 8;
+  char *p_end = buf + layout->buf_size;
   for (int k = 0; k < num_geoms; k++) {
-    int buf_size = geom_buf_sizes[k];
-    memcpy(p_next_geom, geom_bufs[k], buf_size);
-    free(geom_bufs[k]);
-    int padding_size = aligned_offset(buf_size) - buf_size;
-    p_next_geom += buf_size;
-    if (padding_size > 0) {
-      memset(p_next_geom, 0, padding_size);
-      p_next_geom += padding_size;
+    const GEOSGeometry *child_geom = dyn_GEOSGetGeometryN_r(handle, geom, k);
+    if (child_geom == NULL) {
+      return SEDONA_GEOS_ERROR;
+    }
+
+    const SerializationLayout *child_layout = &layout->children[k];
+    int child_buf_size = child_layout->buf_size;
+    int padded_size = aligned_offset(child_buf_size);
+    if (p_end - p_next_geom < padded_size) {
+      return SEDONA_INTERNAL_ERROR;
     }
+    SedonaErrorCode err = serialize_geom_with_layout(
+        handle, child_geom, child_layout, p_next_geom);
+    if (err != SEDONA_SUCCESS) {
+      return err;
+    }
+    memset(p_next_geom + child_buf_size, 0, padded_size - child_buf_size);
+    p_next_geom += padded_size;
   }
 
-  free(scratch);
-  *p_buf = buf;
-  *p_buf_size = total_size;
   return SEDONA_SUCCESS;
-
-handle_error:
-  for (int k = 0; k < num_geoms; k++) {
-    free(geom_bufs[k]);
-  }
-  free(scratch);
-  return err;
 }
 
 static SedonaErrorCode deserialize_geom_buf(GEOSContextHandle_t handle,
                                             GeometryTypeId geom_type_id,
-                                            int srid, GeomBuffer *geom_buf,
+                                            int srid, int depth,
+                                            GeomBuffer *geom_buf,
                                             CoordinateSequenceInfo *cs_info,
                                             GEOSGeometry **p_geom);
 
+static SedonaErrorCode deserialize_geom(GEOSContextHandle_t handle,
+                                        const char *buf, int buf_size,
+                                        int depth, GEOSGeometry **p_geom,
+                                        int *p_bytes_read);
+
 static SedonaErrorCode sedona_deserialize_geometrycollection(
-    GEOSContextHandle_t handle, int srid, GeomBuffer *geom_buf,
+    GEOSContextHandle_t handle, int srid, int depth, GeomBuffer *geom_buf,
     CoordinateSequenceInfo *cs_info, GEOSGeometry **p_geom) {
+  if (depth >= SEDONA_MAX_NESTING_DEPTH) {
+    return SEDONA_BAD_GEOM_BUFFER;
+  }
   SedonaErrorCode err = SEDONA_SUCCESS;
   int num_geoms = cs_info->num_coords;
-  GEOSGeometry **child_geoms = calloc(num_geoms, sizeof(GEOSGeometry *));
+  GEOSGeometry **child_geoms =
+      scratch_arena_calloc(num_geoms, sizeof(GEOSGeometry *));
   if (child_geoms == NULL) {
     return SEDONA_ALLOC_ERROR;
   }
@@ -586,8 +532,8 @@ static SedonaErrorCode sedona_deserialize_geometrycollection(
   for (int k = 0; k < num_geoms; k++) {
     GEOSGeometry *child_geom = NULL;
     int bytes_read = 0;
-    err = sedona_deserialize_geom(handle, buf, remaining_size, &child_geom,
-                                  &bytes_read);
+    err = deserialize_geom(handle, buf, remaining_size, depth + 1,
+                           &child_geom, &bytes_read);
     if (err != SEDONA_SUCCESS) {
       goto handle_error;
     }
@@ -603,14 +549,15 @@ static SedonaErrorCode sedona_deserialize_geometrycollection(
     buf += bytes_read;
   }
 
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_GEOS_CONSTRUCT);
   GEOSGeometry *geom_collection = dyn_GEOSGeom_createCollection_r(
       handle, GEOS_GEOMETRYCOLLECTION, child_geoms, num_geoms);
   if (geom_collection == NULL) {
-    err = SEDONA_GEOS_ERROR;
-    goto handle_error;
+    /* Child geometries are owned by GEOS even if the construction failed */
+    return SEDONA_GEOS_ERROR;
   }
+  serde_stats_timer_end(SERDE_STAGE_GEOS_CONSTRUCT, timer);
 
-  free(child_geoms);
   *p_geom = geom_collection;
 
   /* set geom_buf.buf_int to mark the end of the buffer for this geometry
@@ -623,60 +570,240 @@ handle_error:
   return err;
 }
 
-SedonaErrorCode sedona_serialize_geom(GEOSContextHandle_t handle,
-                                      const GEOSGeometry *geom, char **p_buf,
-                                      int *p_buf_size) {
+static SedonaErrorCode get_serialization_layout(GEOSContextHandle_t handle,
+                                                const GEOSGeometry *geom,
+                                                int depth,
+                                                SerializationLayout *layout) {
   int srid = dyn_GEOSGetSRID_r(handle, geom);
   int geom_type_id = dyn_GEOSGeomTypeId_r(handle, geom);
+  layout->srid = srid;
+  layout->geos_type_id = geom_type_id;
+  layout->children = NULL;
   if (geom_type_id == GEOS_GEOMETRYCOLLECTION) {
-    return sedona_serialize_geometrycollection(handle, geom, srid, p_buf,
-                                               p_buf_size);
+    return get_geometrycollection_layout(handle, geom, depth, layout);
   }
 
-  CoordinateSequenceInfo cs_info;
-  SedonaErrorCode err = get_coord_seq_info_from_geom(handle, geom, &cs_info);
+  CoordinateSequenceInfo *cs_info = &layout->cs_info;
+  SedonaErrorCode err = get_coord_seq_info_from_geom(handle, geom, cs_info);
   if (err != SEDONA_SUCCESS) {
     return err;
   }
 
+  int num_ints = 0;
   switch (geom_type_id) {
     case GEOS_POINT:
-      err = sedona_serialize_point(handle, geom, srid, &cs_info, p_buf,
-                                   p_buf_size);
-      break;
     case GEOS_LINESTRING:
-      err = sedona_serialize_linestring(handle, geom, srid, &cs_info, p_buf,
-                                        p_buf_size);
       break;
     case GEOS_LINEARRING:
-      err = SEDONA_UNSUPPORTED_GEOM_TYPE;
+      return SEDONA_UNSUPPORTED_GEOM_TYPE;
+    case GEOS_POLYGON: {
+      if (cs_info->num_coords == 0) {
+        break;
+      }
+      int num_interior_rings = dyn_GEOSGetNumInteriorRings_r(handle, geom);
+      if (num_interior_rings == -1) {
+        return SEDONA_GEOS_ERROR;
+      }
+      /* number of rings, and number of coordinates of each ring */
+      num_ints = num_interior_rings + 2;
       break;
-    case GEOS_POLYGON:
-      err = sedona_serialize_polygon(handle, geom, srid, &cs_info, p_buf,
-                                     p_buf_size);
+    }
+    case GEOS_MULTIPOINT: {
+      int num_points = dyn_GEOSGetNumGeometries_r(handle, geom);
+      if (num_points == -1) {
+        return SEDONA_GEOS_ERROR;
+      }
+      /* cs_info->num_coords will be smaller than actual number of serialized
+       * coordinates when there're empty points in the multipoint, so let's
+       * fix it. */
+      cs_info->num_coords = num_points;
+      cs_info->total_bytes = num_points * cs_info->bytes_per_coord;
       break;
-    case GEOS_MULTIPOINT:
-      err = sedona_serialize_multipoint(handle, geom, srid, &cs_info, p_buf,
-                                        p_buf_size);
+    }
+    case GEOS_MULTILINESTRING: {
+      int num_geoms = dyn_GEOSGetNumGeometries_r(handle, geom);
+      if (num_geoms == -1) {
+        return SEDONA_GEOS_ERROR;
+      }
+      num_ints = num_geoms + 1;
       break;
-    case GEOS_MULTILINESTRING:
-      err = sedona_serialize_multilinestring(handle, geom, srid, &cs_info,
-                                             p_buf, p_buf_size);
+    }
+    case GEOS_MULTIPOLYGON: {
+      int num_geoms = dyn_GEOSGetNumGeometries_r(handle, geom);
+      if (num_geoms == -1) {
+        return SEDONA_GEOS_ERROR;
+      }
+
+      /* collect size of structural data */
+      int num_rings = 0;
+      for (int k = 0; k < num_geoms; k++) {
+        const GEOSGeometry *polygon = dyn_GEOSGetGeometryN_r(handle, geom, k);
+        if (polygon == NULL) {
+          return SEDONA_GEOS_ERROR;
+        }
+        int num_interior_rings = dyn_GEOSGetNumInteriorRings_r(handle, polygon);
+        if (num_interior_rings == -1) {
+          return SEDONA_GEOS_ERROR;
+        }
+        if (num_interior_rings > 0) {
+          num_rings += (num_interior_rings + 1);
+        } else {
+          /* check if polygon is empty */
+          char is_empty = dyn_GEOSisEmpty_r(handle, polygon);
+          if (is_empty == 2) {
+            return SEDONA_GEOS_ERROR;
+          }
+          num_rings += (is_empty == 1 ? 0 : 1);
+        }
+      }
+      num_ints = 1 + num_geoms + num_rings;
       break;
+    }
+    default:
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+
+  layout->num_ints = num_ints;
+  layout->buf_size = geom_buf_size(cs_info, num_ints);
+  return SEDONA_SUCCESS;
+}
+
+static SedonaErrorCode serialize_geom_with_layout(
+    GEOSContextHandle_t handle, const GEOSGeometry *geom,
+    const SerializationLayout *layout, char *buf) {
+  if (layout->geos_type_id == GEOS_GEOMETRYCOLLECTION) {
+    return sedona_serialize_geometrycollection(handle, geom, layout, buf);
+  }
+
+  /* serialization functions may modify cs_info, so we work on a copy */
+  CoordinateSequenceInfo cs_info = layout->cs_info;
+  GeomBuffer geom_buf;
+  switch (layout->geos_type_id) {
+    case GEOS_POINT:
+      geom_buf_init_with_buffer(&geom_buf, buf, POINT, layout->srid, &cs_info,
+                                layout->num_ints);
+      return sedona_serialize_point(handle, geom, &cs_info, &geom_buf);
+    case GEOS_LINESTRING:
+      geom_buf_init_with_buffer(&geom_buf, buf, LINESTRING, layout->srid,
+                                &cs_info, layout->num_ints);
+      return sedona_serialize_linestring(handle, geom, &cs_info, &geom_buf);
+    case GEOS_POLYGON:
+      geom_buf_init_with_buffer(&geom_buf, buf, POLYGON, layout->srid,
+                                &cs_info, layout->num_ints);
+      return sedona_serialize_polygon(handle, geom, &cs_info, &geom_buf);
+    case GEOS_MULTIPOINT:
+      geom_buf_init_with_buffer(&geom_buf, buf, MULTIPOINT, layout->srid,
+                                &cs_info, layout->num_ints);
+      return sedona_serialize_multipoint(handle, geom, &cs_info, &geom_buf);
+    case GEOS_MULTILINESTRING:
+      geom_buf_init_with_buffer(&geom_buf, buf, MULTILINESTRING, layout->srid,
+                                &cs_info, layout->num_ints);
+      return sedona_serialize_multilinestring(handle, geom, &cs_info,
+                                              &geom_buf);
     case GEOS_MULTIPOLYGON:
-      err = sedona_serialize_multipolygon(handle, geom, srid, &cs_info, p_buf,
-                                          p_buf_size);
-      break;
+      geom_buf_init_with_buffer(&geom_buf, buf, MULTIPOLYGON, layout->srid,
+                                &cs_info, layout->num_ints);
+      return sedona_serialize_multipolygon(handle, geom, &cs_info, &geom_buf);
     default:
-      err = SEDONA_UNKNOWN_GEOM_TYPE;
+      return SEDONA_UNKNOWN_GEOM_TYPE;
+  }
+}
+
+SedonaErrorCode sedona_serialized_size(GEOSContextHandle_t handle,
+                                       const GEOSGeometry *geom,
+                                       int *p_buf_size) {
+  scratch_arena_begin();
+  SerializationLayout layout;
+  SedonaErrorCode err = get_serialization_layout(handle, geom, 0, &layout);
+  scratch_arena_end();
+  if (err != SEDONA_SUCCESS) {
+    return err;
   }
+  *p_buf_size = layout.buf_size;
+  return SEDONA_SUCCESS;
+}
 
+/* Top-level geometries are counted and traced when they are done, nested
+ * geometries of collections are not */
+static void serialize_done(const char *buf, int buf_size) {
+  int geom_type_id = ((unsigned char)buf[0] & 0x7F) >> 4;
+  SERDE_STATS_ADD(serialized_geoms[geom_type_id], 1);
+  SERDE_STATS_ADD(serialized_bytes[geom_type_id], buf_size);
+  SEDONA_PROBE3(serialize__done, geom_type_id, ((const int *)buf)[1],
+                buf_size);
+}
+
+static SedonaErrorCode serialize_failed(SedonaErrorCode err) {
+  serde_stats_error(err);
+  SEDONA_PROBE1(serialize__error, (int)err);
   return err;
 }
 
+SedonaErrorCode sedona_serialize_geom_into(GEOSContextHandle_t handle,
+                                           const GEOSGeometry *geom, char *buf,
+                                           int buf_size,
+                                           int *p_bytes_written) {
+  SEDONA_PROBE1(serialize__start, geom);
+  scratch_arena_begin();
+  SerializationLayout layout;
+  SedonaErrorCode err = get_serialization_layout(handle, geom, 0, &layout);
+  if (err != SEDONA_SUCCESS) {
+    goto handle_error;
+  }
+  if (layout.buf_size > buf_size) {
+    err = SEDONA_BUFFER_TOO_SMALL;
+    goto handle_error;
+  }
+  err = serialize_geom_with_layout(handle, geom, &layout, buf);
+  if (err != SEDONA_SUCCESS) {
+    goto handle_error;
+  }
+  scratch_arena_end();
+  serialize_done(buf, layout.buf_size);
+  *p_bytes_written = layout.buf_size;
+  return SEDONA_SUCCESS;
+
+handle_error:
+  scratch_arena_end();
+  return serialize_failed(err);
+}
+
+SedonaErrorCode sedona_serialize_geom(GEOSContextHandle_t handle,
+                                      const GEOSGeometry *geom, char **p_buf,
+                                      int *p_buf_size) {
+  SEDONA_PROBE1(serialize__start, geom);
+  scratch_arena_begin();
+  char *buf = NULL;
+  SerializationLayout layout;
+  SedonaErrorCode err = get_serialization_layout(handle, geom, 0, &layout);
+  if (err != SEDONA_SUCCESS) {
+    goto handle_error;
+  }
+  buf = serde_malloc(layout.buf_size);
+  if (buf == NULL) {
+    err = SEDONA_ALLOC_ERROR;
+    goto handle_error;
+  }
+  err = serialize_geom_with_layout(handle, geom, &layout, buf);
+  if (err != SEDONA_SUCCESS) {
+    serde_free(buf, layout.buf_size);
+    goto handle_error;
+  }
+  scratch_arena_end();
+  serialize_done(buf, layout.buf_size);
+  *p_buf = buf;
+  *p_buf_size = layout.buf_size;
+  return SEDONA_SUCCESS;
+
+handle_error:
+  scratch_arena_end();
+  return serialize_failed(err);
+}
+
 static SedonaErrorCode deserialize_geom_buf(GEOSContextHandle_t handle,
                                             GeometryTypeId geom_type_id,
-                                            int srid, GeomBuffer *geom_buf,
+                                            int srid, int depth,
+                                            GeomBuffer *geom_buf,
                                             CoordinateSequenceInfo *cs_info,
                                             GEOSGeometry **p_geom) {
   SedonaErrorCode err = SEDONA_SUCCESS;
@@ -704,8 +831,8 @@ static SedonaErrorCode deserialize_geom_buf(GEOSContextHandle_t handle,
                                             p_geom);
       break;
     case GEOMETRYCOLLECTION:
-      err = sedona_deserialize_geometrycollection(handle, srid, geom_buf,
-                                                  cs_info, p_geom);
+      err = sedona_deserialize_geometrycollection(handle, srid, depth,
+                                                  geom_buf, cs_info, p_geom);
       break;
     default:
       return SEDONA_UNSUPPORTED_GEOM_TYPE;
@@ -720,27 +847,53 @@ static SedonaErrorCode deserialize_geom_buf(GEOSContextHandle_t handle,
   return SEDONA_SUCCESS;
 }
 
-SedonaErrorCode sedona_deserialize_geom(GEOSContextHandle_t handle,
+static SedonaErrorCode deserialize_geom(GEOSContextHandle_t handle,
                                         const char *buf, int buf_size,
-                                        GEOSGeometry **p_geom,
+                                        int depth, GEOSGeometry **p_geom,
                                         int *p_bytes_read) {
   GeomBuffer geom_buf;
   CoordinateSequenceInfo cs_info;
   GeometryTypeId geom_type_id;
   int srid;
+
+  /* Temporary arrays of child geometries and decoded coordinates are
+   * allocated from the scratch arena, they are reclaimed when the outermost
+   * call returns. */
+  scratch_arena_begin();
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_HEADER_PARSE);
   SedonaErrorCode err = read_geom_buf_header(buf, buf_size, &geom_buf, &cs_info,
                                              &geom_type_id, &srid);
+  serde_stats_timer_end(SERDE_STAGE_HEADER_PARSE, timer);
+  if (err == SEDONA_SUCCESS) {
+    err = deserialize_geom_buf(handle, geom_type_id, srid, depth, &geom_buf,
+                               &cs_info, p_geom);
+  }
+  scratch_arena_end();
   if (err != SEDONA_SUCCESS) {
     return err;
   }
 
-  err = deserialize_geom_buf(handle, geom_type_id, srid, &geom_buf, &cs_info,
-                             p_geom);
+  *p_bytes_read = (int)((unsigned char *)geom_buf.buf_int - (unsigned char *)geom_buf.buf);
+  return SEDONA_SUCCESS;
+}
+
+SedonaErrorCode sedona_deserialize_geom(GEOSContextHandle_t handle,
+                                        const char *buf, int buf_size,
+                                        GEOSGeometry **p_geom,
+                                        int *p_bytes_read) {
+  SEDONA_PROBE2(deserialize__start, buf, buf_size);
+  SedonaErrorCode err =
+      deserialize_geom(handle, buf, buf_size, 0, p_geom, p_bytes_read);
   if (err != SEDONA_SUCCESS) {
+    serde_stats_error(err);
+    SEDONA_PROBE1(deserialize__error, (int)err);
     return err;
   }
-
-  *p_bytes_read = (int)((unsigned char *)geom_buf.buf_int - (unsigned char *)geom_buf.buf);
+  int geom_type_id = ((unsigned char)buf[0] & 0x7F) >> 4;
+  SERDE_STATS_ADD(deserialized_geoms[geom_type_id], 1);
+  SERDE_STATS_ADD(deserialized_bytes[geom_type_id], *p_bytes_read);
+  SEDONA_PROBE3(deserialize__done, geom_type_id, ((const int *)buf)[1],
+                *p_bytes_read);
   return SEDONA_SUCCESS;
 }
 
@@ -764,6 +917,8 @@ const char *sedona_get_error_message(int err) {
       return "Out of memory";
     case SEDONA_INTERNAL_ERROR:
       return "Internal error";
+    case SEDONA_BUFFER_TOO_SMALL:
+      return "Buffer is too small to hold the serialized geometry";
     default:
       return "Unknown failure occurred";
   }
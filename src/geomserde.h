@@ -35,6 +35,7 @@ typedef enum SedonaErrorCode {
   SEDONA_GEOS_ERROR,
   SEDONA_ALLOC_ERROR,
   SEDONA_INTERNAL_ERROR,
+  SEDONA_BUFFER_TOO_SMALL,
 } SedonaErrorCode;
 
 /**
@@ -45,12 +46,18 @@ typedef enum SedonaErrorCode {
  */
 extern const char *sedona_get_error_message(int err);
 
+/* Maximum number of geometry collections a geometry could be nested in.
+ * Functions walking nested collections recursively reject deeper geometries
+ * with SEDONA_BAD_GEOM_BUFFER instead of running out of stack. */
+#define SEDONA_MAX_NESTING_DEPTH 256
+
 /**
  * Serializes a GEOS geometry object as a binary buffer
  *
  * @param handle the GEOS context handle
  * @param geom The GEOS geometry object to serialize
- * @param p_buf OUTPUT parameter for receiving the pointer to buffer
+ * @param p_buf OUTPUT parameter for receiving the pointer to buffer, which
+ * should be released by serde_free
  * @param p_buf_size OUTPUT parameter for receiving size of the buffer
  * @return error code
  */
@@ -58,6 +65,36 @@ SedonaErrorCode sedona_serialize_geom(GEOSContextHandle_t handle,
                                       const GEOSGeometry *geom, char **p_buf,
                                       int *p_buf_size);
 
+/**
+ * Computes the exact size of the serialized buffer of a GEOS geometry object
+ *
+ * @param handle the GEOS context handle
+ * @param geom The GEOS geometry object to serialize
+ * @param p_buf_size OUTPUT parameter for receiving size of the serialized
+ * buffer
+ * @return error code
+ */
+SedonaErrorCode sedona_serialized_size(GEOSContextHandle_t handle,
+                                       const GEOSGeometry *geom,
+                                       int *p_buf_size);
+
+/**
+ * Serializes a GEOS geometry object into a caller provided buffer
+ *
+ * @param handle the GEOS context handle
+ * @param geom The GEOS geometry object to serialize
+ * @param buf buffer for writing the serialized geometry into
+ * @param buf_size size of the buffer, SEDONA_BUFFER_TOO_SMALL will be returned
+ * if it is smaller than the serialized size of geom
+ * @param p_bytes_written OUTPUT parameter for receiving number of bytes
+ * written
+ * @return error code
+ */
+SedonaErrorCode sedona_serialize_geom_into(GEOSContextHandle_t handle,
+                                           const GEOSGeometry *geom, char *buf,
+                                           int buf_size,
+                                           int *p_bytes_written);
+
 /**
  * Deserializes a serialized geometry to a GEOS geometry object
  *
@@ -73,4 +110,63 @@ SedonaErrorCode sedona_deserialize_geom(GEOSContextHandle_t handle,
                                         GEOSGeometry **p_geom,
                                         int *p_bytes_read);
 
+/**
+ * Basic information of a serialized geometry, which could be retrieved
+ * without constructing a GEOS geometry object
+ */
+typedef struct SedonaGeometryInfo {
+  /* geometry type in the serialized buffer, 1 for POINT, 2 for LINESTRING,
+   * ..., 7 for GEOMETRYCOLLECTION */
+  int geom_type;
+  int srid;
+  /* number of dimensions, has_z and has_m of geometry collections are derived
+   * from their child geometries */
+  int dims;
+  int has_z;
+  int has_m;
+  /* total number of non-empty coordinates, including coordinates of child
+   * geometries */
+  int num_coords;
+  int is_empty;
+  /* min x, min y, max x, max y, all NaN for empty geometries */
+  double bounds[4];
+} SedonaGeometryInfo;
+
+/**
+ * Retrieves basic information of a serialized geometry
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param compute_bounds whether to compute info->bounds, which requires
+ * scanning all coordinates
+ * @param info OUTPUT parameter for receiving the geometry info
+ * @param p_bytes_read OUTPUT parameter for receiving number of bytes occupied
+ * by the serialized geometry, could be NULL
+ * @return error code
+ */
+SedonaErrorCode sedona_get_geom_info(const char *buf, int buf_size,
+                                     int compute_bounds,
+                                     SedonaGeometryInfo *info,
+                                     int *p_bytes_read);
+
+/**
+ * Validates the structure of a serialized geometry without constructing GEOS
+ * geometries or allocating memory. The header, encoded coordinates, the
+ * structural integers and child geometries of collections are checked the
+ * same way as the deserializer does, so a validated buffer could only fail to
+ * deserialize when GEOS rejects the geometry itself (e.g. a ring with too few
+ * points). Unlike the deserializer, unknown coordinate type 0 is rejected and
+ * geometry collections nested deeper than 64 levels are reported as
+ * SEDONA_BAD_GEOM_BUFFER.
+ *
+ * @param buf buffer containing serialized geometry
+ * @param buf_size size of the buffer
+ * @param p_bytes_read OUTPUT parameter for receiving number of bytes occupied
+ * by the serialized geometry, could be NULL
+ * @return SEDONA_SUCCESS for well-formed buffers, otherwise the error code
+ * deserialization would fail with
+ */
+SedonaErrorCode sedona_validate(const char *buf, int buf_size,
+                                int *p_bytes_read);
+
 #endif /* GEOM_SERDE */
@@ -19,26 +19,60 @@
 
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "block_codec.h"
+#include "coord_codec.h"
+#include "geom_buf.h"
+#include "geom_text.h"
+#include "geom_wkb.h"
+#include "geoarrow.h"
 #include "geomserde.h"
 #include "geos_c_dyn.h"
+#include "geos_context_pool.h"
 #include "pygeos/c_api.h"
+#include "sedona_thread.h"
+#include "serde_alloc.h"
+#include "serde_stats.h"
+#include "thread_pool.h"
 
 PyDoc_STRVAR(module_doc, "Geometry serialization/deserialization module.");
 
 #define ERR_MSG_BUF_SIZE 1024
 
-#ifdef __GNUC__
-# define thread_local __thread
-#elif __STDC_VERSION__ >= 201112L
-# define thread_local _Thread_local
-#elif defined(_MSC_VER)
-# define thread_local __declspec(thread)
-#else
-# error Cannot define thread_local
+/* Free-threaded builds of Python 3.13+ lock objects with critical sections,
+ * the GIL serializes accesses to objects on other builds */
+#ifndef Py_BEGIN_CRITICAL_SECTION
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
 #endif
 
+/* Geometry classes of Shapely 1.x are indexed by GEOS geometry type id */
+#define NUM_SHAPELY_1_CLASSES (GEOS_GEOMETRYCOLLECTION + 1)
+
+/* Per-module state, so that each (sub)interpreter importing this module gets
+ * its own Python objects */
+typedef struct GeomserdeState {
+  PyObject *serialized_geometry_type;
+  /* Shapely 1.x classes registered by init_shapely_1, and interned names of
+   * the attributes filled in by create_shapely_1_geometry */
+  PyObject *shapely_1_base_class;
+  PyObject *shapely_1_classes[NUM_SHAPELY_1_CLASSES];
+  PyObject *str_class;
+  PyObject *str_geom;
+  PyObject *str_p;
+  PyObject *str_ndim;
+  PyObject *str_is_empty;
+} GeomserdeState;
+
+static GeomserdeState *get_state(PyObject *module) {
+  return (GeomserdeState *)PyModule_GetState(module);
+}
+
 static PyObject *load_libgeos_c(PyObject *self, PyObject *args) {
   PyObject *obj;
   char err_msg[ERR_MSG_BUF_SIZE];
@@ -71,69 +105,62 @@ static PyObject *load_libgeos_c(PyObject *self, PyObject *args) {
   return Py_None;
 }
 
-static thread_local GEOSContextHandle_t handle;
-static thread_local char *geos_err_msg;
+/* Get GEOS context handle of the calling thread. The context is borrowed from
+ * the GEOS context pool on first use and returned to the pool when the thread
+ * exits. This function does not call any Python API so it could be called by
+ * threads not holding the GIL. Returns NULL when libgeos_c was not loaded or
+ * we ran out of memory. */
+static GEOSContextHandle_t get_geos_context_handle_nogil() {
+  if (!is_geos_c_loaded()) {
+    return NULL;
+  }
+  GeosContext *ctx = geos_context_get();
+  if (ctx == NULL) {
+    return NULL;
+  }
+  ctx->err_msg[0] = '\0';
+  return ctx->handle;
+}
 
-static void geos_msg_handler(const char *fmt, ...) {
-  if (geos_err_msg == NULL) return;
-  va_list ap;
-  va_start(ap, fmt);
-  vprintf(fmt, ap);
-  vsnprintf(geos_err_msg, ERR_MSG_BUF_SIZE, fmt, ap);
-  va_end(ap);
+/* Last GEOS error message of the calling thread */
+static const char *get_geos_err_msg() {
+  GeosContext *ctx = is_geos_c_loaded() ? geos_context_get() : NULL;
+  return ctx != NULL ? ctx->err_msg : "";
 }
 
 static GEOSContextHandle_t get_geos_context_handle() {
-  if (handle == NULL) {
-    if (!is_geos_c_loaded()) {
-      PyErr_SetString(
-          PyExc_RuntimeError,
-          "libgeos_c was not loaded, please call load_libgeos_c first");
-      return NULL;
-    }
-
-    handle = dyn_GEOS_init_r();
-    if (handle == NULL) {
-      goto oom_failure;
-    }
-    geos_err_msg = malloc(ERR_MSG_BUF_SIZE);
-    if (geos_err_msg == NULL) {
-      goto oom_failure;
-    }
-    dyn_GEOSContext_setErrorHandler_r(handle, geos_msg_handler);
+  if (!is_geos_c_loaded()) {
+    PyErr_SetString(
+        PyExc_RuntimeError,
+        "libgeos_c was not loaded, please call load_libgeos_c first");
+    return NULL;
   }
 
-  geos_err_msg[0] = '\0';
-  return handle;
-
-oom_failure:
-  PyErr_NoMemory();
-  if (handle != NULL) {
-    dyn_GEOS_finish_r(handle);
-    handle = NULL;
-  }
-  if (geos_err_msg != NULL) {
-    free(geos_err_msg);
-    geos_err_msg = NULL;
+  GEOSContextHandle_t handle = get_geos_context_handle_nogil();
+  if (handle == NULL) {
+    PyErr_NoMemory();
+    return NULL;
   }
-  return NULL;
+  return handle;
 }
 
-static void handle_geomserde_error(SedonaErrorCode err) {
+static void raise_geomserde_error(SedonaErrorCode err, const char *geos_msg) {
   const char *errmsg = sedona_get_error_message(err);
   if (err == SEDONA_ALLOC_ERROR) {
     PyErr_NoMemory();
   } else if (err == SEDONA_INTERNAL_ERROR) {
     PyErr_Format(PyExc_RuntimeError, "%s", errmsg);
   } else if (err == SEDONA_GEOS_ERROR) {
-    const char *errmsg = sedona_get_error_message(err);
-    PyErr_Format(PyExc_RuntimeError, "%s: %s", errmsg, geos_err_msg);
+    PyErr_Format(PyExc_RuntimeError, "%s: %s", errmsg, geos_msg);
   } else {
-    const char *errmsg = sedona_get_error_message(err);
     PyErr_Format(PyExc_ValueError, "%s", errmsg);
   }
 }
 
+static void handle_geomserde_error(SedonaErrorCode err) {
+  raise_geomserde_error(err, get_geos_err_msg());
+}
+
 static PyObject *do_serialize(GEOSGeometry *geos_geom) {
   if (geos_geom == NULL) {
     Py_INCREF(Py_None);
@@ -145,18 +172,28 @@ static PyObject *do_serialize(GEOSGeometry *geos_geom) {
     return NULL;
   }
 
-  char *buf = NULL;
+  /* Compute the exact size of the serialized geometry first, so that we can
+   * write it directly into the buffer of a bytes object */
   int buf_size = 0;
-  SedonaErrorCode err =
-      sedona_serialize_geom(handle, geos_geom, &buf, &buf_size);
+  SedonaErrorCode err = sedona_serialized_size(handle, geos_geom, &buf_size);
   if (err != SEDONA_SUCCESS) {
     handle_geomserde_error(err);
     return NULL;
   }
 
-  PyObject *bytearray = PyByteArray_FromStringAndSize(buf, buf_size);
-  free(buf);
-  return bytearray;
+  PyObject *bytes = PyBytes_FromStringAndSize(NULL, buf_size);
+  if (bytes == NULL) {
+    return NULL;
+  }
+  int bytes_written = 0;
+  err = sedona_serialize_geom_into(handle, geos_geom, PyBytes_AS_STRING(bytes),
+                                   buf_size, &bytes_written);
+  if (err != SEDONA_SUCCESS) {
+    Py_DECREF(bytes);
+    handle_geomserde_error(err);
+    return NULL;
+  }
+  return bytes;
 }
 
 static GEOSGeometry *do_deserialize(PyObject *args,
@@ -189,6 +226,591 @@ static GEOSGeometry *do_deserialize(PyObject *args,
   return geom;
 }
 
+/* Batch serialization writes all serialized geometries into one growable
+ * bytearray. The i-th geometry occupies data[offsets[i]:offsets[i + 1]], where
+ * offsets is an array of n + 1 int64 values. Null geometries are recorded in a
+ * validity bitmap using the same bit order as Apache Arrow (bit i % 8 of byte
+ * i / 8 is set when the i-th geometry is valid), and occupy 0 bytes in data. */
+
+typedef struct SerializedBatch {
+  PyObject *data;
+  Py_ssize_t data_size;
+  Py_ssize_t data_capacity;
+  PyObject *offsets;
+  PyObject *validity;
+} SerializedBatch;
+
+static int serialized_batch_init(SerializedBatch *batch, Py_ssize_t num_geoms) {
+  batch->data_size = 0;
+  batch->data_capacity = 0;
+  batch->data = PyByteArray_FromStringAndSize(NULL, 0);
+  batch->offsets = PyByteArray_FromStringAndSize(
+      NULL, (num_geoms + 1) * sizeof(int64_t));
+  batch->validity = PyByteArray_FromStringAndSize(NULL, (num_geoms + 7) / 8);
+  if (batch->data == NULL || batch->offsets == NULL ||
+      batch->validity == NULL) {
+    Py_XDECREF(batch->data);
+    Py_XDECREF(batch->offsets);
+    Py_XDECREF(batch->validity);
+    return -1;
+  }
+  memset(PyByteArray_AS_STRING(batch->validity), 0, (num_geoms + 7) / 8);
+  ((int64_t *)PyByteArray_AS_STRING(batch->offsets))[0] = 0;
+  return 0;
+}
+
+static void serialized_batch_destroy(SerializedBatch *batch) {
+  Py_DECREF(batch->data);
+  Py_DECREF(batch->offsets);
+  Py_DECREF(batch->validity);
+}
+
+/* Reserve size bytes at the end of the data buffer and return the pointer to
+ * the reserved region. The capacity of data buffer grows geometrically, so
+ * appending n geometries takes amortized O(n) time. */
+static char *serialized_batch_reserve(SerializedBatch *batch,
+                                      Py_ssize_t size) {
+  Py_ssize_t required = batch->data_size + size;
+  if (required > batch->data_capacity) {
+    Py_ssize_t capacity = batch->data_capacity * 2;
+    if (capacity < required) {
+      capacity = required;
+    }
+    if (capacity < 256) {
+      capacity = 256;
+    }
+    if (PyByteArray_Resize(batch->data, capacity) != 0) {
+      return NULL;
+    }
+    batch->data_capacity = capacity;
+  }
+  return PyByteArray_AS_STRING(batch->data) + batch->data_size;
+}
+
+/* Mark the k-th geometry as valid, its serialized form has been written to the
+ * region returned by serialized_batch_reserve */
+static void serialized_batch_commit(SerializedBatch *batch, Py_ssize_t k,
+                                    Py_ssize_t size) {
+  batch->data_size += size;
+  ((int64_t *)PyByteArray_AS_STRING(batch->offsets))[k + 1] = batch->data_size;
+  PyByteArray_AS_STRING(batch->validity)[k >> 3] |= (char)(1 << (k & 7));
+}
+
+static void serialized_batch_set_null(SerializedBatch *batch, Py_ssize_t k) {
+  ((int64_t *)PyByteArray_AS_STRING(batch->offsets))[k + 1] = batch->data_size;
+}
+
+/* Shrink data buffer to its actual size and return a (data, offsets,
+ * validity) tuple. References held by batch are stolen by the tuple. */
+static PyObject *serialized_batch_finish(SerializedBatch *batch) {
+  if (PyByteArray_Resize(batch->data, batch->data_size) != 0) {
+    serialized_batch_destroy(batch);
+    return NULL;
+  }
+  return Py_BuildValue("(NNN)", batch->data, batch->offsets, batch->validity);
+}
+
+/* Input of batch deserialization. Serialized geometries could either be given
+ * as a contiguous data buffer with int64 or int32 offsets and an optional
+ * validity bitmap (the output of serialize_array, or buffers of an Arrow
+ * binary array), as an Arrow binary or large binary array exported through
+ * the Arrow PyCapsule interface, or as a sequence of bytes-like objects and
+ * None values. All forms are resolved into an array of (pointer, size)
+ * pairs, where pointer is NULL for null geometries. */
+
+typedef struct BatchInput {
+  Py_ssize_t num_geoms;
+  const char **bufs;
+  int *buf_sizes;
+
+  /* Resources to be released by batch_input_release */
+  PyObject *seq;
+  PyObject *arrow_capsules;
+  Py_buffer *item_views;
+  Py_ssize_t num_item_views;
+  Py_buffer data_view;
+  Py_buffer offsets_view;
+  Py_buffer validity_view;
+  int has_data_view;
+  int has_offsets_view;
+  int has_validity_view;
+} BatchInput;
+
+static void batch_input_release(BatchInput *input) {
+  for (Py_ssize_t k = 0; k < input->num_item_views; k++) {
+    PyBuffer_Release(&input->item_views[k]);
+  }
+  PyMem_Free(input->item_views);
+  PyMem_Free(input->bufs);
+  PyMem_Free(input->buf_sizes);
+  Py_XDECREF(input->seq);
+  Py_XDECREF(input->arrow_capsules);
+  if (input->has_data_view) {
+    PyBuffer_Release(&input->data_view);
+  }
+  if (input->has_offsets_view) {
+    PyBuffer_Release(&input->offsets_view);
+  }
+  if (input->has_validity_view) {
+    PyBuffer_Release(&input->validity_view);
+  }
+}
+
+static int batch_input_alloc(BatchInput *input, Py_ssize_t num_geoms) {
+  input->num_geoms = num_geoms;
+  input->bufs = PyMem_Calloc(num_geoms + 1, sizeof(const char *));
+  input->buf_sizes = PyMem_Calloc(num_geoms + 1, sizeof(int));
+  if (input->bufs == NULL || input->buf_sizes == NULL) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  return 0;
+}
+
+static int batch_input_set_buf(BatchInput *input, Py_ssize_t k,
+                               const char *buf, Py_ssize_t buf_size) {
+  if (buf_size > INT_MAX) {
+    PyErr_Format(PyExc_ValueError,
+                 "Serialized geometry %zd is too large (%zd bytes)", k,
+                 buf_size);
+    return -1;
+  }
+  input->bufs[k] = buf;
+  input->buf_sizes[k] = (int)buf_size;
+  return 0;
+}
+
+/* Like PySequence_Fast, but lists passed in by the caller are copied as
+ * tuples. Items of the result are kept alive until it is released, even if
+ * the original list is mutated by other threads while we are working on them
+ * without holding the GIL. */
+static PyObject *sequence_snapshot(PyObject *obj, const char *err_msg) {
+  PyObject *seq = PySequence_Fast(obj, err_msg);
+  if (seq == obj && PyList_Check(seq)) {
+    Py_SETREF(seq, PyList_AsTuple(seq));
+  }
+  return seq;
+}
+
+static int batch_input_from_sequence(BatchInput *input, PyObject *obj) {
+  input->seq = sequence_snapshot(
+      obj, "Expects a sequence of bytes-like objects, or data with offsets");
+  if (input->seq == NULL) {
+    return -1;
+  }
+  Py_ssize_t num_geoms = PySequence_Fast_GET_SIZE(input->seq);
+  PyObject **items = PySequence_Fast_ITEMS(input->seq);
+  if (batch_input_alloc(input, num_geoms) != 0) {
+    return -1;
+  }
+
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    PyObject *item = items[k];
+    if (item == Py_None) {
+      continue;
+    }
+    if (PyBytes_CheckExact(item)) {
+      /* fast path for bytes objects, which are immutable and kept alive by
+       * input->seq */
+      if (batch_input_set_buf(input, k, PyBytes_AS_STRING(item),
+                              PyBytes_GET_SIZE(item)) != 0) {
+        return -1;
+      }
+      continue;
+    }
+
+    if (input->item_views == NULL) {
+      input->item_views = PyMem_Calloc(num_geoms, sizeof(Py_buffer));
+      if (input->item_views == NULL) {
+        PyErr_NoMemory();
+        return -1;
+      }
+    }
+    Py_buffer *view = &input->item_views[input->num_item_views];
+    if (PyObject_GetBuffer(item, view, PyBUF_C_CONTIGUOUS) != 0) {
+      return -1;
+    }
+    input->num_item_views++;
+    if (batch_input_set_buf(input, k, view->buf, view->len) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* Load the k-th value of int64 or int32 offsets. Offsets may not be aligned
+ * when passed in as raw bytes, so we use memcpy to load them. */
+static inline int64_t load_offset(const char *offsets, int offset_size,
+                                  Py_ssize_t k) {
+  if (offset_size == 4) {
+    int32_t value;
+    memcpy(&value, offsets + 4 * k, 4);
+    return value;
+  } else {
+    int64_t value;
+    memcpy(&value, offsets + 8 * k, 8);
+    return value;
+  }
+}
+
+static int batch_input_from_buffers(BatchInput *input, PyObject *data,
+                                    PyObject *offsets, PyObject *validity) {
+  if (PyObject_GetBuffer(data, &input->data_view, PyBUF_C_CONTIGUOUS) != 0) {
+    return -1;
+  }
+  input->has_data_view = 1;
+  if (PyObject_GetBuffer(offsets, &input->offsets_view,
+                         PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    return -1;
+  }
+  input->has_offsets_view = 1;
+
+  /* offsets could be a typed int64 or int32 buffer (numpy array,
+   * array.array, offsets buffer of an Arrow binary array) or raw bytes
+   * holding native int64 values */
+  Py_buffer *offsets_view = &input->offsets_view;
+  const char *fmt = offsets_view->format;
+  if (fmt != NULL && (fmt[0] == '<' || fmt[0] == '=' || fmt[0] == '@')) {
+    fmt++;
+  }
+  int is_raw = (fmt == NULL || strcmp(fmt, "B") == 0);
+  int is_int = (fmt != NULL && (strcmp(fmt, "q") == 0 ||
+                                strcmp(fmt, "l") == 0 || strcmp(fmt, "i") == 0));
+  int offset_size = (is_raw ? 8 : (int)offsets_view->itemsize);
+  if ((!is_raw && !is_int) || (offset_size != 8 && offset_size != 4) ||
+      offsets_view->len % offset_size != 0 ||
+      offsets_view->len < offset_size) {
+    PyErr_SetString(PyExc_ValueError,
+                    "offsets should be a non-empty array of int64 or int32 "
+                    "values");
+    return -1;
+  }
+
+  Py_ssize_t num_geoms = offsets_view->len / offset_size - 1;
+  const unsigned char *validity_bits = NULL;
+  if (validity != NULL && validity != Py_None) {
+    if (PyObject_GetBuffer(validity, &input->validity_view,
+                           PyBUF_C_CONTIGUOUS) != 0) {
+      return -1;
+    }
+    input->has_validity_view = 1;
+    if (input->validity_view.len < (num_geoms + 7) / 8) {
+      PyErr_SetString(PyExc_ValueError,
+                      "validity bitmap is shorter than number of geometries");
+      return -1;
+    }
+    validity_bits = input->validity_view.buf;
+  }
+
+  if (batch_input_alloc(input, num_geoms) != 0) {
+    return -1;
+  }
+  const char *buf = input->data_view.buf;
+  Py_ssize_t buf_size = input->data_view.len;
+  const char *offsets_buf = offsets_view->buf;
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    int64_t start = load_offset(offsets_buf, offset_size, k);
+    int64_t end = load_offset(offsets_buf, offset_size, k + 1);
+    if (start < 0 || end < start || end > buf_size) {
+      PyErr_Format(PyExc_ValueError,
+                   "Invalid offsets [%lld, %lld) for geometry %zd",
+                   (long long)start, (long long)end, k);
+      return -1;
+    }
+    if (validity_bits != NULL && !(validity_bits[k >> 3] & (1 << (k & 7)))) {
+      continue;
+    }
+    if (batch_input_set_buf(input, k, buf + start, end - start) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* Get the structs of an Arrow array exported as PyCapsules. Returns 0 on
+ * success, returns -1 and sets a Python exception on failure. */
+static int get_arrow_structs(PyObject *schema_capsule, PyObject *array_capsule,
+                             struct ArrowSchema **p_schema,
+                             struct ArrowArray **p_array) {
+  struct ArrowSchema *schema =
+      PyCapsule_GetPointer(schema_capsule, "arrow_schema");
+  if (schema == NULL) {
+    return -1;
+  }
+  struct ArrowArray *array = PyCapsule_GetPointer(array_capsule, "arrow_array");
+  if (array == NULL) {
+    return -1;
+  }
+  if (schema->release == NULL || array->release == NULL) {
+    PyErr_SetString(PyExc_ValueError, "Arrow array was already released");
+    return -1;
+  }
+  *p_schema = schema;
+  *p_array = array;
+  return 0;
+}
+
+/* Get (schema, array) capsules of an object implementing the Arrow PyCapsule
+ * interface, or a tuple of such capsules. *p_capsules receives a new
+ * reference to the tuple, or NULL if obj is not an Arrow array. Returns -1 and
+ * sets a Python exception on failure. */
+static int get_arrow_capsules(PyObject *obj, PyObject **p_capsules) {
+  *p_capsules = NULL;
+  if (PyTuple_Check(obj)) {
+    if (PyTuple_GET_SIZE(obj) == 2 &&
+        PyCapsule_IsValid(PyTuple_GET_ITEM(obj, 0), "arrow_schema") &&
+        PyCapsule_IsValid(PyTuple_GET_ITEM(obj, 1), "arrow_array")) {
+      Py_INCREF(obj);
+      *p_capsules = obj;
+    }
+    return 0;
+  }
+  if (PyList_Check(obj) || !PyObject_HasAttrString(obj, "__arrow_c_array__")) {
+    return 0;
+  }
+  PyObject *capsules = PyObject_CallMethod(obj, "__arrow_c_array__", NULL);
+  if (capsules == NULL) {
+    return -1;
+  }
+  if (!PyTuple_Check(capsules) || PyTuple_GET_SIZE(capsules) != 2) {
+    Py_DECREF(capsules);
+    PyErr_SetString(PyExc_TypeError,
+                    "__arrow_c_array__ should return a (schema, array) tuple");
+    return -1;
+  }
+  *p_capsules = capsules;
+  return 0;
+}
+
+/* Resolve a binary ("z") or large binary ("Z") Arrow array. Rows are read in
+ * place, the capsules are kept alive until the input is released. */
+static int batch_input_from_arrow(BatchInput *input, PyObject *capsules) {
+  input->arrow_capsules = capsules;
+  struct ArrowSchema *schema = NULL;
+  struct ArrowArray *array = NULL;
+  if (get_arrow_structs(PyTuple_GET_ITEM(capsules, 0),
+                        PyTuple_GET_ITEM(capsules, 1), &schema,
+                        &array) != 0) {
+    return -1;
+  }
+  int offset_size = 0;
+  if (strcmp(schema->format, "z") == 0) {
+    offset_size = 4;
+  } else if (strcmp(schema->format, "Z") == 0) {
+    offset_size = 8;
+  } else {
+    PyErr_Format(PyExc_ValueError,
+                 "Expects an Arrow binary or large binary array, got format "
+                 "\"%s\"",
+                 schema->format);
+    return -1;
+  }
+  if (array->n_buffers != 3) {
+    PyErr_SetString(PyExc_ValueError, "Invalid Arrow binary array");
+    return -1;
+  }
+
+  Py_ssize_t num_geoms = (Py_ssize_t)array->length;
+  if (batch_input_alloc(input, num_geoms) != 0) {
+    return -1;
+  }
+  const unsigned char *validity_bits =
+      (array->null_count != 0 ? array->buffers[0] : NULL);
+  const char *offsets = array->buffers[1];
+  const char *data = array->buffers[2];
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    int64_t index = array->offset + k;
+    if (validity_bits != NULL &&
+        !(validity_bits[index >> 3] & (1 << (index & 7)))) {
+      continue;
+    }
+    int64_t start = load_offset(offsets, offset_size, index);
+    int64_t end = load_offset(offsets, offset_size, index + 1);
+    if (start < 0 || end < start) {
+      PyErr_Format(PyExc_ValueError,
+                   "Invalid offsets [%lld, %lld) for geometry %zd",
+                   (long long)start, (long long)end, k);
+      return -1;
+    }
+    if (batch_input_set_buf(input, k, data + start, end - start) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* Initialize BatchInput from Python arguments. offsets and validity are
+ * optional (could be NULL or None). Returns 0 on success, returns -1 and sets
+ * a Python exception on failure. batch_input_release should always be called
+ * to release resources held by input, even if this function failed. */
+static int batch_input_init(BatchInput *input, PyObject *data,
+                            PyObject *offsets, PyObject *validity) {
+  memset(input, 0, sizeof(BatchInput));
+  if (offsets == NULL || offsets == Py_None) {
+    PyObject *capsules = NULL;
+    if (get_arrow_capsules(data, &capsules) != 0) {
+      return -1;
+    }
+    if (capsules != NULL) {
+      return batch_input_from_arrow(input, capsules);
+    }
+    return batch_input_from_sequence(input, data);
+  } else {
+    return batch_input_from_buffers(input, data, offsets, validity);
+  }
+}
+
+/* Batch functions release the GIL and process geometries using the thread
+ * pool. Each thread uses its own GEOS context handle. Only the error with the
+ * smallest geometry index will be reported; workers stop processing as soon
+ * as any error was found. */
+
+typedef struct BatchError {
+  sedona_mutex_t mutex;
+  volatile long has_error;
+  Py_ssize_t index;
+  SedonaErrorCode err;
+  char geos_msg[ERR_MSG_BUF_SIZE];
+} BatchError;
+
+static void batch_error_init(BatchError *error) {
+  sedona_mutex_init(&error->mutex);
+  error->has_error = 0;
+  error->index = 0;
+  error->err = SEDONA_SUCCESS;
+  error->geos_msg[0] = '\0';
+}
+
+static void batch_error_destroy(BatchError *error) {
+  sedona_mutex_destroy(&error->mutex);
+}
+
+/* Record an error occurred when processing the k-th geometry. Should be called
+ * by the thread where the error occurred, so that the GEOS error message of
+ * that thread could be retrieved. */
+static void batch_error_set(BatchError *error, Py_ssize_t k,
+                            SedonaErrorCode err) {
+  sedona_mutex_lock(&error->mutex);
+  if (!error->has_error || k < error->index) {
+    error->index = k;
+    error->err = err;
+    snprintf(error->geos_msg, ERR_MSG_BUF_SIZE, "%s", get_geos_err_msg());
+    sedona_atomic_store_32(&error->has_error, 1);
+  }
+  sedona_mutex_unlock(&error->mutex);
+}
+
+static int batch_error_occurred(BatchError *error) {
+  return sedona_atomic_load_32(&error->has_error) != 0;
+}
+
+typedef struct SerializeArrayJob {
+  GEOSGeometry **geoms;
+  int64_t *buf_sizes;
+  const int64_t *offsets;
+  char *data;
+  BatchError error;
+} SerializeArrayJob;
+
+static void serialized_size_task(void *ctx, int64_t begin, int64_t end) {
+  SerializeArrayJob *job = ctx;
+  GEOSContextHandle_t handle = get_geos_context_handle_nogil();
+  if (handle == NULL) {
+    batch_error_set(&job->error, begin, SEDONA_ALLOC_ERROR);
+    return;
+  }
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    if (job->geoms[k] == NULL) {
+      continue;
+    }
+    int buf_size = 0;
+    SedonaErrorCode err =
+        sedona_serialized_size(handle, job->geoms[k], &buf_size);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+    job->buf_sizes[k] = buf_size;
+  }
+}
+
+static void serialize_array_task(void *ctx, int64_t begin, int64_t end) {
+  SerializeArrayJob *job = ctx;
+  GEOSContextHandle_t handle = get_geos_context_handle_nogil();
+  if (handle == NULL) {
+    batch_error_set(&job->error, begin, SEDONA_ALLOC_ERROR);
+    return;
+  }
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    if (job->geoms[k] == NULL) {
+      continue;
+    }
+    int bytes_written = 0;
+    SedonaErrorCode err = sedona_serialize_geom_into(
+        handle, job->geoms[k], job->data + job->offsets[k],
+        (int)job->buf_sizes[k], &bytes_written);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+  }
+}
+
+typedef struct DeserializeArrayJob {
+  const BatchInput *input;
+  GEOSGeometry **geoms;
+  BatchError error;
+} DeserializeArrayJob;
+
+static void deserialize_array_task(void *ctx, int64_t begin, int64_t end) {
+  DeserializeArrayJob *job = ctx;
+  GEOSContextHandle_t handle = get_geos_context_handle_nogil();
+  if (handle == NULL) {
+    batch_error_set(&job->error, begin, SEDONA_ALLOC_ERROR);
+    return;
+  }
+  const BatchInput *input = job->input;
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    if (input->bufs[k] == NULL) {
+      continue;
+    }
+    int bytes_read = 0;
+    SedonaErrorCode err =
+        sedona_deserialize_geom(handle, input->bufs[k], input->buf_sizes[k],
+                                &job->geoms[k], &bytes_read);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+  }
+}
+
+/* Estimate the cost of deserializing a geometry using the number of
+ * coordinates in its header. The header of geometry collections holds the
+ * number of child geometries, so we use the buffer size instead. */
+static int64_t estimate_deserialization_cost(const char *buf, int buf_size) {
+  if (buf == NULL || buf_size < 8) {
+    return 1;
+  }
+  int num_coords = 0;
+  memcpy(&num_coords, buf + 4, sizeof(int));
+  int geom_type_id = (((unsigned char)buf[0]) & 0x7F) >> 4;
+  if (geom_type_id == GEOMETRYCOLLECTION || num_coords < 0 ||
+      num_coords > buf_size) {
+    return 1 + buf_size / 16;
+  }
+  return 1 + num_coords;
+}
+
 /* serialize/deserialize functions for Shapely 2.x */
 
 static PyObject *serialize(PyObject *self, PyObject *args) {
@@ -209,74 +831,2952 @@ static PyObject *serialize(PyObject *self, PyObject *args) {
   return do_serialize(geos_geom);
 }
 
-static PyObject *deserialize(PyObject *self, PyObject *args) {
-  GEOSContextHandle_t handle = NULL;
-  int length = 0;
-  GEOSGeometry *geom = do_deserialize(args, &handle, &length);
-  if (geom == NULL) {
+static PyObject *serialized_size(PyObject *self, PyObject *args) {
+  PyObject *pygeos_geom = NULL;
+  if (!PyArg_ParseTuple(args, "O", &pygeos_geom)) {
     return NULL;
   }
-  PyObject *pygeom = PyGEOS_CreateGeometry(geom, handle);
-  return Py_BuildValue("(Ni)", pygeom, length);
-}
-
-/* serialize/deserialize functions for Shapely 1.x */
 
-static PyObject *serialize_1(PyObject *self, PyObject *args) {
   GEOSGeometry *geos_geom = NULL;
-  if (!PyArg_ParseTuple(args, "K", &geos_geom)) {
+  char success = PyGEOS_GetGEOSGeometry(pygeos_geom, &geos_geom);
+  if (success == 0) {
+    PyErr_SetString(
+        PyExc_TypeError,
+        "Argument is of incorrect type. Please provide only Geometry objects.");
     return NULL;
   }
-  return do_serialize(geos_geom);
-}
+  if (geos_geom == NULL) {
+    return PyLong_FromLong(0);
+  }
 
-static PyObject *deserialize_1(PyObject *self, PyObject *args) {
-  GEOSContextHandle_t handle = NULL;
-  int length = 0;
-  GEOSGeometry *geom = do_deserialize(args, &handle, &length);
-  if (geom == NULL) {
+  GEOSContextHandle_t handle = get_geos_context_handle();
+  if (handle == NULL) {
     return NULL;
   }
-
-  /* These functions would be called by Shapely using ctypes when constructing
-   * a Shapely BaseGeometry object from GEOSGeometry pointer. We call them here
-   * to get rid of the extra overhead introduced by ctypes. */
-  int geom_type_id = dyn_GEOSGeomTypeId_r(handle, geom);
-  char has_z = dyn_GEOSHasZ_r(handle, geom);
-  return Py_BuildValue("(Kibi)", geom, geom_type_id, has_z, length);
+  int buf_size = 0;
+  SedonaErrorCode err = sedona_serialized_size(handle, geos_geom, &buf_size);
+  if (err != SEDONA_SUCCESS) {
+    handle_geomserde_error(err);
+    return NULL;
+  }
+  return PyLong_FromLong(buf_size);
 }
 
-/* Module definition for Shapely 2.x */
+static PyObject *serialize_into(PyObject *self, PyObject *args) {
+  PyObject *pygeos_geom = NULL;
+  Py_buffer view;
+  Py_ssize_t offset = 0;
+  if (!PyArg_ParseTuple(args, "Ow*|n", &pygeos_geom, &view, &offset)) {
+    return NULL;
+  }
 
-static PyMethodDef geomserde_methods_shapely_2[] = {
-    {"load_libgeos_c", load_libgeos_c, METH_VARARGS, "Load libgeos_c."},
-    {"serialize", serialize, METH_VARARGS,
-     "Serialize geometry object as bytearray."},
-    {"deserialize", deserialize, METH_VARARGS,
-     "Deserialize bytes-like object to geometry object."},
-    {NULL, NULL, 0, NULL}, /* Sentinel */
-};
+  PyObject *result = NULL;
+  GEOSGeometry *geos_geom = NULL;
+  char success = PyGEOS_GetGEOSGeometry(pygeos_geom, &geos_geom);
+  if (success == 0) {
+    PyErr_SetString(
+        PyExc_TypeError,
+        "Argument is of incorrect type. Please provide only Geometry objects.");
+    goto cleanup;
+  }
+  if (offset < 0 || offset > view.len) {
+    PyErr_Format(PyExc_ValueError,
+                 "Offset %zd is out of range of buffer of size %zd", offset,
+                 view.len);
+    goto cleanup;
+  }
+  if (geos_geom == NULL) {
+    result = PyLong_FromLong(0);
+    goto cleanup;
+  }
 
-static struct PyModuleDef geomserde_module_shapely_2 = {
-    PyModuleDef_HEAD_INIT, "geomserde_speedup", module_doc, 0,
-    geomserde_methods_shapely_2};
+  GEOSContextHandle_t handle = get_geos_context_handle();
+  if (handle == NULL) {
+    goto cleanup;
+  }
+  Py_ssize_t capacity = view.len - offset;
+  if (capacity > INT_MAX) {
+    capacity = INT_MAX;
+  }
+  int bytes_written = 0;
+  SedonaErrorCode err =
+      sedona_serialize_geom_into(handle, geos_geom, (char *)view.buf + offset,
+                                 (int)capacity, &bytes_written);
+  if (err != SEDONA_SUCCESS) {
+    handle_geomserde_error(err);
+    goto cleanup;
+  }
+  result = PyLong_FromLong(bytes_written);
 
-/* Module definition for Shapely 1.x */
+cleanup:
+  PyBuffer_Release(&view);
+  return result;
+}
+
+static PyObject *serialize_array(PyObject *self, PyObject *args,
+                                 PyObject *kwargs) {
+  static char *kwlist[] = {"geoms", "num_threads", NULL};
+  PyObject *geoms = NULL;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", kwlist, &geoms,
+                                   &num_threads)) {
+    return NULL;
+  }
+
+  /* numpy arrays and other sequences will be converted to a list, lists are
+   * copied so that the geometry objects could not be released by other
+   * threads while we are serializing them. */
+  PyObject *seq = sequence_snapshot(
+      geoms, "serialize_array expects a sequence of geometry objects");
+  if (seq == NULL) {
+    return NULL;
+  }
+
+  if (get_geos_context_handle() == NULL) {
+    Py_DECREF(seq);
+    return NULL;
+  }
+
+  Py_ssize_t num_geoms = PySequence_Fast_GET_SIZE(seq);
+  PyObject **items = PySequence_Fast_ITEMS(seq);
+  SerializeArrayJob job;
+  memset(&job, 0, sizeof(job));
+  job.geoms = PyMem_Calloc(num_geoms + 1, sizeof(GEOSGeometry *));
+  job.buf_sizes = PyMem_Calloc(num_geoms + 1, sizeof(int64_t));
+  if (job.geoms == NULL || job.buf_sizes == NULL) {
+    PyErr_NoMemory();
+    goto handle_error;
+  }
+
+  /* Collect GEOS geometries while holding the GIL. The geometry objects are
+   * kept alive by seq when we serialize them without holding the GIL. */
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    GEOSGeometry *geos_geom = NULL;
+    if (PyGEOS_GetGEOSGeometry(items[k], &geos_geom) == 0) {
+      PyErr_Format(PyExc_TypeError,
+                   "Element %zd is of incorrect type. Please provide only "
+                   "Geometry objects or None.",
+                   k);
+      goto handle_error;
+    }
+    job.geoms[k] = geos_geom;
+  }
+
+  /* Pass 1: compute sizes of serialized geometries */
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, NULL, num_threads, serialized_size_task, &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto handle_error;
+  }
+  batch_error_destroy(&job.error);
+
+  /* Allocate the data buffer at once and assign a region to each geometry */
+  SerializedBatch batch;
+  if (serialized_batch_init(&batch, num_geoms) != 0) {
+    goto handle_error;
+  }
+  Py_ssize_t total_size = 0;
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    total_size += job.buf_sizes[k];
+  }
+  job.data = serialized_batch_reserve(&batch, total_size);
+  if (job.data == NULL) {
+    serialized_batch_destroy(&batch);
+    goto handle_error;
+  }
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    if (job.geoms[k] == NULL) {
+      serialized_batch_set_null(&batch, k);
+    } else {
+      serialized_batch_commit(&batch, k, job.buf_sizes[k]);
+    }
+  }
+  job.offsets = (const int64_t *)PyByteArray_AS_STRING(batch.offsets);
+
+  /* Pass 2: serialize geometries into their regions. The sizes of serialized
+   * geometries are good estimations of the serialization cost. */
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, job.buf_sizes, num_threads, serialize_array_task,
+                  &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    serialized_batch_destroy(&batch);
+    goto handle_error;
+  }
+  batch_error_destroy(&job.error);
+
+  PyMem_Free(job.geoms);
+  PyMem_Free(job.buf_sizes);
+  Py_DECREF(seq);
+  return serialized_batch_finish(&batch);
+
+handle_error:
+  PyMem_Free(job.geoms);
+  PyMem_Free(job.buf_sizes);
+  Py_DECREF(seq);
+  return NULL;
+}
+
+/* Wraps a GEOS geometry as a Python geometry object. The geometry is owned by
+ * the returned object, it is not taken over on failure. */
+typedef PyObject *(*WrapGeomFunc)(PyObject *module, GEOSGeometry *geom,
+                                  GEOSContextHandle_t handle);
+
+static PyObject *create_shapely_2_geometry(PyObject *module,
+                                           GEOSGeometry *geom,
+                                           GEOSContextHandle_t handle) {
+  return PyGEOS_CreateGeometry(geom, handle);
+}
+
+static PyObject *deserialize(PyObject *self, PyObject *args) {
+  GEOSContextHandle_t handle = NULL;
+  int length = 0;
+  GEOSGeometry *geom = do_deserialize(args, &handle, &length);
+  if (geom == NULL) {
+    return NULL;
+  }
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_PYTHON_WRAP);
+  PyObject *pygeom = PyGEOS_CreateGeometry(geom, handle);
+  serde_stats_timer_end(SERDE_STAGE_PYTHON_WRAP, timer);
+  return Py_BuildValue("(Ni)", pygeom, length);
+}
+
+static PyObject *do_deserialize_array(PyObject *module, PyObject *args,
+                                      PyObject *kwargs, WrapGeomFunc wrap) {
+  static char *kwlist[] = {"data", "offsets", "validity", "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOi", kwlist, &data,
+                                   &offsets, &validity, &num_threads)) {
+    return NULL;
+  }
+
+  GEOSContextHandle_t handle = get_geos_context_handle();
+  if (handle == NULL) {
+    return NULL;
+  }
+
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  Py_ssize_t num_geoms = input.num_geoms;
+  PyObject *result = NULL;
+  DeserializeArrayJob job;
+  job.input = &input;
+  job.geoms = PyMem_Calloc(num_geoms + 1, sizeof(GEOSGeometry *));
+  int64_t *weights = PyMem_Calloc(num_geoms + 1, sizeof(int64_t));
+  if (job.geoms == NULL || weights == NULL) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    weights[k] =
+        estimate_deserialization_cost(input.bufs[k], input.buf_sizes[k]);
+  }
+
+  /* Phase 1: build GEOS geometries in parallel without holding the GIL */
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, weights, num_threads, deserialize_array_task,
+                  &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+
+  /* Phase 2: wrap GEOS geometries as Python objects */
+  result = PyList_New(num_geoms);
+  if (result == NULL) {
+    goto cleanup;
+  }
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    if (job.geoms[k] == NULL) {
+      Py_INCREF(Py_None);
+      PyList_SET_ITEM(result, k, Py_None);
+      continue;
+    }
+    int64_t timer = serde_stats_timer_begin(SERDE_STAGE_PYTHON_WRAP);
+    PyObject *pygeom = wrap(module, job.geoms[k], handle);
+    serde_stats_timer_end(SERDE_STAGE_PYTHON_WRAP, timer);
+    if (pygeom == NULL) {
+      /* Unfilled items of the list are NULL, which are correctly handled by
+       * the deallocator of list */
+      Py_CLEAR(result);
+      goto cleanup;
+    }
+    job.geoms[k] = NULL;
+    PyList_SET_ITEM(result, k, pygeom);
+  }
+
+cleanup:
+  if (job.geoms != NULL) {
+    for (Py_ssize_t k = 0; k < num_geoms; k++) {
+      if (job.geoms[k] != NULL) {
+        dyn_GEOSGeom_destroy_r(handle, job.geoms[k]);
+      }
+    }
+  }
+  PyMem_Free(job.geoms);
+  PyMem_Free(weights);
+  batch_input_release(&input);
+  return result;
+}
+
+static PyObject *deserialize_array(PyObject *self, PyObject *args,
+                                   PyObject *kwargs) {
+  return do_deserialize_array(self, args, kwargs, create_shapely_2_geometry);
+}
+
+/* Transcoders convert serialized geometries to other formats, or the other
+ * way around, without constructing GEOS geometries. Binary transcoders
+ * compute the exact size of their output cheaply before writing it, so
+ * outputs are written directly into their final places. Text transcoders
+ * render their output in one pass, since computing the length of text takes
+ * as much work as rendering it. Their write functions report the required
+ * size along with SEDONA_BUFFER_TOO_SMALL when the output does not fit. */
+
+typedef struct TranscodeOptions {
+  int byte_order;
+  int include_srid;
+  int precision;
+  int coord_encoding;
+  double step;
+} TranscodeOptions;
+
+typedef SedonaErrorCode (*TranscodeSizeFunc)(const TranscodeOptions *opts,
+                                             const char *src, int src_size,
+                                             int *p_size);
+typedef SedonaErrorCode (*TranscodeWriteFunc)(const TranscodeOptions *opts,
+                                              const char *src, int src_size,
+                                              char *dst, int dst_capacity,
+                                              int *p_size);
+
+typedef struct Transcoder {
+  TranscodeSizeFunc size; /* NULL for single pass transcoders */
+  TranscodeWriteFunc write;
+  int is_text; /* output of single geometries are str instead of bytes */
+} Transcoder;
+
+static SedonaErrorCode to_wkb_size(const TranscodeOptions *opts,
+                                   const char *src, int src_size,
+                                   int *p_size) {
+  return sedona_wkb_size(src, src_size, opts->include_srid, p_size);
+}
+
+static SedonaErrorCode to_wkb_write(const TranscodeOptions *opts,
+                                    const char *src, int src_size, char *dst,
+                                    int dst_capacity, int *p_size) {
+  return sedona_to_wkb(src, src_size, opts->byte_order, opts->include_srid,
+                       dst, dst_capacity, p_size);
+}
+
+static SedonaErrorCode from_wkb_size(const TranscodeOptions *opts,
+                                     const char *src, int src_size,
+                                     int *p_size) {
+  return sedona_wkb_serialized_size(src, src_size, p_size);
+}
+
+static SedonaErrorCode from_wkb_write(const TranscodeOptions *opts,
+                                      const char *src, int src_size,
+                                      char *dst, int dst_capacity,
+                                      int *p_size) {
+  return wkb_to_sedona(src, src_size, dst, dst_capacity, p_size);
+}
+
+static SedonaErrorCode to_wkt_write(const TranscodeOptions *opts,
+                                    const char *src, int src_size, char *dst,
+                                    int dst_capacity, int *p_size) {
+  return sedona_to_wkt(src, src_size, opts->precision, opts->include_srid,
+                       dst, dst_capacity, p_size);
+}
+
+static SedonaErrorCode to_geojson_write(const TranscodeOptions *opts,
+                                        const char *src, int src_size,
+                                        char *dst, int dst_capacity,
+                                        int *p_size) {
+  return sedona_to_geojson(src, src_size, opts->precision, dst, dst_capacity,
+                           p_size);
+}
+
+static SedonaErrorCode encode_coords_size(const TranscodeOptions *opts,
+                                          const char *src, int src_size,
+                                          int *p_size) {
+  return sedona_encode_coords(src, src_size, opts->coord_encoding, opts->step,
+                              NULL, 0, p_size);
+}
+
+static SedonaErrorCode encode_coords_write(const TranscodeOptions *opts,
+                                           const char *src, int src_size,
+                                           char *dst, int dst_capacity,
+                                           int *p_size) {
+  return sedona_encode_coords(src, src_size, opts->coord_encoding, opts->step,
+                              dst, dst_capacity, p_size);
+}
+
+static const Transcoder to_wkb_transcoder = {to_wkb_size, to_wkb_write, 0};
+static const Transcoder from_wkb_transcoder = {from_wkb_size, from_wkb_write,
+                                               0};
+static const Transcoder to_wkt_transcoder = {NULL, to_wkt_write, 1};
+static const Transcoder to_geojson_transcoder = {NULL, to_geojson_write, 1};
+static const Transcoder encode_coords_transcoder = {encode_coords_size,
+                                                    encode_coords_write, 0};
+/* Size of XOR encoded coordinates is only known after encoding them, so they
+ * are encoded in one pass like text */
+static const Transcoder encode_coords_xor_transcoder = {
+    NULL, encode_coords_write, 0};
+
+static const Transcoder *get_encode_coords_transcoder(int coord_encoding) {
+  if (coord_encoding < COORD_ENCODING_NONE ||
+      coord_encoding > COORD_ENCODING_XOR) {
+    PyErr_Format(PyExc_ValueError, "Unknown coordinate encoding %d",
+                 coord_encoding);
+    return NULL;
+  }
+  return (coord_encoding == COORD_ENCODING_XOR ? &encode_coords_xor_transcoder
+                                               : &encode_coords_transcoder);
+}
+
+static PyObject *new_transcode_output(const Transcoder *transcoder, int size,
+                                      char **p_dst) {
+  PyObject *result;
+  if (transcoder->is_text) {
+    /* Text outputs are pure ASCII */
+    result = PyUnicode_New(size, 127);
+    *p_dst = (result != NULL ? (char *)PyUnicode_1BYTE_DATA(result) : NULL);
+  } else {
+    result = PyBytes_FromStringAndSize(NULL, size);
+    *p_dst = (result != NULL ? PyBytes_AS_STRING(result) : NULL);
+  }
+  return result;
+}
+
+static PyObject *transcode(const Transcoder *transcoder,
+                           const TranscodeOptions *opts, PyObject *obj) {
+  if (obj == Py_None) {
+    Py_INCREF(Py_None);
+    return Py_None;
+  }
+
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) != 0) {
+    return NULL;
+  }
+  PyObject *result = NULL;
+  if (view.len > INT_MAX) {
+    PyErr_SetString(PyExc_ValueError, "Input buffer is too large");
+    goto cleanup;
+  }
+
+  int size = 0;
+  char *dst = NULL;
+  SedonaErrorCode err;
+  if (transcoder->size == NULL) {
+    /* Most geometries fit in the stack buffer, larger ones are rendered again
+     * into an output object of the reported size */
+    char stack_buf[1024];
+    err = transcoder->write(opts, view.buf, (int)view.len, stack_buf,
+                            sizeof(stack_buf), &size);
+    if (err == SEDONA_SUCCESS) {
+      result = new_transcode_output(transcoder, size, &dst);
+      if (result != NULL) {
+        memcpy(dst, stack_buf, size);
+      }
+      goto cleanup;
+    }
+  } else {
+    err = transcoder->size(opts, view.buf, (int)view.len, &size);
+  }
+  if (err != SEDONA_SUCCESS && err != SEDONA_BUFFER_TOO_SMALL) {
+    handle_geomserde_error(err);
+    goto cleanup;
+  }
+  result = new_transcode_output(transcoder, size, &dst);
+  if (result == NULL) {
+    goto cleanup;
+  }
+  err = transcoder->write(opts, view.buf, (int)view.len, dst, size, &size);
+  if (err != SEDONA_SUCCESS) {
+    Py_CLEAR(result);
+    handle_geomserde_error(err);
+  }
+
+cleanup:
+  PyBuffer_Release(&view);
+  return result;
+}
+
+/* Outputs of single pass transcoders are staged in one block per range of
+ * geometries processed by the thread pool. stage_blocks[k] is the block
+ * holding the k-th output at stage_offsets[k]. */
+typedef struct TranscodeArrayJob {
+  const Transcoder *transcoder;
+  const TranscodeOptions *opts;
+  const BatchInput *input;
+  int64_t *sizes;
+  char **stage_blocks;
+  int64_t *stage_offsets;
+  const int64_t *offsets;
+  char *data;
+  BatchError error;
+} TranscodeArrayJob;
+
+/* Buffers of worker threads are allocated the same way as the serde core, so
+ * that they are only traced by tracemalloc when it was requested */
+static void *native_buffer_alloc(size_t size) {
+  return serde_get_allocator()->malloc(size);
+}
+
+static void native_buffer_free(void *ptr) { serde_get_allocator()->free(ptr); }
+
+static SedonaErrorCode transcode_staged(TranscodeArrayJob *job, int64_t k,
+                                        char **p_block, int64_t *p_capacity,
+                                        int64_t *p_used) {
+  const BatchInput *input = job->input;
+  if (*p_block == NULL) {
+    /* Some writers take a NULL destination as a request for the size only */
+    *p_block = native_buffer_alloc(4096);
+    if (*p_block == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+    *p_capacity = 4096;
+  }
+  for (;;) {
+    int64_t available = *p_capacity - *p_used;
+    int size = 0;
+    SedonaErrorCode err = job->transcoder->write(
+        job->opts, input->bufs[k], input->buf_sizes[k], *p_block + *p_used,
+        (int)(available < INT_MAX ? available : INT_MAX), &size);
+    if (err == SEDONA_SUCCESS) {
+      job->sizes[k] = size;
+      job->stage_offsets[k] = *p_used;
+      *p_used += size;
+      return SEDONA_SUCCESS;
+    }
+    if (err != SEDONA_BUFFER_TOO_SMALL) {
+      return err;
+    }
+    int64_t capacity = *p_capacity * 2;
+    if (capacity < *p_used + size) {
+      capacity = *p_used + size;
+    }
+    if (capacity < 4096) {
+      capacity = 4096;
+    }
+    char *block = native_buffer_alloc(capacity);
+    if (block == NULL) {
+      return SEDONA_ALLOC_ERROR;
+    }
+    memcpy(block, *p_block, *p_used);
+    native_buffer_free(*p_block);
+    *p_block = block;
+    *p_capacity = capacity;
+  }
+}
+
+/* The first pass computes sizes of outputs, or renders outputs into staging
+ * blocks for single pass transcoders */
+static void transcode_size_task(void *ctx, int64_t begin, int64_t end) {
+  TranscodeArrayJob *job = ctx;
+  const BatchInput *input = job->input;
+  char *block = NULL;
+  int64_t capacity = 0;
+  int64_t used = 0;
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      break;
+    }
+    if (input->bufs[k] == NULL) {
+      continue;
+    }
+    SedonaErrorCode err;
+    if (job->transcoder->size == NULL) {
+      err = transcode_staged(job, k, &block, &capacity, &used);
+    } else {
+      int size = 0;
+      err = job->transcoder->size(job->opts, input->bufs[k],
+                                  input->buf_sizes[k], &size);
+      job->sizes[k] = size;
+    }
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      break;
+    }
+  }
+  if (job->stage_blocks != NULL) {
+    for (int64_t k = begin; k < end; k++) {
+      job->stage_blocks[k] = block;
+    }
+  }
+}
+
+static void transcode_write_task(void *ctx, int64_t begin, int64_t end) {
+  TranscodeArrayJob *job = ctx;
+  const BatchInput *input = job->input;
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    if (input->bufs[k] == NULL) {
+      continue;
+    }
+    char *dst = job->data + job->offsets[k];
+    if (job->stage_blocks != NULL) {
+      memcpy(dst, job->stage_blocks[k] + job->stage_offsets[k], job->sizes[k]);
+      continue;
+    }
+    int size = 0;
+    SedonaErrorCode err =
+        job->transcoder->write(job->opts, input->bufs[k], input->buf_sizes[k],
+                               dst, (int)job->sizes[k], &size);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+  }
+}
+
+static void free_stage_blocks(char **stage_blocks, Py_ssize_t num_geoms) {
+  if (stage_blocks == NULL) {
+    return;
+  }
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    if (k == 0 || stage_blocks[k] != stage_blocks[k - 1]) {
+      native_buffer_free(stage_blocks[k]);
+    }
+  }
+  PyMem_Free(stage_blocks);
+}
+
+/* Transcode a batch of geometries into a (data, offsets, validity) tuple in
+ * 2 parallel passes: the first pass computes output sizes (or stages the
+ * outputs), the second pass writes outputs into their regions of the data
+ * buffer. */
+static PyObject *transcode_array(const Transcoder *transcoder,
+                                 const TranscodeOptions *opts, PyObject *data,
+                                 PyObject *offsets, PyObject *validity,
+                                 int num_threads) {
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  Py_ssize_t num_geoms = input.num_geoms;
+  PyObject *result = NULL;
+  TranscodeArrayJob job;
+  memset(&job, 0, sizeof(job));
+  job.transcoder = transcoder;
+  job.opts = opts;
+  job.input = &input;
+  job.sizes = PyMem_Calloc(num_geoms + 1, sizeof(int64_t));
+  if (job.sizes == NULL) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  if (transcoder->size == NULL) {
+    job.stage_blocks = PyMem_Calloc(num_geoms + 1, sizeof(char *));
+    job.stage_offsets = PyMem_Calloc(num_geoms + 1, sizeof(int64_t));
+    if (job.stage_blocks == NULL || job.stage_offsets == NULL) {
+      PyErr_NoMemory();
+      goto cleanup;
+    }
+  }
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, NULL, num_threads, transcode_size_task, &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+
+  SerializedBatch batch;
+  if (serialized_batch_init(&batch, num_geoms) != 0) {
+    goto cleanup;
+  }
+  Py_ssize_t total_size = 0;
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    total_size += job.sizes[k];
+  }
+  job.data = serialized_batch_reserve(&batch, total_size);
+  if (job.data == NULL) {
+    serialized_batch_destroy(&batch);
+    goto cleanup;
+  }
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    if (input.bufs[k] == NULL) {
+      serialized_batch_set_null(&batch, k);
+    } else {
+      serialized_batch_commit(&batch, k, job.sizes[k]);
+    }
+  }
+  job.offsets = (const int64_t *)PyByteArray_AS_STRING(batch.offsets);
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, job.sizes, num_threads, transcode_write_task,
+                  &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    serialized_batch_destroy(&batch);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+  result = serialized_batch_finish(&batch);
+
+cleanup:
+  free_stage_blocks(job.stage_blocks, num_geoms);
+  PyMem_Free(job.stage_offsets);
+  PyMem_Free(job.sizes);
+  batch_input_release(&input);
+  return result;
+}
+
+static PyObject *to_wkb(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static char *kwlist[] = {"buf", "byte_order", "include_srid", NULL};
+  PyObject *obj = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ip", kwlist, &obj,
+                                   &opts.byte_order, &opts.include_srid)) {
+    return NULL;
+  }
+  return transcode(&to_wkb_transcoder, &opts, obj);
+}
+
+static PyObject *from_wkb(PyObject *self, PyObject *args) {
+  PyObject *obj = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  if (!PyArg_ParseTuple(args, "O", &obj)) {
+    return NULL;
+  }
+  return transcode(&from_wkb_transcoder, &opts, obj);
+}
+
+static PyObject *to_wkb_array(PyObject *self, PyObject *args,
+                              PyObject *kwargs) {
+  static char *kwlist[] = {"data",         "offsets",     "validity",
+                           "byte_order",   "include_srid", "num_threads",
+                           NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOipi", kwlist, &data,
+                                   &offsets, &validity, &opts.byte_order,
+                                   &opts.include_srid, &num_threads)) {
+    return NULL;
+  }
+  return transcode_array(&to_wkb_transcoder, &opts, data, offsets, validity,
+                         num_threads);
+}
+
+static PyObject *from_wkb_array(PyObject *self, PyObject *args,
+                                PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets", "validity", "num_threads",
+                           NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOi", kwlist, &data,
+                                   &offsets, &validity, &num_threads)) {
+    return NULL;
+  }
+  return transcode_array(&from_wkb_transcoder, &opts, data, offsets,
+                         validity, num_threads);
+}
+
+static PyObject *to_wkt(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static char *kwlist[] = {"buf", "precision", "include_srid", NULL};
+  PyObject *obj = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ip", kwlist, &obj,
+                                   &opts.precision, &opts.include_srid)) {
+    return NULL;
+  }
+  return transcode(&to_wkt_transcoder, &opts, obj);
+}
+
+static PyObject *to_geojson(PyObject *self, PyObject *args,
+                            PyObject *kwargs) {
+  static char *kwlist[] = {"buf", "precision", NULL};
+  PyObject *obj = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", kwlist, &obj,
+                                   &opts.precision)) {
+    return NULL;
+  }
+  return transcode(&to_geojson_transcoder, &opts, obj);
+}
+
+static PyObject *to_wkt_array(PyObject *self, PyObject *args,
+                              PyObject *kwargs) {
+  static char *kwlist[] = {"data",      "offsets",      "validity",
+                           "precision", "include_srid", "num_threads",
+                           NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOipi", kwlist, &data,
+                                   &offsets, &validity, &opts.precision,
+                                   &opts.include_srid, &num_threads)) {
+    return NULL;
+  }
+  return transcode_array(&to_wkt_transcoder, &opts, data, offsets, validity,
+                         num_threads);
+}
+
+static PyObject *to_geojson_array(PyObject *self, PyObject *args,
+                                  PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets", "validity", "precision",
+                           "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1};
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOii", kwlist, &data,
+                                   &offsets, &validity, &opts.precision,
+                                   &num_threads)) {
+    return NULL;
+  }
+  return transcode_array(&to_geojson_transcoder, &opts, data, offsets,
+                         validity, num_threads);
+}
+
+static PyObject *encode_coords(PyObject *self, PyObject *args,
+                               PyObject *kwargs) {
+  static char *kwlist[] = {"buf", "coord_encoding", "step", NULL};
+  PyObject *obj = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1, COORD_ENCODING_NONE, 0};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|id", kwlist, &obj,
+                                   &opts.coord_encoding, &opts.step)) {
+    return NULL;
+  }
+  const Transcoder *transcoder =
+      get_encode_coords_transcoder(opts.coord_encoding);
+  if (transcoder == NULL) {
+    return NULL;
+  }
+  return transcode(transcoder, &opts, obj);
+}
+
+static PyObject *encode_coords_array(PyObject *self, PyObject *args,
+                                     PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets",     "validity", "coord_encoding",
+                           "step", "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  TranscodeOptions opts = {SEDONA_WKB_NDR, 0, -1, COORD_ENCODING_NONE, 0};
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOidi", kwlist, &data,
+                                   &offsets, &validity, &opts.coord_encoding,
+                                   &opts.step, &num_threads)) {
+    return NULL;
+  }
+  const Transcoder *transcoder =
+      get_encode_coords_transcoder(opts.coord_encoding);
+  if (transcoder == NULL) {
+    return NULL;
+  }
+  return transcode_array(transcoder, &opts, data, offsets, validity,
+                         num_threads);
+}
+
+/* Exchanging batches of serialized geometries with Arrow as GeoArrow native
+ * arrays. The Arrow C data interface structs are wrapped in PyCapsules
+ * following the Arrow PyCapsule interface, so that any Arrow implementation
+ * could consume or produce them without a build-time dependency on pyarrow.
+ * Consumers move the structs out of the capsules and mark them as released,
+ * otherwise the structs are released when the capsules are destroyed. */
+
+static void arrow_schema_capsule_destructor(PyObject *capsule) {
+  struct ArrowSchema *schema = PyCapsule_GetPointer(capsule, "arrow_schema");
+  if (schema->release != NULL) {
+    schema->release(schema);
+  }
+  PyMem_Free(schema);
+}
+
+static void arrow_array_capsule_destructor(PyObject *capsule) {
+  struct ArrowArray *array = PyCapsule_GetPointer(capsule, "arrow_array");
+  if (array->release != NULL) {
+    array->release(array);
+  }
+  PyMem_Free(array);
+}
+
+static PyObject *to_geoarrow(PyObject *self, PyObject *args,
+                             PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets", "validity", "interleaved",
+                           NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  int interleaved = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOp", kwlist, &data,
+                                   &offsets, &validity, &interleaved)) {
+    return NULL;
+  }
+
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+  struct ArrowSchema *schema = PyMem_Malloc(sizeof(struct ArrowSchema));
+  struct ArrowArray *array = PyMem_Malloc(sizeof(struct ArrowArray));
+  PyObject *schema_capsule = NULL;
+  PyObject *array_capsule = NULL;
+  if (schema == NULL || array == NULL) {
+    PyErr_NoMemory();
+    goto fail;
+  }
+  schema->release = NULL;
+  array->release = NULL;
+
+  SedonaErrorCode err;
+  Py_BEGIN_ALLOW_THREADS;
+  err = sedona_export_geoarrow(input.bufs, input.buf_sizes, input.num_geoms,
+                               interleaved, schema, array);
+  Py_END_ALLOW_THREADS;
+  batch_input_release(&input);
+  if (err != SEDONA_SUCCESS) {
+    handle_geomserde_error(err);
+    PyMem_Free(schema);
+    PyMem_Free(array);
+    return NULL;
+  }
+
+  /* The structs are owned by the capsules once they were created */
+  schema_capsule = PyCapsule_New(schema, "arrow_schema",
+                                 arrow_schema_capsule_destructor);
+  if (schema_capsule == NULL) {
+    schema->release(schema);
+    PyMem_Free(schema);
+    array->release(array);
+    PyMem_Free(array);
+    return NULL;
+  }
+  array_capsule =
+      PyCapsule_New(array, "arrow_array", arrow_array_capsule_destructor);
+  if (array_capsule == NULL) {
+    Py_DECREF(schema_capsule);
+    array->release(array);
+    PyMem_Free(array);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", schema_capsule, array_capsule);
+
+fail:
+  batch_input_release(&input);
+  PyMem_Free(schema);
+  PyMem_Free(array);
+  return NULL;
+}
+
+typedef struct GeoArrowImportJob {
+  const GeoArrowReader *reader;
+  int64_t *sizes;
+  char *data;
+  const int64_t *offsets;
+  BatchError error;
+} GeoArrowImportJob;
+
+static void geoarrow_size_task(void *ctx, int64_t begin, int64_t end) {
+  GeoArrowImportJob *job = ctx;
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    if (geoarrow_reader_is_null(job->reader, k)) {
+      continue;
+    }
+    int size = 0;
+    SedonaErrorCode err =
+        geoarrow_reader_serialized_size(job->reader, k, &size);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+    job->sizes[k] = size;
+  }
+}
+
+static void geoarrow_read_task(void *ctx, int64_t begin, int64_t end) {
+  GeoArrowImportJob *job = ctx;
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    if (geoarrow_reader_is_null(job->reader, k)) {
+      continue;
+    }
+    int size = 0;
+    SedonaErrorCode err =
+        geoarrow_reader_read(job->reader, k, job->data + job->offsets[k],
+                             (int)job->sizes[k], &size);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+  }
+}
+
+static PyObject *from_geoarrow(PyObject *self, PyObject *args,
+                               PyObject *kwargs) {
+  static char *kwlist[] = {"schema", "array", "geom_type", "num_threads",
+                           NULL};
+  PyObject *schema_capsule = NULL;
+  PyObject *array_capsule = NULL;
+  int geom_type = 0;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|ii", kwlist,
+                                   &schema_capsule, &array_capsule,
+                                   &geom_type, &num_threads)) {
+    return NULL;
+  }
+  struct ArrowSchema *schema = NULL;
+  struct ArrowArray *array = NULL;
+  if (get_arrow_structs(schema_capsule, array_capsule, &schema, &array) != 0) {
+    return NULL;
+  }
+
+  GeoArrowReader reader;
+  SedonaErrorCode err = geoarrow_reader_init(&reader, schema, array, geom_type);
+  if (err != SEDONA_SUCCESS) {
+    handle_geomserde_error(err);
+    return NULL;
+  }
+
+  Py_ssize_t num_geoms = (Py_ssize_t)reader.length;
+  PyObject *result = NULL;
+  GeoArrowImportJob job;
+  job.reader = &reader;
+  job.sizes = PyMem_Calloc(num_geoms + 1, sizeof(int64_t));
+  if (job.sizes == NULL) {
+    return PyErr_NoMemory();
+  }
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, NULL, num_threads, geoarrow_size_task, &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+
+  SerializedBatch batch;
+  if (serialized_batch_init(&batch, num_geoms) != 0) {
+    goto cleanup;
+  }
+  Py_ssize_t total_size = 0;
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    total_size += job.sizes[k];
+  }
+  job.data = serialized_batch_reserve(&batch, total_size);
+  if (job.data == NULL) {
+    serialized_batch_destroy(&batch);
+    goto cleanup;
+  }
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    if (geoarrow_reader_is_null(&reader, k)) {
+      serialized_batch_set_null(&batch, k);
+    } else {
+      serialized_batch_commit(&batch, k, job.sizes[k]);
+    }
+  }
+  job.offsets = (const int64_t *)PyByteArray_AS_STRING(batch.offsets);
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_geoms, job.sizes, num_threads, geoarrow_read_task,
+                  &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    serialized_batch_destroy(&batch);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+  result = serialized_batch_finish(&batch);
+
+cleanup:
+  PyMem_Free(job.sizes);
+  return result;
+}
+
+/* Framed streams of serialized geometries. Each record is a 4-byte little
+ * endian signed length followed by the serialized geometry, null geometries
+ * are encoded as a length of -1 without payload. Framing lets readers find
+ * record boundaries without parsing the geometries, so a stream could be
+ * consumed in arbitrary chunks and complete records are decoded in batches. */
+
+#define FRAME_HEADER_SIZE 4
+#define FRAME_NULL_LENGTH (-1)
+
+static inline int32_t load_frame_length(const unsigned char *p) {
+  uint32_t value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                   ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  return (int32_t)value;
+}
+
+static inline void store_frame_length(unsigned char *p, int32_t length) {
+  uint32_t value = (uint32_t)length;
+  p[0] = (unsigned char)value;
+  p[1] = (unsigned char)(value >> 8);
+  p[2] = (unsigned char)(value >> 16);
+  p[3] = (unsigned char)(value >> 24);
+}
+
+static PyObject *frame_array(PyObject *self, PyObject *args,
+                             PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets", "validity", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OO", kwlist, &data,
+                                   &offsets, &validity)) {
+    return NULL;
+  }
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  Py_ssize_t total_size = 0;
+  for (Py_ssize_t k = 0; k < input.num_geoms; k++) {
+    total_size += FRAME_HEADER_SIZE + input.buf_sizes[k];
+  }
+  PyObject *result = PyByteArray_FromStringAndSize(NULL, total_size);
+  if (result != NULL) {
+    unsigned char *p = (unsigned char *)PyByteArray_AS_STRING(result);
+    for (Py_ssize_t k = 0; k < input.num_geoms; k++) {
+      if (input.bufs[k] == NULL) {
+        store_frame_length(p, FRAME_NULL_LENGTH);
+        p += FRAME_HEADER_SIZE;
+        continue;
+      }
+      store_frame_length(p, input.buf_sizes[k]);
+      memcpy(p + FRAME_HEADER_SIZE, input.bufs[k], input.buf_sizes[k]);
+      p += FRAME_HEADER_SIZE + input.buf_sizes[k];
+    }
+  }
+  batch_input_release(&input);
+  return result;
+}
+
+static PyObject *split_frames(PyObject *self, PyObject *args) {
+  PyObject *obj = NULL;
+  if (!PyArg_ParseTuple(args, "O", &obj)) {
+    return NULL;
+  }
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS) != 0) {
+    return NULL;
+  }
+
+  /* Find complete records, the trailing partial record is left for the next
+   * call after more data arrived */
+  const unsigned char *buf = view.buf;
+  Py_ssize_t pos = 0;
+  Py_ssize_t num_geoms = 0;
+  Py_ssize_t total_size = 0;
+  while (view.len - pos >= FRAME_HEADER_SIZE) {
+    int32_t length = load_frame_length(buf + pos);
+    if (length < FRAME_NULL_LENGTH) {
+      PyErr_Format(PyExc_ValueError, "Invalid frame length %d at offset %zd",
+                   (int)length, pos);
+      PyBuffer_Release(&view);
+      return NULL;
+    }
+    Py_ssize_t payload_size = (length > 0 ? length : 0);
+    if (view.len - pos - FRAME_HEADER_SIZE < payload_size) {
+      break;
+    }
+    pos += FRAME_HEADER_SIZE + payload_size;
+    total_size += payload_size;
+    num_geoms++;
+  }
+  Py_ssize_t consumed = pos;
+
+  SerializedBatch batch;
+  if (serialized_batch_init(&batch, num_geoms) != 0) {
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  char *dst = serialized_batch_reserve(&batch, total_size);
+  if (dst == NULL) {
+    serialized_batch_destroy(&batch);
+    PyBuffer_Release(&view);
+    return NULL;
+  }
+  pos = 0;
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    int32_t length = load_frame_length(buf + pos);
+    pos += FRAME_HEADER_SIZE;
+    if (length == FRAME_NULL_LENGTH) {
+      serialized_batch_set_null(&batch, k);
+      continue;
+    }
+    memcpy(dst, buf + pos, length);
+    dst += length;
+    pos += length;
+    serialized_batch_commit(&batch, k, length);
+  }
+  PyBuffer_Release(&view);
+
+  PyObject *frames = serialized_batch_finish(&batch);
+  if (frames == NULL) {
+    return NULL;
+  }
+  return Py_BuildValue("(Nn)", frames, consumed);
+}
+
+/* Pad each serialized geometry with zero bytes to a multiple of alignment
+ * bytes. Deserializers ignore trailing bytes after the geometry, so padded
+ * batches could be decoded as-is while the coordinates of every record stay
+ * aligned when the batch is stored at an aligned address (e.g. in a memory
+ * mapped file). Null geometries remain empty. */
+static inline Py_ssize_t align_size(Py_ssize_t size, Py_ssize_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+static PyObject *pad_array(PyObject *self, PyObject *args, PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets", "validity", "alignment", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  Py_ssize_t alignment = 8;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOn", kwlist, &data,
+                                   &offsets, &validity, &alignment)) {
+    return NULL;
+  }
+  if (alignment <= 0) {
+    PyErr_Format(PyExc_ValueError, "Invalid alignment %zd", alignment);
+    return NULL;
+  }
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  PyObject *result = NULL;
+  SerializedBatch batch;
+  if (serialized_batch_init(&batch, input.num_geoms) != 0) {
+    goto cleanup;
+  }
+  Py_ssize_t total_size = 0;
+  for (Py_ssize_t k = 0; k < input.num_geoms; k++) {
+    if (input.bufs[k] != NULL) {
+      total_size += align_size(input.buf_sizes[k], alignment);
+    }
+  }
+  char *dst = serialized_batch_reserve(&batch, total_size);
+  if (dst == NULL) {
+    serialized_batch_destroy(&batch);
+    goto cleanup;
+  }
+  for (Py_ssize_t k = 0; k < input.num_geoms; k++) {
+    if (input.bufs[k] == NULL) {
+      serialized_batch_set_null(&batch, k);
+      continue;
+    }
+    Py_ssize_t size = input.buf_sizes[k];
+    Py_ssize_t padded_size = align_size(size, alignment);
+    memcpy(dst, input.bufs[k], size);
+    memset(dst + size, 0, padded_size - size);
+    dst += padded_size;
+    serialized_batch_commit(&batch, k, padded_size);
+  }
+  result = serialized_batch_finish(&batch);
+
+cleanup:
+  batch_input_release(&input);
+  return result;
+}
+
+/* Block compression of batches of serialized geometries. Rows are grouped
+ * into blocks of rows_per_block rows, the raw form of a block is the
+ * concatenation of its serialized geometries followed by int32 sizes of its
+ * rows (-1 for nulls), which is compressed by block_compress. Blocks are
+ * described by an index of int64 (offset, compressed size, raw size, number
+ * of rows) tuples, and are compressed or decompressed in parallel. */
+
+#define BLOCK_INDEX_FIELDS 4
+
+typedef struct CompressBlocksJob {
+  const BatchInput *input;
+  Py_ssize_t rows_per_block;
+  int64_t *index;
+  char **blocks;
+  BatchError error;
+} CompressBlocksJob;
+
+static void compress_blocks_task(void *ctx, int64_t begin, int64_t end) {
+  CompressBlocksJob *job = ctx;
+  const BatchInput *input = job->input;
+  for (int64_t b = begin; b < end; b++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    int64_t *entry = job->index + BLOCK_INDEX_FIELDS * b;
+    Py_ssize_t row_begin = b * job->rows_per_block;
+    Py_ssize_t row_end = row_begin + entry[3];
+    int raw_size = (int)entry[2];
+    char *raw = native_buffer_alloc(raw_size > 0 ? raw_size : 1);
+    int capacity = block_compress_bound(raw_size);
+    char *block = native_buffer_alloc(capacity);
+    if (raw == NULL || block == NULL) {
+      native_buffer_free(raw);
+      native_buffer_free(block);
+      batch_error_set(&job->error, row_begin, SEDONA_ALLOC_ERROR);
+      return;
+    }
+    char *p = raw;
+    char *sizes = raw + raw_size - entry[3] * sizeof(int32_t);
+    for (Py_ssize_t k = row_begin; k < row_end; k++) {
+      int32_t size = -1;
+      if (input->bufs[k] != NULL) {
+        size = input->buf_sizes[k];
+        memcpy(p, input->bufs[k], size);
+        p += size;
+      }
+      memcpy(sizes + (k - row_begin) * sizeof(int32_t), &size, sizeof(size));
+    }
+    int size = 0;
+    SedonaErrorCode err = block_compress(raw, raw_size, block, capacity, &size);
+    native_buffer_free(raw);
+    if (err != SEDONA_SUCCESS) {
+      native_buffer_free(block);
+      batch_error_set(&job->error, row_begin, err);
+      return;
+    }
+    entry[1] = size;
+    job->blocks[b] = block;
+  }
+}
+
+static PyObject *compress_blocks(PyObject *self, PyObject *args,
+                                 PyObject *kwargs) {
+  static char *kwlist[] = {"data",           "offsets",     "validity",
+                           "rows_per_block", "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  Py_ssize_t rows_per_block = 4096;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOni", kwlist, &data,
+                                   &offsets, &validity, &rows_per_block,
+                                   &num_threads)) {
+    return NULL;
+  }
+  if (rows_per_block <= 0) {
+    PyErr_Format(PyExc_ValueError, "Invalid rows_per_block %zd",
+                 rows_per_block);
+    return NULL;
+  }
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  PyObject *result = NULL;
+  PyObject *compressed = NULL;
+  Py_ssize_t num_blocks =
+      (input.num_geoms + rows_per_block - 1) / rows_per_block;
+  CompressBlocksJob job;
+  job.input = &input;
+  job.rows_per_block = rows_per_block;
+  job.blocks = PyMem_Calloc(num_blocks + 1, sizeof(char *));
+  int64_t *weights = PyMem_Calloc(num_blocks + 1, sizeof(int64_t));
+  PyObject *index = PyByteArray_FromStringAndSize(
+      NULL, num_blocks * BLOCK_INDEX_FIELDS * sizeof(int64_t));
+  if (job.blocks == NULL || weights == NULL) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  if (index == NULL) {
+    goto cleanup;
+  }
+  job.index = (int64_t *)PyByteArray_AS_STRING(index);
+  for (Py_ssize_t b = 0; b < num_blocks; b++) {
+    Py_ssize_t row_begin = b * rows_per_block;
+    Py_ssize_t num_rows = input.num_geoms - row_begin;
+    if (num_rows > rows_per_block) {
+      num_rows = rows_per_block;
+    }
+    int64_t raw_size = num_rows * sizeof(int32_t);
+    for (Py_ssize_t k = row_begin; k < row_begin + num_rows; k++) {
+      if (input.bufs[k] != NULL) {
+        raw_size += input.buf_sizes[k];
+      }
+    }
+    /* Leave room for the worst-case expansion of compression */
+    if (raw_size >= INT_MAX / 2) {
+      PyErr_Format(PyExc_ValueError,
+                   "Block %zd is too large, use a smaller rows_per_block", b);
+      goto cleanup;
+    }
+    int64_t *entry = job.index + BLOCK_INDEX_FIELDS * b;
+    entry[0] = 0;
+    entry[1] = 0;
+    entry[2] = raw_size;
+    entry[3] = num_rows;
+    weights[b] = 1 + raw_size / 64;
+  }
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_blocks, weights, num_threads, compress_blocks_task,
+                  &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+
+  Py_ssize_t total_size = 0;
+  for (Py_ssize_t b = 0; b < num_blocks; b++) {
+    job.index[BLOCK_INDEX_FIELDS * b] = total_size;
+    total_size += job.index[BLOCK_INDEX_FIELDS * b + 1];
+  }
+  compressed = PyByteArray_FromStringAndSize(NULL, total_size);
+  if (compressed == NULL) {
+    goto cleanup;
+  }
+  char *dst = PyByteArray_AS_STRING(compressed);
+  for (Py_ssize_t b = 0; b < num_blocks; b++) {
+    const int64_t *entry = job.index + BLOCK_INDEX_FIELDS * b;
+    memcpy(dst + entry[0], job.blocks[b], entry[1]);
+  }
+  result = Py_BuildValue("(OO)", compressed, index);
+
+cleanup:
+  if (job.blocks != NULL) {
+    for (Py_ssize_t b = 0; b < num_blocks; b++) {
+      native_buffer_free(job.blocks[b]);
+    }
+  }
+  PyMem_Free(job.blocks);
+  PyMem_Free(weights);
+  Py_XDECREF(compressed);
+  Py_XDECREF(index);
+  batch_input_release(&input);
+  return result;
+}
+
+typedef struct DecompressBlocksJob {
+  const char *src;
+  const int64_t *index;
+  const int64_t *row_starts;
+  const int64_t *data_starts;
+  char *data;
+  int64_t *offsets;
+  uint8_t *is_valid;
+  BatchError error;
+} DecompressBlocksJob;
+
+static SedonaErrorCode decompress_block(DecompressBlocksJob *job, int64_t b) {
+  const int64_t *entry = job->index + BLOCK_INDEX_FIELDS * b;
+  int raw_size = (int)entry[2];
+  int64_t num_rows = entry[3];
+  char *raw = native_buffer_alloc(raw_size > 0 ? raw_size : 1);
+  if (raw == NULL) {
+    return SEDONA_ALLOC_ERROR;
+  }
+  SedonaErrorCode err = block_decompress(job->src + entry[0], (int)entry[1],
+                                         raw, raw_size);
+  if (err == SEDONA_SUCCESS) {
+    const char *sizes = raw + raw_size - num_rows * sizeof(int32_t);
+    int64_t data_size = sizes - raw;
+    int64_t pos = 0;
+    int64_t row_start = job->row_starts[b];
+    int64_t data_start = job->data_starts[b];
+    for (int64_t k = 0; k < num_rows; k++) {
+      int32_t size;
+      memcpy(&size, sizes + k * sizeof(int32_t), sizeof(size));
+      if (size < -1 || size > data_size - pos) {
+        err = SEDONA_BAD_GEOM_BUFFER;
+        break;
+      }
+      if (size >= 0) {
+        pos += size;
+        job->is_valid[row_start + k] = 1;
+      }
+      job->offsets[row_start + k + 1] = data_start + pos;
+    }
+    if (err == SEDONA_SUCCESS && pos != data_size) {
+      err = SEDONA_BAD_GEOM_BUFFER;
+    }
+    if (err == SEDONA_SUCCESS) {
+      memcpy(job->data + data_start, raw, data_size);
+    }
+  }
+  native_buffer_free(raw);
+  return err;
+}
+
+static void decompress_blocks_task(void *ctx, int64_t begin, int64_t end) {
+  DecompressBlocksJob *job = ctx;
+  for (int64_t b = begin; b < end; b++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    SedonaErrorCode err = decompress_block(job, b);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, job->row_starts[b], err);
+      return;
+    }
+  }
+}
+
+static PyObject *decompress_blocks(PyObject *self, PyObject *args,
+                                   PyObject *kwargs) {
+  static char *kwlist[] = {"data", "index", "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *index_obj = NULL;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|i", kwlist, &data,
+                                   &index_obj, &num_threads)) {
+    return NULL;
+  }
+  Py_buffer data_view;
+  Py_buffer index_view;
+  if (PyObject_GetBuffer(data, &data_view, PyBUF_C_CONTIGUOUS) != 0) {
+    return NULL;
+  }
+  if (PyObject_GetBuffer(index_obj, &index_view, PyBUF_C_CONTIGUOUS) != 0) {
+    PyBuffer_Release(&data_view);
+    return NULL;
+  }
+
+  PyObject *result = NULL;
+  int64_t *index = NULL;
+  int64_t *row_starts = NULL;
+  int64_t *data_starts = NULL;
+  int64_t *weights = NULL;
+  uint8_t *is_valid = NULL;
+  SerializedBatch batch;
+  int has_batch = 0;
+  const Py_ssize_t entry_size = BLOCK_INDEX_FIELDS * sizeof(int64_t);
+  if (index_view.len % entry_size != 0) {
+    PyErr_SetString(PyExc_ValueError,
+                    "Block index should be an array of int64 (offset, "
+                    "compressed size, raw size, number of rows) tuples");
+    goto cleanup;
+  }
+  Py_ssize_t num_blocks = index_view.len / entry_size;
+
+  /* The index may not be aligned when passed in as raw bytes */
+  index = PyMem_Malloc(index_view.len + 1);
+  row_starts = PyMem_Calloc(num_blocks + 1, sizeof(int64_t));
+  data_starts = PyMem_Calloc(num_blocks + 1, sizeof(int64_t));
+  weights = PyMem_Calloc(num_blocks + 1, sizeof(int64_t));
+  if (index == NULL || row_starts == NULL || data_starts == NULL ||
+      weights == NULL) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  memcpy(index, index_view.buf, index_view.len);
+  for (Py_ssize_t b = 0; b < num_blocks; b++) {
+    const int64_t *entry = index + BLOCK_INDEX_FIELDS * b;
+    if (entry[0] < 0 || entry[1] < 0 || entry[1] > data_view.len - entry[0] ||
+        entry[2] < 0 || entry[2] >= INT_MAX / 2 || entry[3] < 0 ||
+        entry[3] > entry[2] / (int64_t)sizeof(int32_t)) {
+      PyErr_Format(PyExc_ValueError, "Invalid index entry of block %zd", b);
+      goto cleanup;
+    }
+    row_starts[b + 1] = row_starts[b] + entry[3];
+    data_starts[b + 1] =
+        data_starts[b] + entry[2] - entry[3] * (int64_t)sizeof(int32_t);
+    weights[b] = 1 + entry[2] / 64;
+  }
+
+  Py_ssize_t num_geoms = row_starts[num_blocks];
+  is_valid = PyMem_Calloc(num_geoms + 1, 1);
+  if (is_valid == NULL) {
+    PyErr_NoMemory();
+    goto cleanup;
+  }
+  if (serialized_batch_init(&batch, num_geoms) != 0) {
+    goto cleanup;
+  }
+  has_batch = 1;
+  DecompressBlocksJob job;
+  job.src = data_view.buf;
+  job.index = index;
+  job.row_starts = row_starts;
+  job.data_starts = data_starts;
+  job.data = serialized_batch_reserve(&batch, data_starts[num_blocks]);
+  if (job.data == NULL) {
+    goto cleanup;
+  }
+  job.offsets = (int64_t *)PyByteArray_AS_STRING(batch.offsets);
+  job.is_valid = is_valid;
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(num_blocks, weights, num_threads, decompress_blocks_task,
+                  &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+
+  /* Validity bits of adjacent blocks may share bytes, so they are set after
+   * all blocks were decompressed */
+  char *validity = PyByteArray_AS_STRING(batch.validity);
+  for (Py_ssize_t k = 0; k < num_geoms; k++) {
+    if (is_valid[k]) {
+      validity[k >> 3] |= (char)(1 << (k & 7));
+    }
+  }
+  batch.data_size = data_starts[num_blocks];
+  has_batch = 0;
+  result = serialized_batch_finish(&batch);
+
+cleanup:
+  if (has_batch) {
+    serialized_batch_destroy(&batch);
+  }
+  PyMem_Free(index);
+  PyMem_Free(row_starts);
+  PyMem_Free(data_starts);
+  PyMem_Free(weights);
+  PyMem_Free(is_valid);
+  PyBuffer_Release(&index_view);
+  PyBuffer_Release(&data_view);
+  return result;
+}
+
+/* Structure-only validation of untrusted serialized geometries, which
+ * neither constructs GEOS geometries nor allocates memory per geometry. */
+
+static PyObject *validate(PyObject *self, PyObject *args) {
+  PyObject *obj = NULL;
+  if (!PyArg_ParseTuple(args, "O", &obj)) {
+    return NULL;
+  }
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS) != 0) {
+    return NULL;
+  }
+  SedonaErrorCode err = SEDONA_BAD_GEOM_BUFFER;
+  if (view.len <= INT_MAX) {
+    err = sedona_validate(view.buf, (int)view.len, NULL);
+  }
+  PyBuffer_Release(&view);
+  return PyLong_FromLong(err);
+}
+
+typedef struct ValidateArrayJob {
+  const BatchInput *input;
+  int8_t *codes;
+} ValidateArrayJob;
+
+static void validate_array_task(void *ctx, int64_t begin, int64_t end) {
+  ValidateArrayJob *job = ctx;
+  const BatchInput *input = job->input;
+  for (int64_t k = begin; k < end; k++) {
+    job->codes[k] =
+        (input->bufs[k] == NULL
+             ? SEDONA_SUCCESS
+             : (int8_t)sedona_validate(input->bufs[k], input->buf_sizes[k],
+                                       NULL));
+  }
+}
+
+static PyObject *validate_array(PyObject *self, PyObject *args,
+                                PyObject *kwargs) {
+  static char *kwlist[] = {"data", "offsets", "validity", "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOi", kwlist, &data,
+                                   &offsets, &validity, &num_threads)) {
+    return NULL;
+  }
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  Py_ssize_t n = input.num_geoms;
+  int64_t *weights = NULL;
+  PyObject *codes = PyByteArray_FromStringAndSize(NULL, n);
+  if (codes == NULL) {
+    goto cleanup;
+  }
+  weights = PyMem_Calloc(n + 1, sizeof(int64_t));
+  if (weights == NULL) {
+    PyErr_NoMemory();
+    Py_CLEAR(codes);
+    goto cleanup;
+  }
+  for (Py_ssize_t k = 0; k < n; k++) {
+    weights[k] = 1 + input.buf_sizes[k] / 64;
+  }
+  ValidateArrayJob job;
+  job.input = &input;
+  job.codes = (int8_t *)PyByteArray_AS_STRING(codes);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(n, weights, num_threads, validate_array_task, &job);
+  Py_END_ALLOW_THREADS;
+
+cleanup:
+  PyMem_Free(weights);
+  batch_input_release(&input);
+  return codes;
+}
+
+static PyObject *get_error_message(PyObject *self, PyObject *args) {
+  int err = 0;
+  if (!PyArg_ParseTuple(args, "i", &err)) {
+    return NULL;
+  }
+  return PyUnicode_FromString(sedona_get_error_message(err));
+}
+
+/* Scanning headers and bounds of a batch of serialized geometries. This does
+ * not construct any GEOS geometry, so it works for both Shapely 1.x and 2.x.
+ * Results are written to columnar buffers which will be wrapped as numpy
+ * arrays by the Python wrapper. */
+
+typedef struct GeomInfoArrayJob {
+  const BatchInput *input;
+  int compute_bounds;
+  int8_t *geom_types;
+  int32_t *srids;
+  int8_t *dims;
+  int32_t *num_coords;
+  uint8_t *is_empty;
+  double *bounds;
+  BatchError error;
+} GeomInfoArrayJob;
+
+static void geom_info_array_task(void *ctx, int64_t begin, int64_t end) {
+  GeomInfoArrayJob *job = ctx;
+  const BatchInput *input = job->input;
+  for (int64_t k = begin; k < end; k++) {
+    if (batch_error_occurred(&job->error)) {
+      return;
+    }
+    double *bounds = job->bounds + 4 * k;
+    if (input->bufs[k] == NULL) {
+      /* Null geometries have geometry type 0 */
+      job->geom_types[k] = 0;
+      job->srids[k] = 0;
+      job->dims[k] = 0;
+      job->num_coords[k] = 0;
+      job->is_empty[k] = 1;
+      bounds[0] = bounds[1] = bounds[2] = bounds[3] = NAN;
+      continue;
+    }
+    SedonaGeometryInfo info;
+    SedonaErrorCode err =
+        sedona_get_geom_info(input->bufs[k], input->buf_sizes[k],
+                             job->compute_bounds, &info, NULL);
+    if (err != SEDONA_SUCCESS) {
+      batch_error_set(&job->error, k, err);
+      return;
+    }
+    job->geom_types[k] = (int8_t)info.geom_type;
+    job->srids[k] = info.srid;
+    job->dims[k] = (int8_t)info.dims;
+    job->num_coords[k] = info.num_coords;
+    job->is_empty[k] = (uint8_t)info.is_empty;
+    if (job->compute_bounds) {
+      memcpy(bounds, info.bounds, sizeof(info.bounds));
+    } else {
+      bounds[0] = bounds[1] = bounds[2] = bounds[3] = NAN;
+    }
+  }
+}
+
+static PyObject *get_geom_info_array(PyObject *self, PyObject *args,
+                                     PyObject *kwargs) {
+  static char *kwlist[] = {"data",           "offsets",     "validity",
+                           "compute_bounds", "num_threads", NULL};
+  PyObject *data = NULL;
+  PyObject *offsets = NULL;
+  PyObject *validity = NULL;
+  int compute_bounds = 1;
+  int num_threads = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOpi", kwlist, &data,
+                                   &offsets, &validity, &compute_bounds,
+                                   &num_threads)) {
+    return NULL;
+  }
+
+  BatchInput input;
+  if (batch_input_init(&input, data, offsets, validity) != 0) {
+    batch_input_release(&input);
+    return NULL;
+  }
+
+  Py_ssize_t n = input.num_geoms;
+  PyObject *result = NULL;
+  int64_t *weights = NULL;
+  PyObject *geom_types = PyByteArray_FromStringAndSize(NULL, n);
+  PyObject *srids = PyByteArray_FromStringAndSize(NULL, n * sizeof(int32_t));
+  PyObject *dims = PyByteArray_FromStringAndSize(NULL, n);
+  PyObject *num_coords =
+      PyByteArray_FromStringAndSize(NULL, n * sizeof(int32_t));
+  PyObject *is_empty = PyByteArray_FromStringAndSize(NULL, n);
+  PyObject *bounds =
+      PyByteArray_FromStringAndSize(NULL, n * 4 * sizeof(double));
+  if (geom_types == NULL || srids == NULL || dims == NULL ||
+      num_coords == NULL || is_empty == NULL || bounds == NULL) {
+    goto cleanup;
+  }
+
+  GeomInfoArrayJob job;
+  job.input = &input;
+  job.compute_bounds = compute_bounds;
+  job.geom_types = (int8_t *)PyByteArray_AS_STRING(geom_types);
+  job.srids = (int32_t *)PyByteArray_AS_STRING(srids);
+  job.dims = (int8_t *)PyByteArray_AS_STRING(dims);
+  job.num_coords = (int32_t *)PyByteArray_AS_STRING(num_coords);
+  job.is_empty = (uint8_t *)PyByteArray_AS_STRING(is_empty);
+  job.bounds = (double *)PyByteArray_AS_STRING(bounds);
+
+  /* Scanning coordinates dominates the cost when computing bounds */
+  if (compute_bounds) {
+    weights = PyMem_Calloc(n + 1, sizeof(int64_t));
+    if (weights == NULL) {
+      PyErr_NoMemory();
+      goto cleanup;
+    }
+    for (Py_ssize_t k = 0; k < n; k++) {
+      weights[k] = 1 + input.buf_sizes[k] / 16;
+    }
+  }
+
+  batch_error_init(&job.error);
+  Py_BEGIN_ALLOW_THREADS;
+  thread_pool_run(n, weights, num_threads, geom_info_array_task, &job);
+  Py_END_ALLOW_THREADS;
+  if (job.error.has_error) {
+    raise_geomserde_error(job.error.err, job.error.geos_msg);
+    batch_error_destroy(&job.error);
+    goto cleanup;
+  }
+  batch_error_destroy(&job.error);
+
+  result = Py_BuildValue("(OOOOOO)", geom_types, srids, dims, num_coords,
+                         is_empty, bounds);
+
+cleanup:
+  Py_XDECREF(geom_types);
+  Py_XDECREF(srids);
+  Py_XDECREF(dims);
+  Py_XDECREF(num_coords);
+  Py_XDECREF(is_empty);
+  Py_XDECREF(bounds);
+  PyMem_Free(weights);
+  batch_input_release(&input);
+  return result;
+}
+
+static PyObject *set_num_threads(PyObject *self, PyObject *args) {
+  int num_threads = 0;
+  if (!PyArg_ParseTuple(args, "i", &num_threads)) {
+    return NULL;
+  }
+  if (num_threads < 0) {
+    PyErr_SetString(PyExc_ValueError, "num_threads should not be negative");
+    return NULL;
+  }
+  thread_pool_set_size(num_threads);
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject *get_num_threads(PyObject *self, PyObject *args) {
+  return PyLong_FromLong(thread_pool_get_size());
+}
+
+static PyObject *set_coord_copy_path(PyObject *self, PyObject *args) {
+  int path = 0;
+  if (!PyArg_ParseTuple(args, "i", &path)) {
+    return NULL;
+  }
+  if (path < COORD_COPY_AUTO || path > COORD_COPY_LOOP) {
+    PyErr_Format(PyExc_ValueError, "Unknown coordinate copy path: %d", path);
+    return NULL;
+  }
+  if (!geom_buf_coord_copy_path_available(path)) {
+    PyErr_Format(PyExc_ValueError, "Coordinate copy path %d is not available",
+                 path);
+    return NULL;
+  }
+  return PyLong_FromLong(geom_buf_set_coord_copy_path(path));
+}
+
+static const char *stats_geom_type_names[SERDE_NUM_GEOM_TYPES] = {
+    "unknown",    "point",           "linestring",   "polygon",
+    "multipoint", "multilinestring", "multipolygon", "geometrycollection"};
+
+static const char *stats_error_names[SERDE_NUM_ERRORS] = {
+    "success",           "unknown_geom_type", "unknown_coord_type",
+    "unsupported_geom_type", "incomplete_buffer", "bad_geom_buffer",
+    "geos_error",        "alloc_error",       "internal_error",
+    "buffer_too_small"};
+
+static const char *stats_stage_names[SERDE_NUM_STAGES] = {
+    "header_parse", "coord_copy", "geos_construct", "python_wrap"};
+
+static int set_stats_item(PyObject *dict, const char *key, PyObject *value) {
+  if (value == NULL) {
+    return -1;
+  }
+  int ret = PyDict_SetItemString(dict, key, value);
+  Py_DECREF(value);
+  return ret;
+}
+
+static PyObject *geom_type_stats_to_dict(const int64_t *geoms,
+                                         const int64_t *bytes) {
+  PyObject *dict = PyDict_New();
+  if (dict == NULL) {
+    return NULL;
+  }
+  for (int k = 1; k < SERDE_NUM_GEOM_TYPES; k++) {
+    if (set_stats_item(dict, stats_geom_type_names[k],
+                       Py_BuildValue("{sLsL}", "count", (long long)geoms[k],
+                                     "bytes", (long long)bytes[k])) < 0) {
+      Py_DECREF(dict);
+      return NULL;
+    }
+  }
+  return dict;
+}
+
+static PyObject *timing_to_dict(const SerdeTiming *timing) {
+  PyObject *buckets = PyList_New(SERDE_NUM_BUCKETS);
+  if (buckets == NULL) {
+    return NULL;
+  }
+  for (int k = 0; k < SERDE_NUM_BUCKETS; k++) {
+    PyObject *count = PyLong_FromLongLong(timing->buckets[k]);
+    if (count == NULL) {
+      Py_DECREF(buckets);
+      return NULL;
+    }
+    PyList_SET_ITEM(buckets, k, count);
+  }
+  return Py_BuildValue("{sLsLsN}", "count", (long long)timing->count, "sum_ns",
+                       (long long)timing->sum_ns, "buckets", buckets);
+}
+
+static PyObject *geos_context_pool_to_dict(void) {
+  GeosContextPoolInfo info;
+  geos_context_pool_get_info(&info);
+  int64_t in_use = info.created - info.destroyed - info.idle;
+  return Py_BuildValue("{sLsLsisLsi}", "created", (long long)info.created,
+                       "destroyed", (long long)info.destroyed, "idle",
+                       info.idle, "in_use", (long long)in_use, "capacity",
+                       info.capacity);
+}
+
+static PyObject *stats(PyObject *self, PyObject *args) {
+  SerdeStats total;
+  serde_stats_collect(&total);
+  PyObject *dict = PyDict_New();
+  PyObject *errors = PyDict_New();
+  PyObject *timings = PyDict_New();
+  if (dict == NULL || errors == NULL || timings == NULL) {
+    goto handle_error;
+  }
+  for (int k = 1; k < SERDE_NUM_ERRORS; k++) {
+    if (set_stats_item(errors, stats_error_names[k],
+                       PyLong_FromLongLong(total.errors[k])) < 0) {
+      goto handle_error;
+    }
+  }
+  for (int k = 0; k < SERDE_NUM_STAGES; k++) {
+    if (set_stats_item(timings, stats_stage_names[k],
+                       timing_to_dict(&total.timings[k])) < 0) {
+      goto handle_error;
+    }
+  }
+  if (set_stats_item(dict, "serialized",
+                     geom_type_stats_to_dict(total.serialized_geoms,
+                                             total.serialized_bytes)) < 0 ||
+      set_stats_item(dict, "deserialized",
+                     geom_type_stats_to_dict(total.deserialized_geoms,
+                                             total.deserialized_bytes)) < 0 ||
+      set_stats_item(dict, "serialized_coords",
+                     PyLong_FromLongLong(total.serialized_coords)) < 0 ||
+      set_stats_item(dict, "deserialized_coords",
+                     PyLong_FromLongLong(total.deserialized_coords)) < 0 ||
+      set_stats_item(dict, "slow_path_serialize",
+                     PyLong_FromLongLong(total.slow_path_serialize)) < 0 ||
+      set_stats_item(dict, "slow_path_deserialize",
+                     PyLong_FromLongLong(total.slow_path_deserialize)) < 0 ||
+      set_stats_item(dict, "allocs", PyLong_FromLongLong(total.allocs)) < 0 ||
+      set_stats_item(dict, "alloc_bytes",
+                     PyLong_FromLongLong(total.alloc_bytes)) < 0 ||
+      set_stats_item(dict, "frees", PyLong_FromLongLong(total.frees)) < 0 ||
+      set_stats_item(dict, "free_bytes",
+                     PyLong_FromLongLong(total.free_bytes)) < 0 ||
+      set_stats_item(dict, "sample_interval",
+                     PyLong_FromLong(serde_stats_get_sample_interval())) < 0 ||
+      set_stats_item(dict, "geos_contexts", geos_context_pool_to_dict()) < 0 ||
+      PyDict_SetItemString(dict, "errors", errors) < 0 ||
+      PyDict_SetItemString(dict, "timings", timings) < 0) {
+    goto handle_error;
+  }
+  Py_DECREF(errors);
+  Py_DECREF(timings);
+  return dict;
+
+handle_error:
+  Py_XDECREF(dict);
+  Py_XDECREF(errors);
+  Py_XDECREF(timings);
+  return NULL;
+}
+
+static PyObject *reset_stats(PyObject *self, PyObject *args) {
+  serde_stats_reset();
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject *set_stats_sampling(PyObject *self, PyObject *args) {
+  int interval = 0;
+  if (!PyArg_ParseTuple(args, "i", &interval)) {
+    return NULL;
+  }
+  if (interval < 0) {
+    PyErr_SetString(PyExc_ValueError, "interval should not be negative");
+    return NULL;
+  }
+  serde_stats_set_sample_interval(interval);
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject *set_geos_context_pool_size(PyObject *self, PyObject *args) {
+  int size = 0;
+  if (!PyArg_ParseTuple(args, "i", &size)) {
+    return NULL;
+  }
+  if (size < 0) {
+    PyErr_SetString(PyExc_ValueError, "size should not be negative");
+    return NULL;
+  }
+  geos_context_pool_set_capacity(size);
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+/* SerializedGeometry is a lazy view of a serialized geometry. It holds a
+ * reference to the bytes-like object containing the serialized geometry and
+ * answers basic questions such as geometry type, SRID and bounds by reading
+ * the serialized buffer directly. The Shapely geometry object is only built
+ * when it is really needed. */
+
+typedef struct SerializedGeometryObject {
+  PyObject_HEAD
+  Py_buffer view;
+  SedonaGeometryInfo info;
+  int has_bounds;
+  /* Shape and strides of the coordinate array exported through the buffer
+   * protocol */
+  Py_ssize_t coords_shape[2];
+  Py_ssize_t coords_strides[2];
+  /* Decoded coordinates of geometries with encoded coordinates */
+  double *decoded_coords;
+  PyObject *geom;
+} SerializedGeometryObject;
+
+static const char *geometry_type_names[] = {
+    "Unknown",    "Point",           "LineString",   "Polygon",
+    "MultiPoint", "MultiLineString", "MultiPolygon", "GeometryCollection"};
+
+static PyObject *serialized_geometry_new(PyTypeObject *type, PyObject *args,
+                                         PyObject *kwargs) {
+  static char *kwlist[] = {"buf", NULL};
+  PyObject *obj = NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", kwlist, &obj)) {
+    return NULL;
+  }
+
+  SerializedGeometryObject *self =
+      (SerializedGeometryObject *)type->tp_alloc(type, 0);
+  if (self == NULL) {
+    return NULL;
+  }
+  if (PyObject_GetBuffer(obj, &self->view, PyBUF_SIMPLE) != 0) {
+    Py_DECREF(self);
+    return NULL;
+  }
+  if (self->view.len > INT_MAX) {
+    PyErr_SetString(PyExc_ValueError, "Serialized geometry is too large");
+    Py_DECREF(self);
+    return NULL;
+  }
+
+  SedonaErrorCode err = sedona_get_geom_info(
+      self->view.buf, (int)self->view.len, 0, &self->info, NULL);
+  if (err != SEDONA_SUCCESS) {
+    handle_geomserde_error(err);
+    Py_DECREF(self);
+    return NULL;
+  }
+
+  /* number of serialized coordinates, including empty points of multipoints */
+  int num_coords = 0;
+  memcpy(&num_coords, (const char *)self->view.buf + 4, sizeof(int));
+  self->coords_shape[0] = num_coords;
+  self->coords_shape[1] = self->info.dims;
+  self->coords_strides[0] = self->info.dims * sizeof(double);
+  self->coords_strides[1] = sizeof(double);
+  return (PyObject *)self;
+}
+
+static void serialized_geometry_dealloc(SerializedGeometryObject *self) {
+  PyTypeObject *type = Py_TYPE(self);
+  if (self->view.obj != NULL) {
+    PyBuffer_Release(&self->view);
+  }
+  PyMem_Free(self->decoded_coords);
+  Py_XDECREF(self->geom);
+  type->tp_free((PyObject *)self);
+  /* Instances of heap types own a reference to their type */
+  Py_DECREF(type);
+}
+
+/* Lazily computed members are filled in while holding the critical section
+ * of the object, so that free-threaded builds won't compute them twice */
+
+static PyObject *serialized_geometry_to_shapely_lock_held(
+    SerializedGeometryObject *self) {
+  if (self->geom == NULL) {
+    GEOSContextHandle_t handle = get_geos_context_handle();
+    if (handle == NULL) {
+      return NULL;
+    }
+    GEOSGeometry *geos_geom = NULL;
+    int bytes_read = 0;
+    SedonaErrorCode err = sedona_deserialize_geom(
+        handle, self->view.buf, (int)self->view.len, &geos_geom, &bytes_read);
+    if (err != SEDONA_SUCCESS) {
+      handle_geomserde_error(err);
+      return NULL;
+    }
+    int64_t timer = serde_stats_timer_begin(SERDE_STAGE_PYTHON_WRAP);
+    self->geom = PyGEOS_CreateGeometry(geos_geom, handle);
+    serde_stats_timer_end(SERDE_STAGE_PYTHON_WRAP, timer);
+    if (self->geom == NULL) {
+      return NULL;
+    }
+  }
+  Py_INCREF(self->geom);
+  return self->geom;
+}
+
+static PyObject *serialized_geometry_to_shapely(SerializedGeometryObject *self,
+                                                PyObject *Py_UNUSED(ignored)) {
+  PyObject *geom;
+  Py_BEGIN_CRITICAL_SECTION(self);
+  geom = serialized_geometry_to_shapely_lock_held(self);
+  Py_END_CRITICAL_SECTION();
+  return geom;
+}
+
+static PyObject *serialized_geometry_get_geom_type(
+    SerializedGeometryObject *self, void *closure) {
+  return PyUnicode_FromString(geometry_type_names[self->info.geom_type]);
+}
+
+static PyObject *serialized_geometry_get_srid(SerializedGeometryObject *self,
+                                              void *closure) {
+  return PyLong_FromLong(self->info.srid);
+}
+
+static PyObject *serialized_geometry_get_num_coords(
+    SerializedGeometryObject *self, void *closure) {
+  return PyLong_FromLong(self->info.num_coords);
+}
+
+static PyObject *serialized_geometry_get_is_empty(
+    SerializedGeometryObject *self, void *closure) {
+  return PyBool_FromLong(self->info.is_empty);
+}
+
+static PyObject *serialized_geometry_get_bounds_lock_held(
+    SerializedGeometryObject *self) {
+  if (!self->has_bounds) {
+    /* Only the bounds are copied, other fields of info are read by getters
+     * without locking */
+    SedonaGeometryInfo info;
+    SedonaErrorCode err = sedona_get_geom_info(
+        self->view.buf, (int)self->view.len, 1, &info, NULL);
+    if (err != SEDONA_SUCCESS) {
+      handle_geomserde_error(err);
+      return NULL;
+    }
+    memcpy(self->info.bounds, info.bounds, sizeof(info.bounds));
+    self->has_bounds = 1;
+  }
+  const double *bounds = self->info.bounds;
+  return Py_BuildValue("(dddd)", bounds[0], bounds[1], bounds[2], bounds[3]);
+}
+
+static PyObject *serialized_geometry_get_bounds(SerializedGeometryObject *self,
+                                                void *closure) {
+  PyObject *bounds;
+  Py_BEGIN_CRITICAL_SECTION(self);
+  bounds = serialized_geometry_get_bounds_lock_held(self);
+  Py_END_CRITICAL_SECTION();
+  return bounds;
+}
+
+static PyObject *serialized_geometry_get_coords(SerializedGeometryObject *self,
+                                                void *closure) {
+  return PyMemoryView_FromObject((PyObject *)self);
+}
+
+static int serialized_geometry_getbuffer_lock_held(
+    SerializedGeometryObject *self, Py_buffer *view, int flags) {
+  if (self->info.geom_type == GEOMETRYCOLLECTION) {
+    PyErr_SetString(PyExc_NotImplementedError,
+                    "Coordinates of geometry collections are not stored "
+                    "contiguously");
+    view->obj = NULL;
+    return -1;
+  }
+  int is_encoded =
+      (((const unsigned char *)self->view.buf)[0] & COORD_ENCODED_FLAG) != 0;
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE &&
+      (self->view.readonly || is_encoded)) {
+    PyErr_SetString(PyExc_BufferError, "Serialized geometry is read-only");
+    view->obj = NULL;
+    return -1;
+  }
+
+  Py_ssize_t len = self->coords_shape[0] * self->coords_strides[0];
+  if (is_encoded && self->decoded_coords == NULL) {
+    /* Encoded coordinates are exposed as a read-only decoded copy */
+    self->decoded_coords = PyMem_Malloc(len > 0 ? len : 1);
+    if (self->decoded_coords == NULL) {
+      PyErr_NoMemory();
+      view->obj = NULL;
+      return -1;
+    }
+    SedonaErrorCode err = sedona_read_coords(
+        self->view.buf, (int)self->view.len, self->decoded_coords);
+    if (err != SEDONA_SUCCESS) {
+      PyMem_Free(self->decoded_coords);
+      self->decoded_coords = NULL;
+      handle_geomserde_error(err);
+      view->obj = NULL;
+      return -1;
+    }
+  }
+
+  view->buf = (is_encoded ? (char *)self->decoded_coords
+                          : (char *)self->view.buf + 8);
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->len = len;
+  view->readonly = (self->view.readonly || is_encoded);
+  view->itemsize = sizeof(double);
+  view->format = (flags & PyBUF_FORMAT) ? "d" : NULL;
+  view->ndim = 2;
+  view->shape = (flags & PyBUF_ND) ? self->coords_shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) ? self->coords_strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static int serialized_geometry_getbuffer(SerializedGeometryObject *self,
+                                         Py_buffer *view, int flags) {
+  int ret;
+  Py_BEGIN_CRITICAL_SECTION(self);
+  ret = serialized_geometry_getbuffer_lock_held(self, view, flags);
+  Py_END_CRITICAL_SECTION();
+  return ret;
+}
+
+#ifndef Py_bf_getbuffer
+/* Buffer slots of PyType_Spec are not supported before Python 3.9 */
+static PyBufferProcs serialized_geometry_as_buffer = {
+    (getbufferproc)serialized_geometry_getbuffer, NULL};
+#endif
+
+/* Attributes not provided by SerializedGeometry are looked up on the Shapely
+ * geometry object, so that it could be used in place of a Shapely
+ * geometry in most cases. */
+static PyObject *serialized_geometry_getattro(PyObject *self, PyObject *name) {
+  PyObject *attr = PyObject_GenericGetAttr(self, name);
+  if (attr != NULL || !PyErr_ExceptionMatches(PyExc_AttributeError)) {
+    return attr;
+  }
+  PyErr_Clear();
+  PyObject *geom = serialized_geometry_to_shapely(
+      (SerializedGeometryObject *)self, NULL);
+  if (geom == NULL) {
+    return NULL;
+  }
+  attr = PyObject_GetAttr(geom, name);
+  Py_DECREF(geom);
+  return attr;
+}
+
+static PyObject *serialized_geometry_repr(SerializedGeometryObject *self) {
+  return PyUnicode_FromFormat("<SerializedGeometry %s srid=%d>",
+                              geometry_type_names[self->info.geom_type],
+                              self->info.srid);
+}
+
+static PyMethodDef serialized_geometry_methods[] = {
+    {"to_shapely", (PyCFunction)serialized_geometry_to_shapely, METH_NOARGS,
+     "Deserialize as Shapely geometry object, the result is cached."},
+    {NULL, NULL, 0, NULL}, /* Sentinel */
+};
+
+static PyGetSetDef serialized_geometry_getset[] = {
+    {"geom_type", (getter)serialized_geometry_get_geom_type, NULL,
+     "Name of the geometry type, such as 'Point' or 'Polygon'.", NULL},
+    {"srid", (getter)serialized_geometry_get_srid, NULL, "SRID of geometry.",
+     NULL},
+    {"num_coords", (getter)serialized_geometry_get_num_coords, NULL,
+     "Number of coordinates, empty points are not counted.", NULL},
+    {"is_empty", (getter)serialized_geometry_get_is_empty, NULL,
+     "Whether the geometry is empty.", NULL},
+    {"bounds", (getter)serialized_geometry_get_bounds, NULL,
+     "(minx, miny, maxx, maxy) tuple, all NaN for empty geometries.", NULL},
+    {"coords", (getter)serialized_geometry_get_coords, NULL,
+     "Memoryview of the serialized coordinates with shape (n, dims). Empty "
+     "points of multipoints are represented as NaN coordinates.",
+     NULL},
+    {NULL, NULL, NULL, NULL, NULL}, /* Sentinel */
+};
+
+PyDoc_STRVAR(
+    serialized_geometry_doc,
+    "SerializedGeometry(buf)\n\n"
+    "Lazy view of a serialized geometry. Basic properties are read from the "
+    "serialized buffer directly without building a Shapely geometry. "
+    "Attributes not provided by this type are looked up on the geometry "
+    "returned by to_shapely(). The buffer protocol exposes the coordinates "
+    "as an (n, dims) float64 array.");
+
+/* SerializedGeometry is a heap type, each interpreter gets its own one */
+
+static PyType_Slot serialized_geometry_slots[] = {
+    {Py_tp_dealloc, serialized_geometry_dealloc},
+    {Py_tp_repr, serialized_geometry_repr},
+    {Py_tp_getattro, serialized_geometry_getattro},
+    {Py_tp_doc, (void *)serialized_geometry_doc},
+    {Py_tp_methods, serialized_geometry_methods},
+    {Py_tp_getset, serialized_geometry_getset},
+    {Py_tp_new, serialized_geometry_new},
+#ifdef Py_bf_getbuffer
+    {Py_bf_getbuffer, serialized_geometry_getbuffer},
+#endif
+    {0, NULL}, /* Sentinel */
+};
+
+#ifdef Py_TPFLAGS_IMMUTABLETYPE
+#define SERIALIZED_GEOMETRY_FLAGS \
+  (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE)
+#else
+#define SERIALIZED_GEOMETRY_FLAGS Py_TPFLAGS_DEFAULT
+#endif
+
+static PyType_Spec serialized_geometry_spec = {
+    "sedona.utils.geomserde_speedup.SerializedGeometry",
+    sizeof(SerializedGeometryObject), 0, SERIALIZED_GEOMETRY_FLAGS,
+    serialized_geometry_slots};
+
+static PyObject *create_serialized_geometry_type(void) {
+  PyObject *type = PyType_FromSpec(&serialized_geometry_spec);
+#ifndef Py_bf_getbuffer
+  if (type != NULL) {
+    ((PyTypeObject *)type)->tp_as_buffer = &serialized_geometry_as_buffer;
+  }
+#endif
+  return type;
+}
+
+/* serialize/deserialize functions for Shapely 1.x */
+
+static PyObject *serialize_1(PyObject *self, PyObject *args) {
+  GEOSGeometry *geos_geom = NULL;
+  if (!PyArg_ParseTuple(args, "K", &geos_geom)) {
+    return NULL;
+  }
+  return do_serialize(geos_geom);
+}
+
+static PyObject *init_shapely_1(PyObject *self, PyObject *args) {
+  PyObject *base_class = NULL;
+  PyObject *classes = NULL;
+  if (!PyArg_ParseTuple(args, "OO", &base_class, &classes)) {
+    return NULL;
+  }
+  PyObject *seq = PySequence_Fast(classes, "classes should be a sequence");
+  if (seq == NULL) {
+    return NULL;
+  }
+  if (PySequence_Fast_GET_SIZE(seq) != NUM_SHAPELY_1_CLASSES) {
+    PyErr_Format(PyExc_ValueError, "Expect %d geometry classes",
+                 NUM_SHAPELY_1_CLASSES);
+    Py_DECREF(seq);
+    return NULL;
+  }
+  GeomserdeState *state = get_state(self);
+  Py_INCREF(base_class);
+  Py_XSETREF(state->shapely_1_base_class, base_class);
+  for (int k = 0; k < NUM_SHAPELY_1_CLASSES; k++) {
+    PyObject *cls = PySequence_Fast_GET_ITEM(seq, k);
+    Py_INCREF(cls);
+    Py_XSETREF(state->shapely_1_classes[k], cls);
+  }
+  Py_DECREF(seq);
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+/* This is what geom_factory in shapely/geometry/base.py does, without calling
+ * GEOS functions through ctypes. Attributes are put into __dict__ directly to
+ * get rid of the extra cost of __setattr__ in shapely 1.8. */
+static PyObject *create_shapely_1_geometry(PyObject *module,
+                                           GEOSGeometry *geom,
+                                           GEOSContextHandle_t handle) {
+  GeomserdeState *state = get_state(module);
+  if (state->shapely_1_base_class == NULL) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "Shapely 1.x classes were not initialized");
+    return NULL;
+  }
+  int geom_type_id = dyn_GEOSGeomTypeId_r(handle, geom);
+  char has_z = dyn_GEOSHasZ_r(handle, geom);
+  if (geom_type_id < 0 || geom_type_id >= NUM_SHAPELY_1_CLASSES ||
+      has_z == 2) {
+    handle_geomserde_error(SEDONA_GEOS_ERROR);
+    return NULL;
+  }
+
+  PyObject *dict = NULL;
+  PyObject *geom_ptr = NULL;
+  PyObject *ndim = NULL;
+  PyObject *ob = PyObject_CallObject(state->shapely_1_base_class, NULL);
+  if (ob == NULL ||
+      PyObject_SetAttr(ob, state->str_class,
+                       state->shapely_1_classes[geom_type_id]) < 0) {
+    goto handle_error;
+  }
+  dict = PyObject_GenericGetDict(ob, NULL);
+  geom_ptr = PyLong_FromVoidPtr(geom);
+  ndim = PyLong_FromLong(has_z ? 3 : 2);
+  if (dict == NULL || geom_ptr == NULL || ndim == NULL ||
+      PyDict_SetItem(dict, state->str_p, Py_None) < 0 ||
+      PyDict_SetItem(dict, state->str_ndim, ndim) < 0 ||
+      PyDict_SetItem(dict, state->str_is_empty, Py_False) < 0) {
+    goto handle_error;
+  }
+  /* The geometry is owned by the object once __geom__ is set, so it should
+   * be the last step that could fail */
+  if (PyDict_SetItem(dict, state->str_geom, geom_ptr) < 0) {
+    goto handle_error;
+  }
+  Py_DECREF(dict);
+  Py_DECREF(geom_ptr);
+  Py_DECREF(ndim);
+  return ob;
+
+handle_error:
+  Py_XDECREF(ob);
+  Py_XDECREF(dict);
+  Py_XDECREF(geom_ptr);
+  Py_XDECREF(ndim);
+  return NULL;
+}
+
+static PyObject *deserialize_1(PyObject *self, PyObject *args) {
+  GEOSContextHandle_t handle = NULL;
+  int length = 0;
+  GEOSGeometry *geom = do_deserialize(args, &handle, &length);
+  if (geom == NULL) {
+    return NULL;
+  }
+  int64_t timer = serde_stats_timer_begin(SERDE_STAGE_PYTHON_WRAP);
+  PyObject *pygeom = create_shapely_1_geometry(self, geom, handle);
+  serde_stats_timer_end(SERDE_STAGE_PYTHON_WRAP, timer);
+  if (pygeom == NULL) {
+    dyn_GEOSGeom_destroy_r(handle, geom);
+    return NULL;
+  }
+  return Py_BuildValue("(Ni)", pygeom, length);
+}
+
+static PyObject *deserialize_array_1(PyObject *self, PyObject *args,
+                                     PyObject *kwargs) {
+  return do_deserialize_array(self, args, kwargs, create_shapely_1_geometry);
+}
+
+/* Module definition for Shapely 2.x */
+
+static PyMethodDef geomserde_methods_shapely_2[] = {
+    {"load_libgeos_c", load_libgeos_c, METH_VARARGS, "Load libgeos_c."},
+    {"serialize", serialize, METH_VARARGS,
+     "Serialize geometry object as bytes."},
+    {"serialized_size", serialized_size, METH_VARARGS,
+     "Get size of the serialized geometry object in bytes."},
+    {"serialize_into", serialize_into, METH_VARARGS,
+     "Serialize geometry object into a writable buffer at the given offset, "
+     "returns number of bytes written."},
+    {"serialize_array", (PyCFunction)(void (*)(void))serialize_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Serialize a sequence of geometry objects as (data, offsets, validity)."},
+    {"deserialize", deserialize, METH_VARARGS,
+     "Deserialize bytes-like object to geometry object."},
+    {"deserialize_array", (PyCFunction)(void (*)(void))deserialize_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Deserialize a batch of serialized geometries to a list of geometry "
+     "objects."},
+    {"to_wkb", (PyCFunction)(void (*)(void))to_wkb,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert serialized geometry to WKB without constructing geometry "
+     "object."},
+    {"from_wkb", from_wkb, METH_VARARGS,
+     "Convert WKB or EWKB to serialized geometry without constructing "
+     "geometry object."},
+    {"to_wkb_array", (PyCFunction)(void (*)(void))to_wkb_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of serialized geometries to WKB as (data, offsets, "
+     "validity)."},
+    {"from_wkb_array", (PyCFunction)(void (*)(void))from_wkb_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of WKB to serialized geometries as (data, offsets, "
+     "validity)."},
+    {"to_wkt", (PyCFunction)(void (*)(void))to_wkt,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert serialized geometry to WKT without constructing geometry "
+     "object."},
+    {"to_geojson", (PyCFunction)(void (*)(void))to_geojson,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert serialized geometry to GeoJSON without constructing geometry "
+     "object."},
+    {"to_wkt_array", (PyCFunction)(void (*)(void))to_wkt_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of serialized geometries to WKT as (data, offsets, "
+     "validity)."},
+    {"to_geojson_array", (PyCFunction)(void (*)(void))to_geojson_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of serialized geometries to GeoJSON as (data, "
+     "offsets, validity)."},
+    {"to_geoarrow", (PyCFunction)(void (*)(void))to_geoarrow,
+     METH_VARARGS | METH_KEYWORDS,
+     "Export a batch of serialized geometries as a GeoArrow native array, "
+     "returns (schema, array) PyCapsules of the Arrow C data interface."},
+    {"from_geoarrow", (PyCFunction)(void (*)(void))from_geoarrow,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a GeoArrow native array given as (schema, array) PyCapsules to "
+     "serialized geometries as (data, offsets, validity)."},
+    {"frame_array", (PyCFunction)(void (*)(void))frame_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Encode a batch of serialized geometries as length-prefixed records."},
+    {"split_frames", split_frames, METH_VARARGS,
+     "Decode complete length-prefixed records at the beginning of a buffer, "
+     "returns ((data, offsets, validity), number of bytes consumed)."},
+    {"pad_array", (PyCFunction)(void (*)(void))pad_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Pad each serialized geometry of a batch with zero bytes to a multiple "
+     "of alignment bytes."},
+    {"encode_coords", (PyCFunction)(void (*)(void))encode_coords,
+     METH_VARARGS | METH_KEYWORDS,
+     "Re-encode coordinates of a serialized geometry using a compact "
+     "encoding, or convert them back to plain doubles."},
+    {"encode_coords_array", (PyCFunction)(void (*)(void))encode_coords_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Re-encode coordinates of a batch of serialized geometries, returns "
+     "(data, offsets, validity)."},
+    {"compress_blocks", (PyCFunction)(void (*)(void))compress_blocks,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compress a batch of serialized geometries into blocks."},
+    {"decompress_blocks", (PyCFunction)(void (*)(void))decompress_blocks,
+     METH_VARARGS | METH_KEYWORDS,
+     "Decompress blocks into a batch of serialized geometries."},
+    {"validate", validate, METH_VARARGS,
+     "Validate the structure of a serialized geometry, returns an error "
+     "code."},
+    {"validate_array", (PyCFunction)(void (*)(void))validate_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Validate the structure of a batch of serialized geometries, returns an "
+     "error code per geometry."},
+    {"get_error_message", get_error_message, METH_VARARGS,
+     "Get the message of an error code."},
+    {"stats", stats, METH_NOARGS,
+     "Get counters and sampled stage timings of serialization and "
+     "deserialization, summed up over all threads."},
+    {"reset_stats", reset_stats, METH_NOARGS,
+     "Reset counters and stage timings of all threads."},
+    {"set_stats_sampling", set_stats_sampling, METH_VARARGS,
+     "Time one of every n executions of each stage, 0 disables timing."},
+    {"set_geos_context_pool_size", set_geos_context_pool_size, METH_VARARGS,
+     "Set the maximum number of idle GEOS contexts kept for reuse by new "
+     "threads, 0 for the number of CPU cores."},
+    {"set_coord_copy_path", set_coord_copy_path, METH_VARARGS,
+     "Force the way coordinates are copied between serialized geometries and "
+     "GEOS, returns the previous one."},
+    {"get_geom_info_array", (PyCFunction)(void (*)(void))get_geom_info_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Get geometry types, SRIDs, dimensions, number of coordinates, emptiness "
+     "and bounds of a batch of serialized geometries."},
+    {"set_num_threads", set_num_threads, METH_VARARGS,
+     "Set number of threads used by batch functions, 0 for number of CPU "
+     "cores."},
+    {"get_num_threads", get_num_threads, METH_NOARGS,
+     "Get number of threads used by batch functions."},
+    {NULL, NULL, 0, NULL}, /* Sentinel */
+};
+
+/* Bulk coordinate copy of shapely, which is linked with the same libgeos_c
+ * loaded by load_libgeos_c. Shapely 2.1 changed the C API function to return
+ * an error code and take a handle_nan argument, which is 0 for allowing NaN
+ * coordinates. */
+typedef int (*ShapelyCoordSeqFromBuffer)(GEOSContextHandle_t ctx,
+                                         const double *buf, unsigned int size,
+                                         unsigned int dims, char ring_closure,
+                                         int handle_nan,
+                                         GEOSCoordSequence **coord_seq);
+
+static GEOSCoordSequence *shapely_2_0_coord_seq_from_buffer(
+    GEOSContextHandle_t handle, const double *buf, unsigned int size,
+    unsigned int dims) {
+  return PyGEOS_CoordSeq_FromBuffer(handle, buf, size, dims, 0);
+}
+
+static GEOSCoordSequence *shapely_2_1_coord_seq_from_buffer(
+    GEOSContextHandle_t handle, const double *buf, unsigned int size,
+    unsigned int dims) {
+  ShapelyCoordSeqFromBuffer func =
+      (ShapelyCoordSeqFromBuffer)PyGEOS_API[PyGEOS_CoordSeq_FromBuffer_NUM];
+  GEOSCoordSequence *coord_seq = NULL;
+  if (func(handle, buf, size, dims, 0, 0, &coord_seq) != 0) {
+    return NULL;
+  }
+  return coord_seq;
+}
+
+static int register_shapely_coord_seq_from_buffer(void) {
+  PyObject *shapely = PyImport_ImportModule("shapely");
+  if (shapely == NULL) {
+    return -1;
+  }
+  PyObject *version = PyObject_GetAttrString(shapely, "__version__");
+  Py_DECREF(shapely);
+  if (version == NULL) {
+    return -1;
+  }
+  const char *version_str = PyUnicode_AsUTF8(version);
+  int major = 0;
+  int minor = 0;
+  if (version_str == NULL) {
+    Py_DECREF(version);
+    return -1;
+  }
+  if (sscanf(version_str, "%d.%d", &major, &minor) == 2 && major == 2) {
+    geom_buf_set_coord_seq_from_buffer(minor == 0
+                                           ? shapely_2_0_coord_seq_from_buffer
+                                           : shapely_2_1_coord_seq_from_buffer);
+  }
+  Py_DECREF(version);
+  return 0;
+}
+
+/* Python objects of the module live in the module state, and GEOS contexts
+ * are borrowed from the thread safe GEOS context pool, so the module could be
+ * imported by isolated subinterpreters and used without the GIL. */
+
+static int geomserde_traverse(PyObject *module, visitproc visit, void *arg) {
+  GeomserdeState *state = get_state(module);
+  Py_VISIT(state->serialized_geometry_type);
+  Py_VISIT(state->shapely_1_base_class);
+  for (int k = 0; k < NUM_SHAPELY_1_CLASSES; k++) {
+    Py_VISIT(state->shapely_1_classes[k]);
+  }
+  return 0;
+}
+
+static int geomserde_clear(PyObject *module) {
+  GeomserdeState *state = get_state(module);
+  Py_CLEAR(state->serialized_geometry_type);
+  Py_CLEAR(state->shapely_1_base_class);
+  for (int k = 0; k < NUM_SHAPELY_1_CLASSES; k++) {
+    Py_CLEAR(state->shapely_1_classes[k]);
+  }
+  Py_CLEAR(state->str_class);
+  Py_CLEAR(state->str_geom);
+  Py_CLEAR(state->str_p);
+  Py_CLEAR(state->str_ndim);
+  Py_CLEAR(state->str_is_empty);
+  return 0;
+}
+
+static void geomserde_free(void *module) { geomserde_clear(module); }
+
+static int geomserde_exec_shapely_2(PyObject *module) {
+  GeomserdeState *state = get_state(module);
+  if (register_shapely_coord_seq_from_buffer() < 0) {
+    return -1;
+  }
+  state->serialized_geometry_type = create_serialized_geometry_type();
+  if (state->serialized_geometry_type == NULL) {
+    return -1;
+  }
+  Py_INCREF(state->serialized_geometry_type);
+  if (PyModule_AddObject(module, "SerializedGeometry",
+                         state->serialized_geometry_type) < 0) {
+    Py_DECREF(state->serialized_geometry_type);
+    return -1;
+  }
+  return 0;
+}
+
+static PyModuleDef_Slot geomserde_slots_shapely_2[] = {
+    {Py_mod_exec, geomserde_exec_shapely_2},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}, /* Sentinel */
+};
+
+static struct PyModuleDef geomserde_module_shapely_2 = {
+    PyModuleDef_HEAD_INIT,
+    "geomserde_speedup",
+    module_doc,
+    sizeof(GeomserdeState),
+    geomserde_methods_shapely_2,
+    geomserde_slots_shapely_2,
+    geomserde_traverse,
+    geomserde_clear,
+    geomserde_free};
+
+/* Module definition for Shapely 1.x */
 
 static PyMethodDef geomserde_methods_shapely_1[] = {
     {"load_libgeos_c", load_libgeos_c, METH_VARARGS, "Load libgeos_c."},
     {"serialize_1", serialize_1, METH_VARARGS,
-     "Serialize geometry object as bytearray."},
+     "Serialize geometry object as bytes."},
+    {"init_shapely_1", init_shapely_1, METH_VARARGS,
+     "Register BaseGeometry and geometry classes indexed by GEOS geometry "
+     "type id."},
     {"deserialize_1", deserialize_1, METH_VARARGS,
      "Deserialize bytes-like object to geometry object."},
+    {"deserialize_array_1", (PyCFunction)(void (*)(void))deserialize_array_1,
+     METH_VARARGS | METH_KEYWORDS,
+     "Deserialize a batch of serialized geometries to a list of geometry "
+     "objects."},
+    {"to_wkb", (PyCFunction)(void (*)(void))to_wkb,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert serialized geometry to WKB without constructing geometry "
+     "object."},
+    {"from_wkb", from_wkb, METH_VARARGS,
+     "Convert WKB or EWKB to serialized geometry without constructing "
+     "geometry object."},
+    {"to_wkb_array", (PyCFunction)(void (*)(void))to_wkb_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of serialized geometries to WKB as (data, offsets, "
+     "validity)."},
+    {"from_wkb_array", (PyCFunction)(void (*)(void))from_wkb_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of WKB to serialized geometries as (data, offsets, "
+     "validity)."},
+    {"to_wkt", (PyCFunction)(void (*)(void))to_wkt,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert serialized geometry to WKT without constructing geometry "
+     "object."},
+    {"to_geojson", (PyCFunction)(void (*)(void))to_geojson,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert serialized geometry to GeoJSON without constructing geometry "
+     "object."},
+    {"to_wkt_array", (PyCFunction)(void (*)(void))to_wkt_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of serialized geometries to WKT as (data, offsets, "
+     "validity)."},
+    {"to_geojson_array", (PyCFunction)(void (*)(void))to_geojson_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a batch of serialized geometries to GeoJSON as (data, "
+     "offsets, validity)."},
+    {"to_geoarrow", (PyCFunction)(void (*)(void))to_geoarrow,
+     METH_VARARGS | METH_KEYWORDS,
+     "Export a batch of serialized geometries as a GeoArrow native array, "
+     "returns (schema, array) PyCapsules of the Arrow C data interface."},
+    {"from_geoarrow", (PyCFunction)(void (*)(void))from_geoarrow,
+     METH_VARARGS | METH_KEYWORDS,
+     "Convert a GeoArrow native array given as (schema, array) PyCapsules to "
+     "serialized geometries as (data, offsets, validity)."},
+    {"frame_array", (PyCFunction)(void (*)(void))frame_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Encode a batch of serialized geometries as length-prefixed records."},
+    {"split_frames", split_frames, METH_VARARGS,
+     "Decode complete length-prefixed records at the beginning of a buffer, "
+     "returns ((data, offsets, validity), number of bytes consumed)."},
+    {"pad_array", (PyCFunction)(void (*)(void))pad_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Pad each serialized geometry of a batch with zero bytes to a multiple "
+     "of alignment bytes."},
+    {"encode_coords", (PyCFunction)(void (*)(void))encode_coords,
+     METH_VARARGS | METH_KEYWORDS,
+     "Re-encode coordinates of a serialized geometry using a compact "
+     "encoding, or convert them back to plain doubles."},
+    {"encode_coords_array", (PyCFunction)(void (*)(void))encode_coords_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Re-encode coordinates of a batch of serialized geometries, returns "
+     "(data, offsets, validity)."},
+    {"compress_blocks", (PyCFunction)(void (*)(void))compress_blocks,
+     METH_VARARGS | METH_KEYWORDS,
+     "Compress a batch of serialized geometries into blocks."},
+    {"decompress_blocks", (PyCFunction)(void (*)(void))decompress_blocks,
+     METH_VARARGS | METH_KEYWORDS,
+     "Decompress blocks into a batch of serialized geometries."},
+    {"validate", validate, METH_VARARGS,
+     "Validate the structure of a serialized geometry, returns an error "
+     "code."},
+    {"validate_array", (PyCFunction)(void (*)(void))validate_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Validate the structure of a batch of serialized geometries, returns an "
+     "error code per geometry."},
+    {"get_error_message", get_error_message, METH_VARARGS,
+     "Get the message of an error code."},
+    {"stats", stats, METH_NOARGS,
+     "Get counters and sampled stage timings of serialization and "
+     "deserialization, summed up over all threads."},
+    {"reset_stats", reset_stats, METH_NOARGS,
+     "Reset counters and stage timings of all threads."},
+    {"set_stats_sampling", set_stats_sampling, METH_VARARGS,
+     "Time one of every n executions of each stage, 0 disables timing."},
+    {"set_geos_context_pool_size", set_geos_context_pool_size, METH_VARARGS,
+     "Set the maximum number of idle GEOS contexts kept for reuse by new "
+     "threads, 0 for the number of CPU cores."},
+    {"set_coord_copy_path", set_coord_copy_path, METH_VARARGS,
+     "Force the way coordinates are copied between serialized geometries and "
+     "GEOS, returns the previous one."},
+    {"get_geom_info_array", (PyCFunction)(void (*)(void))get_geom_info_array,
+     METH_VARARGS | METH_KEYWORDS,
+     "Get geometry types, SRIDs, dimensions, number of coordinates, emptiness "
+     "and bounds of a batch of serialized geometries."},
     {NULL, NULL, 0, NULL}, /* Sentinel */
 };
 
+static int geomserde_exec_shapely_1(PyObject *module) {
+  GeomserdeState *state = get_state(module);
+  state->str_class = PyUnicode_InternFromString("__class__");
+  state->str_geom = PyUnicode_InternFromString("__geom__");
+  state->str_p = PyUnicode_InternFromString("__p__");
+  state->str_ndim = PyUnicode_InternFromString("_ndim");
+  state->str_is_empty = PyUnicode_InternFromString("_is_empty");
+  if (state->str_class == NULL || state->str_geom == NULL ||
+      state->str_p == NULL || state->str_ndim == NULL ||
+      state->str_is_empty == NULL) {
+    return -1;
+  }
+  return 0;
+}
+
+static PyModuleDef_Slot geomserde_slots_shapely_1[] = {
+    {Py_mod_exec, geomserde_exec_shapely_1},
+#if PY_VERSION_HEX >= 0x030C0000
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#if PY_VERSION_HEX >= 0x030D0000
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}, /* Sentinel */
+};
+
 static struct PyModuleDef geomserde_module_shapely_1 = {
-    PyModuleDef_HEAD_INIT, "geomserde_speedup", module_doc, 0,
-    geomserde_methods_shapely_1};
+    PyModuleDef_HEAD_INIT,
+    "geomserde_speedup",
+    module_doc,
+    sizeof(GeomserdeState),
+    geomserde_methods_shapely_1,
+    geomserde_slots_shapely_1,
+    geomserde_traverse,
+    geomserde_clear,
+    geomserde_free};
+
+/* The raw allocator of CPython makes native memory visible to tracemalloc
+ * without holding the GIL, but its tracing hooks take the GIL on every call
+ * made by worker threads. It is only installed when tracemalloc is already
+ * tracing at the first import, e.g. by python -X tracemalloc, and the
+ * allocator of the C library is kept otherwise. */
+static const SerdeAllocator py_raw_allocator = {
+    PyMem_RawMalloc, PyMem_RawCalloc, PyMem_RawFree};
+
+static sedona_once_t allocator_once = SEDONA_ONCE_INIT;
+
+static void allocator_init(void) {
+  PyObject *is_tracing = NULL;
+  PyObject *tracemalloc = PyImport_ImportModule("_tracemalloc");
+  if (tracemalloc != NULL) {
+    is_tracing = PyObject_CallMethod(tracemalloc, "is_tracing", NULL);
+    Py_DECREF(tracemalloc);
+  }
+  if (is_tracing == NULL) {
+    PyErr_Clear();
+    return;
+  }
+  if (is_tracing == Py_True) {
+    serde_set_allocator(&py_raw_allocator);
+  }
+  Py_DECREF(is_tracing);
+}
 
 PyMODINIT_FUNC PyInit_geomserde_speedup(void) {
+  sedona_once(&allocator_once, allocator_init);
   if (import_shapely_c_api() != 0) {
     /* As long as the capsule provided by Shapely 2.0 cannot be loaded, we
      * assume that we're working with Shapely 1.0 */
@@ -20,6 +20,8 @@
 #define _GNU_SOURCE
 #include "geos_c_dyn.h"
 
+#include "sedona_thread.h"
+
 #if defined(_WIN32) || defined(_WIN64)
 #define TARGETING_WINDOWS
 #include <windows.h>
@@ -85,6 +87,9 @@ static int load_geos_c_symbol(void *handle, const char *func_name,
 }
 
 int load_geos_c_library(const char *path, char *err_msg, int len) {
+  if (is_geos_c_loaded()) {
+    return 0;
+  }
 #ifndef TARGETING_WINDOWS
   void *handle = dlopen(path, RTLD_LOCAL | RTLD_NOW);
   if (handle == NULL) {
@@ -110,11 +115,21 @@ int load_geos_c_library(const char *path, char *err_msg, int len) {
   return load_geos_c_from_handle(handle, err_msg, len);
 }
 
-int is_geos_c_loaded() { return (dyn_GEOS_init_r != NULL) ? 1 : 0; }
+/* Worker threads call the loaded functions without holding the GIL, so
+ * loading is serialized and the first library loaded successfully is kept.
+ * geos_c_loaded is published after all function pointers were set. */
+static sedona_once_t load_once = SEDONA_ONCE_INIT;
+static sedona_mutex_t load_mutex;
+static volatile long geos_c_loaded;
 
-int load_geos_c_from_handle(void *handle, char *err_msg, int len) {
+static void load_init(void) { sedona_mutex_init(&load_mutex); }
+
+int is_geos_c_loaded() { return sedona_atomic_load_32(&geos_c_loaded) != 0; }
+
+static int load_geos_c_functions(void *handle, char *err_msg, int len) {
   LOAD_GEOS_FUNCTION(GEOS_finish_r);
   LOAD_GEOS_FUNCTION(GEOSContext_setErrorHandler_r);
+  LOAD_GEOS_FUNCTION(GEOSContext_setErrorMessageHandler_r);
   LOAD_GEOS_FUNCTION(GEOSGeomTypeId_r);
   LOAD_GEOS_FUNCTION(GEOSHasZ_r);
   LOAD_GEOS_FUNCTION(GEOSGetSRID_r);
@@ -155,9 +170,20 @@ int load_geos_c_from_handle(void *handle, char *err_msg, int len) {
   dyn_GEOSCoordSeq_copyToBuffer_r =
       try_load_geos_c_symbol(handle, "GEOSCoordSeq_copyToBuffer_r");
 
-  /* Deliberately load GEOS_init_r after all other functions, so that we can
-   * check if all functions were loaded by checking if GEOS_init_r was
-   * loaded. */
   LOAD_GEOS_FUNCTION(GEOS_init_r);
   return 0;
 }
+
+int load_geos_c_from_handle(void *handle, char *err_msg, int len) {
+  sedona_once(&load_once, load_init);
+  sedona_mutex_lock(&load_mutex);
+  int err = 0;
+  if (!geos_c_loaded) {
+    err = load_geos_c_functions(handle, err_msg, len);
+    if (err == 0) {
+      sedona_atomic_store_32(&geos_c_loaded, 1);
+    }
+  }
+  sedona_mutex_unlock(&load_mutex);
+  return err;
+}
@@ -34,6 +34,7 @@ typedef struct GEOSContextHandle *GEOSContextHandle_t;
 typedef struct GEOSCoordSeq_t GEOSCoordSequence;
 
 typedef void (*GEOSMessageHandler)(const char *fmt, ...);
+typedef void (*GEOSMessageHandler_r)(const char *message, void *userdata);
 
 /**
  * Check if GEOS C was loaded
@@ -50,6 +51,9 @@ int is_geos_c_loaded();
  * extension since our extension is an augmentation of shapely. Mixing various
  * versions of the same library together is likely to cause nasty bugs.
  *
+ * This function is thread safe. Once a library was loaded successfully, later
+ * calls keep using it and return 0 without loading anything.
+ *
  * @param path path to the libgeos_c library
  * @param err_msg buffer for receiving error message in case of errors
  * @param len length of the error message buffer
@@ -29,6 +29,11 @@ GEOS_FP_QUALIFIER void (*dyn_GEOS_finish_r)(GEOSContextHandle_t handle);
 GEOS_FP_QUALIFIER GEOSMessageHandler (*dyn_GEOSContext_setErrorHandler_r)(
     GEOSContextHandle_t extHandle, GEOSMessageHandler ef);
 
+GEOS_FP_QUALIFIER GEOSMessageHandler_r (
+    *dyn_GEOSContext_setErrorMessageHandler_r)(GEOSContextHandle_t extHandle,
+                                               GEOSMessageHandler_r ef,
+                                               void *userData);
+
 GEOS_FP_QUALIFIER int (*dyn_GEOSGeomTypeId_r)(GEOSContextHandle_t handle,
                                               const GEOSGeometry *g);
 
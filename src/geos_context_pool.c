@@ -0,0 +1,193 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "geos_context_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sedona_thread.h"
+#include "thread_pool.h"
+
+static sedona_mutex_t pool_mutex;
+static GeosContext *idle_list;
+static int num_idle;
+static int64_t num_created;
+static int64_t num_destroyed;
+
+/* 0 for the number of CPU cores */
+static volatile long pool_capacity;
+
+static thread_local GeosContext *thread_ctx;
+
+static void geos_context_msg_handler(const char *message, void *userdata) {
+  GeosContext *ctx = userdata;
+  snprintf(ctx->err_msg, GEOS_CONTEXT_ERR_MSG_SIZE, "%s", message);
+}
+
+static int get_capacity(void) {
+  int capacity = (int)sedona_atomic_load_32(&pool_capacity);
+  return capacity > 0 ? capacity : thread_pool_default_size();
+}
+
+static void destroy_context(GeosContext *ctx) {
+  dyn_GEOS_finish_r(ctx->handle);
+  free(ctx);
+}
+
+/* Contexts are returned to the pool when their owner threads exit */
+static void return_thread_context(void *ptr) {
+  GeosContext *ctx = ptr;
+  if (ctx == NULL) {
+    return;
+  }
+  if (thread_ctx == ctx) {
+    thread_ctx = NULL;
+  }
+  geos_context_release(ctx);
+}
+
+#ifdef SEDONA_THREAD_WIN32
+static DWORD ctx_key = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI ctx_key_destructor(PVOID ptr) { return_thread_context(ptr); }
+
+static void pool_init(void) {
+  sedona_mutex_init(&pool_mutex);
+  ctx_key = FlsAlloc(ctx_key_destructor);
+}
+
+static void ctx_key_set(GeosContext *ctx) {
+  if (ctx_key != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(ctx_key, ctx);
+  }
+}
+#else
+static pthread_key_t ctx_key;
+
+static void pool_init(void) {
+  sedona_mutex_init(&pool_mutex);
+  pthread_key_create(&ctx_key, return_thread_context);
+}
+
+static void ctx_key_set(GeosContext *ctx) { pthread_setspecific(ctx_key, ctx); }
+#endif
+
+static sedona_once_t pool_once = SEDONA_ONCE_INIT;
+
+GeosContext *geos_context_acquire(void) {
+  sedona_once(&pool_once, pool_init);
+  sedona_mutex_lock(&pool_mutex);
+  GeosContext *ctx = idle_list;
+  if (ctx != NULL) {
+    idle_list = ctx->next;
+    num_idle--;
+  }
+  sedona_mutex_unlock(&pool_mutex);
+
+  if (ctx == NULL) {
+    ctx = malloc(sizeof(GeosContext));
+    if (ctx == NULL) {
+      return NULL;
+    }
+    ctx->handle = dyn_GEOS_init_r();
+    if (ctx->handle == NULL) {
+      free(ctx);
+      return NULL;
+    }
+    dyn_GEOSContext_setErrorMessageHandler_r(ctx->handle,
+                                             geos_context_msg_handler, ctx);
+    sedona_mutex_lock(&pool_mutex);
+    num_created++;
+    sedona_mutex_unlock(&pool_mutex);
+  }
+
+  ctx->next = NULL;
+  ctx->err_msg[0] = '\0';
+  return ctx;
+}
+
+void geos_context_release(GeosContext *ctx) {
+  if (ctx == NULL) {
+    return;
+  }
+  sedona_once(&pool_once, pool_init);
+  sedona_mutex_lock(&pool_mutex);
+  if (num_idle < get_capacity()) {
+    ctx->next = idle_list;
+    idle_list = ctx;
+    num_idle++;
+    ctx = NULL;
+  } else {
+    num_destroyed++;
+  }
+  sedona_mutex_unlock(&pool_mutex);
+
+  if (ctx != NULL) {
+    destroy_context(ctx);
+  }
+}
+
+GeosContext *geos_context_get(void) {
+  GeosContext *ctx = thread_ctx;
+  if (ctx == NULL) {
+    ctx = geos_context_acquire();
+    if (ctx == NULL) {
+      return NULL;
+    }
+    ctx_key_set(ctx);
+    thread_ctx = ctx;
+  }
+  return ctx;
+}
+
+void geos_context_pool_set_capacity(int capacity) {
+  sedona_once(&pool_once, pool_init);
+  sedona_atomic_store_32(&pool_capacity, capacity > 0 ? capacity : 0);
+
+  /* Shrink the pool to the new capacity */
+  GeosContext *excess = NULL;
+  sedona_mutex_lock(&pool_mutex);
+  int new_capacity = get_capacity();
+  while (num_idle > new_capacity) {
+    GeosContext *ctx = idle_list;
+    idle_list = ctx->next;
+    ctx->next = excess;
+    excess = ctx;
+    num_idle--;
+    num_destroyed++;
+  }
+  sedona_mutex_unlock(&pool_mutex);
+
+  while (excess != NULL) {
+    GeosContext *next = excess->next;
+    destroy_context(excess);
+    excess = next;
+  }
+}
+
+void geos_context_pool_get_info(GeosContextPoolInfo *info) {
+  sedona_once(&pool_once, pool_init);
+  sedona_mutex_lock(&pool_mutex);
+  info->created = num_created;
+  info->destroyed = num_destroyed;
+  info->idle = num_idle;
+  sedona_mutex_unlock(&pool_mutex);
+  info->capacity = get_capacity();
+}
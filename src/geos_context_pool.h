@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GEOS_CONTEXT_POOL
+#define GEOS_CONTEXT_POOL
+
+#include <stdint.h>
+
+#include "geos_c_dyn.h"
+
+/* GEOS context handles are not thread safe, each thread needs its own one.
+ * Contexts are borrowed from a process-wide pool and returned to it when the
+ * borrowing thread exits, so that short-lived threads reuse contexts instead
+ * of leaking them. At most capacity idle contexts are retained by the pool,
+ * returned contexts beyond that are destroyed.
+ *
+ * The number of borrowed contexts is not limited: a thread keeps its context
+ * until it exits, so bounding borrowing would block threads on contexts held
+ * by other live threads, possibly forever. Memory used by contexts grows with
+ * the number of live threads that ever called into GEOS, which is reported as
+ * in_use by the statistics of the pool. */
+
+#define GEOS_CONTEXT_ERR_MSG_SIZE 1024
+
+typedef struct GeosContext {
+  GEOSContextHandle_t handle;
+  /* last error reported by GEOS on this context */
+  char err_msg[GEOS_CONTEXT_ERR_MSG_SIZE];
+  struct GeosContext *next;
+} GeosContext;
+
+typedef struct GeosContextPoolInfo {
+  int64_t created;
+  int64_t destroyed;
+  int idle;
+  int capacity;
+} GeosContextPoolInfo;
+
+/**
+ * Get the context of the calling thread, borrowing one from the pool on
+ * first use. The context is returned to the pool when the thread exits.
+ * libgeos_c should be loaded before calling this function.
+ *
+ * @return context of the calling thread, NULL if out of memory
+ */
+GeosContext *geos_context_get(void);
+
+/**
+ * Borrow a context from the pool, or create one if the pool is empty
+ *
+ * @return the context, NULL if out of memory
+ */
+GeosContext *geos_context_acquire(void);
+
+/**
+ * Return a context borrowed by geos_context_acquire to the pool
+ */
+void geos_context_release(GeosContext *ctx);
+
+/**
+ * Set the maximum number of idle contexts retained by the pool
+ *
+ * @param capacity maximum number of idle contexts, 0 for the number of CPU
+ * cores
+ */
+void geos_context_pool_set_capacity(int capacity);
+
+/**
+ * Get counters of the pool. Contexts created but neither destroyed nor idle
+ * are borrowed by threads.
+ */
+void geos_context_pool_get_info(GeosContextPoolInfo *info);
+
+#endif /* GEOS_CONTEXT_POOL */
@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "scratch_arena.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sedona_thread.h"
+#include "serde_alloc.h"
+
+/* Size of the first block of each arena */
+#define MIN_BLOCK_SIZE 4096
+
+/* Blocks larger than this will be released when the outermost scope ends, so
+ * that decoding a huge geometry won't pin lots of memory for the thread */
+#define MAX_RETAINED_SIZE (1 << 20)
+
+#define ALIGNMENT 16
+
+typedef struct ScratchBlock {
+  struct ScratchBlock *prev;
+  size_t capacity;
+  size_t used;
+} ScratchBlock;
+
+#define BLOCK_HEADER_SIZE \
+  ((sizeof(ScratchBlock) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+
+typedef struct ScratchArena {
+  ScratchBlock *block;
+  int depth;
+} ScratchArena;
+
+static thread_local ScratchArena *arena;
+
+static void free_blocks(ScratchBlock *block) {
+  while (block != NULL) {
+    ScratchBlock *prev = block->prev;
+    serde_free(block, BLOCK_HEADER_SIZE + block->capacity);
+    block = prev;
+  }
+}
+
+/* Arenas are freed when their owner threads exit */
+static void destroy_arena(void *ptr) {
+  ScratchArena *a = ptr;
+  if (a != NULL) {
+    free_blocks(a->block);
+    serde_free(a, sizeof(ScratchArena));
+  }
+}
+
+#ifdef SEDONA_THREAD_WIN32
+static DWORD arena_key = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI arena_key_destructor(PVOID ptr) { destroy_arena(ptr); }
+
+static void arena_key_init(void) {
+  arena_key = FlsAlloc(arena_key_destructor);
+}
+
+static void arena_key_set(ScratchArena *a) {
+  if (arena_key != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(arena_key, a);
+  }
+}
+#else
+static pthread_key_t arena_key;
+
+static void arena_key_init(void) {
+  pthread_key_create(&arena_key, destroy_arena);
+}
+
+static void arena_key_set(ScratchArena *a) {
+  pthread_setspecific(arena_key, a);
+}
+#endif
+
+static sedona_once_t arena_key_once = SEDONA_ONCE_INIT;
+
+static ScratchArena *get_arena(void) {
+  if (arena == NULL) {
+    ScratchArena *a = serde_calloc(1, sizeof(ScratchArena));
+    if (a == NULL) {
+      return NULL;
+    }
+    sedona_once(&arena_key_once, arena_key_init);
+    arena_key_set(a);
+    arena = a;
+  }
+  return arena;
+}
+
+static ScratchBlock *new_block(size_t capacity, ScratchBlock *prev) {
+  ScratchBlock *block = serde_malloc(BLOCK_HEADER_SIZE + capacity);
+  if (block == NULL) {
+    return NULL;
+  }
+  block->prev = prev;
+  block->capacity = capacity;
+  block->used = 0;
+  return block;
+}
+
+void scratch_arena_begin(void) {
+  ScratchArena *a = get_arena();
+  if (a != NULL) {
+    a->depth++;
+  }
+}
+
+void scratch_arena_end(void) {
+  ScratchArena *a = arena;
+  if (a == NULL || --a->depth > 0) {
+    return;
+  }
+
+  ScratchBlock *block = a->block;
+  if (block == NULL) {
+    return;
+  }
+  if (block->prev == NULL && block->capacity <= MAX_RETAINED_SIZE) {
+    block->used = 0;
+    return;
+  }
+
+  /* The arena has grown to multiple blocks, replace them with one block large
+   * enough to hold all of them, so that the next scope with similar memory
+   * usage won't need to allocate. */
+  size_t total_capacity = 0;
+  for (ScratchBlock *b = block; b != NULL; b = b->prev) {
+    total_capacity += b->capacity;
+  }
+  free_blocks(block);
+  a->block = NULL;
+  if (total_capacity <= MAX_RETAINED_SIZE) {
+    a->block = new_block(total_capacity, NULL);
+  }
+}
+
+void *scratch_arena_calloc(size_t num, size_t size) {
+  ScratchArena *a = get_arena();
+  if (a == NULL || (size != 0 && num > SIZE_MAX / 2 / size)) {
+    return NULL;
+  }
+  size_t bytes = (num * size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+  if (bytes == 0) {
+    bytes = ALIGNMENT;
+  }
+
+  ScratchBlock *block = a->block;
+  if (block == NULL || block->capacity - block->used < bytes) {
+    size_t capacity = block != NULL ? block->capacity * 2 : MIN_BLOCK_SIZE;
+    if (capacity < bytes) {
+      capacity = bytes;
+    }
+    block = new_block(capacity, block);
+    if (block == NULL) {
+      return NULL;
+    }
+    a->block = block;
+  }
+
+  void *ptr = (char *)block + BLOCK_HEADER_SIZE + block->used;
+  block->used += bytes;
+  memset(ptr, 0, num * size);
+  return ptr;
+}
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SCRATCH_ARENA
+#define SCRATCH_ARENA
+
+#include <stddef.h>
+
+/* Per-thread bump allocator for short-lived temporaries of geometry
+ * deserialization, such as the arrays of child geometries passed to
+ * GEOSGeom_createCollection_r. Memory allocated from the arena is not freed
+ * individually; all of it is reclaimed when the outermost scope ends. */
+
+/**
+ * Enter a scratch scope of the calling thread. Scopes could be nested.
+ */
+void scratch_arena_begin(void);
+
+/**
+ * Leave a scratch scope of the calling thread. All memory allocated in the
+ * outermost scope is reclaimed when leaving it.
+ */
+void scratch_arena_end(void);
+
+/**
+ * Allocate zero-initialized memory from the scratch arena of the calling
+ * thread. Should only be called within a scratch scope.
+ *
+ * @param num number of elements
+ * @param size size of each element
+ * @return pointer to the allocated memory, or NULL if out of memory
+ */
+void *scratch_arena_calloc(size_t num, size_t size);
+
+#endif /* SCRATCH_ARENA */
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SEDONA_PROBES
+#define SEDONA_PROBES
+
+/* USDT probes of the serializer, provider name is "sedona". They are only
+ * compiled in when SEDONA_ENABLE_USDT is defined (set ENABLE_USDT=1 when
+ * building the extension), which requires sys/sdt.h from systemtap. Each
+ * probe is a single nop instruction until a tracer attaches to it.
+ *
+ *   serialize__start(geom)                      GEOS geometry
+ *   serialize__done(geom_type, num_coords, size)
+ *   serialize__error(err)
+ *   deserialize__start(buf, buf_size)
+ *   deserialize__done(geom_type, num_coords, size)
+ *   deserialize__error(err)
+ *   serialize__slow_path(num_coords, dims)      no GEOSCoordSeq_copyToBuffer
+ *   deserialize__slow_path(num_coords, dims)    no GEOSCoordSeq_copyFromBuffer
+ *
+ * geom_type is the geometry type id of the serialized format (1 for POINT,
+ * ..., 7 for GEOMETRYCOLLECTION), num_coords is the num_coords field of the
+ * serialized header, which is the number of child geometries for geometry
+ * collections. Only top-level geometries fire start, done and error probes.
+ * See experi/bpftrace for examples. */
+
+#ifdef SEDONA_ENABLE_USDT
+#include <sys/sdt.h>
+#define SEDONA_PROBE1(name, a1) DTRACE_PROBE1(sedona, name, a1)
+#define SEDONA_PROBE2(name, a1, a2) DTRACE_PROBE2(sedona, name, a1, a2)
+#define SEDONA_PROBE3(name, a1, a2, a3) \
+  DTRACE_PROBE3(sedona, name, a1, a2, a3)
+#else
+#define SEDONA_PROBE1(name, a1) \
+  do {                          \
+  } while (0)
+#define SEDONA_PROBE2(name, a1, a2) \
+  do {                              \
+  } while (0)
+#define SEDONA_PROBE3(name, a1, a2, a3) \
+  do {                                  \
+  } while (0)
+#endif
+
+#endif /* SEDONA_PROBES */
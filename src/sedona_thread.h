@@ -0,0 +1,189 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SEDONA_THREAD
+#define SEDONA_THREAD
+
+/* Minimal portable wrappers of threading primitives used by the extension
+ * module. We only need a small subset of pthreads, which could be easily
+ * mapped to Win32 APIs. */
+
+#include <stdint.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define SEDONA_THREAD_WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __GNUC__
+# define thread_local __thread
+#elif __STDC_VERSION__ >= 201112L
+# define thread_local _Thread_local
+#elif defined(_MSC_VER)
+# define thread_local __declspec(thread)
+#else
+# error Cannot define thread_local
+#endif
+
+#ifdef SEDONA_THREAD_WIN32
+typedef CRITICAL_SECTION sedona_mutex_t;
+typedef CONDITION_VARIABLE sedona_cond_t;
+typedef INIT_ONCE sedona_once_t;
+#define SEDONA_ONCE_INIT INIT_ONCE_STATIC_INIT
+
+static inline BOOL CALLBACK sedona_once_trampoline(PINIT_ONCE once,
+                                                   PVOID param, PVOID *ctx) {
+  (void)once;
+  (void)ctx;
+  ((void (*)(void))param)();
+  return TRUE;
+}
+static inline void sedona_once(sedona_once_t *once, void (*func)(void)) {
+  InitOnceExecuteOnce(once, sedona_once_trampoline, (PVOID)func, NULL);
+}
+
+static inline void sedona_mutex_init(sedona_mutex_t *m) {
+  InitializeCriticalSection(m);
+}
+static inline void sedona_mutex_destroy(sedona_mutex_t *m) {
+  DeleteCriticalSection(m);
+}
+static inline void sedona_mutex_lock(sedona_mutex_t *m) {
+  EnterCriticalSection(m);
+}
+static inline int sedona_mutex_trylock(sedona_mutex_t *m) {
+  return TryEnterCriticalSection(m) ? 0 : -1;
+}
+static inline void sedona_mutex_unlock(sedona_mutex_t *m) {
+  LeaveCriticalSection(m);
+}
+static inline void sedona_cond_init(sedona_cond_t *c) {
+  InitializeConditionVariable(c);
+}
+static inline void sedona_cond_destroy(sedona_cond_t *c) { (void)c; }
+static inline void sedona_cond_wait(sedona_cond_t *c, sedona_mutex_t *m) {
+  SleepConditionVariableCS(c, m, INFINITE);
+}
+static inline void sedona_cond_broadcast(sedona_cond_t *c) {
+  WakeAllConditionVariable(c);
+}
+#else
+typedef pthread_mutex_t sedona_mutex_t;
+typedef pthread_cond_t sedona_cond_t;
+typedef pthread_once_t sedona_once_t;
+#define SEDONA_ONCE_INIT PTHREAD_ONCE_INIT
+
+static inline void sedona_once(sedona_once_t *once, void (*func)(void)) {
+  pthread_once(once, func);
+}
+
+static inline void sedona_mutex_init(sedona_mutex_t *m) {
+  pthread_mutex_init(m, NULL);
+}
+static inline void sedona_mutex_destroy(sedona_mutex_t *m) {
+  pthread_mutex_destroy(m);
+}
+static inline void sedona_mutex_lock(sedona_mutex_t *m) {
+  pthread_mutex_lock(m);
+}
+static inline int sedona_mutex_trylock(sedona_mutex_t *m) {
+  return pthread_mutex_trylock(m) == 0 ? 0 : -1;
+}
+static inline void sedona_mutex_unlock(sedona_mutex_t *m) {
+  pthread_mutex_unlock(m);
+}
+static inline void sedona_cond_init(sedona_cond_t *c) {
+  pthread_cond_init(c, NULL);
+}
+static inline void sedona_cond_destroy(sedona_cond_t *c) {
+  pthread_cond_destroy(c);
+}
+static inline void sedona_cond_wait(sedona_cond_t *c, sedona_mutex_t *m) {
+  pthread_cond_wait(c, m);
+}
+static inline void sedona_cond_broadcast(sedona_cond_t *c) {
+  pthread_cond_broadcast(c);
+}
+#endif
+
+/* Atomic operations on 64-bit and 32-bit integers and pointers, with
+ * sequentially consistent ordering unless named relaxed. Relaxed loads and
+ * stores are meant for counters written by a single thread and read by
+ * others. */
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline int64_t sedona_atomic_load_64(volatile int64_t *p) {
+  return _InterlockedCompareExchange64(p, 0, 0);
+}
+static inline int64_t sedona_atomic_load_relaxed_64(volatile int64_t *p) {
+  return __iso_volatile_load64((volatile __int64 *)p);
+}
+static inline void sedona_atomic_store_relaxed_64(volatile int64_t *p,
+                                                  int64_t value) {
+  __iso_volatile_store64((volatile __int64 *)p, value);
+}
+static inline int sedona_atomic_cas_64(volatile int64_t *p, int64_t expected,
+                                       int64_t desired) {
+  return _InterlockedCompareExchange64(p, desired, expected) == expected;
+}
+static inline long sedona_atomic_load_32(volatile long *p) {
+  return _InterlockedCompareExchange(p, 0, 0);
+}
+static inline void sedona_atomic_store_32(volatile long *p, long value) {
+  _InterlockedExchange(p, value);
+}
+static inline void *sedona_atomic_load_ptr(void *volatile *p) {
+  return _InterlockedCompareExchangePointer(p, NULL, NULL);
+}
+static inline void sedona_atomic_store_ptr(void *volatile *p, void *value) {
+  _InterlockedExchangePointer(p, value);
+}
+#else
+static inline int64_t sedona_atomic_load_64(volatile int64_t *p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+static inline int64_t sedona_atomic_load_relaxed_64(volatile int64_t *p) {
+  return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+static inline void sedona_atomic_store_relaxed_64(volatile int64_t *p,
+                                                  int64_t value) {
+  __atomic_store_n(p, value, __ATOMIC_RELAXED);
+}
+static inline int sedona_atomic_cas_64(volatile int64_t *p, int64_t expected,
+                                       int64_t desired) {
+  return __atomic_compare_exchange_n(p, &expected, desired, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+static inline long sedona_atomic_load_32(volatile long *p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+static inline void sedona_atomic_store_32(volatile long *p, long value) {
+  __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+static inline void *sedona_atomic_load_ptr(void *volatile *p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+static inline void sedona_atomic_store_ptr(void *volatile *p, void *value) {
+  __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+#endif
+
+#endif /* SEDONA_THREAD */
@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "serde_alloc.h"
+
+#include <stdlib.h>
+
+#include "serde_stats.h"
+
+static SerdeAllocator allocator = {malloc, calloc, free};
+
+void serde_set_allocator(const SerdeAllocator *new_allocator) {
+  if (new_allocator != NULL) {
+    allocator = *new_allocator;
+  } else {
+    allocator.malloc = malloc;
+    allocator.calloc = calloc;
+    allocator.free = free;
+  }
+}
+
+const SerdeAllocator *serde_get_allocator(void) { return &allocator; }
+
+void *serde_malloc(size_t size) {
+  void *ptr = allocator.malloc(size);
+  if (ptr != NULL) {
+    SERDE_STATS_ADD(allocs, 1);
+    SERDE_STATS_ADD(alloc_bytes, (int64_t)size);
+  }
+  return ptr;
+}
+
+void *serde_calloc(size_t num, size_t size) {
+  void *ptr = allocator.calloc(num, size);
+  if (ptr != NULL) {
+    SERDE_STATS_ADD(allocs, 1);
+    SERDE_STATS_ADD(alloc_bytes, (int64_t)(num * size));
+  }
+  return ptr;
+}
+
+void serde_free(void *ptr, size_t size) {
+  if (ptr == NULL) {
+    return;
+  }
+  /* Blocks freed by thread exit destructors may outlive the statistics of
+   * the thread, which are not attached again for counting them */
+  SerdeThreadStats *thread_stats = serde_thread_stats;
+  if (thread_stats != NULL) {
+    serde_stats_add(&thread_stats->stats.frees, 1);
+    serde_stats_add(&thread_stats->stats.free_bytes, (int64_t)size);
+  }
+  allocator.free(ptr);
+}
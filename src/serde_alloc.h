@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SERDE_ALLOC
+#define SERDE_ALLOC
+
+#include <stddef.h>
+
+/* Heap allocations of the serde core go through a pluggable allocator, which
+ * is the C library allocator by default. The Python module installs the raw
+ * allocator of CPython only when tracemalloc is tracing at import time, since
+ * the tracing hooks of the raw domain take the GIL on worker threads.
+ *
+ * Allocated and freed blocks are counted by serde_stats. */
+
+typedef struct SerdeAllocator {
+  void *(*malloc)(size_t size);
+  void *(*calloc)(size_t num, size_t size);
+  void (*free)(void *ptr);
+} SerdeAllocator;
+
+/**
+ * Install the allocator of the serde core. Memory is released by the
+ * allocator which was installed when it was allocated, so this should be
+ * called before any serialization or deserialization takes place.
+ *
+ * @param allocator the allocator to install, NULL for the C library allocator
+ */
+void serde_set_allocator(const SerdeAllocator *allocator);
+
+/**
+ * Get the installed allocator, for buffers outside of the core which should
+ * be allocated the same way without being counted by serde_stats
+ */
+const SerdeAllocator *serde_get_allocator(void);
+
+void *serde_malloc(size_t size);
+
+void *serde_calloc(size_t num, size_t size);
+
+/**
+ * Release a block returned by serde_malloc or serde_calloc
+ *
+ * @param ptr the block to release, could be NULL
+ * @param size size of the block when it was allocated, for statistics
+ */
+void serde_free(void *ptr, size_t size);
+
+#endif /* SERDE_ALLOC */
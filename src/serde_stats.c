@@ -0,0 +1,203 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "serde_stats.h"
+
+#include <stdlib.h>
+
+#ifndef SEDONA_THREAD_WIN32
+#include <time.h>
+#endif
+
+thread_local SerdeThreadStats *serde_thread_stats;
+volatile long serde_stats_sample_interval;
+
+/* Statistics of running threads, the total of exited threads, and the total
+ * of all threads when statistics were reset */
+static SerdeThreadStats *thread_stats_list;
+static SerdeStats retired_stats;
+static SerdeStats baseline_stats;
+static sedona_mutex_t stats_mutex;
+
+/* SerdeStats only contains int64_t counters */
+#define NUM_COUNTERS (sizeof(SerdeStats) / sizeof(int64_t))
+
+/* src could be the statistics of a running thread, its counters are loaded
+ * atomically */
+static void stats_add(SerdeStats *dst, SerdeStats *src) {
+  int64_t *d = (int64_t *)dst;
+  int64_t *s = (int64_t *)src;
+  for (size_t k = 0; k < NUM_COUNTERS; k++) {
+    d[k] += sedona_atomic_load_relaxed_64(&s[k]);
+  }
+}
+
+static void stats_subtract(SerdeStats *dst, const SerdeStats *src) {
+  int64_t *d = (int64_t *)dst;
+  const int64_t *s = (const int64_t *)src;
+  for (size_t k = 0; k < NUM_COUNTERS; k++) {
+    d[k] -= s[k];
+  }
+}
+
+/* Sum up statistics of all threads, should be called with stats_mutex
+ * locked */
+static void stats_total(SerdeStats *out) {
+  *out = retired_stats;
+  for (SerdeThreadStats *s = thread_stats_list; s != NULL; s = s->next) {
+    stats_add(out, &s->stats);
+  }
+}
+
+/* Statistics are merged into retired_stats when their owner threads exit */
+static void detach_thread_stats(void *ptr) {
+  SerdeThreadStats *thread_stats = ptr;
+  if (thread_stats == NULL) {
+    return;
+  }
+  sedona_mutex_lock(&stats_mutex);
+  stats_add(&retired_stats, &thread_stats->stats);
+  if (thread_stats->prev != NULL) {
+    thread_stats->prev->next = thread_stats->next;
+  } else {
+    thread_stats_list = thread_stats->next;
+  }
+  if (thread_stats->next != NULL) {
+    thread_stats->next->prev = thread_stats->prev;
+  }
+  sedona_mutex_unlock(&stats_mutex);
+  if (serde_thread_stats == thread_stats) {
+    serde_thread_stats = NULL;
+  }
+  free(thread_stats);
+}
+
+#ifdef SEDONA_THREAD_WIN32
+static DWORD stats_key = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI stats_key_destructor(PVOID ptr) {
+  detach_thread_stats(ptr);
+}
+
+static void stats_init(void) {
+  sedona_mutex_init(&stats_mutex);
+  stats_key = FlsAlloc(stats_key_destructor);
+}
+
+static void stats_key_set(SerdeThreadStats *thread_stats) {
+  if (stats_key != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(stats_key, thread_stats);
+  }
+}
+
+static int64_t now_ns(void) {
+  static LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  if (frequency.QuadPart == 0) {
+    QueryPerformanceFrequency(&frequency);
+  }
+  QueryPerformanceCounter(&counter);
+  return (int64_t)((double)counter.QuadPart * 1e9 / frequency.QuadPart);
+}
+#else
+static pthread_key_t stats_key;
+
+static void stats_init(void) {
+  sedona_mutex_init(&stats_mutex);
+  pthread_key_create(&stats_key, detach_thread_stats);
+}
+
+static void stats_key_set(SerdeThreadStats *thread_stats) {
+  pthread_setspecific(stats_key, thread_stats);
+}
+
+static int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+
+static sedona_once_t stats_once = SEDONA_ONCE_INIT;
+
+SerdeStats *serde_stats_attach(void) {
+  SerdeThreadStats *thread_stats = calloc(1, sizeof(SerdeThreadStats));
+  if (thread_stats == NULL) {
+    return NULL;
+  }
+  sedona_once(&stats_once, stats_init);
+  sedona_mutex_lock(&stats_mutex);
+  thread_stats->next = thread_stats_list;
+  if (thread_stats_list != NULL) {
+    thread_stats_list->prev = thread_stats;
+  }
+  thread_stats_list = thread_stats;
+  sedona_mutex_unlock(&stats_mutex);
+  stats_key_set(thread_stats);
+  serde_thread_stats = thread_stats;
+  return &thread_stats->stats;
+}
+
+int64_t serde_stats_sample(SerdeStage stage) {
+  if (serde_stats_local() == NULL) {
+    return 0;
+  }
+  int *countdown = &serde_thread_stats->sample_countdown[stage];
+  if (--*countdown > 0) {
+    return 0;
+  }
+  *countdown = serde_stats_get_sample_interval();
+  int64_t now = now_ns();
+  return now != 0 ? now : 1;
+}
+
+void serde_stats_record(SerdeStage stage, int64_t start) {
+  int64_t elapsed = now_ns() - start;
+  if (elapsed < 0) {
+    elapsed = 0;
+  }
+  int bucket = 0;
+  while (bucket < SERDE_NUM_BUCKETS - 1 && (elapsed >> (bucket + 1)) != 0) {
+    bucket++;
+  }
+  SerdeTiming *timing = &serde_thread_stats->stats.timings[stage];
+  serde_stats_add(&timing->count, 1);
+  serde_stats_add(&timing->sum_ns, elapsed);
+  serde_stats_add(&timing->buckets[bucket], 1);
+}
+
+void serde_stats_collect(SerdeStats *out) {
+  sedona_once(&stats_once, stats_init);
+  sedona_mutex_lock(&stats_mutex);
+  stats_total(out);
+  stats_subtract(out, &baseline_stats);
+  sedona_mutex_unlock(&stats_mutex);
+}
+
+void serde_stats_reset(void) {
+  sedona_once(&stats_once, stats_init);
+  sedona_mutex_lock(&stats_mutex);
+  stats_total(&baseline_stats);
+  sedona_mutex_unlock(&stats_mutex);
+}
+
+void serde_stats_set_sample_interval(int interval) {
+  sedona_atomic_store_32(&serde_stats_sample_interval,
+                         interval > 0 ? interval : 0);
+}
@@ -0,0 +1,172 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SERDE_STATS
+#define SERDE_STATS
+
+#include <stdint.h>
+
+#include "geomserde.h"
+#include "sedona_thread.h"
+
+/* Runtime statistics of serialization and deserialization. Counters are kept
+ * per thread and only written by their owner thread, so updating them takes
+ * a relaxed atomic load and store instead of a locked increment. They are
+ * summed up on demand by serde_stats_collect using relaxed atomic loads,
+ * counters of exited threads are merged into a global total. Resetting
+ * records the current total as a baseline to be subtracted later, counters
+ * of other threads are never written.
+ *
+ * Timing of stages is sampled: when the sample interval is N > 0, one of
+ * every N executions of each stage is timed and recorded in a log2
+ * histogram. Sampling is disabled by default. */
+
+typedef enum SerdeStage {
+  SERDE_STAGE_HEADER_PARSE,
+  SERDE_STAGE_COORD_COPY,
+  SERDE_STAGE_GEOS_CONSTRUCT,
+  SERDE_STAGE_PYTHON_WRAP,
+  SERDE_NUM_STAGES
+} SerdeStage;
+
+/* Indexed by GeometryTypeId, index 0 is unused */
+#define SERDE_NUM_GEOM_TYPES 8
+
+/* Indexed by SedonaErrorCode */
+#define SERDE_NUM_ERRORS (SEDONA_BUFFER_TOO_SMALL + 1)
+
+/* Bucket k counts durations in [2^k, 2^(k+1)) nanoseconds, the last bucket
+ * also counts all longer durations */
+#define SERDE_NUM_BUCKETS 32
+
+typedef struct SerdeTiming {
+  int64_t count;
+  int64_t sum_ns;
+  int64_t buckets[SERDE_NUM_BUCKETS];
+} SerdeTiming;
+
+typedef struct SerdeStats {
+  int64_t serialized_geoms[SERDE_NUM_GEOM_TYPES];
+  int64_t serialized_bytes[SERDE_NUM_GEOM_TYPES];
+  int64_t deserialized_geoms[SERDE_NUM_GEOM_TYPES];
+  int64_t deserialized_bytes[SERDE_NUM_GEOM_TYPES];
+  int64_t serialized_coords;
+  int64_t deserialized_coords;
+  /* number of coordinate sequences copied without
+   * GEOSCoordSeq_copyToBuffer_r or GEOSCoordSeq_copyFromBuffer_r */
+  int64_t slow_path_serialize;
+  int64_t slow_path_deserialize;
+  /* heap blocks allocated and freed by serde_alloc */
+  int64_t allocs;
+  int64_t alloc_bytes;
+  int64_t frees;
+  int64_t free_bytes;
+  int64_t errors[SERDE_NUM_ERRORS];
+  SerdeTiming timings[SERDE_NUM_STAGES];
+} SerdeStats;
+
+typedef struct SerdeThreadStats {
+  SerdeStats stats;
+  int sample_countdown[SERDE_NUM_STAGES];
+  struct SerdeThreadStats *prev;
+  struct SerdeThreadStats *next;
+} SerdeThreadStats;
+
+extern thread_local SerdeThreadStats *serde_thread_stats;
+extern volatile long serde_stats_sample_interval;
+
+/**
+ * Allocate and register statistics of the calling thread
+ *
+ * @return statistics of the calling thread, or NULL if out of memory
+ */
+SerdeStats *serde_stats_attach(void);
+
+static inline SerdeStats *serde_stats_local(void) {
+  SerdeThreadStats *thread_stats = serde_thread_stats;
+  return thread_stats != NULL ? &thread_stats->stats : serde_stats_attach();
+}
+
+/* Add n to a counter of the calling thread */
+static inline void serde_stats_add(int64_t *counter, int64_t n) {
+  sedona_atomic_store_relaxed_64(counter,
+                                 sedona_atomic_load_relaxed_64(counter) + n);
+}
+
+#define SERDE_STATS_ADD(field, n)                \
+  do {                                           \
+    SerdeStats *stats_ = serde_stats_local();    \
+    if (stats_ != NULL) {                        \
+      serde_stats_add(&stats_->field, (n));      \
+    }                                            \
+  } while (0)
+
+/**
+ * Count an error of serialization or deserialization
+ */
+static inline void serde_stats_error(SedonaErrorCode err) {
+  if (err > SEDONA_SUCCESS && err < SERDE_NUM_ERRORS) {
+    SERDE_STATS_ADD(errors[err], 1);
+  }
+}
+
+static inline int serde_stats_get_sample_interval(void) {
+  return (int)sedona_atomic_load_32(&serde_stats_sample_interval);
+}
+
+int64_t serde_stats_sample(SerdeStage stage);
+
+void serde_stats_record(SerdeStage stage, int64_t start);
+
+/**
+ * Start timing a stage. Returns the current time if this execution of the
+ * stage is sampled, otherwise returns 0 and the stage won't be recorded by
+ * serde_stats_timer_end.
+ */
+static inline int64_t serde_stats_timer_begin(SerdeStage stage) {
+  return serde_stats_get_sample_interval() > 0 ? serde_stats_sample(stage) : 0;
+}
+
+static inline void serde_stats_timer_end(SerdeStage stage, int64_t start) {
+  if (start != 0) {
+    serde_stats_record(stage, start);
+  }
+}
+
+/**
+ * Sum up statistics of all threads since the last reset, including exited
+ * threads. Counters of running threads are read one at a time, so the result
+ * may be slightly behind while batches are being processed.
+ *
+ * @param out OUTPUT parameter for receiving the statistics
+ */
+void serde_stats_collect(SerdeStats *out);
+
+/**
+ * Reset statistics of all threads to zero, by taking the current total as
+ * the baseline of serde_stats_collect
+ */
+void serde_stats_reset(void);
+
+/**
+ * Set the sample interval of stage timing, 0 disables timing
+ */
+void serde_stats_set_sample_interval(int interval);
+
+#endif /* SERDE_STATS */
@@ -0,0 +1,369 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "thread_pool.h"
+
+#include <stdlib.h>
+
+#include "sedona_thread.h"
+
+#ifndef SEDONA_THREAD_WIN32
+#include <unistd.h>
+#endif
+
+#define MAX_POOL_SIZE 256
+
+/* Number of chunks assigned to each participating thread. Having more chunks
+ * than threads gives idle threads something to steal when the weights do not
+ * reflect the actual cost of items precisely. */
+#define CHUNKS_PER_THREAD 16
+
+/* A parallel job. Chunk k covers items [chunk_starts[k], chunk_starts[k + 1]).
+ * Each participating thread owns a queue of chunks, which is a contiguous
+ * range of chunk indexes packed into a 64-bit integer as (head << 32) | tail.
+ * The owner takes chunks from the head of its queue, while thieves take
+ * chunks from the tail. Both ends are updated using CAS on the packed value,
+ * so there's no need to lock the queues. */
+typedef struct ThreadPoolJob {
+  ThreadPoolTaskFunc func;
+  void *ctx;
+  int num_participants;
+  int64_t *chunk_starts;
+  volatile int64_t *queues;
+  int num_running_workers; /* protected by pool.mutex */
+} ThreadPoolJob;
+
+typedef struct WorkerArg {
+  int worker_id;
+  uint64_t generation;
+} WorkerArg;
+
+static struct {
+  sedona_mutex_t mutex;
+  sedona_cond_t work_cond;
+  sedona_cond_t done_cond;
+  /* Only one parallel job could run at a time */
+  sedona_mutex_t job_mutex;
+  volatile long size;
+  int num_workers;
+  uint64_t generation;
+  ThreadPoolJob *job;
+} pool;
+
+static sedona_once_t pool_once = SEDONA_ONCE_INIT;
+
+static int64_t queue_pop_head(volatile int64_t *queue) {
+  for (;;) {
+    int64_t value = sedona_atomic_load_64(queue);
+    int64_t head = value >> 32;
+    int64_t tail = value & 0xFFFFFFFF;
+    if (head >= tail) {
+      return -1;
+    }
+    if (sedona_atomic_cas_64(queue, value, ((head + 1) << 32) | tail)) {
+      return head;
+    }
+  }
+}
+
+static int64_t queue_steal_tail(volatile int64_t *queue) {
+  for (;;) {
+    int64_t value = sedona_atomic_load_64(queue);
+    int64_t head = value >> 32;
+    int64_t tail = value & 0xFFFFFFFF;
+    if (head >= tail) {
+      return -1;
+    }
+    if (sedona_atomic_cas_64(queue, value, (head << 32) | (tail - 1))) {
+      return tail - 1;
+    }
+  }
+}
+
+static void run_chunk(ThreadPoolJob *job, int64_t chunk) {
+  job->func(job->ctx, job->chunk_starts[chunk], job->chunk_starts[chunk + 1]);
+}
+
+static void run_participant(ThreadPoolJob *job, int id) {
+  int64_t chunk;
+  while ((chunk = queue_pop_head(&job->queues[id])) >= 0) {
+    run_chunk(job, chunk);
+  }
+
+  /* Our own queue is drained, steal chunks from other threads. Queues never
+   * grow, so one pass over all other queues is enough. */
+  for (int k = 1; k < job->num_participants; k++) {
+    int victim = (id + k) % job->num_participants;
+    while ((chunk = queue_steal_tail(&job->queues[victim])) >= 0) {
+      run_chunk(job, chunk);
+    }
+  }
+}
+
+static void worker_main(WorkerArg *arg) {
+  int worker_id = arg->worker_id;
+  uint64_t generation = arg->generation;
+  free(arg);
+
+  sedona_mutex_lock(&pool.mutex);
+  for (;;) {
+    while (pool.generation == generation) {
+      sedona_cond_wait(&pool.work_cond, &pool.mutex);
+    }
+    generation = pool.generation;
+    ThreadPoolJob *job = pool.job;
+    if (job != NULL && worker_id < job->num_participants) {
+      sedona_mutex_unlock(&pool.mutex);
+      run_participant(job, worker_id);
+      sedona_mutex_lock(&pool.mutex);
+      if (--job->num_running_workers == 0) {
+        sedona_cond_broadcast(&pool.done_cond);
+      }
+    }
+  }
+}
+
+#ifdef SEDONA_THREAD_WIN32
+static DWORD WINAPI worker_entry(LPVOID arg) {
+  worker_main((WorkerArg *)arg);
+  return 0;
+}
+
+static int start_worker(WorkerArg *arg) {
+  HANDLE thread = CreateThread(NULL, 0, worker_entry, arg, 0, NULL);
+  if (thread == NULL) {
+    return -1;
+  }
+  CloseHandle(thread);
+  return 0;
+}
+#else
+static void *worker_entry(void *arg) {
+  worker_main((WorkerArg *)arg);
+  return NULL;
+}
+
+static int start_worker(WorkerArg *arg) {
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, worker_entry, arg) != 0) {
+    return -1;
+  }
+  pthread_detach(thread);
+  return 0;
+}
+
+/* Worker threads do not survive fork(). The child process starts with an
+ * empty pool and spawns new workers when needed. */
+static void pool_atfork_prepare(void) {
+  sedona_mutex_lock(&pool.job_mutex);
+  sedona_mutex_lock(&pool.mutex);
+}
+
+static void pool_atfork_parent(void) {
+  sedona_mutex_unlock(&pool.mutex);
+  sedona_mutex_unlock(&pool.job_mutex);
+}
+
+static void pool_atfork_child(void) {
+  pool.num_workers = 0;
+  pool.job = NULL;
+  sedona_cond_init(&pool.work_cond);
+  sedona_cond_init(&pool.done_cond);
+  sedona_mutex_unlock(&pool.mutex);
+  sedona_mutex_unlock(&pool.job_mutex);
+}
+#endif
+
+static void pool_init(void) {
+  sedona_mutex_init(&pool.mutex);
+  sedona_mutex_init(&pool.job_mutex);
+  sedona_cond_init(&pool.work_cond);
+  sedona_cond_init(&pool.done_cond);
+#ifndef SEDONA_THREAD_WIN32
+  pthread_atfork(pool_atfork_prepare, pool_atfork_parent, pool_atfork_child);
+#endif
+}
+
+/* Make sure that there are at least num_workers worker threads. Should be
+ * called with pool.mutex held. Returns number of available workers. */
+static int ensure_workers(int num_workers) {
+  while (pool.num_workers < num_workers) {
+    WorkerArg *arg = malloc(sizeof(WorkerArg));
+    if (arg == NULL) {
+      break;
+    }
+    /* Worker ids start from 1, the calling thread is participant 0 */
+    arg->worker_id = pool.num_workers + 1;
+    arg->generation = pool.generation;
+    if (start_worker(arg) != 0) {
+      free(arg);
+      break;
+    }
+    pool.num_workers++;
+  }
+  return pool.num_workers < num_workers ? pool.num_workers : num_workers;
+}
+
+/* Split items into at most max_chunks chunks of roughly equal weight. Returns
+ * number of chunks. chunk_starts should have room for max_chunks + 2
+ * elements. */
+static int64_t split_chunks(int64_t num_items, const int64_t *weights,
+                            int64_t max_chunks, int64_t *chunk_starts) {
+  if (weights == NULL) {
+    for (int64_t k = 0; k <= max_chunks; k++) {
+      chunk_starts[k] = num_items * k / max_chunks;
+    }
+    return max_chunks;
+  }
+
+  int64_t total_weight = 0;
+  for (int64_t k = 0; k < num_items; k++) {
+    total_weight += (weights[k] > 0 ? weights[k] : 1);
+  }
+  int64_t target_weight = (total_weight + max_chunks - 1) / max_chunks;
+  int64_t num_chunks = 0;
+  int64_t chunk_weight = 0;
+  chunk_starts[0] = 0;
+  for (int64_t k = 0; k < num_items; k++) {
+    chunk_weight += (weights[k] > 0 ? weights[k] : 1);
+    if (chunk_weight >= target_weight) {
+      chunk_starts[++num_chunks] = k + 1;
+      chunk_weight = 0;
+    }
+  }
+  if (chunk_starts[num_chunks] != num_items) {
+    chunk_starts[++num_chunks] = num_items;
+  }
+  return num_chunks;
+}
+
+int thread_pool_default_size(void) {
+#ifdef SEDONA_THREAD_WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  int num_cpus = (int)info.dwNumberOfProcessors;
+#else
+  int num_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (num_cpus < 1) {
+    return 1;
+  }
+  return num_cpus < MAX_POOL_SIZE ? num_cpus : MAX_POOL_SIZE;
+}
+
+int thread_pool_get_size(void) {
+  int size = (int)sedona_atomic_load_32(&pool.size);
+  return size > 0 ? size : thread_pool_default_size();
+}
+
+void thread_pool_set_size(int num_threads) {
+  if (num_threads < 0) {
+    num_threads = 0;
+  }
+  if (num_threads > MAX_POOL_SIZE) {
+    num_threads = MAX_POOL_SIZE;
+  }
+  sedona_atomic_store_32(&pool.size, num_threads);
+}
+
+void thread_pool_run(int64_t num_items, const int64_t *weights,
+                     int num_threads, ThreadPoolTaskFunc func, void *ctx) {
+  if (num_items <= 0) {
+    return;
+  }
+  if (num_threads <= 0) {
+    num_threads = thread_pool_get_size();
+  }
+  if (num_threads > MAX_POOL_SIZE) {
+    num_threads = MAX_POOL_SIZE;
+  }
+  if (num_threads > num_items) {
+    num_threads = (int)num_items;
+  }
+  if (num_threads <= 1) {
+    func(ctx, 0, num_items);
+    return;
+  }
+
+  sedona_once(&pool_once, pool_init);
+
+  /* If the pool is busy running a job submitted by another thread, we simply
+   * process all items on the calling thread instead of waiting for it. */
+  if (sedona_mutex_trylock(&pool.job_mutex) != 0) {
+    func(ctx, 0, num_items);
+    return;
+  }
+
+  int64_t max_chunks = (int64_t)num_threads * CHUNKS_PER_THREAD;
+  if (max_chunks > num_items) {
+    max_chunks = num_items;
+  }
+  int64_t *chunk_starts = malloc((max_chunks + 2) * sizeof(int64_t));
+  volatile int64_t *queues = malloc(num_threads * sizeof(int64_t));
+  if (chunk_starts == NULL || queues == NULL) {
+    free(chunk_starts);
+    free((void *)queues);
+    sedona_mutex_unlock(&pool.job_mutex);
+    func(ctx, 0, num_items);
+    return;
+  }
+  int64_t num_chunks =
+      split_chunks(num_items, weights, max_chunks, chunk_starts);
+
+  sedona_mutex_lock(&pool.mutex);
+  int num_participants = 1 + ensure_workers(num_threads - 1);
+  if (num_participants > num_chunks) {
+    num_participants = (int)num_chunks;
+  }
+
+  ThreadPoolJob job;
+  job.func = func;
+  job.ctx = ctx;
+  job.num_participants = num_participants;
+  job.chunk_starts = chunk_starts;
+  job.queues = queues;
+  job.num_running_workers = num_participants - 1;
+  for (int k = 0; k < num_participants; k++) {
+    int64_t head = num_chunks * k / num_participants;
+    int64_t tail = num_chunks * (k + 1) / num_participants;
+    queues[k] = (head << 32) | tail;
+  }
+
+  if (num_participants > 1) {
+    pool.job = &job;
+    pool.generation++;
+    sedona_cond_broadcast(&pool.work_cond);
+  }
+  sedona_mutex_unlock(&pool.mutex);
+
+  run_participant(&job, 0);
+
+  if (num_participants > 1) {
+    sedona_mutex_lock(&pool.mutex);
+    while (job.num_running_workers > 0) {
+      sedona_cond_wait(&pool.done_cond, &pool.mutex);
+    }
+    pool.job = NULL;
+    sedona_mutex_unlock(&pool.mutex);
+  }
+
+  free(chunk_starts);
+  free((void *)queues);
+  sedona_mutex_unlock(&pool.job_mutex);
+}
@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef THREAD_POOL
+#define THREAD_POOL
+
+#include <stdint.h>
+
+/**
+ * Function processing items in range [begin, end) of a parallel job.
+ *
+ * @param ctx user provided context of the job
+ * @param begin first item to process
+ * @param end one past the last item to process
+ */
+typedef void (*ThreadPoolTaskFunc)(void *ctx, int64_t begin, int64_t end);
+
+/**
+ * Get number of online CPU cores, which is the default size of the thread pool
+ *
+ * @return number of CPU cores
+ */
+int thread_pool_default_size(void);
+
+/**
+ * Get number of threads used by parallel jobs, including the calling thread
+ *
+ * @return number of threads
+ */
+int thread_pool_get_size(void);
+
+/**
+ * Set number of threads used by parallel jobs, including the calling thread.
+ * Worker threads are started lazily when running parallel jobs.
+ *
+ * @param num_threads number of threads, 0 for thread_pool_default_size()
+ */
+void thread_pool_set_size(int num_threads);
+
+/**
+ * Process items [0, num_items) in parallel and wait for all of them to finish.
+ *
+ * Items are grouped into chunks of roughly equal total weight, so that heavy
+ * items won't be put into the same chunk. Chunks are initially distributed
+ * evenly to participating threads; a thread running out of chunks steals
+ * chunks from other threads. The calling thread also participates in the job.
+ * This function does not touch any Python API, it is safe to call it without
+ * holding the GIL.
+ *
+ * @param num_items number of items to process
+ * @param weights estimated cost of each item, NULL if all items have the same
+ * cost
+ * @param num_threads number of threads to use, 0 for thread_pool_get_size()
+ * @param func function processing a range of items
+ * @param ctx context passed to func
+ */
+void thread_pool_run(int64_t num_items, const int64_t *weights,
+                     int num_threads, ThreadPoolTaskFunc func, void *ctx);
+
+#endif /* THREAD_POOL */
@@ -0,0 +1,115 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+import numpy as np
+import pytest
+
+from shapely.geometry import LineString
+from shapely.geometry import Point
+from shapely.geometry import Polygon
+from shapely.wkt import loads as wkt_loads
+from sedona.utils import geometry_serde
+from sedona.utils.geometry_blocks import GeometryBlocks
+
+
+GEOMS = [
+    Point(10, 20),
+    None,
+    wkt_loads('POLYGON EMPTY'),
+    LineString([(float(n), float(n)) for n in range(100)]),
+    Polygon([(0, 0), (0, 10), (10, 10), (0, 0)]),
+    wkt_loads('MULTIPOLYGON (((0 0, 1 0, 1 1, 0 0)), ((5 5, 6 5, 6 6, 5 5)))'),
+    None,
+    wkt_loads('GEOMETRYCOLLECTION (POINT (1 2), LINESTRING (3 4, 5 6))'),
+] * 50
+
+
+class TestGeometryBlocks:
+    @pytest.mark.parametrize("rows_per_block", [1, 7, 64, 10000])
+    def test_roundtrip(self, rows_per_block):
+        blocks = GeometryBlocks.from_geometries(GEOMS, rows_per_block=rows_per_block)
+        assert len(blocks) == len(GEOMS)
+        assert blocks.num_blocks == (len(GEOMS) + rows_per_block - 1) // rows_per_block
+        assert list(blocks.index[:, 3]) == [min(rows_per_block, len(GEOMS) - k)
+                                            for k in range(0, len(GEOMS), rows_per_block)]
+        assert list(blocks.read_blocks()) == GEOMS
+        data, offsets, validity = geometry_serde.serialize_array(GEOMS)
+        data2, offsets2, validity2 = blocks.serialized_blocks()
+        assert bytes(data2) == bytes(data)
+        assert list(offsets2) == list(offsets)
+        assert bytes(validity2) == bytes(validity)
+
+    def test_empty(self):
+        blocks = GeometryBlocks.from_geometries([])
+        assert len(blocks) == 0 and blocks.num_blocks == 0
+        assert len(blocks.read_blocks()) == 0
+        assert len(GeometryBlocks.from_buffer(blocks.to_bytes())) == 0
+
+    def test_compression(self):
+        # Repeated small polygons on a shared grid compress well across rows
+        geoms = [Polygon([(x, y), (x + 1, y), (x + 1, y + 1), (x, y + 1), (x, y)])
+                 for x in range(50) for y in range(50)]
+        blocks = GeometryBlocks.from_geometries(geoms, rows_per_block=500)
+        assert blocks.compressed_size * 3 < blocks.raw_size
+        assert list(blocks.read_blocks()) == geoms
+
+    def test_partial_reads(self):
+        blocks = GeometryBlocks.from_geometries(GEOMS, rows_per_block=16)
+        for start, stop in [(0, 1), (5, 37), (16, 32), (100, 400), (399, 400), (20, 20), (400, 400)]:
+            assert list(blocks.read_batch(start, stop)) == GEOMS[start:stop]
+        assert list(blocks.read_blocks([3, 1])) == GEOMS[48:64] + GEOMS[16:32]
+        assert list(blocks.read_blocks([])) == []
+
+    def test_block_bounds(self):
+        geoms = [Point(k, -k) for k in range(100)] + [None] * 10 + [wkt_loads('POINT EMPTY')] * 10
+        blocks = GeometryBlocks.from_geometries(geoms, rows_per_block=10)
+        assert np.array_equal(blocks.bounds[0], [0, -9, 9, 0])
+        assert np.array_equal(blocks.bounds[9], [90, -99, 99, -90])
+        assert np.isnan(blocks.bounds[10:]).all()
+        ids = blocks.blocks_intersecting(25, -35, 45, -25)
+        assert list(ids) == [2, 3]
+        assert list(blocks.read_blocks(ids)) == geoms[20:40]
+
+    def test_serialized_form(self):
+        blocks = GeometryBlocks.from_geometries(GEOMS, rows_per_block=16)
+        buf = blocks.to_bytes()
+        loaded = GeometryBlocks.from_buffer(buf)
+        assert np.array_equal(loaded.index, blocks.index)
+        assert np.array_equal(loaded.bounds, blocks.bounds, equal_nan=True)
+        assert list(loaded.read_batch(10, 90)) == GEOMS[10:90]
+        with pytest.raises(ValueError):
+            GeometryBlocks.from_buffer(b'NOTBLOCK' + buf[8:])
+        with pytest.raises(ValueError):
+            GeometryBlocks.from_buffer(buf[:100])
+
+        # Corrupted blocks are detected instead of producing garbage
+        corrupted = bytearray(buf)
+        data_offset = len(buf) - len(blocks.data)
+        for k in range(data_offset, len(buf), 7):
+            corrupted[k] ^= 0x5A
+        with pytest.raises(ValueError):
+            GeometryBlocks.from_buffer(corrupted).read_blocks()
+
+    @pytest.mark.parametrize("num_threads", [2, 4])
+    def test_multithreaded(self, num_threads):
+        geoms = [LineString([(k, k), (k + 1, k * 2)]) if k % 11 else None for k in range(5000)]
+        single = GeometryBlocks.from_geometries(geoms, rows_per_block=100)
+        multi = GeometryBlocks.from_geometries(geoms, rows_per_block=100, num_threads=num_threads)
+        assert np.array_equal(single.index, multi.index)
+        assert bytes(single.data) == bytes(multi.data)
+        assert list(multi.read_blocks(num_threads=num_threads)) == geoms
+        assert list(multi.read_batch(1234, 4321, num_threads=num_threads)) == geoms[1234:4321]
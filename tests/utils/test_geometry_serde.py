@@ -15,7 +15,11 @@
 #  specific language governing permissions and limitations
 #  under the License.
 
+import ctypes
+import struct
+
 import pytest
+import shapely
 
 from shapely.geometry.base import BaseGeometry
 from sedona.utils import geometry_serde
@@ -30,6 +34,147 @@ from shapely.geometry import GeometryCollection
 from shapely.wkt import loads as wkt_loads
 
 
+# SEDONA_MAX_NESTING_DEPTH in geomserde.h
+_MAX_NESTING_DEPTH = 256
+
+
+def _nested_collection(geom, depth):
+    # Serialized geom nested in depth single-child geometry collections. It is
+    # built by hand since creating deep collections using shapely is slow.
+    header = b'\x72\x00\x00\x00' + struct.pack('<i', 1)
+    return header * depth + bytes(geometry_serde.serialize(geom))
+
+
+def _flatten_coords(geom):
+    if hasattr(geom, 'geoms'):
+        for g in geom.geoms:
+            yield from _flatten_coords(g)
+    elif hasattr(geom, 'exterior'):
+        if not geom.is_empty:
+            yield from geom.exterior.coords
+            for ring in geom.interiors:
+                yield from ring.coords
+    else:
+        yield from geom.coords
+
+
+class _ArrowBinaryArray:
+    """Arrow binary array built using ctypes, for testing Arrow input of batch
+    functions without depending on pyarrow"""
+
+    class Schema(ctypes.Structure):
+        _fields_ = [('format', ctypes.c_char_p), ('name', ctypes.c_char_p),
+                    ('metadata', ctypes.c_char_p), ('flags', ctypes.c_int64),
+                    ('n_children', ctypes.c_int64), ('children', ctypes.c_void_p),
+                    ('dictionary', ctypes.c_void_p), ('release', ctypes.c_void_p),
+                    ('private_data', ctypes.c_void_p)]
+
+    class Array(ctypes.Structure):
+        _fields_ = [('length', ctypes.c_int64), ('null_count', ctypes.c_int64),
+                    ('offset', ctypes.c_int64), ('n_buffers', ctypes.c_int64),
+                    ('n_children', ctypes.c_int64), ('buffers', ctypes.POINTER(ctypes.c_void_p)),
+                    ('children', ctypes.c_void_p), ('dictionary', ctypes.c_void_p),
+                    ('release', ctypes.c_void_p), ('private_data', ctypes.c_void_p)]
+
+    RELEASE = ctypes.CFUNCTYPE(None, ctypes.c_void_p)(lambda _: None)
+
+    def __init__(self, values, offset=0, large=False):
+        import numpy as np
+        data = b''.join(v for v in values if v is not None)
+        lengths = [len(v) if v is not None else 0 for v in values]
+        self._offsets = np.concatenate([[0], np.cumsum(lengths)]).astype(np.int64 if large else np.int32)
+        self._data = ctypes.create_string_buffer(data, len(data) + 1)
+        self._validity = ctypes.create_string_buffer(bytes(
+            sum(1 << (i % 8) for i in range(j, min(j + 8, len(values))) if values[i] is not None)
+            for j in range(0, len(values), 8)) + b'\0')
+        self._buffers = (ctypes.c_void_p * 3)(ctypes.addressof(self._validity), self._offsets.ctypes.data,
+                                             ctypes.addressof(self._data))
+        release = ctypes.cast(self.RELEASE, ctypes.c_void_p)
+        self._schema = self.Schema(format=b'Z' if large else b'z', flags=2, release=release)
+        self._array = self.Array(length=len(values) - offset, null_count=values.count(None),
+                                 offset=offset, n_buffers=3, buffers=self._buffers, release=release)
+
+    def __arrow_c_array__(self, requested_schema=None):
+        capsule_new = ctypes.pythonapi.PyCapsule_New
+        capsule_new.restype = ctypes.py_object
+        capsule_new.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_void_p]
+        return (capsule_new(ctypes.addressof(self._schema), b'arrow_schema', None),
+                capsule_new(ctypes.addressof(self._array), b'arrow_array', None))
+
+
+# Prints the peak memory traced while deserializing a hex encoded buffer.
+_TRACEMALLOC_SCRIPT = """
+import sys
+import tracemalloc
+from sedona.utils import geometry_serde
+
+buf = bytes.fromhex(sys.stdin.read())
+geometry_serde.deserialize(buf)
+tracemalloc.reset_peak()
+base, _ = tracemalloc.get_traced_memory()
+geometry_serde.deserialize(buf)
+_, peak = tracemalloc.get_traced_memory()
+print(peak - base)
+"""
+
+
+# Exercises the Shapely 1.x functions of geomserde_speedup with stand-in
+# geometry classes. shapely.lib is hidden when importing the module, so that
+# the module definition for Shapely 1.x is picked like it is without Shapely 2.
+_SHAPELY_1_SCRIPT = """
+import json
+import sys
+import types
+
+sys.modules['shapely.lib'] = types.ModuleType('shapely.lib')
+from sedona.utils import geomserde_speedup as m
+
+m.load_libgeos_c(sys.argv[1])
+cases = [(bytes.fromhex(buf), name, ndim) for buf, name, ndim in json.loads(sys.stdin.read())]
+bufs = [buf for buf, _, _ in cases]
+
+class BaseGeometry:
+    pass
+
+names = ['Point', 'LineString', 'LinearRing', 'Polygon', 'MultiPoint',
+         'MultiLineString', 'MultiPolygon', 'GeometryCollection']
+classes = [type(name, (BaseGeometry,), {}) for name in names]
+
+try:
+    m.deserialize_1(bufs[0])
+    raise AssertionError('deserialize_1 should fail before init_shapely_1')
+except RuntimeError:
+    pass
+for args, error in [((BaseGeometry, classes[:-1]), ValueError), ((BaseGeometry, 42), TypeError),
+                    ((BaseGeometry,), TypeError)]:
+    try:
+        m.init_shapely_1(*args)
+        raise AssertionError('init_shapely_1{} should fail'.format(args))
+    except error:
+        pass
+m.init_shapely_1(BaseGeometry, classes)
+
+for buf, name, ndim in cases:
+    geom, length = m.deserialize_1(buf)
+    assert length == len(buf)
+    assert type(geom) is classes[names.index(name)]
+    assert geom.__p__ is None and geom._is_empty is False and geom._ndim == ndim
+    assert m.serialize_1(geom.__geom__) == buf
+
+geoms = m.deserialize_array_1([bufs[0], None, bufs[1]], num_threads=2)
+assert geoms[1] is None
+assert m.serialize_1(geoms[0].__geom__) == bufs[0]
+assert m.serialize_1(geoms[2].__geom__) == bufs[1]
+
+# Classes are looked up from the ones registered most recently
+other_classes = [type(name, (BaseGeometry,), {}) for name in names]
+m.init_shapely_1(BaseGeometry, other_classes)
+geom, _ = m.deserialize_1(bufs[0])
+assert type(geom) is other_classes[0]
+print('ok')
+"""
+
+
 class TestGeometrySerde:
     @pytest.mark.parametrize("wkt", [
         # empty geometries
@@ -163,6 +308,804 @@ class TestGeometrySerde:
         ]
         self._test_serde_roundtrip(geometry_collections)
 
+    def test_serialize_array(self):
+        geoms = [
+            Point(10, 20),
+            None,
+            wkt_loads("POLYGON EMPTY"),
+            LineString([(10, 20), (30, 40), (50, 60)]),
+            None,
+            GeometryCollection([Point(10, 20), LineString([(10, 20), (30, 40)])]),
+        ]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        assert len(offsets) == len(geoms) + 1
+        assert offsets[0] == 0 and offsets[-1] == len(data)
+        for k, geom in enumerate(geoms):
+            is_valid = (validity[k // 8] >> (k % 8)) & 1
+            buf = bytes(data[offsets[k]:offsets[k + 1]])
+            if geom is None:
+                assert not is_valid
+                assert buf == b''
+            else:
+                assert is_valid
+                assert buf == bytes(geometry_serde.serialize(geom))
+
+    @pytest.mark.parametrize("wkt", [
+        'POINT EMPTY',
+        'POINT (10 20 30)',
+        'POLYGON ((0 0, 0 10, 10 10, 10 0, 0 0), (1 1, 1 2, 2 2, 2 1, 1 1))',
+        'MULTIPOINT ((10 20), (30 40))',
+        'MULTIPOLYGON (EMPTY, ((10 10, 20 20, 20 10, 10 10)))',
+        'GEOMETRYCOLLECTION (POINT (1 2), GEOMETRYCOLLECTION (POINT (10 20), LINESTRING (10 20, 30 40)))',
+    ])
+    def test_serialize_into(self, wkt):
+        geom = wkt_loads(wkt)
+        expected = bytes(geometry_serde.serialize(geom))
+        size = geometry_serde.serialized_size(geom)
+        assert size == len(expected)
+        buf = bytearray(b'\xff' * (size + 3))
+        assert geometry_serde.serialize_into(geom, buf, 3) == size
+        assert bytes(buf[3:]) == expected
+        assert buf[:3] == b'\xff\xff\xff'
+        with pytest.raises(ValueError):
+            geometry_serde.serialize_into(geom, bytearray(size - 1))
+
+    def test_nested_geometry_collection(self):
+        geom = GeometryCollection([
+            Point(1, 2),
+            MultiPoint([(10, 20), (30, 40)]),
+            LineString([(k, k) for k in range(100)]),
+        ])
+        for k in range(5):
+            geom = GeometryCollection([geom, Point(k, k), geom])
+        buf = geometry_serde.serialize(geom)
+        assert len(buf) == geometry_serde.serialized_size(geom)
+        geom_actual, length = geometry_serde.deserialize(buf)
+        assert length == len(buf)
+        assert geom_actual.equals_exact(geom, 1e-6)
+
+    @pytest.mark.parametrize("view_type", [
+        geometry_serde.SerializedGeometry,
+        geometry_serde._SerializedGeometryPy,
+    ])
+    @pytest.mark.parametrize("wkt", [
+        'POINT EMPTY',
+        'POINT (10 20)',
+        'LINESTRING (10 20 30, 40 50 60)',
+        'POLYGON ((0 0, 0 10, 10 10, 10 0, 0 0), (1 1, 1 2, 2 2, 2 1, 1 1))',
+        'MULTIPOINT ((10 20), (30 40))',
+        'MULTILINESTRING ((10 20, 30 40), (50 60, 70 80))',
+        'MULTIPOLYGON (EMPTY, ((10 10, 20 20, 20 10, 10 10)))',
+        'GEOMETRYCOLLECTION (POINT (1 2), GEOMETRYCOLLECTION (POINT (-10 20), LINESTRING (10 20, 30 40)))',
+        'GEOMETRYCOLLECTION EMPTY',
+    ])
+    def test_serialized_geometry(self, view_type, wkt):
+        import math
+        geom = wkt_loads(wkt)
+        view = view_type(geometry_serde.serialize(geom))
+        assert view.geom_type == geom.geom_type
+        assert view.srid == 0
+        assert view.is_empty == geom.is_empty
+        assert view.num_coords == len(list(_flatten_coords(geom)))
+        if geom.is_empty:
+            assert all(math.isnan(v) for v in view.bounds)
+        else:
+            assert view.bounds == tuple(geom.bounds)
+        if geom.geom_type == 'GeometryCollection':
+            with pytest.raises(NotImplementedError):
+                view.coords
+        else:
+            coords = view.coords.tolist()
+            assert coords == [list(c) for c in _flatten_coords(geom)]
+        # unknown attributes are delegated to the deserialized geometry
+        assert view.length == geom.length
+        assert view.to_shapely().equals(geom)
+
+    @pytest.mark.skipif(not shapely.__version__.startswith('2.'), reason="SRID requires shapely 2.x")
+    def test_serialized_geometry_srid(self):
+        geom = shapely.set_srid(Point(10, 20), 4326)
+        buf = geometry_serde.serialize(geom)
+        assert geometry_serde.SerializedGeometry(buf).srid == 4326
+        assert shapely.get_srid(geometry_serde.deserialize(buf)[0]) == 4326
+
+    @pytest.mark.parametrize("info_func", [
+        geometry_serde.geometry_info_array,
+        geometry_serde._geometry_info_array_py,
+    ])
+    def test_geometry_info_array(self, info_func):
+        import numpy as np
+        geoms = [
+            Point(10, 20),
+            None,
+            wkt_loads("POLYGON EMPTY"),
+            LineString([(10, 20, 1), (-30, 40, 2)]),
+            MultiPolygon([Polygon([(0, 0), (0, 10), (10, 10), (0, 0)]),
+                          Polygon([(20, 20), (20, 30), (30, 30), (20, 20)])]),
+            GeometryCollection([Point(-5, 3), LineString([(10, 20), (30, 40)])]),
+        ]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        info = info_func(data, offsets, validity)
+        assert list(info['geom_type']) == [1, 0, 3, 2, 6, 7]
+        assert list(info['srid']) == [0] * 6
+        assert list(info['dims']) == [2, 0, 2, 3, 2, 2]
+        assert list(info['num_coords']) == [1, 0, 0, 2, 8, 3]
+        assert list(info['is_empty']) == [False, True, True, False, False, False]
+        for k, geom in enumerate(geoms):
+            bounds = (info['xmin'][k], info['ymin'][k], info['xmax'][k], info['ymax'][k])
+            if geom is None or geom.is_empty:
+                assert np.isnan(bounds).all()
+            else:
+                assert bounds == tuple(geom.bounds)
+
+        info = info_func(data, offsets, validity, compute_bounds=False)
+        assert list(info['num_coords']) == [1, 0, 0, 2, 8, 3]
+        assert np.isnan(info['xmin']).all()
+
+    def test_geometry_info_deeply_nested(self):
+        buf = _nested_collection(Point(1, 2), _MAX_NESTING_DEPTH)
+        assert geometry_serde.geometry_info_array([buf])['num_coords'][0] == 1
+        assert geometry_serde.SerializedGeometry(buf).bounds == (1, 2, 1, 2)
+        for depth in [_MAX_NESTING_DEPTH + 1, 200000]:
+            buf = _nested_collection(Point(1, 2), depth)
+            with pytest.raises(ValueError):
+                geometry_serde.geometry_info_array([buf])
+            with pytest.raises(ValueError):
+                geometry_serde.SerializedGeometry(buf).num_coords
+
+    @pytest.mark.parametrize("byte_order", [0, 1])
+    @pytest.mark.parametrize("wkt", [
+        'POINT EMPTY',
+        'POINT (10 20 30)',
+        'POLYGON EMPTY',
+        'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))',
+        'MULTIPOINT ((10 20), (30 40))',
+        'MULTILINESTRING Z ((10 20 1, 30 40 2), (50 60 3, 70 80 4))',
+        'MULTIPOLYGON (((0 0, 0 10, 10 10, 0 0)), EMPTY)',
+        'GEOMETRYCOLLECTION (POINT (10 20), GEOMETRYCOLLECTION (LINESTRING (10 20, 30 40)))',
+    ])
+    def test_wkb(self, wkt, byte_order):
+        geom = shapely.set_srid(wkt_loads(wkt), 4326)
+        buf = geometry_serde.serialize(geom)
+        for include_srid in [False, True]:
+            wkb = geometry_serde.to_wkb(buf, byte_order, include_srid)
+            assert wkb == shapely.to_wkb(geom, byte_order=byte_order, include_srid=include_srid,
+                                         flavor="extended")
+        assert geometry_serde.from_wkb(shapely.to_wkb(geom, byte_order=byte_order, include_srid=True)) == buf
+        iso_wkb = shapely.to_wkb(geom, byte_order=byte_order, flavor="iso")
+        assert geometry_serde.from_wkb(iso_wkb) == geometry_serde.serialize(wkt_loads(wkt))
+
+    def test_wkb_deeply_nested(self):
+        point = Point(1, 2, 3)
+        point_wkb = shapely.to_wkb(point, flavor="extended")
+
+        def nested_wkb(depth):
+            # Dimensions of collections are derived from their children
+            return struct.pack('<BII', 1, 7 | 0x80000000, 1) * depth + point_wkb
+
+        buf = _nested_collection(point, _MAX_NESTING_DEPTH)
+        assert geometry_serde.to_wkb(buf) == nested_wkb(_MAX_NESTING_DEPTH)
+        assert geometry_serde.from_wkb(nested_wkb(_MAX_NESTING_DEPTH)) == buf
+        for depth in [_MAX_NESTING_DEPTH + 1, 200000]:
+            with pytest.raises(ValueError):
+                geometry_serde.to_wkb(_nested_collection(point, depth))
+            with pytest.raises(ValueError):
+                geometry_serde.from_wkb(nested_wkb(depth))
+
+    def test_wkb_array(self):
+        geoms = [Point(10, 20), None, wkt_loads("POLYGON EMPTY"), LineString([(10, 20, 1), (-30, 40, 2)])]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        wkb_data, wkb_offsets, wkb_validity = geometry_serde.to_wkb_array(data, offsets, validity, byte_order=0)
+        assert list(wkb_validity) == list(validity)
+        for k, geom in enumerate(geoms):
+            wkb = bytes(wkb_data[wkb_offsets[k]:wkb_offsets[k + 1]])
+            assert wkb == (shapely.to_wkb(geom, byte_order=0) if geom is not None else b'')
+        assert geometry_serde.from_wkb_array(wkb_data, wkb_offsets, wkb_validity)[0] == data
+        with pytest.raises(ValueError):
+            geometry_serde.from_wkb_array([shapely.to_wkb(Point(1, 2)), b'\x01\x01\x00'])
+
+    @pytest.mark.parametrize("wkt", [
+        'POINT EMPTY',
+        'POINT (10.5 -20.25)',
+        'POINT Z (1 2 3)',
+        'LINESTRING (0.1 0.2, 1e+20 1e-7)',
+        'POLYGON EMPTY',
+        'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))',
+        'MULTIPOINT (EMPTY, (10 20))',
+        'MULTILINESTRING ((10 20, 30 40), EMPTY)',
+        'MULTIPOLYGON (((0 0, 0 10, 10 10, 0 0)), EMPTY)',
+        'GEOMETRYCOLLECTION (POINT Z (10 20 30), LINESTRING (10 20, 30 40))',
+        'GEOMETRYCOLLECTION EMPTY',
+    ])
+    def test_wkt_and_geojson(self, wkt):
+        import json
+        geom = shapely.set_srid(wkt_loads(wkt), 4326)
+        buf = geometry_serde.serialize(geom)
+        assert geometry_serde.to_wkt(buf) == shapely.to_wkt(geom, rounding_precision=-1)
+        assert geometry_serde.to_wkt(buf, include_srid=True) == 'SRID=4326;' + shapely.to_wkt(geom, rounding_precision=-1)
+        geojson = json.loads(geometry_serde.to_geojson(buf))
+        expected = json.loads(shapely.to_geojson(shapely.from_wkt(wkt.replace('EMPTY, ', ''))))
+        if geom.geom_type == 'Polygon' and geom.is_empty:
+            expected['coordinates'] = []
+        elif geom.geom_type == 'MultiPolygon':
+            expected['coordinates'][-1] = []
+        assert geojson == expected
+
+    def test_wkt_precision(self):
+        import random
+        rng = random.Random(42)
+        coords = [(rng.uniform(-180, 180), rng.uniform(-1e-3, 1e-3)) for _ in range(1000)]
+        buf = geometry_serde.serialize(LineString(coords))
+        # Full precision WKT round-trips
+        assert list(wkt_loads(geometry_serde.to_wkt(buf)).coords) == coords
+        for (x, y), (x_rounded, y_rounded) in zip(coords, wkt_loads(geometry_serde.to_wkt(buf, 3)).coords):
+            assert x_rounded == round(x, 3) and y_rounded == round(y, 3)
+        assert geometry_serde.to_wkt(geometry_serde.serialize(Point(1 / 3, -2 / 3)), 4) == 'POINT (0.3333 -0.6667)'
+        assert geometry_serde.to_geojson(geometry_serde.serialize(Point(1 / 3, 10)), 2) == \
+            '{"type":"Point","coordinates":[0.33,10]}'
+
+    def test_wkt_and_geojson_deeply_nested(self):
+        depth = _MAX_NESTING_DEPTH
+        buf = _nested_collection(Point(1, 2), depth)
+        assert geometry_serde.to_wkt(buf) == 'GEOMETRYCOLLECTION (' * depth + 'POINT (1 2)' + ')' * depth
+        assert geometry_serde.to_geojson(buf) == \
+            '{"type":"GeometryCollection","geometries":[' * depth + \
+            '{"type":"Point","coordinates":[1,2]}' + ']}' * depth
+        for depth in [_MAX_NESTING_DEPTH + 1, 200000]:
+            buf = _nested_collection(Point(1, 2), depth)
+            with pytest.raises(ValueError):
+                geometry_serde.to_wkt(buf)
+            with pytest.raises(ValueError):
+                geometry_serde.to_geojson(buf)
+
+    def test_text_array(self):
+        geoms = [Point(10, 20), None, wkt_loads("POLYGON EMPTY"), LineString([(10, 20, 1), (-30, 40, 2)])]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        for to_text_array, to_text in [(geometry_serde.to_wkt_array, geometry_serde.to_wkt),
+                                       (geometry_serde.to_geojson_array, geometry_serde.to_geojson)]:
+            text_data, text_offsets, text_validity = to_text_array(data, offsets, validity, precision=1)
+            assert list(text_validity) == list(validity)
+            for k, geom in enumerate(geoms):
+                text = bytes(text_data[text_offsets[k]:text_offsets[k + 1]]).decode()
+                if geom is None:
+                    assert text == ''
+                else:
+                    assert text == to_text(geometry_serde.serialize(geom), 1)
+
+    @pytest.mark.parametrize("interleaved", [True, False])
+    @pytest.mark.parametrize("wkts", [
+        ['POINT (10 20)', None, 'POINT EMPTY', 'POINT (30 40)'],
+        ['LINESTRING Z (10 20 1, 30 40 2)', 'LINESTRING EMPTY', None],
+        ['POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))', None, 'POLYGON EMPTY'],
+        ['MULTIPOINT ((10 20), (30 40))', 'MULTIPOINT EMPTY', None],
+        ['MULTILINESTRING ((10 20, 30 40), (50 60, 70 80))', None, 'MULTILINESTRING EMPTY'],
+        ['MULTIPOLYGON (((0 0, 0 10, 10 10, 0 0)), ((20 20, 20 30, 30 30, 20 20)))', None],
+    ])
+    def test_geoarrow(self, wkts, interleaved):
+        geoms = [wkt_loads(wkt) if wkt is not None else None for wkt in wkts]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        arr = geometry_serde.to_geoarrow(data, offsets, validity, interleaved=interleaved)
+        data, offsets, validity = geometry_serde.from_geoarrow(arr)
+        assert list(geometry_serde.deserialize_array(data, offsets, validity)) == geoms
+
+        # The array could be exported multiple times
+        data, offsets, validity = geometry_serde.from_geoarrow(arr.__arrow_c_array__())
+        assert list(geometry_serde.deserialize_array(data, offsets, validity)) == geoms
+
+    def test_geoarrow_types(self):
+        geoms = [shapely.set_srid(geom, 4326) for geom in [
+            LineString([(10, 20), (30, 40)]),
+            MultiLineString([[(1, 2, 3), (4, 5, 6)]]),
+            wkt_loads('POINT EMPTY'),
+            wkt_loads('GEOMETRYCOLLECTION EMPTY'),
+        ]]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        arr = geometry_serde.to_geoarrow(data, offsets, validity)
+        data, offsets, validity = geometry_serde.from_geoarrow(arr)
+        result = list(geometry_serde.deserialize_array(data, offsets, validity))
+        assert [geom.wkt for geom in result] == [
+            'MULTILINESTRING Z ((10 20 NaN, 30 40 NaN))',
+            'MULTILINESTRING Z ((1 2 3, 4 5 6))',
+            'MULTILINESTRING EMPTY',
+            'MULTILINESTRING EMPTY',
+        ]
+        assert [shapely.get_srid(geom) for geom in result] == [4326] * 4
+
+        for wkts in [['POINT (1 2)', 'LINESTRING (1 2, 3 4)'],
+                     ['GEOMETRYCOLLECTION (POINT (1 2))']]:
+            data, offsets, _ = geometry_serde.serialize_array([wkt_loads(wkt) for wkt in wkts])
+            with pytest.raises(ValueError):
+                geometry_serde.to_geoarrow(data, offsets)
+
+    def test_geoarrow_sliced(self):
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+        geoms = [wkt_loads('POLYGON ((0 0, 0 10, 10 10, 0 0))'), None,
+                 wkt_loads('POLYGON ((1 1, 2 2, 1 2, 1 1), (0 0, 1 1, 0 1, 0 0))')]
+        for interleaved in [True, False]:
+            data, offsets, validity = geometry_serde.serialize_array(geoms)
+            schema, array = geometry_serde.to_geoarrow(data, offsets, validity, interleaved).__arrow_c_array__()
+            # Slice the array by adjusting length and offset of the ArrowArray struct
+            fields = ctypes.cast(get_pointer(array, b"arrow_array"), ctypes.POINTER(ctypes.c_int64))
+            fields[0] -= 1
+            fields[2] += 1
+            data, offsets, validity = geometry_serde.from_geoarrow((schema, array), geom_type='polygon')
+            assert list(geometry_serde.deserialize_array(data, offsets, validity)) == geoms[1:]
+
+    def test_geoarrow_pyarrow(self):
+        pa = pytest.importorskip("pyarrow")
+        geoms = [Point(10, 20), None, Point(30, 40)]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        arr = pa.array(geometry_serde.to_geoarrow(data, offsets, validity))
+        assert len(arr) == 3 and arr.null_count == 1
+        data, offsets, validity = geometry_serde.from_geoarrow(arr, geom_type='point')
+        assert list(geometry_serde.deserialize_array(data, offsets, validity)) == geoms
+
+    @pytest.mark.parametrize("large", [False, True])
+    def test_arrow_binary_input(self, large):
+        import numpy as np
+        geoms = [Point(10, 20), None, wkt_loads("POLYGON EMPTY"), LineString([(10, 20, 1), (-30, 40, 2)])]
+        bufs = [geometry_serde.serialize(geom) if geom is not None else None for geom in geoms]
+        arr = _ArrowBinaryArray(bufs, large=large)
+        assert list(geometry_serde.deserialize_array(arr)) == geoms
+        assert list(geometry_serde.deserialize_array(arr.__arrow_c_array__())) == geoms
+        assert geometry_serde.to_wkb_array(arr)[0] == geometry_serde.to_wkb_array(bufs)[0]
+
+        # Sliced arrays
+        arr = _ArrowBinaryArray(bufs, offset=1, large=large)
+        assert list(geometry_serde.deserialize_array(arr)) == geoms[1:]
+
+        # Buffers of Arrow binary arrays with int32 offsets
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        result = geometry_serde.deserialize_array(data, offsets.astype(np.int32), validity)
+        assert list(result) == geoms
+
+    def test_arrow_binary_input_pyarrow(self):
+        pa = pytest.importorskip("pyarrow")
+        geoms = [Point(10, 20), None, LineString([(10, 20), (30, 40)])]
+        bufs = [geometry_serde.serialize(geom) if geom is not None else None for geom in geoms]
+        for arr in [pa.array(bufs, pa.binary()), pa.array(bufs, pa.large_binary())]:
+            assert list(geometry_serde.deserialize_array(arr)) == geoms
+            assert list(geometry_serde.deserialize_array(arr.slice(1))) == geoms[1:]
+
+    def test_serialize_empty_array(self):
+        data, offsets, validity = geometry_serde.serialize_array([])
+        assert len(data) == 0
+        assert list(offsets) == [0]
+        assert len(validity) == 0
+
+    def test_deserialize_array(self):
+        geoms = [
+            Point(10, 20),
+            None,
+            wkt_loads("POLYGON EMPTY"),
+            MultiLineString([[(10, 20), (30, 40)], [(50, 60), (70, 80)]]),
+            GeometryCollection([Point(10, 20), LineString([(10, 20), (30, 40)])]),
+        ]
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        from_buffers = geometry_serde.deserialize_array(data, offsets, validity)
+        from_list = geometry_serde.deserialize_array(
+            [bytes(geometry_serde.serialize(g)) if g is not None else None for g in geoms])
+        for result in [from_buffers, from_list]:
+            assert len(result) == len(geoms)
+            for geom, geom_actual in zip(geoms, result):
+                if geom is None:
+                    assert geom_actual is None
+                else:
+                    assert geom_actual.equals_exact(geom, 1e-6)
+
+    @pytest.mark.parametrize("num_threads", [1, 2, 4, 16])
+    def test_array_serde_multithreaded(self, num_threads):
+        large_polygon = Polygon([(n, 0) for n in range(1000)] + [(0, 1000), (0, 0)])
+        geoms = []
+        for k in range(2000):
+            if k % 7 == 0:
+                geoms.append(None)
+            elif k % 500 == 0:
+                geoms.append(large_polygon)
+            else:
+                geoms.append(Point(k, k + 1))
+        data, offsets, validity = geometry_serde.serialize_array(geoms, num_threads=num_threads)
+        data_1, offsets_1, validity_1 = geometry_serde.serialize_array(geoms, num_threads=1)
+        assert data == data_1
+        assert list(offsets) == list(offsets_1)
+        assert list(validity) == list(validity_1)
+        result = geometry_serde.deserialize_array(data, offsets, validity, num_threads=num_threads)
+        for geom, geom_actual in zip(geoms, result):
+            if geom is None:
+                assert geom_actual is None
+            else:
+                assert geom_actual.equals_exact(geom, 1e-6)
+
+    def test_deserialize_array_multithreaded_error(self):
+        bufs = [bytes(geometry_serde.serialize(Point(k, k))) for k in range(1000)]
+        bufs[600] = b'\x12\x00\x00\x00'
+        with pytest.raises(ValueError):
+            geometry_serde.deserialize_array(bufs, num_threads=4)
+
+    def test_deserialize_array_bad_offsets(self):
+        data, offsets, validity = geometry_serde.serialize_array([Point(10, 20)])
+        offsets[1] = len(data) + 1
+        with pytest.raises(ValueError):
+            geometry_serde.deserialize_array(data, offsets)
+
+    def test_batch_input_mutated_concurrently(self):
+        import threading
+        import numpy as np
+        geom = LineString(np.random.default_rng(0).random((5000, 2)))
+        geoms = [geom] * 16
+        bufs = [geometry_serde.serialize(geom)] * 16
+        stop = threading.Event()
+
+        # Items replaced by another thread while batches are processed without
+        # holding the GIL should not be released under our feet
+        def mutate():
+            k = 0
+            while not stop.is_set():
+                geoms[k % 16] = LineString(geom.coords)
+                bufs[k % 16] = bytes(bufs[(k + 1) % 16])
+                k += 1
+
+        thread = threading.Thread(target=mutate)
+        thread.start()
+        try:
+            for _ in range(50):
+                data, offsets, validity = geometry_serde.serialize_array(geoms, 4)
+                assert len(offsets) == 17
+                for result in geometry_serde.deserialize_array(bufs, num_threads=4):
+                    assert result.equals_exact(geom, 0)
+        finally:
+            stop.set()
+            thread.join()
+
+    @pytest.mark.parametrize("coord_encoding,tolerance", [('float32', 1e-5), ('quantized', 1e-7), ('xor', 0)])
+    @pytest.mark.parametrize("wkt", [
+        'POINT EMPTY',
+        'POINT (10.125 -20.5)',
+        'LINESTRING Z (0.1 0.2 0.3, 1.1 1.2 1.3, 2.1 2.2 2.3)',
+        'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))',
+        'MULTIPOINT ((1.5 2.5), (10 20))',
+        'MULTILINESTRING ((10 20, 30 40), EMPTY)',
+        'MULTIPOLYGON (((0 0, 0 10, 10 10, 0 0)), EMPTY, ((20 20, 20 30, 30 30, 20 20)))',
+        'GEOMETRYCOLLECTION (POINT Z (10 20 30), GEOMETRYCOLLECTION (LINESTRING (10 20, 30 40)))',
+    ])
+    def test_coord_encoding(self, wkt, coord_encoding, tolerance):
+        geom = shapely.set_srid(wkt_loads(wkt), 4326)
+        buf = geometry_serde.serialize(geom)
+        encoded = geometry_serde.encode_coords(buf, coord_encoding)
+        geom_actual, size = geometry_serde.deserialize(encoded)
+        assert size == len(encoded)
+        assert shapely.get_srid(geom_actual) == 4326
+        assert geom_actual.equals_exact(geom, tolerance)
+        if tolerance == 0:
+            assert geometry_serde.to_wkb(encoded) == geometry_serde.to_wkb(buf)
+            assert geometry_serde.to_wkt(encoded) == geometry_serde.to_wkt(buf)
+            assert geometry_serde.encode_coords(encoded, 'none') == buf
+        info = geometry_serde.geometry_info_array([encoded])
+        assert info['num_coords'][0] == shapely.get_num_coordinates(geom)
+        ser = geometry_serde.SerializedGeometry(encoded)
+        assert ser.geom_type == geom.geom_type
+        if not geom.is_empty and geom.geom_type != 'GeometryCollection':
+            import numpy as np
+            coords = np.asarray(ser.coords)
+            assert np.allclose(coords, np.array(list(_flatten_coords(geom))), rtol=0, atol=tolerance)
+
+    def test_coord_encoding_deeply_nested(self):
+        buf = _nested_collection(Point(1.5, 2.5), _MAX_NESTING_DEPTH)
+        encoded = geometry_serde.encode_coords(buf, 'xor')
+        assert geometry_serde.encode_coords(encoded, 'none') == buf
+        for depth in [_MAX_NESTING_DEPTH + 1, 200000]:
+            with pytest.raises(ValueError):
+                geometry_serde.encode_coords(_nested_collection(Point(1.5, 2.5), depth), 'xor')
+
+    def test_coord_encoding_array(self):
+        import random
+        import numpy as np
+        rng = random.Random(42)
+        geoms = []
+        for _ in range(20):
+            # Random walk on a grid like digitized tracks, which XOR encoding compresses
+            x, y, coords = rng.uniform(-180, 180), rng.uniform(-90, 90), []
+            for _ in range(100):
+                x, y = x + rng.randint(-100, 100) / 1024, y + rng.randint(-100, 100) / 1024
+                coords.append((x, y))
+            geoms.append(LineString(coords))
+        geoms[5] = None
+        data, offsets, validity = geometry_serde.serialize_array(geoms)
+        for coord_encoding in ['float32', 'quantized', 'xor']:
+            enc_data, enc_offsets, enc_validity = geometry_serde.encode_coords_array(
+                data, offsets, validity, coord_encoding=coord_encoding, num_threads=2)
+            assert list(enc_validity) == list(validity)
+            assert len(enc_data) < len(data)
+            for geom, geom_actual in zip(geoms, geometry_serde.deserialize_array(enc_data, enc_offsets, enc_validity)):
+                if geom is None:
+                    assert geom_actual is None
+                else:
+                    assert geom_actual.equals_exact(geom, 1e-4)
+
+        # A coarse quantization step is honored
+        enc_data, enc_offsets, enc_validity = geometry_serde.encode_coords_array(
+            data, offsets, validity, coord_encoding='quantized', step=0.5)
+        geom_actual = geometry_serde.deserialize_array(enc_data, enc_offsets, enc_validity)[0]
+        errors = np.abs(shapely.get_coordinates(geom_actual) - shapely.get_coordinates(geoms[0]))
+        assert errors.max() <= 0.25 + 1e-9 and errors.max() > 1e-3
+        with pytest.raises(ValueError):
+            geometry_serde.encode_coords(geometry_serde.serialize(Point(1, 2)), 17)
+
+    @pytest.mark.parametrize("wkt", [
+        'POINT (1 2)',
+        'LINESTRING Z (0 0 1, 1 1 2, 2 3 3)',
+        'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))',
+        'MULTILINESTRING ((0 0, 1 1), (2 2, 3 3, 4 4))',
+        'MULTIPOLYGON (((0 0, 0 10, 10 10, 0 0)), EMPTY, ((20 20, 20 30, 30 30, 20 20)))',
+        'GEOMETRYCOLLECTION (POINT Z (10 20 30), GEOMETRYCOLLECTION (LINESTRING (10 20, 30 40)), POLYGON EMPTY)',
+    ])
+    def test_validate(self, wkt):
+        buf = bytes(geometry_serde.serialize(wkt_loads(wkt)))
+        bufs = [buf] + [bytes(geometry_serde.encode_coords(buf, e)) for e in ['float32', 'quantized', 'xor']]
+        for buf in bufs:
+            assert geometry_serde.validate(buf) == geometry_serde.VALID
+            # Every truncation is reported, deserialize fails on the same buffers
+            for size in range(len(buf)):
+                code = geometry_serde.validate(buf[:size])
+                assert code != geometry_serde.VALID
+                with pytest.raises(Exception):
+                    geometry_serde.deserialize(buf[:size])
+
+    def test_validate_corrupted(self):
+        import struct
+        buf = bytearray(geometry_serde.serialize(wkt_loads('MULTILINESTRING ((0 0, 1 1), (2 2, 3 3, 4 4))')))
+        bad_type = bytearray(buf)
+        bad_type[0] = 0x01
+        assert geometry_serde.validate(bytes(bad_type)) == geometry_serde.ERROR_UNKNOWN_GEOM_TYPE
+        bad_coord_type = bytearray(buf)
+        bad_coord_type[0] = 0x50
+        assert geometry_serde.validate(bytes(bad_coord_type)) == geometry_serde.ERROR_UNKNOWN_COORD_TYPE
+        # Number of points of a line exceeds num_coords
+        bad_count = bytearray(buf)
+        struct.pack_into('i', bad_count, 8 + 5 * 16 + 4, 100)
+        assert geometry_serde.validate(bytes(bad_count)) != geometry_serde.VALID
+        with pytest.raises(Exception):
+            geometry_serde.deserialize(bytes(bad_count))
+        assert geometry_serde.validation_error_message(geometry_serde.ERROR_BAD_GEOM_BUFFER)
+
+    def test_nesting_depth_limit(self):
+        # Validation accepts exactly the nesting depths deserialization does
+        nested = Point(1, 2)
+        for k in range(_MAX_NESTING_DEPTH):
+            nested = GeometryCollection([nested])
+        buf = _nested_collection(Point(1, 2), _MAX_NESTING_DEPTH)
+        assert geometry_serde.serialize(nested) == buf
+        assert geometry_serde.validate(buf) == geometry_serde.VALID
+        assert geometry_serde.deserialize(buf)[0].equals_exact(nested, 0)
+
+        with pytest.raises(ValueError):
+            geometry_serde.serialize(GeometryCollection([nested]))
+        for depth in [_MAX_NESTING_DEPTH + 1, 200000]:
+            buf = _nested_collection(Point(1, 2), depth)
+            assert geometry_serde.validate(buf) == geometry_serde.ERROR_BAD_GEOM_BUFFER
+            with pytest.raises(ValueError):
+                geometry_serde.deserialize(buf)
+
+    def test_validate_fuzz(self):
+        import random
+        rng = random.Random(42)
+        wkts = [
+            'POINT Z (1 2 3)',
+            'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))',
+            'MULTIPOINT ((1 2), (3 4))',
+            'GEOMETRYCOLLECTION (LINESTRING (10 20, 30 40), POLYGON EMPTY)',
+        ]
+        bufs = []
+        for wkt in wkts:
+            buf = bytes(geometry_serde.serialize(wkt_loads(wkt)))
+            bufs += [buf, bytes(geometry_serde.encode_coords(buf, 'xor'))]
+        for k in range(2000):
+            buf = bytearray(rng.choice(bufs))
+            for _ in range(rng.randint(1, 3)):
+                buf[rng.randrange(len(buf))] = rng.randrange(256)
+            code = geometry_serde.validate(bytes(buf))
+            if code != geometry_serde.VALID:
+                with pytest.raises(Exception):
+                    geometry_serde.deserialize(bytes(buf))
+
+    def test_validate_array(self):
+        import numpy as np
+        buf = bytes(geometry_serde.serialize(wkt_loads('LINESTRING (0 0, 1 1, 2 3)')))
+        bufs = [buf, buf[:-4], None, buf, b'\xff' * 8]
+        data = b''.join(b for b in bufs if b is not None)
+        offsets = np.cumsum([0] + [len(b) if b is not None else 0 for b in bufs]).astype(np.int64)
+        validity = np.packbits([b is not None for b in bufs], bitorder='little')
+        for num_threads in [1, 2]:
+            codes = geometry_serde.validate_array(data, offsets, validity, num_threads=num_threads)
+            assert list(codes) == [geometry_serde.validate(b) if b is not None else 0 for b in bufs]
+            assert list(codes != 0) == [False, True, False, False, True]
+
+    @pytest.mark.parametrize("path", ['auto', 'geos_buffer', 'shapely', 'loop'])
+    def test_coord_copy_path(self, path):
+        if path == 'shapely' and not shapely.__version__.startswith('2.'):
+            pytest.skip('shapely path requires shapely 2')
+        geoms = [wkt_loads(wkt) for wkt in [
+            'POINT Z (1 2 3)',
+            'LINESTRING (0 0, 1 1, 2 3)',
+            'LINESTRING Z (0 0 1, 1 1 2, 2 3 NaN)',
+            'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 1 2, 2 2, 1 1))',
+            'MULTIPOINT Z ((10 20 30), (40 50 60))',
+            'GEOMETRYCOLLECTION (POINT (10 20), LINESTRING (10 20, 30 40), LINESTRING EMPTY)',
+        ]]
+        expected = [geometry_serde.serialize(geom) for geom in geoms]
+        prev_path = geometry_serde.set_coord_copy_path(path)
+        try:
+            assert geometry_serde.set_coord_copy_path(path) == path
+            for geom, buf in zip(geoms, expected):
+                assert geometry_serde.serialize(geom) == buf
+                geom_actual = geometry_serde.deserialize(buf)[0]
+                assert geom_actual.equals_exact(geom, 0) or geom_actual.wkt == geom.wkt
+                assert geom_actual.has_z == geom.has_z
+            assert list(geometry_serde.deserialize_array(*geometry_serde.serialize_array(geoms))) == geoms
+        finally:
+            geometry_serde.set_coord_copy_path(prev_path)
+
+    def test_stats(self):
+        geoms = [wkt_loads(wkt) for wkt in [
+            'POINT (1 2)',
+            'LINESTRING Z (0 0 1, 1 1 2, 2 3 3)',
+            'POLYGON ((0 0, 0 10, 10 10, 0 0))',
+            'GEOMETRYCOLLECTION (POINT (10 20), LINESTRING (10 20, 30 40))',
+        ]]
+        geometry_serde.reset_stats()
+        geometry_serde.set_stats_sampling(1)
+        try:
+            bufs = [geometry_serde.serialize(geom) for geom in geoms]
+            for buf in bufs:
+                geometry_serde.deserialize(buf)
+            geometry_serde.deserialize_array(*geometry_serde.serialize_array(geoms * 10, 2), num_threads=2)
+            with pytest.raises(Exception):
+                geometry_serde.deserialize(b'\x01' * 8)
+            stats = geometry_serde.stats()
+        finally:
+            geometry_serde.set_stats_sampling(0)
+
+        # Counters of worker threads are included, children of collections
+        # are not counted as separate geometries
+        assert stats['serialized']['polygon'] == {'count': 11, 'bytes': 11 * len(bufs[2])}
+        assert stats['deserialized']['geometrycollection'] == {'count': 11, 'bytes': 11 * len(bufs[3])}
+        assert stats['deserialized']['multipoint']['count'] == 0
+        assert stats['serialized_coords'] == stats['deserialized_coords'] == 11 * (1 + 3 + 4 + 3)
+        assert stats['errors']['unknown_coord_type'] == 1
+        for stage in ['header_parse', 'coord_copy', 'geos_construct', 'python_wrap']:
+            timing = stats['timings'][stage]
+            assert timing['count'] > 0 and sum(timing['buckets']) == timing['count']
+
+        text = geometry_serde.stats_openmetrics(stats)
+        assert 'sedona_serde_serialized_geometries_total{type="polygon"} 11\n' in text
+        assert 'sedona_serde_stage_seconds_bucket{stage="python_wrap",le="+Inf"} ' in text
+        assert text.endswith('# EOF\n')
+
+        geometry_serde.reset_stats()
+        stats = geometry_serde.stats()
+        assert stats['serialized']['polygon']['count'] == 0
+        assert stats['timings']['coord_copy']['count'] == 0
+
+    def test_stats_reset_concurrently(self):
+        import threading
+        buf = geometry_serde.serialize(Point(1, 2))
+        counted = threading.Event()
+        reset = threading.Event()
+
+        def work():
+            geometry_serde.deserialize(buf)
+            counted.set()
+            reset.wait()
+            for _ in range(5):
+                geometry_serde.deserialize(buf)
+
+        # Resetting does not write counters of other threads, geometries
+        # deserialized by a thread before the reset are excluded whether or
+        # not the thread has exited
+        thread = threading.Thread(target=work)
+        thread.start()
+        counted.wait()
+        geometry_serde.reset_stats()
+        reset.set()
+        thread.join()
+        assert geometry_serde.stats()['deserialized']['point']['count'] == 5
+
+        data, offsets, validity = geometry_serde.serialize_array([Point(1, 2)] * 1000)
+        thread = threading.Thread(target=lambda: [
+            geometry_serde.deserialize_array(data, offsets, validity, num_threads=4) for _ in range(20)])
+        thread.start()
+        while thread.is_alive():
+            geometry_serde.reset_stats()
+            assert geometry_serde.stats()['deserialized']['point']['count'] >= 0
+        thread.join()
+
+    def test_alloc_stats(self):
+        import os
+        import subprocess
+        import sys
+        import numpy as np
+        coords = np.arange(200000, dtype=float).reshape(-1, 2)
+        buf = geometry_serde.encode_coords(geometry_serde.serialize(LineString(coords)), 'xor')
+        decoded_size = coords.nbytes
+
+        # Decoded coordinates are too large to be retained by the scratch
+        # arena, so they are allocated and freed by every call
+        geometry_serde.deserialize(buf)
+        geometry_serde.reset_stats()
+        geometry_serde.deserialize(buf)
+        stats = geometry_serde.stats()
+        assert stats['allocs'] >= 1 and stats['alloc_bytes'] >= decoded_size
+        assert stats['frees'] == stats['allocs']
+        assert stats['free_bytes'] == stats['alloc_bytes']
+
+        # Native buffers are only traced when tracemalloc was requested
+        # before the module was imported
+        repo_root = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+        env = dict(os.environ, PYTHONPATH=os.pathsep.join([repo_root, os.environ.get('PYTHONPATH', '')]))
+        result = subprocess.run([sys.executable, '-X', 'tracemalloc', '-c', _TRACEMALLOC_SCRIPT],
+                                input=buf.hex(), capture_output=True, text=True, env=env)
+        assert result.returncode == 0, result.stderr
+        assert int(result.stdout) >= decoded_size
+
+    @pytest.mark.skipif(not shapely.__version__.startswith('2.'), reason="stand-in classes require shapely 2.x")
+    def test_shapely_1_functions(self):
+        import json
+        import os
+        import subprocess
+        import sys
+        wkts = [
+            'POINT (1 2)',
+            'POINT Z (1 2 3)',
+            'LINESTRING (0 0, 1 1, 2 3)',
+            'POLYGON ((0 0, 0 10, 10 10, 0 0), (1 1, 2 2, 1 2, 1 1))',
+            'MULTIPOINT ((1 2), (3 4))',
+            'MULTILINESTRING Z ((0 0 1, 1 1 2), (2 2 3, 3 3 4))',
+            'MULTIPOLYGON (((0 0, 0 1, 1 1, 0 0)), ((5 5, 5 6, 6 6, 5 5)))',
+            'GEOMETRYCOLLECTION (POINT (1 2), LINESTRING (0 0, 1 1))',
+        ]
+        geoms = [wkt_loads(wkt) for wkt in wkts]
+        cases = [(geometry_serde.serialize(geom).hex(), geom.geom_type, 3 if geom.has_z else 2) for geom in geoms]
+        repo_root = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+        env = dict(os.environ, PYTHONPATH=os.pathsep.join([repo_root, os.environ.get('PYTHONPATH', '')]))
+        result = subprocess.run([sys.executable, '-c', _SHAPELY_1_SCRIPT, shapely.lib.__file__],
+                                input=json.dumps(cases), capture_output=True, text=True, env=env)
+        assert result.returncode == 0, result.stderr
+        assert result.stdout.strip() == 'ok'
+
+    def test_geos_context_pool(self):
+        import threading
+        buf = geometry_serde.serialize(Point(1, 2))
+
+        def work():
+            geometry_serde.deserialize(buf)
+
+        # Contexts of exited threads are reused by new threads instead of
+        # being leaked
+        geometry_serde.set_geos_context_pool_size(4)
+        try:
+            created = geometry_serde.stats()['geos_contexts']['created']
+            num_threads = 100
+            for _ in range(num_threads):
+                thread = threading.Thread(target=work)
+                thread.start()
+                thread.join()
+            contexts = geometry_serde.stats()['geos_contexts']
+            assert contexts['created'] - created < num_threads // 2
+            assert contexts['capacity'] == 4 and contexts['idle'] <= 4
+        finally:
+            geometry_serde.set_geos_context_pool_size(0)
+        with pytest.raises(ValueError):
+            geometry_serde.set_geos_context_pool_size(-1)
+
+    def test_load_libgeos_c_keeps_loaded_library(self):
+        from sedona.utils import geomserde_speedup
+        # Worker threads may be calling the loaded functions, so loading
+        # another library is a no-op once one was loaded
+        geomserde_speedup.load_libgeos_c('/nonexistent/libgeos_c.so')
+        geom = Point(1, 2)
+        assert geometry_serde.deserialize(geometry_serde.serialize(geom))[0].equals(geom)
+
     @staticmethod
     def _test_serde_roundtrip(geoms):
         for geom in geoms:
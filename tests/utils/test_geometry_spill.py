@@ -0,0 +1,108 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+
+import math
+
+import numpy as np
+import pytest
+
+from shapely.geometry import LineString
+from shapely.geometry import Point
+from shapely.geometry import Polygon
+from shapely.wkt import loads as wkt_loads
+from sedona.utils import geometry_serde
+from sedona.utils import geometry_spill
+from sedona.utils.geometry_spill import SpillFileReader, SpillFileWriter
+
+
+GEOMS = [
+    Point(10, 20),
+    None,
+    wkt_loads('POLYGON EMPTY'),
+    LineString([(float(n), float(n)) for n in range(100)]),
+    Polygon([(0, 0), (0, 10), (10, 10), (0, 0)]),
+    wkt_loads('MULTIPOLYGON (((0 0, 1 0, 1 1, 0 0)), ((5 5, 6 5, 6 6, 5 5)))'),
+    None,
+]
+
+
+class TestGeometrySpill:
+    @pytest.fixture
+    def spill_file(self, tmp_path):
+        path = tmp_path / 'geoms.spill'
+        with SpillFileWriter(path, batch_size=4) as writer:
+            writer.write_array(GEOMS)
+            for geom in GEOMS:
+                writer.write(geom)
+            writer.write_serialized_array(*geometry_serde.serialize_array(GEOMS))
+        return path
+
+    def test_roundtrip(self, spill_file):
+        with SpillFileReader(spill_file) as reader:
+            assert len(reader) == 3 * len(GEOMS)
+            assert list(reader) == GEOMS * 3
+            assert list(reader[3:10]) == (GEOMS * 3)[3:10]
+            assert list(reader[::3]) == (GEOMS * 3)[::3]
+            assert reader[-1] is None
+            assert reader[4] == GEOMS[4]
+            with pytest.raises(IndexError):
+                reader[len(reader)]
+            assert np.all(reader.offsets % 8 == 0)
+            batches = list(reader.iter_batches(batch_size=5))
+            assert [len(batch) for batch in batches] == [5, 5, 5, 5, 1]
+            assert list(np.concatenate(batches)) == GEOMS * 3
+
+    def test_bounds(self, spill_file):
+        with SpillFileReader(spill_file) as reader:
+            for geom, bounds in zip(GEOMS * 3, reader.bounds):
+                if geom is None or geom.is_empty:
+                    assert all(math.isnan(v) for v in bounds)
+                else:
+                    assert tuple(bounds) == geom.bounds
+
+    def test_zero_copy(self, spill_file):
+        with SpillFileReader(spill_file) as reader:
+            data, offsets, validity = reader.serialized_batch(3, 6)
+            assert data is reader._mmap
+            assert list(geometry_serde.deserialize_array(data, offsets, validity)) == GEOMS[3:6]
+            view = reader.get_serialized(4)
+            assert view.readonly
+            assert geometry_serde.deserialize(view)[0] == GEOMS[4]
+            assert reader.get_serialized(1) is None
+            view.release()
+
+    def test_pad_array(self):
+        data, offsets, validity = geometry_serde.serialize_array(GEOMS)
+        for pad_array in [geometry_spill.pad_array, geometry_spill._pad_array_py]:
+            padded = geometry_serde._batch_arrays(*pad_array(data, offsets, validity, 8))
+            assert np.all(padded[1] % 8 == 0)
+            assert list(geometry_serde.deserialize_array(*padded)) == GEOMS
+
+    def test_empty_file(self, tmp_path):
+        path = tmp_path / 'empty.spill'
+        SpillFileWriter(path).close()
+        with SpillFileReader(path) as reader:
+            assert len(reader) == 0
+            assert list(reader) == []
+            assert len(reader[0:10]) == 0
+
+    def test_invalid_file(self, tmp_path, spill_file):
+        path = tmp_path / 'truncated.spill'
+        path.write_bytes(spill_file.read_bytes()[:-3])
+        with pytest.raises(ValueError):
+            SpillFileReader(path)
@@ -0,0 +1,86 @@
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing,
+#  software distributed under the License is distributed on an
+#  "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+#  KIND, either express or implied.  See the License for the
+#  specific language governing permissions and limitations
+#  under the License.
+
+
+import io
+import socket
+import threading
+
+import pytest
+
+from shapely.geometry import LineString
+from shapely.geometry import Point
+from shapely.geometry import Polygon
+from shapely.wkt import loads as wkt_loads
+from sedona.utils import geometry_serde
+from sedona.utils import geometry_stream
+from sedona.utils.geometry_stream import GeometryStreamReader, GeometryStreamWriter
+
+
+GEOMS = [
+    Point(10, 20),
+    None,
+    wkt_loads('POLYGON EMPTY'),
+    LineString([(float(n), float(n)) for n in range(100)]),
+    Polygon([(0, 0), (0, 10), (10, 10), (0, 0)]),
+    None,
+]
+
+
+class TestGeometryStream:
+    @pytest.mark.parametrize("chunk_size", [1, 7, 1 << 20])
+    def test_roundtrip(self, chunk_size):
+        stream = io.BytesIO()
+        with GeometryStreamWriter(stream, buffer_size=64, batch_size=4) as writer:
+            writer.write_array(GEOMS)
+            for geom in GEOMS:
+                writer.write(geom)
+        stream.seek(0)
+        reader = GeometryStreamReader(stream, chunk_size=chunk_size)
+        assert list(reader) == GEOMS * 2
+
+    def test_frames(self):
+        data, offsets, validity = geometry_serde.serialize_array(GEOMS)
+        frames = geometry_stream.frame_array(data, offsets, validity)
+        assert frames == geometry_stream._frame_array_py(data, offsets, validity)
+        for split_frames in [geometry_stream.split_frames, geometry_stream._split_frames_py]:
+            # Partial record at the end is left for the next call
+            batch, consumed = split_frames(frames + frames[:10])
+            assert consumed == len(frames)
+            assert list(geometry_serde.deserialize_array(*batch)) == GEOMS
+
+    def test_truncated_stream(self):
+        stream = io.BytesIO()
+        with GeometryStreamWriter(stream) as writer:
+            writer.write_array(GEOMS)
+        reader = GeometryStreamReader(io.BytesIO(stream.getvalue()[:-3]), chunk_size=16)
+        with pytest.raises(ValueError):
+            list(reader)
+
+    def test_socket(self):
+        sender, receiver = socket.socketpair()
+
+        def send():
+            with sender, GeometryStreamWriter(sender, buffer_size=32) as writer:
+                for _ in range(100):
+                    writer.write_array(GEOMS)
+
+        thread = threading.Thread(target=send)
+        thread.start()
+        with receiver:
+            assert list(GeometryStreamReader(receiver, chunk_size=1000)) == GEOMS * 100
+        thread.join()